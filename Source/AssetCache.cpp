@@ -0,0 +1,176 @@
+/**
+ * =================================================================
+ * @file AssetCache.cpp
+ * @brief Implementation of the AssetCache class.
+ *
+ * Created: 18 Oct 2026 8:02:15pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "AssetCache.h"
+
+/**
+ * @brief Gets the shared cache contents.
+ * @return The store.
+ */
+AssetCache::Store& AssetCache::getStore()
+{
+    static Store store;
+    return store;
+}
+
+/**
+ * @brief Gets an embedded image, decoding it on first use.
+ * @param fileName The image's original file name in Assets (e.g. "knob.png").
+ * @return The image, or an invalid image if there is no such asset.
+ */
+juce::Image AssetCache::getImage(const juce::String& fileName)
+{
+    auto& store = getStore();
+
+    {
+        const juce::ScopedLock sl (store.lock);
+        auto found = store.images.find(fileName);
+
+        if (found != store.images.end())
+            return found->second;
+    }
+
+    // Decode outside the lock so parallel preloading is not serialised.
+    auto image = decode(fileName);
+
+    const juce::ScopedLock sl (store.lock);
+    return store.images.emplace(fileName, image).first->second;
+}
+
+/**
+ * @brief Gets an embedded image resampled by a scale factor.
+ * @param fileName The image's original file name in Assets.
+ * @param scale The scale to resample by.
+ * @return The rescaled image, or an invalid image if there is no such asset.
+ */
+juce::Image AssetCache::getScaledImage(const juce::String& fileName, float scale)
+{
+    auto& store = getStore();
+    const auto key = fileName + "@" + juce::String(scale, 3);
+
+    {
+        const juce::ScopedLock sl (store.lock);
+        auto found = store.scaled.find(key);
+
+        if (found != store.scaled.end())
+            return found->second;
+    }
+
+    auto image = getImage(fileName);
+
+    if (image.isValid())
+        image = image.rescaled(juce::jmax(1, juce::roundToInt(image.getWidth() * scale)),
+                               juce::jmax(1, juce::roundToInt(image.getHeight() * scale)),
+                               juce::Graphics::highResamplingQuality);
+
+    const juce::ScopedLock sl (store.lock);
+    return store.scaled.emplace(key, image).first->second;
+}
+
+/**
+ * @brief Decodes every embedded image in parallel.
+ *
+ * Work is shared between a few threads through an atomic index and the
+ * function returns once every image is in the cache.
+ */
+void AssetCache::preloadAll()
+{
+    juce::StringArray names;
+
+    for (int i = 0; i < BinaryData::namedResourceListSize; ++i)
+    {
+        const juce::String name (BinaryData::originalFilenames[i]);
+
+        if (name.endsWithIgnoreCase(".png"))
+            names.add(name);
+    }
+
+    std::atomic<int> next { 0 };
+    auto worker = [&] {
+        for (int i = next++; i < names.size(); i = next++)
+            getImage(names[i]);
+    };
+
+    const int numThreads = juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1);
+    std::vector<std::thread> threads;
+
+    for (int i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+/**
+ * @brief Releases every cached image.
+ */
+void AssetCache::clear()
+{
+    auto& store = getStore();
+    const juce::ScopedLock sl (store.lock);
+    store.images.clear();
+    store.scaled.clear();
+}
+
+/**
+ * @brief Decodes an embedded image without touching the cache.
+ * @param fileName The image's original file name in Assets.
+ * @return The decoded image, or an invalid image if there is no such asset.
+ */
+juce::Image AssetCache::decode(const juce::String& fileName)
+{
+    for (int i = 0; i < BinaryData::namedResourceListSize; ++i)
+    {
+        if (fileName != BinaryData::originalFilenames[i])
+            continue;
+
+        int size = 0;
+        const char* data = BinaryData::getNamedResource(BinaryData::namedResourceList[i], size);
+
+        if (data != nullptr)
+            return juce::ImageFileFormat::loadFrom(data, (size_t) size);
+    }
+
+    DBG("AssetCache: no embedded asset named " + fileName);
+    return {};
+}
+
+/**
+ * @brief Gets the New_DJ project directory holding the tracks and saved state.
+ * @return The project directory, or the executable's directory if it was not found.
+ */
+juce::File AssetCache::getProjectDirectory()
+{
+    static const juce::File projectDirectory = [] {
+        juce::File executableDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+
+        for (auto dir = executableDir; dir.getParentDirectory() != dir; dir = dir.getParentDirectory())
+            if (dir.getFileName() == "New_DJ")
+                return dir;
+
+        // Handle the case where the New_DJ folder wasn't found
+        DBG("New_DJ folder not found in the directory structure");
+        return executableDir;
+    }();
+
+    return projectDirectory;
+}
+
+/**
+ * @brief Gets a file from the project's Assets folder on disk.
+ * @param fileName The file's name in Assets.
+ * @return The file.
+ */
+juce::File AssetCache::getAssetFile(const juce::String& fileName)
+{
+    return getProjectDirectory().getChildFile("Assets").getChildFile(fileName);
+}
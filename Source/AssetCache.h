@@ -0,0 +1,106 @@
+/**
+ * =================================================================
+ * @file AssetCache.h
+ * @brief Declaration of the AssetCache class.
+ *
+ * This file declares the single place the UI gets its artwork from. Images
+ * are compiled into BinaryData, so nothing is read from disk to draw the UI.
+ *
+ * Created: 18 Oct 2026 8:02:15pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class AssetCache
+ * @brief Shared cache of the embedded UI images.
+ *
+ * Each image is decoded from BinaryData once, on first use or by
+ * preloadAll() at startup, and handed out as a shared juce::Image. Rescaled
+ * copies are cached per scale so drawing never has to downsample a large
+ * source image. All methods are thread safe.
+ */
+class AssetCache
+{
+public:
+    /**
+     * @brief Gets an embedded image, decoding it on first use.
+     * @param fileName The image's original file name in Assets (e.g. "knob.png").
+     * @return The image, or an invalid image if there is no such asset.
+     */
+    static juce::Image getImage(const juce::String& fileName);
+
+    /**
+     * @brief Gets an embedded image resampled by a scale factor.
+     *
+     * Callers usually pass their drawing scale multiplied by the display's
+     * physical pixel scale, then draw the result 1:1 in physical pixels.
+     *
+     * @param fileName The image's original file name in Assets.
+     * @param scale The scale to resample by.
+     * @return The rescaled image, or an invalid image if there is no such asset.
+     */
+    static juce::Image getScaledImage(const juce::String& fileName, float scale);
+
+    /**
+     * @brief Decodes every embedded image in parallel.
+     *
+     * Called once at startup, before the UI is built, so the components find
+     * their images already decoded.
+     */
+    static void preloadAll();
+
+    /**
+     * @brief Releases every cached image.
+     *
+     * Called at shutdown so the images are freed while JUCE is still running.
+     */
+    static void clear();
+
+    /**
+     * @brief Gets the New_DJ project directory holding the tracks and saved state.
+     *
+     * Walks up from the executable the first time it is called and returns
+     * the cached result afterwards.
+     *
+     * @return The project directory, or the executable's directory if it was not found.
+     */
+    static juce::File getProjectDirectory();
+
+    /**
+     * @brief Gets a file from the project's Assets folder on disk.
+     *
+     * Used for files that are streamed or written back (tracks and the deck
+     * state) rather than drawn.
+     *
+     * @param fileName The file's name in Assets.
+     * @return The file.
+     */
+    static juce::File getAssetFile(const juce::String& fileName);
+
+private:
+    /**
+     * @brief Decodes an embedded image without touching the cache.
+     * @param fileName The image's original file name in Assets.
+     * @return The decoded image, or an invalid image if there is no such asset.
+     */
+    static juce::Image decode(const juce::String& fileName);
+
+    /**
+     * @brief The shared cache contents.
+     */
+    struct Store {
+        juce::CriticalSection lock;                   ///< Guards both maps.
+        std::map<juce::String, juce::Image> images;   ///< Decoded images by file name.
+        std::map<juce::String, juce::Image> scaled;   ///< Rescaled copies by "name@scale".
+    };
+
+    /**
+     * @brief Gets the shared cache contents.
+     * @return The store.
+     */
+    static Store& getStore();
+};
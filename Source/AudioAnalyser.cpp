@@ -0,0 +1,269 @@
+/**
+ * =================================================================
+ * @file AudioAnalyser.cpp
+ * @brief Implementation of the AudioAnalyser class.
+ *
+ * Created: 18 Oct 2026 3:20:11pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "AudioAnalyser.h"
+
+/**
+ * @brief Constructor for AudioAnalyser.
+ *
+ * Allocates every buffer up front so neither the audio thread nor the
+ * analysis thread allocates while running.
+ */
+AudioAnalyser::AudioAnalyser()
+    : levels((size_t) levelFifo.getTotalSize()),
+      samples((size_t) sampleFifo.getTotalSize()),
+      fftHistory((size_t) fftSize, 0.0f),
+      fftData((size_t) fftSize * 2, 0.0f)
+{
+    workingFrame.spectrum.fill(-100.0f);
+    configure(sampleRate);
+}
+
+/**
+ * @brief Destructor for AudioAnalyser.
+ */
+AudioAnalyser::~AudioAnalyser()
+{
+}
+
+/**
+ * @brief Tells the analyser the rate of the audio it will receive.
+ * @param newSampleRate The device sample rate.
+ */
+void AudioAnalyser::prepare(double newSampleRate)
+{
+    pendingSampleRate.store(newSampleRate);
+}
+
+/**
+ * @brief Taps a block of audio.
+ *
+ * Works out the block's peak and mean square, then writes a mono mix of the
+ * block into the sample FIFO for the analysis thread.
+ *
+ * @param bufferToFill The block to analyse.
+ */
+void AudioAnalyser::process(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    const auto* buffer = bufferToFill.buffer;
+    const int numChannels = buffer->getNumChannels();
+
+    if (numChannels == 0 || bufferToFill.numSamples == 0)
+        return;
+
+    BlockLevel level;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto range = buffer->findMinMax(channel, bufferToFill.startSample, bufferToFill.numSamples);
+        const float rms = buffer->getRMSLevel(channel, bufferToFill.startSample, bufferToFill.numSamples);
+        level.peak = juce::jmax(level.peak, -range.getStart(), range.getEnd());
+        level.meanSquare += rms * rms / (float) numChannels;
+    }
+
+    {
+        const auto scope = levelFifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            levels[(size_t) scope.startIndex1] = level;
+        else if (scope.blockSize2 > 0)
+            levels[(size_t) scope.startIndex2] = level;
+    }
+
+    const auto scope = sampleFifo.write(bufferToFill.numSamples);
+    const float channelScale = 1.0f / (float) numChannels;
+
+    auto writeMono = [&](int destination, int sourceOffset, int count) {
+        float* out = samples.data() + destination;
+        juce::FloatVectorOperations::copy(out, buffer->getReadPointer(0, bufferToFill.startSample + sourceOffset), count);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::add(out, buffer->getReadPointer(channel, bufferToFill.startSample + sourceOffset), count);
+
+        juce::FloatVectorOperations::multiply(out, channelScale, count);
+    };
+
+    if (scope.blockSize1 > 0)
+        writeMono(scope.startIndex1, 0, scope.blockSize1);
+
+    if (scope.blockSize2 > 0)
+        writeMono(scope.startIndex2, scope.blockSize1, scope.blockSize2);
+}
+
+/**
+ * @brief Copies the most recent analysis results.
+ * @param frame Receives the results.
+ * @return True if new results were available.
+ */
+bool AudioAnalyser::getLatestFrame(AnalysisFrame& frame)
+{
+    return frames.read(frame);
+}
+
+/**
+ * @brief Does a slice of analysis work on the background thread.
+ *
+ * Drains both FIFOs, updates loudness and spectrum, and publishes a new
+ * frame if any audio arrived since the previous slice.
+ *
+ * @return Milliseconds to wait before the next slice.
+ */
+int AudioAnalyser::useTimeSlice()
+{
+    const double newSampleRate = pendingSampleRate.exchange(0.0);
+
+    if (newSampleRate > 0.0)
+        configure(newSampleRate);
+
+    float peak = 0.0f;
+    double meanSquare = 0.0;
+    int numBlocks = 0;
+
+    {
+        const auto scope = levelFifo.read(levelFifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i, ++numBlocks)
+        {
+            peak = juce::jmax(peak, levels[(size_t) (scope.startIndex1 + i)].peak);
+            meanSquare += levels[(size_t) (scope.startIndex1 + i)].meanSquare;
+        }
+
+        for (int i = 0; i < scope.blockSize2; ++i, ++numBlocks)
+        {
+            peak = juce::jmax(peak, levels[(size_t) (scope.startIndex2 + i)].peak);
+            meanSquare += levels[(size_t) (scope.startIndex2 + i)].meanSquare;
+        }
+    }
+
+    {
+        const auto scope = sampleFifo.read(sampleFifo.getNumReady());
+
+        if (scope.blockSize1 > 0)
+            analyseSamples(samples.data() + scope.startIndex1, scope.blockSize1);
+
+        if (scope.blockSize2 > 0)
+            analyseSamples(samples.data() + scope.startIndex2, scope.blockSize2);
+    }
+
+    if (numBlocks > 0)
+    {
+        workingFrame.peak = peak;
+        workingFrame.rms = (float) std::sqrt(meanSquare / numBlocks);
+
+        frames.getWriteBuffer() = workingFrame;
+        frames.publish();
+    }
+
+    return 15;
+}
+
+/**
+ * @brief Rebuilds the loudness filters and band edges for a sample rate.
+ *
+ * The K-weighting follows ITU-R BS.1770: a +4 dB high shelf around 1.7 kHz
+ * followed by a high pass at 38 Hz. Loudness is measured on the mono mix.
+ *
+ * @param newSampleRate The rate of the tapped audio.
+ */
+void AudioAnalyser::configure(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    kWeightShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 1681.97, 0.7071, juce::Decibels::decibelsToGain(4.0f));
+    kWeightHighPass.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 38.13, 0.5003);
+    kWeightShelf.reset();
+    kWeightHighPass.reset();
+
+    loudnessBlocks.fill(0.0);
+    loudnessBlockIndex = 0;
+    loudnessAccumulator = 0.0;
+    loudnessSamples = 0;
+
+    // Log-spaced bands from 20 Hz to 20 kHz, at least one FFT bin wide.
+    for (int band = 0; band <= AnalysisFrame::numBands; ++band)
+    {
+        const double frequency = 20.0 * std::pow(1000.0, (double) band / AnalysisFrame::numBands);
+        const int bin = juce::jlimit(1, fftSize / 2, juce::roundToInt(frequency * fftSize / sampleRate));
+        bandEdges[(size_t) band] = band == 0 ? bin : juce::jmax(bin, bandEdges[(size_t) band - 1] + 1);
+    }
+}
+
+/**
+ * @brief Feeds samples through the loudness filters and the FFT window.
+ * @param input The mono samples.
+ * @param numSamples Number of samples.
+ */
+void AudioAnalyser::analyseSamples(const float* input, int numSamples)
+{
+    const int loudnessBlockLength = juce::jmax(1, (int) (sampleRate * 0.1));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float weighted = kWeightHighPass.processSample(kWeightShelf.processSample(input[i]));
+        loudnessAccumulator += (double) weighted * weighted;
+
+        if (++loudnessSamples >= loudnessBlockLength)
+        {
+            loudnessBlocks[(size_t) loudnessBlockIndex] = loudnessAccumulator / loudnessSamples;
+            loudnessBlockIndex = (loudnessBlockIndex + 1) % (int) loudnessBlocks.size();
+            loudnessAccumulator = 0.0;
+            loudnessSamples = 0;
+
+            double sum = 0.0;
+            for (auto block : loudnessBlocks)
+                sum += block;
+
+            const double mean = sum / (double) loudnessBlocks.size();
+            workingFrame.shortTermLoudness = mean > 0.0 ? (float) juce::jmax(-70.0, -0.691 + 10.0 * std::log10(mean)) : -70.0f;
+        }
+
+        fftHistory[(size_t) fftWritePosition] = input[i];
+        fftWritePosition = (fftWritePosition + 1) % fftSize;
+
+        // Half-overlapping transforms.
+        if (++samplesSinceFft >= fftSize / 2)
+        {
+            computeSpectrum();
+            samplesSinceFft = 0;
+        }
+    }
+}
+
+/**
+ * @brief Runs the FFT and folds it into the spectrum bands.
+ *
+ * Each band shows its loudest bin. Bands fall back by at most 3 dB per
+ * transform so the display does not flicker.
+ */
+void AudioAnalyser::computeSpectrum()
+{
+    const int tail = fftSize - fftWritePosition;
+    std::copy(fftHistory.begin() + fftWritePosition, fftHistory.end(), fftData.begin());
+    std::copy(fftHistory.begin(), fftHistory.begin() + fftWritePosition, fftData.begin() + tail);
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // A full-scale sine reads 0 dB: undo the FFT length and the Hann window's 0.5 gain.
+    const float scale = 4.0f / (float) fftSize;
+
+    for (int band = 0; band < AnalysisFrame::numBands; ++band)
+    {
+        float magnitude = 0.0f;
+
+        for (int bin = bandEdges[(size_t) band]; bin < juce::jmax(bandEdges[(size_t) band + 1], bandEdges[(size_t) band] + 1); ++bin)
+            magnitude = juce::jmax(magnitude, fftData[(size_t) bin]);
+
+        const float level = juce::Decibels::gainToDecibels(magnitude * scale);
+        auto& shown = workingFrame.spectrum[(size_t) band];
+        shown = juce::jmax(level, shown - 3.0f);
+    }
+}
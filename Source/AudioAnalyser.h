@@ -0,0 +1,148 @@
+/**
+ * =================================================================
+ * @file AudioAnalyser.h
+ * @brief Declaration of the AudioAnalyser class and AnalysisFrame structure.
+ *
+ * This file declares the analysis tap used for level meters and the spectrum
+ * display. The audio thread only copies data into lock-free FIFOs; all of the
+ * heavier work happens on a background analysis thread.
+ *
+ * Created: 18 Oct 2026 3:20:11pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+/**
+ * @brief One frame of analysis results, as shown by the UI.
+ */
+struct AnalysisFrame {
+    static constexpr int numBands = 48; /**< Number of spectrum bands (log spaced, 20 Hz - 20 kHz). */
+
+    float peak = 0.0f;                  /**< Highest sample peak since the previous frame (linear). */
+    float rms = 0.0f;                   /**< RMS level of the most recent blocks (linear). */
+    float shortTermLoudness = -70.0f;   /**< Short-term (3 s) loudness in LUFS. */
+    std::array<float, numBands> spectrum {}; /**< Band levels in decibels. */
+};
+
+/**
+ * @class AudioAnalyser
+ * @brief Lock-free analysis tap for one point in the signal chain.
+ *
+ * Call process() from the audio thread with each block. Register the
+ * analyser with a juce::TimeSliceThread, which drains the FIFOs, computes
+ * loudness and the FFT spectrum, and publishes an AnalysisFrame through a
+ * triple buffer for the UI to pick up with getLatestFrame().
+ */
+class AudioAnalyser : public juce::TimeSliceClient
+{
+public:
+    /** FFT order used for the spectrum (2^11 = 2048 points). */
+    static constexpr int fftOrder = 11;
+
+    /** Number of points in the FFT. */
+    static constexpr int fftSize = 1 << fftOrder;
+
+    /**
+     * @brief Constructor for AudioAnalyser.
+     */
+    AudioAnalyser();
+
+    /**
+     * @brief Destructor for AudioAnalyser.
+     */
+    ~AudioAnalyser() override;
+
+    /**
+     * @brief Tells the analyser the rate of the audio it will receive.
+     *
+     * The analysis thread rebuilds its filters the next time it runs.
+     *
+     * @param sampleRate The device sample rate.
+     */
+    void prepare(double sampleRate);
+
+    /**
+     * @brief Taps a block of audio.
+     *
+     * Called from the audio thread. Never allocates, locks or waits; if the
+     * analysis thread falls behind, samples are dropped.
+     *
+     * @param bufferToFill The block to analyse.
+     */
+    void process(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * @brief Copies the most recent analysis results.
+     *
+     * Call from the message thread.
+     *
+     * @param frame Receives the results.
+     * @return True if new results were available.
+     */
+    bool getLatestFrame(AnalysisFrame& frame);
+
+    /**
+     * @brief Does a slice of analysis work on the background thread.
+     * @return Milliseconds to wait before the next slice.
+     */
+    int useTimeSlice() override;
+
+private:
+    /**
+     * @brief Peak and RMS of a single audio block.
+     */
+    struct BlockLevel {
+        float peak = 0.0f;        ///< Absolute peak of the block.
+        float meanSquare = 0.0f;  ///< Mean square of the block.
+    };
+
+    /**
+     * @brief Rebuilds the loudness filters and band edges for a sample rate.
+     * @param sampleRate The rate of the tapped audio.
+     */
+    void configure(double sampleRate);
+
+    /**
+     * @brief Feeds samples through the loudness filters and the FFT window.
+     * @param samples The mono samples.
+     * @param numSamples Number of samples.
+     */
+    void analyseSamples(const float* samples, int numSamples);
+
+    /**
+     * @brief Runs the FFT and folds it into the spectrum bands.
+     */
+    void computeSpectrum();
+
+    juce::AbstractFifo levelFifo { 256 };           ///< Per-block levels from the audio thread.
+    std::vector<BlockLevel> levels;                 ///< Storage for levelFifo.
+    juce::AbstractFifo sampleFifo { 32768 };        ///< Mono samples from the audio thread.
+    std::vector<float> samples;                     ///< Storage for sampleFifo.
+
+    std::atomic<double> pendingSampleRate { 0.0 };  ///< Rate set by prepare(), 0 when unchanged.
+    double sampleRate = 44100.0;                    ///< Rate the analysis is configured for.
+
+    juce::dsp::FFT fft { fftOrder };                ///< FFT engine.
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> fftHistory;                  ///< Last fftSize samples, ring buffer.
+    std::vector<float> fftData;                     ///< Working buffer for the FFT (2 * fftSize).
+    int fftWritePosition = 0;                       ///< Write position in fftHistory.
+    int samplesSinceFft = 0;                        ///< New samples since the last transform.
+    std::array<int, AnalysisFrame::numBands + 1> bandEdges {}; ///< FFT bin where each band starts.
+
+    juce::dsp::IIR::Filter<float> kWeightShelf;     ///< K-weighting stage 1 (high shelf).
+    juce::dsp::IIR::Filter<float> kWeightHighPass;  ///< K-weighting stage 2 (high pass).
+    std::array<double, 30> loudnessBlocks {};       ///< Mean square of each 100 ms block of the last 3 s.
+    int loudnessBlockIndex = 0;                     ///< Block currently being filled.
+    double loudnessAccumulator = 0.0;               ///< Sum of squares for the current block.
+    int loudnessSamples = 0;                        ///< Samples in the current block.
+
+    AnalysisFrame workingFrame;                     ///< Frame being built by the analysis thread.
+    TripleBuffer<AnalysisFrame> frames;             ///< Hands finished frames to the UI.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioAnalyser)
+};
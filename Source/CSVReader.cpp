@@ -1,163 +1,466 @@
-/**
- * =================================================================
- * @file CSVReader.cpp
- * @brief Implementation of the CSVReader class.
- *
- * This file contains the implementation for reading CSV files,
- * tokenizing CSV lines, and converting CSV data into DeckState structures.
- *
- * Created: 24 Feb 2025 9:44:39am
- * Author: Jacques Thurling
- */
-
-#include <JuceHeader.h>
-#include "CSVReader.h"
-#include <fstream>
-
-/**
- * @brief Constructor for CSVReader.
- *
- * Initializes the CSVReader object. In this constructor, any necessary
- * initializations for reading CSV files can be added.
- */
-CSVReader::CSVReader()
-{
-    // Constructor body left intentionally empty.
-}
-
-/**
- * @brief Reads and parses the CSV file containing deck state information.
- *
- * This method locates the CSV file within the application's Resources directory,
- * opens the file, and reads its contents line by line. Each line is tokenized,
- * and the tokens are used to construct a DeckState structure. All valid DeckState
- * objects are collected and returned in a vector.
- *
- * @return std::vector<DeckState> A vector containing all deck states parsed from the CSV file.
- */
-std::vector<DeckState> CSVReader::readCSV() {
-    // Determine the application's directory.
-    juce::File executableFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-    juce::File projectDir = executableFile.getParentDirectory();
-    juce::String correctPath;
-    while (projectDir.getFileName() != "New_DJ" && projectDir.getParentDirectory() != projectDir) {
-        projectDir = projectDir.getParentDirectory();
-    }
-    
-    if (projectDir.getFileName() == "New_DJ") {
-        correctPath = projectDir.getFullPathName();
-    } else {
-        // Handle the case where the New_DJ folder wasn't found
-        DBG("New_DJ folder not found in the directory structure");
-    }
-    
-    juce::File stateFile(correctPath.toStdString() + "/Assets/dj_program_state.csv");
-    
-    // Output the full path of the state file.
-    std::cout << stateFile.getFullPathName().toStdString() << std::endl;
-    
-    // Log a message if the file exists.
-    if (stateFile.exists()) {
-        std::cerr << "File exists" << std::endl;
-    }
-    
-    // Open the CSV file using an ifstream.
-    std::ifstream csvFile{stateFile.getFullPathName().toStdString()};
-    
-    // Check if the file stream is valid.
-    if (!csvFile) {
-        std::cerr << "Failed to open file" << std::endl;
-    }
-    
-    std::string line;
-    
-    // Log messages indicating the loading process.
-    std::cout << "=====================" << std::endl;
-    std::cout << " Loading file data" << std::endl;
-    std::cout << "=====================" << std::endl;
-    
-    // Vector to store the parsed DeckState objects.
-    std::vector<DeckState> deckStates;
-    
-    // Check if the file is open before processing.
-    if (csvFile.is_open()) {
-        // Read each line of the CSV file.
-        while (std::getline(csvFile, line)) {
-            try {
-                // Tokenize the current line using comma as the separator.
-                std::vector<std::string> tokens = tokenise(line, ',');
-                
-                // Debug message: Convert the second token to a double.
-                DBG("" << std::stod(tokens[1]));
-                
-                // Construct a DeckState object from the tokens.
-                DeckState state {
-                    tokens[0],
-                    std::stod(tokens[1]),
-                    tokens[2]
-                };
-                
-                // Add the DeckState object to the vector.
-                deckStates.push_back(state);
-            } catch (const std::exception &e) {
-                // Log a message if there is an error parsing the line.
-                std::cout << "CSVReader::readCSV bad data" << std::endl;
-            }
-        }
-    }
-    
-    // Close the CSV file.
-    csvFile.close();
-    
-    // Return the vector of DeckState objects.
-    return deckStates;
-}
-
-/**
- * @brief Tokenizes a CSV line into individual fields.
- *
- * This static method splits a given CSV line into tokens using the specified separator.
- * It iterates through the line to extract each token and returns a vector of tokens.
- *
- * @param csvLine A string representing a line from a CSV file.
- * @param separator The character used to separate tokens in the CSV line.
- * @return std::vector<std::string> A vector containing the tokens extracted from the CSV line.
- */
-std::vector<std::string> CSVReader::tokenise(std::string csvLine, char separator) {
-    // Vector to store tokens.
-    std::vector<std::string> tokens;
-    
-    // Variables to store the starting and ending positions of tokens.
-    signed int start, end;
-    // String to store each individual token.
-    std::string token;
-    
-    // Find the first character that is not the separator.
-    start = csvLine.find_first_not_of(separator, 0);
-    
-    // Loop to extract all tokens.
-    do {
-        // Find the position of the next separator.
-        end = csvLine.find_first_of(separator, start);
-        
-        // Break out of the loop if at the end of the string or if no token is found.
-        if (start == csvLine.length() || start == end)
-            break;
-        
-        // Extract the token between start and end positions.
-        if (end >= 0)
-            token = csvLine.substr(start, end - start);
-        // Extract the token from start to the end of the string.
-        else
-            token = csvLine.substr(start, csvLine.length() - start);
-        
-        // Add the token to the vector.
-        tokens.push_back(token);
-        
-        // Update the start position for the next token.
-        start = end + 1;
-    } while (end > 0);
-    
-    // Return the vector of tokens.
-    return tokens;
-}
+/**
+ * =================================================================
+ * @file CSVReader.cpp
+ * @brief Implementation of the CSVReader class.
+ *
+ * This file contains the implementation for reading CSV files,
+ * tokenizing CSV lines, and converting CSV data into DeckState structures.
+ *
+ * Created: 24 Feb 2025 9:44:39am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "CSVReader.h"
+#include "AssetCache.h"
+#include <charconv>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+    /**
+     * @brief A quoted field with doubled quotes, unescaped into the scratch buffer.
+     */
+    struct UnescapedField {
+        size_t field;   ///< Index of the field in the record.
+        size_t offset;  ///< Start of the unescaped text in the scratch buffer.
+        size_t length;  ///< Length of the unescaped text.
+    };
+    
+    /**
+     * @brief Parses records from a block of text.
+     *
+     * Fields are views into the text. Quoted fields with doubled quotes are
+     * unescaped into a scratch buffer and their views set once the record is
+     * complete, since the buffer may move while the record is read.
+     *
+     * @param begin Start of the text.
+     * @param end End of the text.
+     * @param separator The character used to delimit fields.
+     * @param callback Called with each non-empty record.
+     * @return The number of records parsed.
+     */
+    template <typename Callback>
+    juce::int64 parseRecords(const char* begin, const char* end, char separator, Callback&& callback) {
+        std::vector<std::string_view> fields;
+        std::vector<UnescapedField> unescaped;
+        std::string scratch;
+        juce::int64 numRecords = 0;
+        const char* p = begin;
+        
+        while (p < end) {
+            fields.clear();
+            unescaped.clear();
+            scratch.clear();
+            
+            // One field per pass, until the end of the record.
+            for (;;) {
+                if (p < end && *p == '"') {
+                    const char* start = ++p;
+                    const size_t offset = scratch.size();
+                    const char* closing = end;
+                    bool hasEscapes = false;
+                    
+                    // An unterminated field runs to the end of the text.
+                    while (const auto* quote = static_cast<const char*>(std::memchr(p, '"', (size_t) (end - p)))) {
+                        if (quote + 1 < end && quote[1] == '"') {
+                            hasEscapes = true;
+                            scratch.append(p, (size_t) (quote + 1 - p));
+                            p = quote + 2;
+                            continue;
+                        }
+                        closing = quote;
+                        break;
+                    }
+                    
+                    if (hasEscapes) {
+                        scratch.append(p, (size_t) (closing - p));
+                        unescaped.push_back({fields.size(), offset, scratch.size() - offset});
+                        fields.emplace_back();
+                    } else {
+                        fields.emplace_back(start, (size_t) (closing - start));
+                    }
+                    p = closing < end ? closing + 1 : end;
+                    
+                    // Anything between the closing quote and the separator is ignored.
+                    while (p < end && *p != separator && *p != '\n' && *p != '\r') {
+                        ++p;
+                    }
+                } else {
+                    const char* start = p;
+                    while (p < end && *p != separator && *p != '\n' && *p != '\r') {
+                        ++p;
+                    }
+                    fields.emplace_back(start, (size_t) (p - start));
+                }
+                
+                if (p < end && *p == separator) {
+                    ++p;
+                    continue;
+                }
+                break;
+            }
+            
+            if (p < end && *p == '\r') {
+                ++p;
+            }
+            if (p < end && *p == '\n') {
+                ++p;
+            }
+            
+            for (const auto& field : unescaped) {
+                fields[field.field] = std::string_view(scratch.data() + field.offset, field.length);
+            }
+            
+            // Blank lines are not records.
+            if (fields.size() == 1 && fields[0].empty()) {
+                continue;
+            }
+            
+            callback(fields);
+            ++numRecords;
+        }
+        
+        return numRecords;
+    }
+    
+    /**
+     * @brief Finds where each chunk of a file starts, at record boundaries.
+     *
+     * Quotes are counted up to each split point, so a line break inside a
+     * quoted field is never taken for the end of a record. Counting uses
+     * memchr and is much cheaper than parsing.
+     *
+     * @param begin Start of the text.
+     * @param end End of the text.
+     * @param numChunks The number of chunks wanted.
+     * @return The start of each chunk, followed by end.
+     */
+    std::vector<const char*> findChunkStarts(const char* begin, const char* end, int numChunks) {
+        std::vector<const char*> starts {begin};
+        const char* p = begin;
+        bool inQuotes = false;
+        
+        for (int chunk = 1; chunk < numChunks; ++chunk) {
+            const char* target = begin + (end - begin) * chunk / numChunks;
+            if (target <= p) {
+                continue;
+            }
+            
+            while (const auto* quote = static_cast<const char*>(std::memchr(p, '"', (size_t) (target - p)))) {
+                inQuotes = ! inQuotes;
+                p = quote + 1;
+            }
+            p = target;
+            
+            while (p < end) {
+                const char c = *p++;
+                if (c == '"') {
+                    inQuotes = ! inQuotes;
+                } else if (c == '\n' && ! inQuotes) {
+                    break;
+                }
+            }
+            
+            if (p >= end) {
+                break;
+            }
+            starts.push_back(p);
+        }
+        
+        starts.push_back(end);
+        return starts;
+    }
+    
+    /**
+     * @brief Gives read access to a whole file, memory-mapped where possible.
+     */
+    struct MappedText {
+        /**
+         * @brief Maps a file, or loads it if it cannot be mapped.
+         * @param file The file.
+         */
+        explicit MappedText(const juce::File& file)
+            : mapping(file, juce::MemoryMappedFile::readOnly) {
+            if (mapping.getData() != nullptr) {
+                text = std::string_view(static_cast<const char*>(mapping.getData()), mapping.getSize());
+            } else if (file.existsAsFile() && file.loadFileAsData(loaded)) {
+                text = std::string_view(static_cast<const char*>(loaded.getData()), loaded.getSize());
+            } else {
+                ok = file.existsAsFile() && file.getSize() == 0;
+                return;
+            }
+            
+            // Skip a UTF-8 byte order mark.
+            if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+                text.remove_prefix(3);
+            }
+        }
+        
+        juce::MemoryMappedFile mapping; ///< The mapping, if the file could be mapped.
+        juce::MemoryBlock loaded; ///< The file's contents, if it could not.
+        std::string_view text; ///< The file's text.
+        bool ok = true; ///< False if the file could not be read.
+    };
+}
+
+/**
+ * @brief Constructor for CSVReader.
+ *
+ * Initializes the CSVReader object. In this constructor, any necessary
+ * initializations for reading CSV files can be added.
+ */
+CSVReader::CSVReader()
+{
+    // Constructor body left intentionally empty.
+}
+
+/**
+ * @brief Reads and parses the CSV file containing deck state information.
+ *
+ * This method locates the CSV file within the project's Assets directory
+ * and parses it in place. Each record's fields are used to construct a
+ * DeckState structure. Rows may carry up to eight extra columns holding the
+ * hot cue positions of the deck's file, with -1 marking an empty slot.
+ * Rows without a deck name, position and file name are skipped.
+ *
+ * @return std::vector<DeckState> A vector containing all deck states parsed from the CSV file.
+ */
+std::vector<DeckState> CSVReader::readCSV() {
+    // The state is written back, so it is read from disk rather than BinaryData.
+    juce::File stateFile = AssetCache::getAssetFile("dj_program_state.csv");
+    std::vector<DeckState> deckStates;
+    
+    const auto numRecords = parseFile(stateFile, ',', [&](const std::vector<std::string_view>& fields) {
+        DeckState state;
+        if (fields.size() < 3 || ! parseNumber(fields[1], state.position)) {
+            std::cout << "CSVReader::readCSV bad data" << std::endl;
+            return;
+        }
+        
+        state.deck_name = std::string(fields[0]);
+        state.file_name = std::string(fields[2]);
+        
+        // Any remaining columns are the hot cues for the file.
+        for (size_t i = 3; i < fields.size() && i - 3 < state.hot_cues.size(); ++i) {
+            if (! parseNumber(fields[i], state.hot_cues[i - 3])) {
+                state.hot_cues[i - 3] = -1.0;
+            }
+        }
+        
+        deckStates.push_back(std::move(state));
+    });
+    
+    if (numRecords < 0) {
+        std::cerr << "Failed to open " << stateFile.getFullPathName() << std::endl;
+    }
+    
+    return deckStates;
+}
+
+/**
+ * @brief Tokenizes a CSV line into individual fields.
+ *
+ * Quoted fields are unquoted; a line break inside quotes ends nothing, so
+ * the whole line is treated as one record.
+ *
+ * @param csvLine A string representing a line from a CSV file.
+ * @param separator The character used to separate tokens in the CSV line.
+ * @return std::vector<std::string> A vector containing the tokens extracted from the CSV line.
+ */
+std::vector<std::string> CSVReader::tokenise(std::string_view csvLine, char separator) {
+    std::vector<std::string> tokens;
+    
+    parseRecords(csvLine.data(), csvLine.data() + csvLine.size(), separator, [&](const std::vector<std::string_view>& fields) {
+        for (const auto& field : fields) {
+            tokens.emplace_back(field);
+        }
+    });
+    
+    return tokens;
+}
+
+/**
+ * @brief Parses CSV text record by record.
+ * @param text The text.
+ * @param separator The character used to delimit fields.
+ * @param callback Called with each non-empty record.
+ * @return The number of records parsed.
+ */
+juce::int64 CSVReader::parse(std::string_view text, char separator, const RecordCallback& callback) {
+    return parseRecords(text.data(), text.data() + text.size(), separator, callback);
+}
+
+/**
+ * @brief Parses a CSV file through a memory mapping.
+ * @param file The file.
+ * @param separator The character used to delimit fields.
+ * @param callback Called with each non-empty record.
+ * @return The number of records parsed, or -1 if the file could not be read.
+ */
+juce::int64 CSVReader::parseFile(const juce::File& file, char separator, const RecordCallback& callback) {
+    const MappedText mapped (file);
+    if (! mapped.ok) {
+        return -1;
+    }
+    
+    return parse(mapped.text, separator, callback);
+}
+
+/**
+ * @brief Parses a CSV file in chunks on several threads.
+ *
+ * The calling thread parses the first chunk itself.
+ *
+ * @param file The file.
+ * @param separator The character used to delimit fields.
+ * @param numChunks The number of chunks and threads; small files use fewer.
+ * @param callback Called with each non-empty record.
+ * @return The number of records parsed, or -1 if the file could not be read.
+ */
+juce::int64 CSVReader::parseFileParallel(const juce::File& file, char separator, int numChunks, const ChunkRecordCallback& callback) {
+    const MappedText mapped (file);
+    if (! mapped.ok) {
+        return -1;
+    }
+    
+    // Chunks under a megabyte are not worth a thread.
+    constexpr size_t minChunkBytes = 1 << 20;
+    numChunks = juce::jlimit(1, juce::jmax(1, (int) (mapped.text.size() / minChunkBytes)), numChunks);
+    
+    const char* begin = mapped.text.data();
+    const auto starts = findChunkStarts(begin, begin + mapped.text.size(), numChunks);
+    std::vector<juce::int64> counts(starts.size() - 1, 0);
+    
+    auto parseChunk = [&](size_t chunk) {
+        counts[chunk] = parseRecords(starts[chunk], starts[chunk + 1], separator, [&](const std::vector<std::string_view>& fields) {
+            callback((int) chunk, fields);
+        });
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t chunk = 1; chunk < counts.size(); ++chunk) {
+        threads.emplace_back(parseChunk, chunk);
+    }
+    
+    parseChunk(0);
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    return std::accumulate(counts.begin(), counts.end(), (juce::int64) 0);
+}
+
+/**
+ * @brief Parses a decimal number without allocating.
+ *
+ * Uses std::from_chars where the standard library has the floating-point
+ * overloads, and strtod on a small stack copy where it does not.
+ *
+ * @param field The field, optionally surrounded by spaces.
+ * @param result Receives the number.
+ * @return True if the whole field was a number.
+ */
+bool CSVReader::parseNumber(std::string_view field, double& result) {
+    while (! field.empty() && field.front() == ' ') {
+        field.remove_prefix(1);
+    }
+    while (! field.empty() && field.back() == ' ') {
+        field.remove_suffix(1);
+    }
+    if (! field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    if (field.empty()) {
+        return false;
+    }
+    
+   #if defined (__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), result);
+    return error == std::errc() && end == field.data() + field.size();
+   #else
+    char buffer[64];
+    if (field.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, field.data(), field.size());
+    buffer[field.size()] = 0;
+    char* end = nullptr;
+    result = std::strtod(buffer, &end);
+    return end == buffer + field.size();
+   #endif
+}
+
+/**
+ * @brief Times sequential and parallel parsing of a file and prints the throughput in MB/s.
+ *
+ * Each mode runs three times and the fastest run is reported, so the first
+ * run can warm the page cache. Every field is touched and the second field
+ * parsed as a number, so the figures include a realistic consumer.
+ *
+ * @param file The CSV file to parse.
+ */
+void CSVReader::runBenchmark(const juce::File& file) {
+    if (! file.existsAsFile()) {
+        std::cout << "Writing a synthetic crate export to " << file.getFullPathName() << std::endl;
+        juce::FileOutputStream output (file);
+        if (! output.openedOk()) {
+            std::cerr << "Failed to create " << file.getFullPathName() << std::endl;
+            return;
+        }
+        
+        juce::Random random (42);
+        output << "track,bpm,title,artist,key,length,added\r\n";
+        for (int i = 0; i < 500000; ++i) {
+            output << "/Music/Crate " << (i % 97) << "/track_" << i << ".mp3,"
+                   << juce::String(80.0 + random.nextDouble() * 80.0, 2) << ","
+                   << "\"Title " << i << ", part " << (i % 7) << "\","
+                   << "\"The \"\"Quoted\"\" Artist " << (i % 311) << "\","
+                   << (1 + i % 12) << (i % 2 == 0 ? "A" : "B") << ","
+                   << (120 + i % 300) << ","
+                   << "2026-10-" << juce::String(1 + i % 28).paddedLeft('0', 2) << "\r\n";
+        }
+    }
+    
+    const double megabytes = (double) file.getSize() / (1024.0 * 1024.0);
+    std::atomic<juce::int64> checksum {0};
+    
+    auto consume = [&checksum](const std::vector<std::string_view>& fields) {
+        juce::int64 sum = 0;
+        for (const auto& field : fields) {
+            sum += (juce::int64) field.size();
+        }
+        double number = 0.0;
+        if (fields.size() > 1 && parseNumber(fields[1], number)) {
+            sum += (juce::int64) number;
+        }
+        checksum += sum;
+    };
+    
+    auto time = [&](const juce::String& name, const std::function<juce::int64()>& run) {
+        double bestSeconds = 0.0;
+        juce::int64 numRecords = 0;
+        for (int i = 0; i < 3; ++i) {
+            const auto start = juce::Time::getHighResolutionTicks();
+            numRecords = run();
+            const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            bestSeconds = i == 0 ? seconds : juce::jmin(bestSeconds, seconds);
+        }
+        
+        std::cout << name << ": " << numRecords << " records, "
+                  << juce::String(megabytes / juce::jmax(bestSeconds, 1.0e-9), 1) << " MB/s" << std::endl;
+    };
+    
+    const int numThreads = juce::jmax(1, juce::SystemStats::getNumCpus());
+    std::cout << "CSV benchmark: " << file.getFullPathName() << " (" << juce::String(megabytes, 1) << " MB)" << std::endl;
+    
+    time("  sequential", [&] { return parseFile(file, ',', consume); });
+    time("  parallel (" + juce::String(numThreads) + " chunks)", [&] {
+        return parseFileParallel(file, ',', numThreads, [&](int, const std::vector<std::string_view>& fields) { consume(fields); });
+    });
+    
+    DBG("CSV benchmark checksum " << checksum.load());
+}
@@ -1,64 +1,127 @@
-/**
- * =================================================================
- * @file CSVReader.h
- * @brief Header file for the CSVReader class and DeckState structure.
- *
- * Created: 24 Feb 2025 9:44:39am
- * Author: Jacques Thurling
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-
-/**
- * @brief Structure representing the state of a deck.
- *
- * Contains the deck's name, current position, and associated file name.
- */
-struct DeckState {
-    std::string deck_name;   /**< The name identifier for the deck. */
-    double position;         /**< The current position in the deck (e.g., time or progress). */
-    std::string file_name;   /**< The name of the file associated with the deck. */
-};
-
-/**
- * @brief Class for reading and parsing CSV files.
- *
- * The CSVReader class provides functionality to tokenize a CSV line and
- * read a CSV file, converting each row into a DeckState structure.
- */
-class CSVReader
-{
-public:
-    /**
-     * @brief Constructor for CSVReader.
-     *
-     * Initializes the CSVReader object.
-     */
-    CSVReader();
-    
-    /**
-     * @brief Splits a CSV line into individual tokens.
-     *
-     * This static method takes a CSV line and a separator character, and returns
-     * a vector containing each token extracted from the line.
-     *
-     * @param csvLine A string representing a line from a CSV file.
-     * @param separator The character used to delimit fields in the CSV line.
-     * @return std::vector<std::string> A vector of tokens parsed from the CSV line.
-     */
-    static std::vector<std::string> tokenise(std::string csvLine, char separator);
-    
-    /**
-     * @brief Reads and parses a CSV file.
-     *
-     * Processes the CSV file and converts its content into a vector of DeckState structures.
-     *
-     * @return std::vector<DeckState> A vector containing the deck states read from the CSV file.
-     */
-    std::vector<DeckState> readCSV();
-    
-private:
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CSVReader)
-};
+/**
+ * =================================================================
+ * @file CSVReader.h
+ * @brief Header file for the CSVReader class and DeckState structure.
+ *
+ * Created: 24 Feb 2025 9:44:39am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <string_view>
+
+/**
+ * @brief Structure representing the state of a deck.
+ *
+ * Contains the deck's name, current position, associated file name and the
+ * hot cues set on that file.
+ */
+struct DeckState {
+    std::string deck_name;   /**< The name identifier for the deck. */
+    double position;         /**< The current position in the deck (e.g., time or progress). */
+    std::string file_name;   /**< The name of the file associated with the deck. */
+    std::vector<double> hot_cues = std::vector<double>(8, -1.0); /**< Hot cue positions in seconds for file_name, -1 when unset. */
+};
+
+/**
+ * @brief Class for reading and parsing CSV files.
+ *
+ * Files are memory-mapped and parsed in place: each record's fields are
+ * handed over as string views into the mapping, so nothing is copied
+ * unless a quoted field contains escaped quotes. Quoting follows RFC 4180:
+ * quoted fields may hold separators, line breaks and doubled quotes, and
+ * records may end in CRLF or LF. Large files can be split into chunks at
+ * record boundaries and parsed on several threads.
+ */
+class CSVReader
+{
+public:
+    /** Called with each record's fields; the views are only valid during the call. */
+    using RecordCallback = std::function<void(const std::vector<std::string_view>& fields)>;
+    
+    /** Called with each record's fields and the index of the chunk it came from, in file order. */
+    using ChunkRecordCallback = std::function<void(int chunk, const std::vector<std::string_view>& fields)>;
+    
+    /**
+     * @brief Constructor for CSVReader.
+     *
+     * Initializes the CSVReader object.
+     */
+    CSVReader();
+    
+    /**
+     * @brief Splits a CSV line into individual tokens.
+     *
+     * This static method takes a CSV line and a separator character, and returns
+     * a vector containing each token extracted from the line, with any quoting removed.
+     *
+     * @param csvLine A string representing a line from a CSV file.
+     * @param separator The character used to delimit fields in the CSV line.
+     * @return std::vector<std::string> A vector of tokens parsed from the CSV line.
+     */
+    static std::vector<std::string> tokenise(std::string_view csvLine, char separator);
+    
+    /**
+     * @brief Parses CSV text record by record.
+     * @param text The text.
+     * @param separator The character used to delimit fields.
+     * @param callback Called with each non-empty record.
+     * @return The number of records parsed.
+     */
+    static juce::int64 parse(std::string_view text, char separator, const RecordCallback& callback);
+    
+    /**
+     * @brief Parses a CSV file through a memory mapping.
+     * @param file The file.
+     * @param separator The character used to delimit fields.
+     * @param callback Called with each non-empty record.
+     * @return The number of records parsed, or -1 if the file could not be read.
+     */
+    static juce::int64 parseFile(const juce::File& file, char separator, const RecordCallback& callback);
+    
+    /**
+     * @brief Parses a CSV file in chunks on several threads.
+     *
+     * The callback is called from every thread at once and must be thread
+     * safe. Records within a chunk arrive in order, and chunks are numbered
+     * in file order, so per-chunk results can be joined back in order.
+     *
+     * @param file The file.
+     * @param separator The character used to delimit fields.
+     * @param numChunks The number of chunks and threads; small files use fewer.
+     * @param callback Called with each non-empty record.
+     * @return The number of records parsed, or -1 if the file could not be read.
+     */
+    static juce::int64 parseFileParallel(const juce::File& file, char separator, int numChunks, const ChunkRecordCallback& callback);
+    
+    /**
+     * @brief Parses a decimal number without allocating.
+     * @param field The field, optionally surrounded by spaces.
+     * @param result Receives the number.
+     * @return True if the whole field was a number.
+     */
+    static bool parseNumber(std::string_view field, double& result);
+    
+    /**
+     * @brief Reads and parses a CSV file.
+     *
+     * Processes the CSV file and converts its content into a vector of DeckState structures.
+     *
+     * @return std::vector<DeckState> A vector containing the deck states read from the CSV file.
+     */
+    std::vector<DeckState> readCSV();
+    
+    /**
+     * @brief Times sequential and parallel parsing of a file and prints the throughput in MB/s.
+     *
+     * If the file does not exist a synthetic crate export is written there first.
+     *
+     * @param file The CSV file to parse.
+     */
+    static void runBenchmark(const juce::File& file);
+    
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CSVReader)
+};
@@ -1,366 +1,1073 @@
-/**
- * @file DJAudioPlayer.cpp
- * @brief Implementation of the DJAudioPlayer class for audio processing.
- *
- * This class handles audio playback, filtering, and effects such as reverb,
- * flanger, and tremolo.
- *
- * @author Matthew
- * @date 13 Mar 2020
- */
-
-#include "DJAudioPlayer.h"
-
-/**
- * @brief Constructor for DJAudioPlayer.
- *
- * Initializes reverb and flanger effect parameters.
- */
-DJAudioPlayer::DJAudioPlayer()
-{
-    reverbParams.roomSize = 0.9f;
-    reverbParams.damping = 0.5f;
-    reverbParams.wetLevel = reverbWetDryMix;
-    reverbParams.dryLevel = 1.0f - reverbWetDryMix;
-    reverbParams.width = 5.0f;
-    reverbParams.freezeMode = 0.0f;
-    
-    reverb.setParameters(reverbParams);
-    
-    // Flanger
-    flanger.setCentreDelay(0.001f);
-    flanger.setRate(0.1f);
-    flanger.setDepth(1.0f);
-    flanger.setFeedback(0.7f);
-    flanger.setMix(flangerWetDryMix);
-}
-
-/**
- * @brief Destructor for DJAudioPlayer.
- */
-DJAudioPlayer::~DJAudioPlayer()
-{}
-
-/**
- * @brief Prepares the audio player for playback.
- * @param samplesPerBlockExpected Number of samples per block expected.
- * @param sampleRate The sample rate of the audio.
- */
-void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    formatManager.registerBasicFormats();
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    // HighPassfilter setup
-    highpassFilter.reset();
-    auto hpCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, hpCutoff, hpQualityFactor);
-    *highpassFilter.coefficients = *hpCoeffs;
-    
-    // Lowpass filter setup
-    lowpassFilter.reset();
-    auto lpCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, lpCutoff, lpQualityFactor);
-    *lowpassFilter.coefficients = *lpCoeffs;
-    
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlockExpected;
-    spec.numChannels = 1;
-    
-    midBandPassFilter.reset();
-    midBandPassFilter.prepare(spec);
-    auto midCoeffs = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, midCutoff, midQualityFactor);
-    *midBandPassFilter.coefficients = *midCoeffs;
-    
-    // Setup reverb processing
-    juce::dsp::ProcessSpec reverbSpec;
-    reverbSpec.sampleRate = sampleRate;
-    reverbSpec.maximumBlockSize = samplesPerBlockExpected;
-    reverbSpec.numChannels = 1;
-    reverb.prepare(reverbSpec);
-    
-    // Flanger spec
-    juce::dsp::ProcessSpec flangerSpec;
-    flangerSpec.sampleRate = sampleRate;
-    flangerSpec.maximumBlockSize = samplesPerBlockExpected;
-    flangerSpec.numChannels = 1;
-    flanger.prepare(flangerSpec);
-    /// ==============================================================
-    
-    // Store sample rate for later processing needed
-    djSampleRate = sampleRate;
-}
-
-/**
- * @brief Processes the next block of audio data.
- * @param bufferToFill The buffer containing the audio data to process.
- */
-void DJAudioPlayer::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
-{
-    // First get the next Audio Block to process
-    resampleSource.getNextAudioBlock(bufferToFill);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    
-    juce::AudioBuffer<float> dryBuffer;
-    dryBuffer.makeCopyOf(*bufferToFill.buffer);
-    
-    // Wrap the buffer in a dsp::AudioBlock to use the DSP module
-    auto dryBlock = juce::dsp::AudioBlock<float>(dryBuffer);
-    // Create a processing context that tells the filter to process in-place
-    juce::dsp::ProcessContextReplacing<float> dryContext(dryBlock);
-    
-    // ================ HIGHPASS ===================
-    highpassFilter.process(dryContext);
-    // =============================================
-    
-    // ================ LOWPASS ====================
-    lowpassFilter.process(dryContext);
-    // =============================================
-    
-    // ================ BANDPASS ===================
-    // Wrap the buffer in a dsp::AudioBlock to use the DSP module
-    auto wetBlock = juce::dsp::AudioBlock<float>(*bufferToFill.buffer).getSubBlock(bufferToFill.startSample, bufferToFill.numSamples);
-    // Create a processing context that tells the filter to process in-place
-    juce::dsp::ProcessContextReplacing<float> wetContext(wetBlock);
-    midBandPassFilter.process(wetContext);
-    // =============================================
-    
-    // Blend the dry (original) and wet (filtered) signals based on bandpassMix:
-    // A bandpassMix of 0.0 means fully dry, 1.0 means fully wet.
-    const int numChannels = bufferToFill.buffer->getNumChannels();
-    const int numSamples  = bufferToFill.buffer->getNumSamples();
-    
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        const float* dry  = dryBuffer.getReadPointer(channel);
-        float* wet = bufferToFill.buffer->getWritePointer(channel);
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            wet[sample] = dry[sample] * (1.0f - (float)midBandPassMix)
-            + wet[sample] * (float)midBandPassMix;
-        }
-    }
-    
-    // ================ REVERB =====================
-    // Process the buffer through the reverb
-    juce::dsp::AudioBlock<float> reverbBlock(*bufferToFill.buffer);
-    juce::dsp::ProcessContextReplacing<float> reverbContext(reverbBlock);
-    reverb.process(reverbContext);
-    // =============================================
-    
-    // ================ FILTER =====================
-    auto flangerBlock = juce::dsp::AudioBlock<float>(*bufferToFill.buffer).getSubBlock(bufferToFill.startSample, bufferToFill.numSamples);
-    juce::dsp::ProcessContextReplacing<float> flangerContext(flangerBlock);
-    flanger.process(flangerContext);
-    // =============================================
-    
-    // ================ TREMOLO =====================
-    const int samples = bufferToFill.numSamples;
-    const int channels = bufferToFill.buffer->getNumChannels();
-    
-    for (int sample = 0; sample < numSamples; ++sample) {
-        float lfoValue = (std::sin(volumeLFOPhase) + 1.0f) * 0.5f;
-        
-        float currentGain = (1.0f - volumeLFOdepth) + (volumeLFOdepth * lfoValue);
-        
-        for (int channel = 0; channel < channels; ++channel) {
-            float* channelData = bufferToFill.buffer->getWritePointer(channel);
-            channelData[sample] *= currentGain;
-        }
-        
-        volumeLFOPhase += juce::MathConstants<float>::twoPi * volumeLFOrate / djSampleRate;
-        
-        if (volumeLFOPhase >= juce::MathConstants<float>::twoPi) {
-            volumeLFOPhase -= juce::MathConstants<float>::twoPi;
-        }
-    }
-    /// ==============================================================
-}
-
-/**
- * @brief Releases allocated resources.
- */
-void DJAudioPlayer::releaseResources()
-{
-    transportSource.releaseResources();
-    resampleSource.releaseResources();
-}
-
-/**
- * @brief Loads an audio file from a given URL.
- * @param audioURL The URL of the audio file to load.
- */
-void DJAudioPlayer::loadURL(juce::URL audioURL)
-{
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
-    if (reader != nullptr) // good file!
-    {
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource (new juce::AudioFormatReaderSource (reader,
-                                                                                                     true));
-        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset (newSource.release());
-    }
-}
-
-/**
- * @brief Sets the playback gain.
- * @param gain The gain value (0.0 to 1.0).
- */
-void DJAudioPlayer::setGain(double gain)
-{
-    if (gain < 0 || gain > 1.0)
-    {
-        std::cout << "DJAudioPlayer::setGain gain should be between 0 and 1" << std::endl;
-    }
-    else {
-        transportSource.setGain(gain);
-    }
-    
-}
-
-/**
- * @brief Sets the playback speed.
- * @param ratio The speed ratio (0.0 to 100.0).
- */
-void DJAudioPlayer::setSpeed(double ratio)
-{
-    if (ratio < 0 || ratio > 100.0)
-    {
-        std::cout << "DJAudioPlayer::setSpeed ratio should be between 0 and 100" << std::endl;
-    }
-    else {
-        resampleSource.setResamplingRatio(ratio);
-    }
-}
-
-/**
- * @brief Sets the playback position.
- * @param posInSecs Position in seconds.
- */
-void DJAudioPlayer::setPosition(double posInSecs)
-{
-    transportSource.setPosition(posInSecs);
-}
-
-/**
- * @brief Sets the playback position relative to the track length.
- * @param pos Relative position (0.0 to 1.0).
- */
-void DJAudioPlayer::setPositionRelative(double pos)
-{
-    if (pos < 0 || pos > 1.0)
-    {
-        std::cout << "DJAudioPlayer::setPositionRelative pos should be between 0 and 1" << std::endl;
-    }
-    else {
-        double posInSecs = transportSource.getLengthInSeconds() * pos;
-        setPosition(posInSecs);
-    }
-}
-
-/**
- * @brief Starts audio playback.
- */
-void DJAudioPlayer::start()
-{
-    transportSource.start();
-}
-
-/**
- * @brief Stops audio playback.
- */
-void DJAudioPlayer::stop()
-{
-    transportSource.stop();
-}
-
-/**
- * @brief Gets the playback position relative to the track length.
- * @return Relative position (0.0 to 1.0).
- */
-double DJAudioPlayer::getPositionRelative()
-{
-    return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
-}
-
-/**
- * ==============================================================
- * Author: Jacques Thurling
- * 13 Mar 2020
- * ==============================================================
- *
- * @brief Sets the high-pass filter amount.
- * @param amount Normalized cutoff frequency factor (0.0 to 1.0).
- */
-void DJAudioPlayer::setHighPassFilterAmount(double amount) {
-    hpCutoff = 2000 * amount;
-    
-    if (djSampleRate > 0) {
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(djSampleRate, hpCutoff, hpQualityFactor);
-        *highpassFilter.coefficients = *coeffs;
-    }
-    
-    std::cout << hpCutoff << " " << amount << std::endl;
-}
-
-/**
- * @brief Sets the low-pass filter amount.
- * @param amount Normalized cutoff frequency factor (0.0 to 1.0).
- */
-void DJAudioPlayer::setLowPassFilterAmount(double amount) {
-    lpCutoff = 20000.0f * amount;
-    
-    if (djSampleRate > 0) {
-        auto lpCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(djSampleRate, lpCutoff, lpQualityFactor);
-        *lowpassFilter.coefficients = *lpCoeffs;
-    }
-    
-    std::cout << lpCutoff << " " << amount << " " << djSampleRate * 0.5 << std::endl;
-}
-
-/**
- * @brief Sets the band-pass filter mix amount.
- * @param amount Mix amount (0.0 to 1.0).
- */
-void DJAudioPlayer::setMidBandPassFilterAmount(double amount) {
-    midBandPassMix = amount;
-}
-
-/**
- * @brief Sets the reverb effect amount.
- * @param amount The amount of reverb (0.0 to 1.0).
- */
-void DJAudioPlayer::setReverbAmount(double amount) {
-    reverbParams.wetLevel = amount;
-    reverbParams.dryLevel = 1.0f - amount;
-    reverb.setParameters(reverbParams);
-}
-
-/**
- * @brief Sets the amount of flanger effect.
- * @param amount The mix amount of the flanger effect (0.0 to 1.0).
- */
-void DJAudioPlayer::setFlangerAmount(double amount) {
-    flanger.setMix(amount);
-}
-
-/**
- * @brief Sets the tremolo effect depth.
- * @param amount The depth of the tremolo effect (0.0 to 1.0).
- */
-void DJAudioPlayer::setTremelo(double amount) {
-    volumeLFOdepth = amount;
-}
-/// ==============================================================
+/**
+ * @file DJAudioPlayer.cpp
+ * @brief Implementation of the DJAudioPlayer class for audio processing.
+ *
+ * This class handles audio playback, filtering, and effects such as reverb,
+ * flanger, and tremolo.
+ *
+ * @author Matthew
+ * @date 13 Mar 2020
+ */
+
+#include "DJAudioPlayer.h"
+#include "MixAutomation.h"
+
+/**
+ * @brief Constructor for DJAudioPlayer.
+ *
+ * Initializes reverb and flanger effect parameters.
+ */
+DJAudioPlayer::DJAudioPlayer()
+{
+    reverbParams.roomSize = 0.9f;
+    reverbParams.damping = 0.5f;
+    reverbParams.wetLevel = reverbWetDryMix;
+    reverbParams.dryLevel = 1.0f - reverbWetDryMix;
+    reverbParams.width = 5.0f;
+    reverbParams.freezeMode = 0.0f;
+    
+    reverb.setParameters(reverbParams);
+    
+    // Flanger
+    flanger.setCentreDelay(0.001f);
+    flanger.setRate(0.1f);
+    flanger.setDepth(1.0f);
+    flanger.setFeedback(0.7f);
+    flanger.setMix(flangerWetDryMix);
+    
+    // Registered up front so tracks can be opened before the audio device starts.
+    formatManager.registerBasicFormats();
+    readAheadThread.addTimeSliceClient(this);
+    readAheadThread.startThread();
+}
+
+/**
+ * @brief Destructor for DJAudioPlayer.
+ */
+DJAudioPlayer::~DJAudioPlayer()
+{
+    readAheadThread.removeTimeSliceClient(this);
+    loaderPool.removeAllJobs(true, 5000);
+    cancelPendingUpdate();
+    transportSource.setSource(nullptr);
+}
+
+/**
+ * @brief Prepares the audio player for playback.
+ * @param samplesPerBlockExpected Number of samples per block expected.
+ * @param sampleRate The sample rate of the audio.
+ */
+void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    
+    // The resampler prepares its input at sampleRate times the current ratio, so prepare at ratio 1;
+    // any other ratio would have the transport play at the wrong speed. The longer block sizes its
+    // buffer for the fastest jog, so scratching never allocates on the audio thread.
+    resampleSource.setResamplingRatio(1.0);
+    appliedRatio = 1.0;
+    resampleSource.prepareToPlay(juce::roundToInt(samplesPerBlockExpected * maxJogRatio), sampleRate);
+    
+    // Room for a stereo block, so the dry copy only grows for unusually wide or long blocks.
+    dryBuffer.setSize(2, samplesPerBlockExpected);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    // HighPassfilter setup
+    highpassFilter.reset();
+    auto hpCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, hpCutoff, hpQualityFactor);
+    *highpassFilter.coefficients = *hpCoeffs;
+    
+    // Lowpass filter setup
+    lowpassFilter.reset();
+    auto lpCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, lpCutoff, lpQualityFactor);
+    *lowpassFilter.coefficients = *lpCoeffs;
+    
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = samplesPerBlockExpected;
+    spec.numChannels = 1;
+    
+    midBandPassFilter.reset();
+    midBandPassFilter.prepare(spec);
+    auto midCoeffs = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, midCutoff, midQualityFactor);
+    *midBandPassFilter.coefficients = *midCoeffs;
+    
+    // Setup reverb processing
+    juce::dsp::ProcessSpec reverbSpec;
+    reverbSpec.sampleRate = sampleRate;
+    reverbSpec.maximumBlockSize = samplesPerBlockExpected;
+    reverbSpec.numChannels = 1;
+    reverb.prepare(reverbSpec);
+    
+    // Flanger spec
+    juce::dsp::ProcessSpec flangerSpec;
+    flangerSpec.sampleRate = sampleRate;
+    flangerSpec.maximumBlockSize = samplesPerBlockExpected;
+    flangerSpec.numChannels = 1;
+    flanger.prepare(flangerSpec);
+    /// ==============================================================
+    
+    // Store sample rate for later processing needed
+    djSampleRate = sampleRate;
+    padBank.prepareToPlay(sampleRate);
+    analyser.prepare(sampleRate);
+}
+
+/**
+ * @brief Processes the next block of audio data.
+ * @param bufferToFill The buffer containing the audio data to process.
+ */
+void DJAudioPlayer::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    auto* recorder = automation.load();
+    
+    // Apply any transport and control events scheduled since the last block.
+    // While a take replays, live control movements are dropped so it plays as recorded.
+    eventQueue.drain([this, recorder](const DeckEvent& event) {
+        if (recorder != nullptr && MixAutomation::isAutomated(event)) {
+            if (recorder->isReplayingBlock())
+                return;
+            
+            if (recorder->isRecordingBlock())
+                recorder->record(automationDeck, event);
+        }
+        
+        applyEvent(event);
+    });
+    
+    // A held deck stays parked until replay releases it on the take's first block
+    if (transportHeld.load()) {
+        bufferToFill.clearActiveBufferRegion();
+        analyser.process(bufferToFill);
+        publishTelemetry(bufferToFill);
+        return;
+    }
+    
+    // Replayed events split the block, so each takes effect on the sample it was recorded at
+    const int numSamples = bufferToFill.numSamples;
+    
+    for (int offset = 0; offset < numSamples;) {
+        const int end = recorder != nullptr
+            ? recorder->replayEvents(automationDeck, offset, numSamples, [this](const DeckEvent& event) { applyEvent(event); })
+            : numSamples;
+        
+        renderSection({bufferToFill.buffer, bufferToFill.startSample + offset, end - offset});
+        offset = end;
+    }
+    
+    // Tap the finished deck output for the meters and telemetry
+    analyser.process(bufferToFill);
+    publishTelemetry(bufferToFill);
+}
+
+/**
+ * @brief Renders one section of a block through the resampler, pads and effects.
+ *
+ * Every stage works on the section's samples only, and the effects carry
+ * their state from one section to the next, so rendering a block in one
+ * section or several gives the same output when no event falls between them.
+ *
+ * @param section The part of the block to render.
+ */
+void DJAudioPlayer::renderSection(const juce::AudioSourceChannelInfo& section)
+{
+    applyJog(section.numSamples);
+    
+    // First get the next Audio Block to process
+    resampleSource.getNextAudioBlock(section);
+    
+    // Sample pads play on top of the track, before the deck's effects
+    padBank.renderNextBlock(*section.buffer, section.startSample, section.numSamples);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    
+    const int numChannels = section.buffer->getNumChannels();
+    const int numSamples  = section.numSamples;
+    
+    // Only grows if a block is larger than any before it
+    dryBuffer.setSize(numChannels, numSamples, false, false, true);
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        dryBuffer.copyFrom(channel, 0, *section.buffer, channel, section.startSample, numSamples);
+    
+    // Wrap the buffer in a dsp::AudioBlock to use the DSP module
+    auto dryBlock = juce::dsp::AudioBlock<float>(dryBuffer).getSubBlock(0, (size_t) numSamples);
+    // Create a processing context that tells the filter to process in-place
+    juce::dsp::ProcessContextReplacing<float> dryContext(dryBlock);
+    
+    // ================ HIGHPASS ===================
+    highpassFilter.process(dryContext);
+    // =============================================
+    
+    // ================ LOWPASS ====================
+    lowpassFilter.process(dryContext);
+    // =============================================
+    
+    // ================ BANDPASS ===================
+    // Wrap the buffer in a dsp::AudioBlock to use the DSP module
+    auto wetBlock = juce::dsp::AudioBlock<float>(*section.buffer).getSubBlock((size_t) section.startSample, (size_t) numSamples);
+    // Create a processing context that tells the filter to process in-place
+    juce::dsp::ProcessContextReplacing<float> wetContext(wetBlock);
+    midBandPassFilter.process(wetContext);
+    // =============================================
+    
+    // Blend the dry (original) and wet (filtered) signals based on bandpassMix:
+    // A bandpassMix of 0.0 means fully dry, 1.0 means fully wet.
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float* dry  = dryBuffer.getReadPointer(channel);
+        float* wet = section.buffer->getWritePointer(channel, section.startSample);
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            wet[sample] = dry[sample] * (1.0f - (float)midBandPassMix)
+            + wet[sample] * (float)midBandPassMix;
+        }
+    }
+    
+    // ================ REVERB =====================
+    // Process the buffer through the reverb
+    juce::dsp::ProcessContextReplacing<float> reverbContext(wetBlock);
+    reverb.process(reverbContext);
+    // =============================================
+    
+    // ================ FILTER =====================
+    juce::dsp::ProcessContextReplacing<float> flangerContext(wetBlock);
+    flanger.process(flangerContext);
+    // =============================================
+    
+    // ================ TREMOLO =====================
+    for (int sample = section.startSample; sample < section.startSample + numSamples; ++sample) {
+        float lfoValue = (std::sin(volumeLFOPhase) + 1.0f) * 0.5f;
+        
+        float currentGain = (1.0f - volumeLFOdepth) + (volumeLFOdepth * lfoValue);
+        
+        for (int channel = 0; channel < numChannels; ++channel) {
+            float* channelData = section.buffer->getWritePointer(channel);
+            channelData[sample] *= currentGain;
+        }
+        
+        volumeLFOPhase += juce::MathConstants<float>::twoPi * volumeLFOrate / djSampleRate;
+        
+        if (volumeLFOPhase >= juce::MathConstants<float>::twoPi) {
+            volumeLFOPhase -= juce::MathConstants<float>::twoPi;
+        }
+    }
+    /// ==============================================================
+}
+
+/**
+ * @brief Applies one queued event on the audio thread.
+ *
+ * Filter coefficients are computed into fixed-size arrays and copied into
+ * the existing coefficient storage, so nothing is allocated here.
+ *
+ * @param event The event.
+ */
+void DJAudioPlayer::applyEvent(const DeckEvent& event)
+{
+    switch (event.type) {
+        case DeckEvent::Type::triggerHotCue: {
+            // The resident audio covers the time the transport takes to get there
+            const double handover = hotCueSource.startCue(event.index);
+            if (handover >= 0.0)
+                seekFromAudioThread(handover);
+            break;
+        }
+        case DeckEvent::Type::cancelHotCue:
+            hotCueSource.cancelCue();
+            break;
+        case DeckEvent::Type::triggerPad:
+            padBank.triggerPad(event.index, event.value);
+            break;
+        case DeckEvent::Type::setGain:
+            transportSource.setGain(event.value);
+            break;
+        case DeckEvent::Type::setSpeed:
+            speedRatio = event.value;
+            break;
+        case DeckEvent::Type::jog:
+            pendingJog += event.value;
+            break;
+        case DeckEvent::Type::setHighPass:
+            hpCutoff = 2000.0 * event.value;
+            if (djSampleRate > 0)
+                *highpassFilter.coefficients = juce::dsp::IIR::ArrayCoefficients<float>::makeHighPass(djSampleRate, hpCutoff, hpQualityFactor);
+            break;
+        case DeckEvent::Type::setMidBandPass:
+            midBandPassMix = event.value;
+            break;
+        case DeckEvent::Type::setLowPass:
+            lpCutoff = 20000.0 * event.value;
+            if (djSampleRate > 0)
+                *lowpassFilter.coefficients = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(djSampleRate, lpCutoff, lpQualityFactor);
+            break;
+        case DeckEvent::Type::setReverb:
+            reverbParams.wetLevel = event.value;
+            reverbParams.dryLevel = 1.0f - event.value;
+            reverb.setParameters(reverbParams);
+            break;
+        case DeckEvent::Type::setFlanger:
+            flangerWetDryMix = event.value;
+            flanger.setMix(event.value);
+            break;
+        case DeckEvent::Type::setTremolo:
+            volumeLFOdepth = event.value;
+            break;
+    }
+}
+
+/**
+ * @brief Moves the transport on behalf of the audio thread.
+ *
+ * Seeking a read-ahead source locks its buffer and wakes its thread, so the
+ * position is left for the read-ahead thread, which picks it up within
+ * seekPollMs and refills from there. Without read-ahead the seek only moves
+ * the reader's index and is applied here, keeping offline renders exact.
+ *
+ * @param posInSecs The position in seconds.
+ */
+void DJAudioPlayer::seekFromAudioThread(double posInSecs)
+{
+    if (readAhead) {
+        pendingSeek = juce::jmax(0.0, posInSecs);
+    } else {
+        transportSource.setPosition(juce::jmax(0.0, posInSecs));
+    }
+}
+
+/**
+ * @brief Read-ahead thread: applies the seek the audio thread last asked for.
+ *
+ * Skipped while the message thread swaps the transport's source; the seek
+ * stays pending and is retried on the next call.
+ *
+ * @return Milliseconds until the next call.
+ */
+int DJAudioPlayer::useTimeSlice()
+{
+    if (pendingSeek.load() < 0.0)
+        return seekPollMs;
+    
+    const juce::ScopedTryLock sl (sourceLock);
+    
+    if (! sl.isLocked())
+        return 1;
+    
+    const double target = pendingSeek.exchange(-1.0);
+    
+    if (target >= 0.0)
+        transportSource.setPosition(target);
+    
+    return seekPollMs;
+}
+
+/**
+ * @brief Gives the resampler the user's speed plus any pending jog movement.
+ *
+ * Rendering n samples at ratio r advances the track by n * r samples, so
+ * adding jog * sampleRate / n to the ratio plays the whole movement out in
+ * this block. Movements the resampler cannot play (backwards, or slower than
+ * minJogRatio) become a seek, handed to seekFromAudioThread so the audio
+ * thread never repositions the read-ahead buffer itself; anything faster
+ * than maxJogRatio is clipped.
+ *
+ * @param numSamples Length of the block about to be rendered.
+ */
+void DJAudioPlayer::applyJog(int numSamples)
+{
+    double ratio = speedRatio;
+    
+    if (pendingJog != 0.0 && numSamples > 0 && djSampleRate > 0) {
+        const double bent = speedRatio + pendingJog * djSampleRate / numSamples;
+        
+        if (transportSource.isPlaying() && bent >= minJogRatio) {
+            ratio = juce::jmin(bent, maxJogRatio);
+        } else {
+            // Relative to a seek still waiting, so jogs in quick succession add up
+            const double waiting = pendingSeek.load();
+            hotCueSource.cancelCue();
+            seekFromAudioThread((waiting >= 0.0 ? waiting : transportSource.getCurrentPosition()) + pendingJog);
+        }
+        
+        pendingJog = 0.0;
+    }
+    
+    if (ratio != appliedRatio) {
+        resampleSource.setResamplingRatio(ratio);
+        appliedRatio = ratio;
+    }
+}
+
+/**
+ * @brief Updates the output level and publishes the block's telemetry.
+ *
+ * The level uses simple meter ballistics, so a reader polling at a few
+ * tens of hertz still sees the peaks between its reads.
+ *
+ * @param bufferToFill The finished block.
+ */
+void DJAudioPlayer::publishTelemetry(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    const int numChannels = bufferToFill.buffer->getNumChannels();
+    float blockPeak = 0.0f;
+    float blockMeanSquare = 0.0f;
+    
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const float rms = bufferToFill.buffer->getRMSLevel(channel, bufferToFill.startSample, bufferToFill.numSamples);
+        blockPeak = juce::jmax(blockPeak, bufferToFill.buffer->getMagnitude(channel, bufferToFill.startSample, bufferToFill.numSamples));
+        blockMeanSquare += rms * rms / (float) numChannels;
+    }
+    
+    const float decay = std::exp(-(float) bufferToFill.numSamples / (float) (0.3 * djSampleRate));
+    telemetryPeak = juce::jmax(blockPeak, telemetryPeak * decay);
+    telemetryMeanSquare = blockMeanSquare + (telemetryMeanSquare - blockMeanSquare) * decay;
+    
+    auto& snapshot = telemetry.getWriteBuffer();
+    snapshot.position = transportSource.getCurrentPosition();
+    snapshot.length = transportSource.getLengthInSeconds();
+    snapshot.speed = speedRatio;
+    snapshot.playing = transportSource.isPlaying();
+    snapshot.peak = telemetryPeak;
+    snapshot.rms = std::sqrt(telemetryMeanSquare);
+    telemetry.publish();
+}
+
+/**
+ * @brief Releases allocated resources.
+ */
+void DJAudioPlayer::releaseResources()
+{
+    transportSource.releaseResources();
+    resampleSource.releaseResources();
+}
+
+/**
+ * @brief Loads an audio file from a given URL.
+ * @param audioURL The URL of the audio file to load.
+ * @return True if the file was loaded.
+ */
+bool DJAudioPlayer::loadURL(juce::URL audioURL)
+{
+    {
+        const juce::ScopedLock sl (loadLock);
+        ++loadGeneration;
+    }
+    
+    const auto superseded = std::exchange(onAsyncLoaded, nullptr);
+    const bool loaded = installReader(formatManager.createReaderFor(audioURL.createInputStream(false)), audioURL);
+    
+    // A background load still in flight will never be installed now.
+    if (superseded) {
+        superseded(false);
+    }
+    
+    return loaded;
+}
+
+/**
+ * @brief Opens an audio file on a background thread and installs it on the message thread.
+ *
+ * Opening a file reads and parses its headers, which for some formats means
+ * scanning the file; only that happens on the loader thread. The transport
+ * is only ever touched on the message thread.
+ *
+ * @param audioURL The URL of the audio file.
+ * @param onLoaded Called on the message thread with true if the file was loaded, or false if it failed or was superseded.
+ */
+void DJAudioPlayer::loadURLAsync(juce::URL audioURL, std::function<void(bool loaded)> onLoaded)
+{
+    juce::uint32 generation;
+    
+    {
+        const juce::ScopedLock sl (loadLock);
+        generation = ++loadGeneration;
+    }
+    
+    const auto superseded = std::exchange(onAsyncLoaded, std::move(onLoaded));
+    
+    loaderPool.addJob([this, audioURL, generation] {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(audioURL.createInputStream(false)));
+        
+        {
+            const juce::ScopedLock sl (loadLock);
+            openedTracks.push_back({std::move(reader), audioURL, generation});
+        }
+        
+        triggerAsyncUpdate();
+    });
+    
+    // Called last, so a callback that starts another load supersedes this one in turn.
+    if (superseded) {
+        superseded(false);
+    }
+}
+
+/**
+ * @brief Installs the newest track opened in the background.
+ *
+ * Tracks from superseded loads are closed without being installed.
+ */
+void DJAudioPlayer::handleAsyncUpdate()
+{
+    std::vector<OpenedTrack> opened;
+    juce::uint32 generation;
+    
+    {
+        const juce::ScopedLock sl (loadLock);
+        opened.swap(openedTracks);
+        generation = loadGeneration;
+    }
+    
+    for (auto& track : opened) {
+        if (track.generation != generation) {
+            continue;
+        }
+        
+        const bool loaded = installReader(track.reader.release(), track.url);
+        
+        if (auto callback = std::exchange(onAsyncLoaded, nullptr)) {
+            callback(loaded);
+        }
+    }
+}
+
+/**
+ * @brief Makes a reader the deck's source.
+ * @param reader The reader to take ownership of, or nullptr.
+ * @param audioURL The track's URL.
+ * @return True if a reader was installed.
+ */
+bool DJAudioPlayer::installReader(juce::AudioFormatReader* reader, const juce::URL& audioURL)
+{
+    if (reader == nullptr) {
+        return false;
+    }
+    
+    // Cues belong to the previous track
+    eventQueue.push({DeckEvent::Type::cancelHotCue});
+    hotCueSource.clearAllCues();
+    
+    std::unique_ptr<juce::AudioFormatReaderSource> newSource (new juce::AudioFormatReaderSource (reader,
+                                                                                                 true));
+    // A seek asked for on the old track means nothing on this one
+    const juce::ScopedLock sl (sourceLock);
+    pendingSeek = -1.0;
+    
+    // Read ahead on a background thread so jumps never decode inside the audio callback
+    if (readAhead) {
+        transportSource.setSource (newSource.get(), 32768, &readAheadThread, reader->sampleRate);
+    } else {
+        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);
+    }
+    readerSource.reset (newSource.release());
+    loadedURL = audioURL;
+    return true;
+}
+
+/**
+ * @brief Sets the playback gain.
+ * @param gain The gain value (0.0 to 1.0).
+ */
+void DJAudioPlayer::setGain(double gain)
+{
+    if (gain < 0 || gain > 1.0)
+    {
+        std::cout << "DJAudioPlayer::setGain gain should be between 0 and 1" << std::endl;
+    }
+    else {
+        eventQueue.push({DeckEvent::Type::setGain, 0, (float) gain});
+    }
+    
+}
+
+/**
+ * @brief Sets the playback speed.
+ * @param ratio The speed ratio (0.0 to 100.0).
+ */
+void DJAudioPlayer::setSpeed(double ratio)
+{
+    if (ratio < 0 || ratio > 100.0)
+    {
+        std::cout << "DJAudioPlayer::setSpeed ratio should be between 0 and 100" << std::endl;
+    }
+    else {
+        eventQueue.push({DeckEvent::Type::setSpeed, 0, (float) ratio});
+    }
+}
+
+/**
+ * @brief Sets the playback position.
+ * @param posInSecs Position in seconds.
+ */
+void DJAudioPlayer::setPosition(double posInSecs)
+{
+    // A seek from the audio thread still waiting would undo this one
+    pendingSeek = -1.0;
+    eventQueue.push({DeckEvent::Type::cancelHotCue});
+    transportSource.setPosition(posInSecs);
+}
+
+/**
+ * @brief Sets the playback position relative to the track length.
+ * @param pos Relative position (0.0 to 1.0).
+ */
+void DJAudioPlayer::setPositionRelative(double pos)
+{
+    if (pos < 0 || pos > 1.0)
+    {
+        std::cout << "DJAudioPlayer::setPositionRelative pos should be between 0 and 1" << std::endl;
+    }
+    else {
+        double posInSecs = transportSource.getLengthInSeconds() * pos;
+        setPosition(posInSecs);
+    }
+}
+
+/**
+ * @brief Starts audio playback.
+ */
+void DJAudioPlayer::start()
+{
+    transportSource.start();
+}
+
+/**
+ * @brief Stops audio playback.
+ */
+void DJAudioPlayer::stop()
+{
+    transportSource.stop();
+}
+
+/**
+ * @brief Checks whether the transport is playing.
+ * @return True if playing.
+ */
+bool DJAudioPlayer::isPlaying() const
+{
+    return transportSource.isPlaying();
+}
+
+/**
+ * @brief Moves the playhead by a jog wheel movement.
+ * @param seconds The movement in seconds, negative to move back.
+ */
+void DJAudioPlayer::jog(double seconds)
+{
+    eventQueue.push({DeckEvent::Type::jog, 0, (float) seconds});
+}
+
+/**
+ * @brief Classic cue button: sets the cue point when stopped, returns to it when playing.
+ */
+void DJAudioPlayer::cue()
+{
+    if (transportSource.isPlaying()) {
+        stop();
+        setPosition(cuePoint);
+    } else {
+        cuePoint = getPosition();
+    }
+}
+
+/**
+ * @brief Gets the playback position relative to the track length.
+ * @return Relative position (0.0 to 1.0), or 0.0 if no track is loaded.
+ */
+double DJAudioPlayer::getPositionRelative()
+{
+    const double length = transportSource.getLengthInSeconds();
+
+    if (length <= 0.0)
+        return 0.0;
+
+    return transportSource.getCurrentPosition() / length;
+}
+
+/**
+ * @brief Gets the playback position in seconds.
+ * @return Position in seconds.
+ */
+double DJAudioPlayer::getPosition()
+{
+    return transportSource.getCurrentPosition();
+}
+
+/**
+ * @brief Stores a hot cue at the given position of the loaded track.
+ *
+ * A separate reader is opened so the resident audio can be decoded without
+ * touching the reader used by the audio thread.
+ *
+ * @param index The cue slot (0 - 7).
+ * @param posInSecs The cue position in seconds.
+ * @return True if the cue was stored.
+ */
+bool DJAudioPlayer::setHotCue(int index, double posInSecs)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(loadedURL.createInputStream(false)));
+    
+    if (reader == nullptr)
+    {
+        std::cout << "DJAudioPlayer::setHotCue no track loaded" << std::endl;
+        return false;
+    }
+    
+    return hotCueSource.setCue(index, *reader, posInSecs);
+}
+
+/**
+ * @brief Stores a whole set of hot cues using a single reader.
+ * @param positions Cue positions in seconds, negative for empty slots.
+ */
+void DJAudioPlayer::setHotCues(const std::vector<double>& positions)
+{
+    hotCueSource.clearAllCues();
+    
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(loadedURL.createInputStream(false)));
+    
+    if (reader == nullptr)
+        return;
+    
+    for (int i = 0; i < (int) positions.size() && i < HotCueSource::numCues; ++i)
+    {
+        if (positions[(size_t) i] >= 0)
+            hotCueSource.setCue(i, *reader, positions[(size_t) i]);
+    }
+}
+
+/**
+ * @brief Removes a hot cue.
+ * @param index The cue slot (0 - 7).
+ */
+void DJAudioPlayer::clearHotCue(int index)
+{
+    hotCueSource.clearCue(index);
+}
+
+/**
+ * @brief Jumps to a hot cue and starts playback from it.
+ *
+ * The trigger goes through the event queue like every other control, so
+ * the audio thread starts the resident audio and asks for the transport to
+ * be parked at its end in the same block; the transport refills in the
+ * background while the cue plays. The trigger is queued before the
+ * transport starts, so no block plays the old position in between.
+ *
+ * @param index The cue slot (0 - 7).
+ * @return True if the slot held a cue.
+ */
+bool DJAudioPlayer::triggerHotCue(int index)
+{
+    if (! hotCueSource.hasCue(index))
+        return false;
+    
+    eventQueue.push({DeckEvent::Type::triggerHotCue, index});
+    transportSource.start();
+    return true;
+}
+
+/**
+ * @brief Checks whether a hot cue slot is in use.
+ * @param index The cue slot (0 - 7).
+ * @return True if the slot holds a cue.
+ */
+bool DJAudioPlayer::hasHotCue(int index)
+{
+    return hotCueSource.hasCue(index);
+}
+
+/**
+ * @brief Gets the position of a hot cue.
+ * @param index The cue slot (0 - 7).
+ * @return The position in seconds, or -1 if the slot is empty.
+ */
+double DJAudioPlayer::getHotCuePosition(int index)
+{
+    return hotCueSource.getCuePosition(index);
+}
+
+/**
+ * @brief Loads a whole audio file as a one-shot on a sample pad.
+ * @param pad The pad to load (0 - 7).
+ * @param file The audio file to load.
+ * @return True if the pad was loaded.
+ */
+bool DJAudioPlayer::loadPadSample(int pad, juce::File file)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(file));
+    
+    if (reader == nullptr)
+    {
+        std::cout << "DJAudioPlayer::loadPadSample could not read " << file.getFullPathName() << std::endl;
+        return false;
+    }
+    
+    return padBank.loadPad(pad, *reader, 0, reader->lengthInSamples);
+}
+
+/**
+ * @brief Fills every pad with consecutive slices of the loaded track.
+ * @param posInSecs Start of the first slice in seconds.
+ */
+void DJAudioPlayer::sliceTrackToPads(double posInSecs)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(loadedURL.createInputStream(false)));
+    
+    if (reader == nullptr)
+    {
+        std::cout << "DJAudioPlayer::sliceTrackToPads no track loaded" << std::endl;
+        return;
+    }
+    
+    const auto sliceLength = (juce::int64) (SamplePadBank::sliceSeconds * reader->sampleRate);
+    const auto firstSample = (juce::int64) (posInSecs * reader->sampleRate);
+    
+    for (int pad = 0; pad < SamplePadBank::numPads; ++pad)
+    {
+        if (! padBank.loadPad(pad, *reader, firstSample + pad * sliceLength, sliceLength))
+            padBank.clearPad(pad);
+    }
+}
+
+/**
+ * @brief Empties a sample pad.
+ * @param pad The pad to clear (0 - 7).
+ */
+void DJAudioPlayer::clearPad(int pad)
+{
+    padBank.clearPad(pad);
+}
+
+/**
+ * @brief Plays a sample pad from the start of the next audio block.
+ *
+ * Pads go through the same event queue as hot cues, so both are applied by
+ * the audio thread at the same point in the block.
+ *
+ * @param pad The pad to play (0 - 7).
+ * @param velocity Gain of the voice (0.0 - 1.0).
+ */
+void DJAudioPlayer::triggerPad(int pad, float velocity)
+{
+    eventQueue.push({DeckEvent::Type::triggerPad, pad, velocity});
+}
+
+/**
+ * @brief Checks whether a sample pad holds audio.
+ * @param pad The pad to check (0 - 7).
+ * @return True if the pad is loaded.
+ */
+bool DJAudioPlayer::isPadLoaded(int pad)
+{
+    return padBank.isPadLoaded(pad);
+}
+
+/**
+ * @brief Gets how much of the deck's sample pad pool holds audio.
+ * @return The used size in bytes.
+ */
+size_t DJAudioPlayer::getPadMemoryUsed() const
+{
+    return padBank.getUsedBytes();
+}
+
+/**
+ * @brief Gets the size of the deck's preallocated sample pad pool.
+ * @return The pool size in bytes.
+ */
+size_t DJAudioPlayer::getPadMemorySize() const
+{
+    return padBank.getPoolSizeInBytes();
+}
+
+/**
+ * @brief Gets the metering tap on the deck's output.
+ * @return Reference to the deck's analyser.
+ */
+AudioAnalyser& DJAudioPlayer::getAnalyser()
+{
+    return analyser;
+}
+
+/**
+ * @brief Copies the newest telemetry published by the audio thread.
+ * @param destination Receives the telemetry.
+ * @return True if new telemetry was copied.
+ */
+bool DJAudioPlayer::getLatestTelemetry(DeckTelemetry& destination)
+{
+    return telemetry.read(destination);
+}
+
+/**
+ * @brief Sets the tempo of the loaded track, for telemetry.
+ * @param bpm The tempo in BPM, 0 when unknown.
+ */
+void DJAudioPlayer::setTrackTempo(float bpm)
+{
+    trackTempo = bpm;
+}
+
+/**
+ * @brief Gets the tempo of the loaded track.
+ * @return The tempo in BPM at normal speed, 0 when unknown.
+ */
+float DJAudioPlayer::getTrackTempo() const
+{
+    return trackTempo;
+}
+
+/**
+ * @brief Gets the URL of the loaded track.
+ * @return The URL, empty if nothing has been loaded.
+ */
+juce::URL DJAudioPlayer::getLoadedURL() const
+{
+    return loadedURL;
+}
+
+/**
+ * @brief Reads the track ahead on a background thread, or inside the audio callback.
+ * @param shouldReadAhead False to read inside the audio callback.
+ */
+void DJAudioPlayer::setReadAhead(bool shouldReadAhead)
+{
+    readAhead = shouldReadAhead;
+}
+
+/**
+ * @brief Hooks the deck into mix automation.
+ * @param automationToUse The automation, or nullptr to unhook.
+ * @param deck This deck's number in the automation (0 or 1).
+ */
+void DJAudioPlayer::setAutomation(MixAutomation* automationToUse, int deck)
+{
+    automationDeck = deck;
+    automation = automationToUse;
+}
+
+/**
+ * @brief Describes every automated control's current setting as an event.
+ * @return One event per control, which applied in order restore the settings.
+ */
+std::array<DeckEvent, 8> DJAudioPlayer::getControlState() const
+{
+    return {{
+        {DeckEvent::Type::setGain, 0, transportSource.getGain()},
+        {DeckEvent::Type::setSpeed, 0, (float) speedRatio},
+        {DeckEvent::Type::setHighPass, 0, (float) (hpCutoff / 2000.0)},
+        {DeckEvent::Type::setMidBandPass, 0, (float) midBandPassMix},
+        {DeckEvent::Type::setLowPass, 0, (float) (lpCutoff / 20000.0)},
+        {DeckEvent::Type::setReverb, 0, reverbParams.wetLevel},
+        {DeckEvent::Type::setFlanger, 0, (float) flangerWetDryMix},
+        {DeckEvent::Type::setTremolo, 0, volumeLFOdepth}
+    }};
+}
+
+/**
+ * @brief Clears the effects' state and settles the gain.
+ *
+ * The transport ramps from its previous gain over each block; rendering an
+ * empty block with the new gain makes it start there instead, without
+ * reading anything from the track.
+ *
+ * @param gain The gain to start from, without a ramp.
+ */
+void DJAudioPlayer::resetProcessing(float gain)
+{
+    highpassFilter.reset();
+    lowpassFilter.reset();
+    midBandPassFilter.reset();
+    reverb.reset();
+    flanger.reset();
+    volumeLFOPhase = 0.0f;
+    pendingJog = 0.0;
+    hotCueSource.cancelCue();
+    resampleSource.flushBuffers();
+    
+    transportSource.setGain(gain);
+    transportSource.getNextAudioBlock({&dryBuffer, 0, 0});
+}
+
+/**
+ * @brief Holds the deck silent and parked, or releases it.
+ * @param shouldHold True to hold, false to release.
+ */
+void DJAudioPlayer::holdTransport(bool shouldHold)
+{
+    transportHeld = shouldHold;
+}
+
+/**
+ * @brief Checks whether the deck is held by holdTransport.
+ * @return True while held.
+ */
+bool DJAudioPlayer::isTransportHeld() const
+{
+    return transportHeld.load();
+}
+
+/**
+ * ==============================================================
+ * Author: Jacques Thurling
+ * 13 Mar 2020
+ * ==============================================================
+ *
+ * @brief Sets the high-pass filter amount.
+ * @param amount Normalized cutoff frequency factor (0.0 to 1.0).
+ */
+void DJAudioPlayer::setHighPassFilterAmount(double amount) {
+    eventQueue.push({DeckEvent::Type::setHighPass, 0, (float) amount});
+}
+
+/**
+ * @brief Sets the low-pass filter amount.
+ * @param amount Normalized cutoff frequency factor (0.0 to 1.0).
+ */
+void DJAudioPlayer::setLowPassFilterAmount(double amount) {
+    eventQueue.push({DeckEvent::Type::setLowPass, 0, (float) amount});
+}
+
+/**
+ * @brief Sets the band-pass filter mix amount.
+ * @param amount Mix amount (0.0 to 1.0).
+ */
+void DJAudioPlayer::setMidBandPassFilterAmount(double amount) {
+    eventQueue.push({DeckEvent::Type::setMidBandPass, 0, (float) amount});
+}
+
+/**
+ * @brief Sets the reverb effect amount.
+ * @param amount The amount of reverb (0.0 to 1.0).
+ */
+void DJAudioPlayer::setReverbAmount(double amount) {
+    eventQueue.push({DeckEvent::Type::setReverb, 0, (float) amount});
+}
+
+/**
+ * @brief Sets the amount of flanger effect.
+ * @param amount The mix amount of the flanger effect (0.0 to 1.0).
+ */
+void DJAudioPlayer::setFlangerAmount(double amount) {
+    eventQueue.push({DeckEvent::Type::setFlanger, 0, (float) amount});
+}
+
+/**
+ * @brief Sets the tremolo effect depth.
+ * @param amount The depth of the tremolo effect (0.0 to 1.0).
+ */
+void DJAudioPlayer::setTremelo(double amount) {
+    eventQueue.push({DeckEvent::Type::setTremolo, 0, (float) amount});
+}
+/// ==============================================================
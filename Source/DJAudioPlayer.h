@@ -1,182 +1,509 @@
-/**
- * @file DJAudioPlayer.cpp
- * @brief Implementation of the DJAudioPlayer class for audio processing.
- *
- * This class handles audio playback, filtering, and effects such as reverb,
- * flanger, and tremolo.
- *
- * @author Matthew
- * @date 13 Mar 2020
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-
-/**
- * @class DJAudioPlayer
- * @brief A class for handling audio playback with various effects and filters.
- *
- * DJAudioPlayer provides functionalities to play, stop, and manipulate audio
- * including filtering, reverb, flanger, and tremolo effects.
- */
-class DJAudioPlayer : public juce::AudioSource {
-    private:
-    juce::AudioFormatManager formatManager; ///< Manages available audio formats.
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource; ///< Pointer to the audio source.
-    
-    /**
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ===========================================================
-     */
-    
-    double hpCutoff = 100.0f; ///< High-pass filter cutoff frequency.
-    double hpQualityFactor = 0.7071f; ///< High-pass filter quality factor.
-    juce::dsp::IIR::Filter<float> highpassFilter; ///< High-pass filter object.
-    
-    double lpCutoff = 20000.0f; ///< Low-pass filter cutoff frequency.
-    double lpQualityFactor = 0.7071f; ///< Low-pass filter quality factor.
-    juce::dsp::IIR::Filter<float> lowpassFilter; ///< Low-pass filter object.
-    
-    double midCutoff = 500.0f; ///< Mid-band pass filter cutoff frequency.
-    double midQualityFactor = 0.7071f; ///< Mid-band pass filter quality factor.
-    double midBandPassMix = 0.0; ///< Mix amount for mid-band pass filter.
-    juce::dsp::IIR::Filter<float> midBandPassFilter; ///< Mid-band pass filter object.
-    
-    float volumeLFOPhase = 0.0f; ///< Phase of volume LFO.
-    float volumeLFOrate = 10.0f; ///< Rate of volume LFO.
-    float volumeLFOdepth = 0.0f; ///< Depth of volume LFO.
-    
-    double djSampleRate; ///< Sample rate for processing.
-    
-    juce::dsp::Reverb reverb; ///< Reverb effect processor.
-    juce::dsp::Reverb::Parameters reverbParams; ///< Parameters for reverb effect.
-    
-    double reverbWetDryMix = 0.0f; ///< Reverb wet/dry mix amount.
-    
-    juce::dsp::Chorus<float> flanger; ///< Flanger effect processor.
-    
-    double flangerWetDryMix = 0.0f; ///< Flanger wet/dry mix amount.
-    
-    // ===========================================================
-    public:
-    /**
-     * @brief Constructor for DJAudioPlayer.
-     */
-    DJAudioPlayer();
-    
-    /**
-     * @brief Destructor for DJAudioPlayer.
-     */
-    ~DJAudioPlayer();
-    
-    juce::AudioTransportSource transportSource; ///< Handles audio transport functions.
-    juce::ResamplingAudioSource resampleSource{&transportSource, false, 2}; ///< Resampler for handling pitch changes.
-    
-    /**
-     * @brief Prepares the player to play audio.
-     * @param samplesPerBlockExpected Expected number of samples per block.
-     * @param sampleRate The sample rate of the audio stream.
-     */
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-    
-    /**
-     * @brief Retrieves the next block of audio data.
-     * @param bufferToFill The buffer to be filled with audio data.
-     */
-    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
-    
-    /**
-     * @brief Releases audio resources when playback stops.
-     */
-    void releaseResources() override;
-    
-    /**
-     * @brief Loads an audio file from a URL.
-     * @param audioURL The URL of the audio file.
-     */
-    void loadURL(juce::URL audioURL);
-    
-    /**
-     * @brief Sets the gain (volume) of the audio.
-     * @param gain The gain value (0.0 - 1.0).
-     */
-    void setGain(double gain);
-    
-    /**
-     * @brief Sets the playback speed.
-     * @param ratio The speed ratio (1.0 is normal speed).
-     */
-    void setSpeed(double ratio);
-    
-    /**
-     * @brief Sets the playback position in seconds.
-     * @param posInSecs The position in seconds.
-     */
-    void setPosition(double posInSecs);
-    
-    /**
-     * @brief Sets the relative playback position.
-     * @param pos The relative position (0.0 - 1.0).
-     */
-    void setPositionRelative(double pos);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     *
-     * @brief Sets the high-pass filter cutoff frequency.
-     * @param amount The cutoff frequency value.
-     */
-    void setHighPassFilterAmount(double amount);
-    
-    /**
-     * @brief Sets the low-pass filter cutoff frequency.
-     * @param amount The cutoff frequency value.
-     */
-    void setLowPassFilterAmount(double amount);
-    
-    /**
-     * @brief Sets the mid-band pass filter parameters.
-     * @param amount The filter amount.
-     */
-    void setMidBandPassFilterAmount(double amount);
-    
-    /**
-     * @brief Sets the reverb effect amount.
-     * @param amount The reverb mix amount.
-     */
-    void setReverbAmount(double amount);
-    
-    /**
-     * @brief Sets the flanger effect amount.
-     * @param amount The flanger mix amount.
-     */
-    void setFlangerAmount(double amount);
-    
-    /**
-     * @brief Sets the tremolo effect amount.
-     * @param amount The tremolo mix amount.
-     */
-    void setTremelo(double amount);
-    /// ==============================================================
-    
-    /**
-     * @brief Starts audio playback.
-     */
-    void start();
-    
-    /**
-     * @brief Stops audio playback.
-     */
-    void stop();
-    
-    /**
-     * @brief Gets the relative position of the playhead.
-     * @return The relative position (0.0 - 1.0).
-     */
-    double getPositionRelative();
-};
+/**
+ * @file DJAudioPlayer.cpp
+ * @brief Implementation of the DJAudioPlayer class for audio processing.
+ *
+ * This class handles audio playback, filtering, and effects such as reverb,
+ * flanger, and tremolo.
+ *
+ * @author Matthew
+ * @date 13 Mar 2020
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckEventQueue.h"
+#include "HotCueSource.h"
+#include "SamplePadBank.h"
+#include "AudioAnalyser.h"
+#include "TripleBuffer.h"
+
+class MixAutomation;
+
+/**
+ * @brief Snapshot of a deck's transport and output level, published by the audio thread.
+ */
+struct DeckTelemetry {
+    double position = 0.0;  /**< Playhead position in seconds. */
+    double length = 0.0;    /**< Track length in seconds, 0 when nothing is loaded. */
+    double speed = 1.0;     /**< Speed ratio set by the user, without jog movements. */
+    bool playing = false;   /**< True while the transport is playing. */
+    float peak = 0.0f;      /**< Output peak with a 300 ms fall (linear). */
+    float rms = 0.0f;       /**< Output RMS averaged over about 300 ms (linear). */
+};
+
+/**
+ * @class DJAudioPlayer
+ * @brief A class for handling audio playback with various effects and filters.
+ *
+ * DJAudioPlayer provides functionalities to play, stop, and manipulate audio
+ * including filtering, reverb, flanger, and tremolo effects.
+ */
+class DJAudioPlayer : public juce::AudioSource, private juce::AsyncUpdater, private juce::TimeSliceClient {
+    private:
+    juce::AudioFormatManager formatManager; ///< Manages available audio formats.
+    std::unique_ptr<juce::AudioFormatReaderSource> readerSource; ///< Pointer to the audio source.
+    juce::TimeSliceThread readAheadThread {"Deck read-ahead"}; ///< Refills the transport's buffer in the background.
+    juce::URL loadedURL; ///< URL of the loaded track, used to decode hot cue audio.
+    DeckEventQueue eventQueue; ///< Transport events waiting for the audio thread.
+    SamplePadBank padBank; ///< Sample pads mixed into the deck output.
+    AudioAnalyser analyser; ///< Metering tap on the deck output.
+    
+    /**
+     * @brief A track opened by the loader thread, waiting to be installed.
+     */
+    struct OpenedTrack {
+        std::unique_ptr<juce::AudioFormatReader> reader; ///< The reader, or nullptr if the file could not be opened.
+        juce::URL url; ///< The track's URL.
+        juce::uint32 generation = 0; ///< Load it belongs to; stale loads are dropped.
+    };
+    
+    juce::CriticalSection loadLock; ///< Guards loadGeneration and openedTracks.
+    juce::uint32 loadGeneration = 0; ///< Incremented on every load, so only the newest is installed.
+    std::vector<OpenedTrack> openedTracks; ///< Tracks opened in the background, waiting for the message thread.
+    std::function<void(bool)> onAsyncLoaded; ///< Called when the newest background load is installed or superseded.
+    juce::ThreadPool loaderPool {1}; ///< Opens tracks in the background, one at a time per deck.
+    
+    double speedRatio = 1.0; ///< Speed set by the user; audio thread only.
+    double appliedRatio = 1.0; ///< Ratio last given to the resampler, including jog; audio thread only.
+    double pendingJog = 0.0; ///< Jog movement in seconds still to be played out; audio thread only.
+    std::atomic<double> cuePoint {0.0}; ///< Position the cue control returns to, in seconds.
+    std::atomic<float> trackTempo {0.0f}; ///< Tempo of the loaded track in BPM, 0 when unknown.
+    
+    TripleBuffer<DeckTelemetry> telemetry; ///< Hands each block's telemetry to one reader.
+    float telemetryPeak = 0.0f; ///< Peak with fall applied; audio thread only.
+    float telemetryMeanSquare = 0.0f; ///< Averaged mean square; audio thread only.
+    
+    std::atomic<MixAutomation*> automation {nullptr}; ///< Records and replays this deck's controls, or nullptr.
+    int automationDeck = 0; ///< This deck's number in the automation.
+    bool readAhead = true; ///< False to read the track inside the audio callback, for offline rendering.
+    std::atomic<double> pendingSeek {-1.0}; ///< Position the audio thread wants the transport moved to, or -1.
+    juce::CriticalSection sourceLock; ///< Held while the transport's source is swapped, so the read-ahead thread never seeks a dying source.
+    std::atomic<bool> transportHeld {false}; ///< True while the deck renders silence without moving its transport.
+    juce::AudioBuffer<float> dryBuffer; ///< Unfiltered copy of the section being processed; audio thread only.
+    
+    static constexpr double maxJogRatio = 4.0; ///< Fastest a jog can push playback; the resampler is sized for it.
+    static constexpr double minJogRatio = 0.05; ///< Slower than this a jog seeks instead of bending the speed.
+    static constexpr int seekPollMs = 5; ///< How often the read-ahead thread looks for seeks from the audio thread.
+    
+    /**
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ===========================================================
+     */
+    
+    double hpCutoff = 100.0f; ///< High-pass filter cutoff frequency.
+    double hpQualityFactor = 0.7071f; ///< High-pass filter quality factor.
+    juce::dsp::IIR::Filter<float> highpassFilter; ///< High-pass filter object.
+    
+    double lpCutoff = 20000.0f; ///< Low-pass filter cutoff frequency.
+    double lpQualityFactor = 0.7071f; ///< Low-pass filter quality factor.
+    juce::dsp::IIR::Filter<float> lowpassFilter; ///< Low-pass filter object.
+    
+    double midCutoff = 500.0f; ///< Mid-band pass filter cutoff frequency.
+    double midQualityFactor = 0.7071f; ///< Mid-band pass filter quality factor.
+    double midBandPassMix = 0.0; ///< Mix amount for mid-band pass filter.
+    juce::dsp::IIR::Filter<float> midBandPassFilter; ///< Mid-band pass filter object.
+    
+    float volumeLFOPhase = 0.0f; ///< Phase of volume LFO.
+    float volumeLFOrate = 10.0f; ///< Rate of volume LFO.
+    float volumeLFOdepth = 0.0f; ///< Depth of volume LFO.
+    
+    double djSampleRate = 0.0; ///< Sample rate for processing, 0 until prepared.
+    
+    juce::dsp::Reverb reverb; ///< Reverb effect processor.
+    juce::dsp::Reverb::Parameters reverbParams; ///< Parameters for reverb effect.
+    
+    double reverbWetDryMix = 0.0f; ///< Reverb wet/dry mix amount.
+    
+    juce::dsp::Chorus<float> flanger; ///< Flanger effect processor.
+    
+    double flangerWetDryMix = 0.0f; ///< Flanger wet/dry mix amount.
+    
+    // ===========================================================
+    public:
+    /**
+     * @brief Constructor for DJAudioPlayer.
+     */
+    DJAudioPlayer();
+    
+    /**
+     * @brief Destructor for DJAudioPlayer.
+     */
+    ~DJAudioPlayer();
+    
+    juce::AudioTransportSource transportSource; ///< Handles audio transport functions.
+    HotCueSource hotCueSource{&transportSource}; ///< Plays hot cues from resident buffers.
+    juce::ResamplingAudioSource resampleSource{&hotCueSource, false, 2}; ///< Resampler for handling pitch changes.
+    
+    /**
+     * @brief Prepares the player to play audio.
+     * @param samplesPerBlockExpected Expected number of samples per block.
+     * @param sampleRate The sample rate of the audio stream.
+     */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    
+    /**
+     * @brief Retrieves the next block of audio data.
+     * @param bufferToFill The buffer to be filled with audio data.
+     */
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+    
+    /**
+     * @brief Releases audio resources when playback stops.
+     */
+    void releaseResources() override;
+    
+    /**
+     * @brief Loads an audio file from a URL.
+     * @param audioURL The URL of the audio file.
+     * @return True if the file was loaded.
+     */
+    bool loadURL(juce::URL audioURL);
+    
+    /**
+     * @brief Opens an audio file on a background thread and installs it on the message thread.
+     *
+     * A later load, background or not, supersedes this one; its callback is
+     * then called with false straight away.
+     *
+     * @param audioURL The URL of the audio file.
+     * @param onLoaded Called on the message thread with true if the file was loaded, or false if it failed or was superseded.
+     */
+    void loadURLAsync(juce::URL audioURL, std::function<void(bool loaded)> onLoaded);
+    
+    /**
+     * @brief Sets the gain (volume) of the audio.
+     *
+     * This and the other level, speed and effect setters queue an event for
+     * the audio thread, so they can be called from any thread, including the
+     * MIDI thread.
+     *
+     * @param gain The gain value (0.0 - 1.0).
+     */
+    void setGain(double gain);
+    
+    /**
+     * @brief Sets the playback speed.
+     * @param ratio The speed ratio (1.0 is normal speed).
+     */
+    void setSpeed(double ratio);
+    
+    /**
+     * @brief Sets the playback position in seconds.
+     * @param posInSecs The position in seconds.
+     */
+    void setPosition(double posInSecs);
+    
+    /**
+     * @brief Sets the relative playback position.
+     * @param pos The relative position (0.0 - 1.0).
+     */
+    void setPositionRelative(double pos);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     *
+     * @brief Sets the high-pass filter cutoff frequency.
+     * @param amount The cutoff frequency value.
+     */
+    void setHighPassFilterAmount(double amount);
+    
+    /**
+     * @brief Sets the low-pass filter cutoff frequency.
+     * @param amount The cutoff frequency value.
+     */
+    void setLowPassFilterAmount(double amount);
+    
+    /**
+     * @brief Sets the mid-band pass filter parameters.
+     * @param amount The filter amount.
+     */
+    void setMidBandPassFilterAmount(double amount);
+    
+    /**
+     * @brief Sets the reverb effect amount.
+     * @param amount The reverb mix amount.
+     */
+    void setReverbAmount(double amount);
+    
+    /**
+     * @brief Sets the flanger effect amount.
+     * @param amount The flanger mix amount.
+     */
+    void setFlangerAmount(double amount);
+    
+    /**
+     * @brief Sets the tremolo effect amount.
+     * @param amount The tremolo mix amount.
+     */
+    void setTremelo(double amount);
+    /// ==============================================================
+    
+    /**
+     * @brief Starts audio playback.
+     */
+    void start();
+    
+    /**
+     * @brief Stops audio playback.
+     *
+     * Waits for the audio thread to fade out, so never call it from there.
+     */
+    void stop();
+    
+    /**
+     * @brief Checks whether the transport is playing.
+     * @return True if playing.
+     */
+    bool isPlaying() const;
+    
+    /**
+     * @brief Moves the playhead by a jog wheel movement.
+     *
+     * While playing the movement is played out over the next audio block by
+     * bending the speed, so scratching and nudging stay smooth; when stopped,
+     * or when moving back faster than the track plays, the playhead seeks.
+     *
+     * @param seconds The movement in seconds, negative to move back.
+     */
+    void jog(double seconds);
+    
+    /**
+     * @brief Classic cue button: sets the cue point when stopped, returns to it when playing.
+     */
+    void cue();
+    
+    /**
+     * @brief Gets the relative position of the playhead.
+     * @return The relative position (0.0 - 1.0), or 0.0 if no track is loaded.
+     */
+    double getPositionRelative();
+    
+    /**
+     * @brief Gets the position of the playhead in seconds.
+     * @return The position in seconds.
+     */
+    double getPosition();
+    
+    /**
+     * @brief Stores a hot cue at the given position of the loaded track.
+     * @param index The cue slot (0 - 7).
+     * @param posInSecs The cue position in seconds.
+     * @return True if the cue was stored.
+     */
+    bool setHotCue(int index, double posInSecs);
+    
+    /**
+     * @brief Stores a whole set of hot cues, e.g. when restoring saved state.
+     * @param positions Cue positions in seconds, negative for empty slots.
+     */
+    void setHotCues(const std::vector<double>& positions);
+    
+    /**
+     * @brief Removes a hot cue.
+     * @param index The cue slot (0 - 7).
+     */
+    void clearHotCue(int index);
+    
+    /**
+     * @brief Jumps to a hot cue and starts playback from it.
+     * @param index The cue slot (0 - 7).
+     * @return True if the slot held a cue.
+     */
+    bool triggerHotCue(int index);
+    
+    /**
+     * @brief Checks whether a hot cue slot is in use.
+     * @param index The cue slot (0 - 7).
+     * @return True if the slot holds a cue.
+     */
+    bool hasHotCue(int index);
+    
+    /**
+     * @brief Gets the position of a hot cue.
+     * @param index The cue slot (0 - 7).
+     * @return The position in seconds, or -1 if the slot is empty.
+     */
+    double getHotCuePosition(int index);
+    
+    /**
+     * @brief Loads a whole audio file as a one-shot on a sample pad.
+     * @param pad The pad to load (0 - 7).
+     * @param file The audio file to load.
+     * @return True if the pad was loaded.
+     */
+    bool loadPadSample(int pad, juce::File file);
+    
+    /**
+     * @brief Fills every pad with consecutive slices of the loaded track.
+     * @param posInSecs Start of the first slice in seconds.
+     */
+    void sliceTrackToPads(double posInSecs);
+    
+    /**
+     * @brief Empties a sample pad.
+     * @param pad The pad to clear (0 - 7).
+     */
+    void clearPad(int pad);
+    
+    /**
+     * @brief Plays a sample pad from the start of the next audio block.
+     * @param pad The pad to play (0 - 7).
+     * @param velocity Gain of the voice (0.0 - 1.0).
+     */
+    void triggerPad(int pad, float velocity = 1.0f);
+    
+    /**
+     * @brief Checks whether a sample pad holds audio.
+     * @param pad The pad to check (0 - 7).
+     * @return True if the pad is loaded.
+     */
+    bool isPadLoaded(int pad);
+    
+    /**
+     * @brief Gets how much of the deck's sample pad pool holds audio.
+     * @return The used size in bytes.
+     */
+    size_t getPadMemoryUsed() const;
+    
+    /**
+     * @brief Gets the size of the deck's preallocated sample pad pool.
+     * @return The pool size in bytes.
+     */
+    size_t getPadMemorySize() const;
+    
+    /**
+     * @brief Gets the metering tap on the deck's output.
+     * @return Reference to the deck's analyser.
+     */
+    AudioAnalyser& getAnalyser();
+    
+    /**
+     * @brief Copies the newest telemetry published by the audio thread.
+     *
+     * Wait-free, but only one thread may read the telemetry.
+     *
+     * @param destination Receives the telemetry.
+     * @return True if new telemetry was copied.
+     */
+    bool getLatestTelemetry(DeckTelemetry& destination);
+    
+    /**
+     * @brief Sets the tempo of the loaded track, for telemetry.
+     * @param bpm The tempo in BPM, 0 when unknown.
+     */
+    void setTrackTempo(float bpm);
+    
+    /**
+     * @brief Gets the tempo of the loaded track. Safe from any thread.
+     * @return The tempo in BPM at normal speed, 0 when unknown.
+     */
+    float getTrackTempo() const;
+    
+    /**
+     * @brief Gets the URL of the loaded track.
+     * @return The URL, empty if nothing has been loaded.
+     */
+    juce::URL getLoadedURL() const;
+    
+    /**
+     * @brief Reads the track ahead on a background thread, or inside the audio callback.
+     *
+     * Offline renders turn the read-ahead off so their output never depends
+     * on thread timing. Takes effect from the next load.
+     *
+     * @param shouldReadAhead False to read inside the audio callback.
+     */
+    void setReadAhead(bool shouldReadAhead);
+    
+    /**
+     * @brief Hooks the deck into mix automation. Call while the audio device is stopped.
+     * @param automationToUse The automation, or nullptr to unhook.
+     * @param deck This deck's number in the automation (0 or 1).
+     */
+    void setAutomation(MixAutomation* automationToUse, int deck);
+    
+    /**
+     * @brief Describes every automated control's current setting as an event. Audio thread only.
+     * @return One event per control, which applied in order restore the settings.
+     */
+    std::array<DeckEvent, 8> getControlState() const;
+    
+    /**
+     * @brief Clears the effects' state and settles the gain, so replay starts the same every time. Audio thread only.
+     * @param gain The gain to start from, without a ramp.
+     */
+    void resetProcessing(float gain);
+    
+    /**
+     * @brief Holds the deck silent and parked, or releases it. Safe from any thread.
+     *
+     * A held deck still applies its events but renders silence without
+     * pulling from its transport, so it can be started on the message thread
+     * and released by the audio thread on an exact block, without the audio
+     * thread taking the transport's lock.
+     *
+     * @param shouldHold True to hold, false to release.
+     */
+    void holdTransport(bool shouldHold);
+    
+    /**
+     * @brief Checks whether the deck is held by holdTransport.
+     * @return True while held.
+     */
+    bool isTransportHeld() const;
+    
+    private:
+    /**
+     * @brief Makes a reader the deck's source.
+     * @param reader The reader to take ownership of, or nullptr.
+     * @param audioURL The track's URL.
+     * @return True if a reader was installed.
+     */
+    bool installReader(juce::AudioFormatReader* reader, const juce::URL& audioURL);
+    
+    /**
+     * @brief Installs the newest track opened in the background.
+     */
+    void handleAsyncUpdate() override;
+    
+    /**
+     * @brief Applies one queued event on the audio thread.
+     * @param event The event.
+     */
+    void applyEvent(const DeckEvent& event);
+    
+    /**
+     * @brief Moves the transport on behalf of the audio thread. Audio thread only.
+     * @param posInSecs The position in seconds.
+     */
+    void seekFromAudioThread(double posInSecs);
+    
+    /**
+     * @brief Read-ahead thread: applies the seek the audio thread last asked for.
+     * @return Milliseconds until the next call.
+     */
+    int useTimeSlice() override;
+    
+    /**
+     * @brief Gives the resampler the user's speed plus any pending jog movement.
+     * @param numSamples Length of the block about to be rendered.
+     */
+    void applyJog(int numSamples);
+    
+    /**
+     * @brief Renders one section of a block through the resampler, pads and effects.
+     * @param section The part of the block to render.
+     */
+    void renderSection(const juce::AudioSourceChannelInfo& section);
+    
+    /**
+     * @brief Updates the output level and publishes the block's telemetry.
+     * @param bufferToFill The finished block.
+     */
+    void publishTelemetry(const juce::AudioSourceChannelInfo& bufferToFill);
+};
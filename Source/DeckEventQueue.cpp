@@ -0,0 +1,49 @@
+/**
+ * =================================================================
+ * @file DeckEventQueue.cpp
+ * @brief Implementation of the DeckEventQueue class.
+ *
+ * Created: 18 Oct 2026 9:12:04am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "DeckEventQueue.h"
+
+/**
+ * @brief Constructs the queue and preallocates its storage.
+ * @param capacity Maximum number of events that can be waiting at once.
+ */
+DeckEventQueue::DeckEventQueue(int capacity)
+    : fifo(capacity), events((size_t) capacity)
+{
+}
+
+/**
+ * @brief Adds an event to the queue.
+ *
+ * If the audio thread has fallen behind and the queue is full the event is
+ * dropped and false is returned. The FIFO only allows one writer at a time,
+ * so concurrent producers are serialised on a spin lock.
+ *
+ * @param event The event to schedule.
+ * @return True if the event was queued.
+ */
+bool DeckEventQueue::push(const DeckEvent& event)
+{
+    const juce::SpinLock::ScopedLockType lock (producerLock);
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0) {
+        events[(size_t) scope.startIndex1] = event;
+        return true;
+    }
+
+    if (scope.blockSize2 > 0) {
+        events[(size_t) scope.startIndex2] = event;
+        return true;
+    }
+
+    DBG("DeckEventQueue::push queue is full, event dropped");
+    return false;
+}
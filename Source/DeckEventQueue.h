@@ -0,0 +1,98 @@
+/**
+ * =================================================================
+ * @file DeckEventQueue.h
+ * @brief Declaration of the DeckEventQueue class and DeckEvent structure.
+ *
+ * This file declares a small queue used to hand transport and control events
+ * (such as hot cue triggers or jog movements) from the message and MIDI
+ * threads to the audio thread, which never waits on it.
+ *
+ * Created: 18 Oct 2026 9:12:04am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @brief Structure describing a single transport event for a deck.
+ *
+ * Events are plain values so they can be copied through the FIFO without
+ * any allocation on the audio thread.
+ */
+struct DeckEvent {
+    /**
+     * @brief The kind of event being scheduled.
+     */
+    enum class Type {
+        triggerHotCue,  /**< Start playback from the resident buffer of a hot cue. */
+        cancelHotCue,   /**< Abandon any hot cue currently being played. */
+        triggerPad,     /**< Start a voice for a sample pad, value is the velocity. */
+        setGain,        /**< Set the deck gain, value is 0 - 1. */
+        setSpeed,       /**< Set the playback speed, value is the ratio. */
+        jog,            /**< Move the playhead, value is in seconds and may be negative. */
+        setHighPass,    /**< Set the high-pass amount, value is 0 - 1. */
+        setMidBandPass, /**< Set the mid band-pass mix, value is 0 - 1. */
+        setLowPass,     /**< Set the low-pass amount, value is 0 - 1. */
+        setReverb,      /**< Set the reverb mix, value is 0 - 1. */
+        setFlanger,     /**< Set the flanger mix, value is 0 - 1. */
+        setTremolo      /**< Set the tremolo depth, value is 0 - 1. */
+    };
+
+    Type type;          /**< The kind of event. */
+    int index = 0;      /**< Slot the event refers to (e.g. the hot cue number). */
+    float value = 0.0f; /**< Optional value carried with the event. */
+};
+
+/**
+ * @class DeckEventQueue
+ * @brief Multi-producer, single-consumer FIFO of DeckEvent objects.
+ *
+ * The message thread and the MIDI thread push events and the audio thread
+ * drains them at the start of each block, so every event takes effect in the
+ * next audio block. Producers take turns on a spin lock held only while an
+ * event is copied in; the audio thread never takes it.
+ */
+class DeckEventQueue
+{
+public:
+    /**
+     * @brief Constructs a queue that can hold a fixed number of pending events.
+     * @param capacity Maximum number of events that can be waiting at once.
+     */
+    explicit DeckEventQueue(int capacity = 256);
+
+    /**
+     * @brief Adds an event to the queue. Safe to call from any thread.
+     * @param event The event to schedule.
+     * @return True if the event was queued, false if the queue was full.
+     */
+    bool push(const DeckEvent& event);
+
+    /**
+     * @brief Removes every pending event, passing each one to a callback.
+     *
+     * Intended to be called from the audio thread. Never allocates or locks.
+     *
+     * @param callback Callable invoked as callback(const DeckEvent&).
+     */
+    template <typename Callback>
+    void drain(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            callback(events[(size_t) (scope.startIndex1 + i)]);
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            callback(events[(size_t) (scope.startIndex2 + i)]);
+    }
+
+private:
+    juce::AbstractFifo fifo;          ///< Index bookkeeping for the ring buffer.
+    std::vector<DeckEvent> events;    ///< Preallocated storage for queued events.
+    juce::SpinLock producerLock;      ///< Serialises pushes from different threads.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckEventQueue)
+};
@@ -1,452 +1,749 @@
-/*
- ============================================================================
- 
- DeckGUI.cpp
- Created: 29 Jan 2025 7:21:23am
- Author:  Jacques Thurling
- 
- ==============================================================================
- */
-
-#include <JuceHeader.h>
-#include "DeckGUI.h"
-
-//==============================================================================
-/**
- * @brief Constructor for DeckGUI.
- * @param _player Pointer to the DJAudioPlayer handling playback.
- * @param formatManager Reference to an AudioFormatManager for handling formats.
- * @param cache Reference to an AudioThumbnailCache for caching waveform thumbnails.
- * @param _deckname Name of the deck.
- * @param _state Reference to the DeckState for storing deck information.
- */
-DeckGUI::DeckGUI(DJAudioPlayer* _player, juce::AudioFormatManager& formatManager, juce::AudioThumbnailCache& cache, std::string _deckname, DeckState& _state)
-: djAudioPlayer(_player), waveformDisplay(formatManager, cache), deck_name(_deckname), deckDisplay(formatManager, cache), state(_state)
-{
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    auto customLookAndFeel = std::make_unique<CustomLookAndFeel>(0.6f);
-
-    juce::File executableFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-    juce::File projectDir = executableFile.getParentDirectory();
-    juce::String correctPath;
-    while (projectDir.getFileName() != "New_DJ" && projectDir.getParentDirectory() != projectDir) {
-        projectDir = projectDir.getParentDirectory();
-    }
-    
-    if (projectDir.getFileName() == "New_DJ") {
-        correctPath = projectDir.getFullPathName();
-    } else {
-        // Handle the case where the New_DJ folder wasn't found
-        DBG("New_DJ folder not found in the directory structure");
-    }
-    
-    std::string imagePath = correctPath.toStdString() + "/Assets/deck_spinner.png";
-    juce::File imageFile(imagePath);
-    deckImage = juce::ImageCache::getFromFile(imageFile);
-    
-    imagePath = correctPath.toStdString() + "/Assets/deck_face.png";
-    juce::File deckFaceImage(imagePath);
-    deck_face_image = juce::ImageCache::getFromFile(deckFaceImage);
-    
-    imagePath = correctPath.toStdString() + "/Assets/background_info.png";
-    juce::File backgroundInfoImage(imagePath);
-    backgroundImage = juce::ImageCache::getFromFile(backgroundInfoImage);
-    
-    imagePath = correctPath.toStdString() + "/Assets/stop.png";
-    juce::File stopImage(imagePath);
-    stop_image = juce::ImageCache::getFromFile(stopImage);
-    
-    imagePath = correctPath.toStdString() + "/Assets/play.png";
-    juce::File playImage(imagePath);
-    play_image = juce::ImageCache::getFromFile(playImage);
-    
-    playImageButton = std::make_unique<juce::ImageButton>("playImageButton");
-    
-    // Set images for the button states: normal, over, and down.
-    playImageButton->setImages(true, true, true,
-                               play_image, 1.0f, juce::Colours::transparentBlack,  // normal state image
-                               play_image, 1.0f, juce::Colours::transparentBlack,  // over state image
-                               play_image, 1.0f, juce::Colours::transparentBlack); // down state image
-    
-    // Make the button visible in your component
-    addAndMakeVisible(playImageButton.get());
-    
-    stopImageButton = std::make_unique<juce::ImageButton>("stopImageButton");
-    
-    // Set images for the button states: normal, over, and down.
-    stopImageButton->setImages(true, true, true,
-                               stop_image, 1.0f, juce::Colours::transparentBlack,  // normal state image
-                               stop_image, 1.0f, juce::Colours::transparentBlack,  // over state image
-                               stop_image, 1.0f, juce::Colours::transparentBlack); // down state image
-    
-    // Make the button visible in your component
-    addAndMakeVisible(stopImageButton.get());
-    
-    imagePath = correctPath.toStdString() + "/Assets/" + deck_name + ".png";
-    juce::File deckImage(imagePath);
-    deck_number_image = juce::ImageCache::getFromFile(deckImage);
-    
-    speedSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
-    
-    speedSlider.setLookAndFeel(customLookAndFeel.get());
-    
-    reverb.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    flanger.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    cut.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    
-    reverb.setLookAndFeel(customLookAndFeel.get());
-    flanger.setLookAndFeel(customLookAndFeel.get());
-    cut.setLookAndFeel(customLookAndFeel.get());
-    
-    // Labels
-    reverbLabel.setText("Reverb", juce::dontSendNotification);
-    reverbLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    reverbLabel.attachToComponent(&reverb, false);
-    reverbLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    flangerLabel.setText("Flanger", juce::dontSendNotification);
-    flangerLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    flangerLabel.attachToComponent(&flanger, false);
-    flangerLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    lfoLabel.setText("LFO Modulation", juce::dontSendNotification);
-    lfoLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    lfoLabel.attachToComponent(&cut, false);
-    lfoLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    speedLabel.setText("Speed", juce::dontSendNotification);
-    speedLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    speedLabel.attachToComponent(&speedSlider, false);
-    speedLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    volumeSlider.setRange(0, 1);
-    positionSlider.setRange(0, 1);
-    speedSlider.setRange(0.1, 2);
-    
-    reverb.setRange(0, 1);
-    flanger.setRange(0, 1);
-    cut.setRange(0, 1);
-    
-    playButton.setButtonText("PLAY");
-    stopButton.setButtonText("STOP");
-    loadButton.setButtonText("LOAD");
-    
-    /// ==================================================================
-    
-    speedSlider.setValue(1.0f);
-    
-    addAndMakeVisible(loadButton);
-    addAndMakeVisible(volumeSlider);
-    addAndMakeVisible(positionSlider);
-    addAndMakeVisible(speedSlider);
-    addAndMakeVisible(waveformDisplay);
-    addAndMakeVisible(reverb);
-    addAndMakeVisible(flanger);
-    addAndMakeVisible(cut);
-    addAndMakeVisible(deckDisplay);
-    
-    loadButton.addListener(this);
-    volumeSlider.addListener(this);
-    positionSlider.addListener(this);
-    speedSlider.addListener(this);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    
-    playImageButton->addListener(this);
-    stopImageButton->addListener(this);
-    
-    reverb.addListener(this);
-    flanger.addListener(this);
-    cut.addListener(this);
-    
-    speedSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    
-    reverb.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    flanger.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    cut.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    
-    startTimer(10);
-    
-    lookAndFeels.emplace_back(std::move(customLookAndFeel));
-    /// ============================================================
-}
-
-/**
- * @brief Destructor for DeckGUI.
- */
-DeckGUI::~DeckGUI()
-{
-}
-
-/**
- * @brief Renders the deck GUI components.
- * @param g JUCE Graphics context.
- */
-void DeckGUI::paint (juce::Graphics& g)
-{
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));   // clear the background
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    if (deckImage.isValid()) {
-        auto bounds = getLocalBounds().toFloat();
-        auto imageBounds = deckImage.getBounds().toFloat();
-        auto faceBounds = deck_face_image.getBounds().toFloat();
-        
-        // Calculate individual scale factors.
-        float scaleX = bounds.getWidth() / (imageBounds.getWidth() * 2);
-        float scaleY = bounds.getHeight() / (imageBounds.getHeight() * 2);
-        
-        // Use the minimum scale factor to preserve the aspect ratio.
-        float uniformScale = std::min(scaleX, scaleY);
-        
-        // Optionally, translate the image such that it is centered.
-        auto imageCentre = imageBounds.getCentre();
-        auto boundsCentre = bounds.getCentre();
-        auto faceCentre = faceBounds.getCentre();
-        
-        // Create a transform: first translate the image so its centre is at the origin,
-        // then apply the uniform scaling and rotation,
-        // and finally translate it to the component's centre.
-        auto transform = juce::AffineTransform::translation(-imageCentre.x, -imageCentre.y)
-            .scaled(uniformScale)
-            .rotated(rotationAngle)
-            .translated(boundsCentre.x, boundsCentre.y);
-        
-        auto deck_face_transform = juce::AffineTransform::translation(-faceCentre.x, -faceCentre.y)
-            .scaled(uniformScale)
-            .translated(boundsCentre.x, boundsCentre.y);
-        
-        // Draw the transformed image.
-        g.drawImage(backgroundImage, getLocalBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
-        g.drawImage(deck_number_image, (getWidth()/8) * 6, (getHeight()/8) + 20,
-                    deck_number_image.getWidth()/3, deck_number_image.getHeight()/3,
-                    0, 0, deck_number_image.getWidth(), deck_number_image.getHeight());
-        g.drawImageTransformed(deckImage, transform);
-        g.drawImageTransformed(deck_face_image, deck_face_transform);
-        deckDisplay.setBounds(getWidth()/2 - 100, (getHeight()/8) * 4 - 50, 200, getHeight()/8);
-    }
-    
-    if (!play)
-    {
-        playImageButton->setVisible(true);
-        stopImageButton->setVisible(false);
-    }
-    else
-    {
-        playImageButton->setVisible(false);
-        stopImageButton->setVisible(true);
-    }
-    /// ====================================================
-}
-
-/**
- * @brief Resizes and positions the components within the DeckGUI.
- */
-void DeckGUI::resized()
-{
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
-    float rowH = getHeight()/8;
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    
-    // Speed slider
-    speedSlider.setBounds((getWidth()/8) * 7, rowH * 4, (getWidth()/8), rowH * 4);
-    speedLabel.setBounds(speedSlider.getX() + 15, speedSlider.getY() - 20, 200, 20);
-    
-    // Effects sliders
-    reverb.setBounds((getWidth()/8) * 2, rowH * 7 - 20, (getWidth()/8), rowH);
-    reverbLabel.setBounds(reverb.getX() + 10, reverb.getY() + 90, 200, 20);
-    
-    flanger.setBounds((getWidth()/8) * 4 - 20, rowH * 7 - 20, (getWidth()/8), rowH);
-    flangerLabel.setBounds(flanger.getX() + 18, flanger.getY() + 90, 200, 20);
-    
-    cut.setBounds((getWidth()/8) * 6 - 40, rowH * 7 - 20, (getWidth()/8), rowH);
-    lfoLabel.setBounds(cut.getX() - 10, cut.getY() + 90, 200, 20);
-    
-    waveformDisplay.setBounds(0, 0, getWidth(), rowH);
-    
-    playImageButton->setBounds(10, rowH * 7 - 50, play_image.getWidth(), play_image.getHeight());
-    stopImageButton->setBounds(10, rowH * 7 - 50, stop_image.getWidth(), stop_image.getHeight());
-    /// ======================================================
-}
-
-/**
- * @brief Handles button clicks for playback and loading.
- * @param button Pointer to the button that was clicked.
- */
-void DeckGUI::buttonClicked(juce::Button* button) {
-    if (button == playImageButton.get()) {
-        djAudioPlayer->start();
-        play = true;
-    }
-    
-    if (button == stopImageButton.get()) {
-        DBG("DeckGUI::buttonClicked: You clicked the stop button");
-        djAudioPlayer->stop();
-        play = false;
-    }
-    
-    if (button == &loadButton) {
-        auto fileChooserFlags = juce::FileBrowserComponent::canSelectFiles;
-        
-        fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser){
-            auto chosenFile = chooser.getResult();
-            djAudioPlayer->loadURL(juce::URL{chosenFile});
-            waveformDisplay.loadUrl(juce::URL{chosenFile});
-        });
-    }
-}
-
-/**
- * @brief Handles slider value changes.
- * @param slider Pointer to the slider that was changed.
- */
-void DeckGUI::sliderValueChanged(juce::Slider* slider) {
-    if (slider == &volumeSlider) {
-        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSlider.getValue());
-        djAudioPlayer->setGain(slider->getValue());
-    }
-    
-    if (slider == &positionSlider) {
-        djAudioPlayer->setPositionRelative(slider->getValue());
-    }
-    
-    if (slider == &speedSlider) {
-        djAudioPlayer->setSpeed(slider->getValue());
-    }
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    if (slider == &reverb) {
-        djAudioPlayer->setReverbAmount(slider->getValue());
-    }
-    
-    if (slider == &flanger) {
-        djAudioPlayer->setFlangerAmount(slider->getValue());
-    }
-    
-    if (slider == &cut) {
-        djAudioPlayer->setTremelo(slider->getValue());
-    }
-}
-
-/**
- * @brief Determines if the playlist accepts dragged files.
- *
- * @param files List of dragged file paths.
- * @return Always returns true.
- */
-bool DeckGUI::isInterestedInFileDrag(const juce::StringArray& files) {
-    std::cout << "DeckGUI::isInterestedInFileDrag" << std::endl;
-    return true;
-}
-
-/**
- * @brief Handles drag-and-drop file loading.
- * @param files Array of file paths.
- * @param x X coordinate of the drop location.
- * @param y Y coordinate of the drop location.
- */
-void DeckGUI::filesDropped(const juce::StringArray& files, int x, int y) {
-    for (juce::String file : files) {
-        juce::URL fileUrl = juce::URL{juce::File{file}};
-        
-        djAudioPlayer->loadURL(fileUrl);
-        waveformDisplay.loadUrl(fileUrl);
-        return;
-    }
-}
-
-void DeckGUI::mouseDown(const juce::MouseEvent& event) {
-    DBG("Mouse is down");
-    auto centre = getLocalBounds().toFloat().getCentre();
-    startAngle = std::atan2(event.position.y - centre.y, event.position.x - centre.x);
-    initialRotationAngle = rotationAngle;
-    
-    initialRelativePosition = djAudioPlayer->getPositionRelative();
-}
-
-void DeckGUI::mouseDrag(const juce::MouseEvent& event) {
-    auto centre = getLocalBounds().toFloat().getCentre();
-    float currentAngle = std::atan2(event.position.y - centre.y, event.position.x - centre.x);
-    float deltaAngle = currentAngle - startAngle;
-    rotationAngle = initialRotationAngle + deltaAngle;
-    
-    float deltaRelative = deltaAngle / (2 * juce::MathConstants<float>::pi);
-    float newRelative = juce::jlimit(0.0f, 1.0f, initialRelativePosition + deltaRelative);
-    
-    djAudioPlayer->setPositionRelative(newRelative);
-    
-    repaint();
-}
-
-/**
- * @brief Timer callback function that updates the deck display.
- */
-void DeckGUI::timerCallback()
-{
-    //std::cout << "DeckGUI::timerCallback" << std::endl;
-    waveformDisplay.setPositionRelative(djAudioPlayer->getPositionRelative());
-    deckDisplay.setPositionRelative(djAudioPlayer->getPositionRelative());
-    
-    if (play) {
-        rotationAngle += 0.02f;
-        
-        if (rotationAngle >= juce::MathConstants<float>::twoPi) {
-            rotationAngle -= juce::MathConstants<float>::twoPi;
-        }
-        
-        repaint();
-    }
-    
-    setDeckState(djAudioPlayer->getPositionRelative());
-}
-
-void DeckGUI::loadUrl(juce::URL fileURL) {
-    djAudioPlayer->loadURL(fileURL);
-    waveformDisplay.loadUrl(fileURL);
-    deckDisplay.loadUrl(fileURL);
-    
-    setDeckState(fileURL.getFileName().toStdString(), djAudioPlayer->getPositionRelative());
-}
-/**
- * ==============================================================
- * Author: Jacques Thurling
- * 13 Mar 2020
- * ==============================================================
- */
-
-void DeckGUI::setDeckState(std::string fileName, double newPosition) {
-    state.file_name = fileName;
-    state.position = newPosition;
-}
-
-void DeckGUI::setDeckState(double newPosition) {
-    state.position = newPosition;
-}
-
-/// ==============================================================
+/*
+ ============================================================================
+ 
+ DeckGUI.cpp
+ Created: 29 Jan 2025 7:21:23am
+ Author:  Jacques Thurling
+ 
+ ==============================================================================
+ */
+
+#include <JuceHeader.h>
+#include "DeckGUI.h"
+#include "AssetCache.h"
+
+//==============================================================================
+/**
+ * @brief Constructor for DeckGUI.
+ * @param _player Pointer to the DJAudioPlayer handling playback.
+ * @param cache Reference to the WaveformCache shared by every waveform view.
+ * @param _deckname Name of the deck.
+ * @param _state Reference to the DeckState for storing deck information.
+ */
+DeckGUI::DeckGUI(DJAudioPlayer* _player, WaveformCache& cache, std::string _deckname, DeckState& _state)
+: djAudioPlayer(_player), waveformDisplay(cache), deck_name(_deckname), deckDisplay(cache), state(_state)
+{
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    auto customLookAndFeel = std::make_unique<CustomLookAndFeel>(0.6f);
+
+    deckImage = AssetCache::getImage("deck_spinner.png");
+    deck_face_image = AssetCache::getImage("deck_face.png");
+    backgroundImage = AssetCache::getImage("background_info.png");
+    stop_image = AssetCache::getImage("stop.png");
+    play_image = AssetCache::getImage("play.png");
+    
+    playImageButton = std::make_unique<juce::ImageButton>("playImageButton");
+    
+    // Set images for the button states: normal, over, and down.
+    playImageButton->setImages(true, true, true,
+                               play_image, 1.0f, juce::Colours::transparentBlack,  // normal state image
+                               play_image, 1.0f, juce::Colours::transparentBlack,  // over state image
+                               play_image, 1.0f, juce::Colours::transparentBlack); // down state image
+    
+    // Make the button visible in your component
+    addAndMakeVisible(playImageButton.get());
+    
+    stopImageButton = std::make_unique<juce::ImageButton>("stopImageButton");
+    
+    // Set images for the button states: normal, over, and down.
+    stopImageButton->setImages(true, true, true,
+                               stop_image, 1.0f, juce::Colours::transparentBlack,  // normal state image
+                               stop_image, 1.0f, juce::Colours::transparentBlack,  // over state image
+                               stop_image, 1.0f, juce::Colours::transparentBlack); // down state image
+    
+    // Make the button visible in your component
+    addAndMakeVisible(stopImageButton.get());
+    
+    deck_number_image = AssetCache::getImage(deck_name + ".png");
+    
+    speedSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
+    
+    speedSlider.setLookAndFeel(customLookAndFeel.get());
+    
+    reverb.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    flanger.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    cut.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    
+    reverb.setLookAndFeel(customLookAndFeel.get());
+    flanger.setLookAndFeel(customLookAndFeel.get());
+    cut.setLookAndFeel(customLookAndFeel.get());
+    
+    // Labels
+    reverbLabel.setText("Reverb", juce::dontSendNotification);
+    reverbLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    reverbLabel.attachToComponent(&reverb, false);
+    reverbLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    flangerLabel.setText("Flanger", juce::dontSendNotification);
+    flangerLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    flangerLabel.attachToComponent(&flanger, false);
+    flangerLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    lfoLabel.setText("LFO Modulation", juce::dontSendNotification);
+    lfoLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    lfoLabel.attachToComponent(&cut, false);
+    lfoLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    speedLabel.setText("Speed", juce::dontSendNotification);
+    speedLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    speedLabel.attachToComponent(&speedSlider, false);
+    speedLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    volumeSlider.setRange(0, 1);
+    positionSlider.setRange(0, 1);
+    speedSlider.setRange(0.1, 2);
+    
+    reverb.setRange(0, 1);
+    flanger.setRange(0, 1);
+    cut.setRange(0, 1);
+    
+    playButton.setButtonText("PLAY");
+    stopButton.setButtonText("STOP");
+    loadButton.setButtonText("LOAD");
+    
+    // Hot cues: click to set or jump, shift-click to clear
+    for (int i = 0; i < HotCueSource::numCues; ++i) {
+        auto* hotCueButton = hotCueButtons.add(new juce::TextButton(juce::String(i + 1)));
+        hotCueButton->setTooltip("Click to set or jump to hot cue " + juce::String(i + 1) + ", shift-click to clear");
+        hotCueButton->addListener(this);
+        addAndMakeVisible(hotCueButton);
+    }
+    updateHotCueButtons();
+    
+    // Sample pads: click to play (or load when empty), shift-click to clear
+    for (int i = 0; i < SamplePadBank::numPads; ++i) {
+        auto* padButton = padButtons.add(new juce::TextButton("PAD " + juce::String(i + 1)));
+        padButton->setTooltip("Click to play pad " + juce::String(i + 1) + ", shift-click to clear");
+        padButton->addListener(this);
+        addAndMakeVisible(padButton);
+    }
+    updatePadButtons();
+    
+    /// ==================================================================
+    
+    speedSlider.setValue(1.0f);
+    
+    addAndMakeVisible(loadButton);
+    addAndMakeVisible(volumeSlider);
+    addAndMakeVisible(positionSlider);
+    addAndMakeVisible(speedSlider);
+    addAndMakeVisible(waveformDisplay);
+    addAndMakeVisible(reverb);
+    addAndMakeVisible(flanger);
+    addAndMakeVisible(cut);
+    addAndMakeVisible(deckDisplay);
+    
+    loadButton.addListener(this);
+    volumeSlider.addListener(this);
+    positionSlider.addListener(this);
+    speedSlider.addListener(this);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    
+    playImageButton->addListener(this);
+    stopImageButton->addListener(this);
+    
+    reverb.addListener(this);
+    flanger.addListener(this);
+    cut.addListener(this);
+    
+    speedSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    
+    reverb.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    flanger.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    cut.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    
+    lookAndFeels.emplace_back(std::move(customLookAndFeel));
+    /// ============================================================
+}
+
+/**
+ * @brief Destructor for DeckGUI.
+ */
+DeckGUI::~DeckGUI()
+{
+}
+
+/**
+ * @brief Renders the deck GUI components.
+ * @param g JUCE Graphics context.
+ */
+void DeckGUI::paint (juce::Graphics& g)
+{
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    // Everything is drawn from cached layers; only a size or display
+    // scale change re-renders them.
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    if (scale != layerScale || backgroundLayer.isNull())
+        rebuildLayers(scale);
+    
+    g.drawImage(backgroundLayer, getLocalBounds().toFloat());
+    
+    if (deckImage.isValid() && ! platterBounds.isEmpty()) {
+        shownPlatterStep = getPlatterStep();
+        const float angle = juce::MathConstants<float>::twoPi * shownPlatterStep / numPlatterSteps;
+        const auto centre = platterBounds.getCentre().toFloat();
+        
+        // Rotating the display-sized layer is a cheap bilinear draw; the costly downscale happened once.
+        g.drawImageTransformed(platterLayer,
+                               juce::AffineTransform::translation(-platterLayer.getWidth() * 0.5f, -platterLayer.getHeight() * 0.5f)
+                                   .scaled(1.0f / layerScale)
+                                   .rotated(angle)
+                                   .translated(centre.x, centre.y));
+        g.drawImageTransformed(faceLayer,
+                               juce::AffineTransform::translation(-faceLayer.getWidth() * 0.5f, -faceLayer.getHeight() * 0.5f)
+                                   .scaled(1.0f / layerScale)
+                                   .translated(centre.x, centre.y));
+    }
+    
+    if (!play)
+    {
+        playImageButton->setVisible(true);
+        stopImageButton->setVisible(false);
+    }
+    else
+    {
+        playImageButton->setVisible(false);
+        stopImageButton->setVisible(true);
+    }
+    /// ====================================================
+}
+
+/**
+ * @brief Resizes and positions the components within the DeckGUI.
+ */
+void DeckGUI::resized()
+{
+    // This method is where you should set the bounds of any child
+    // components that your component contains..
+    float rowH = getHeight()/8;
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    
+    // Speed slider
+    speedSlider.setBounds((getWidth()/8) * 7, rowH * 4, (getWidth()/8), rowH * 4);
+    speedLabel.setBounds(speedSlider.getX() + 15, speedSlider.getY() - 20, 200, 20);
+    
+    // Effects sliders
+    reverb.setBounds((getWidth()/8) * 2, rowH * 7 - 20, (getWidth()/8), rowH);
+    reverbLabel.setBounds(reverb.getX() + 10, reverb.getY() + 90, 200, 20);
+    
+    flanger.setBounds((getWidth()/8) * 4 - 20, rowH * 7 - 20, (getWidth()/8), rowH);
+    flangerLabel.setBounds(flanger.getX() + 18, flanger.getY() + 90, 200, 20);
+    
+    cut.setBounds((getWidth()/8) * 6 - 40, rowH * 7 - 20, (getWidth()/8), rowH);
+    lfoLabel.setBounds(cut.getX() - 10, cut.getY() + 90, 200, 20);
+    
+    waveformDisplay.setBounds(0, 0, getWidth(), rowH);
+    deckDisplay.setBounds(getWidth()/2 - 100, rowH * 4 - 50, 200, rowH);
+    
+    playImageButton->setBounds(10, rowH * 7 - 50, play_image.getWidth(), play_image.getHeight());
+    stopImageButton->setBounds(10, rowH * 7 - 50, stop_image.getWidth(), stop_image.getHeight());
+    
+    // Hot cue buttons in a row between the platter and the effects
+    float cueWidth = ((getWidth()/8) * 7 - 20) / (float) HotCueSource::numCues;
+    for (int i = 0; i < hotCueButtons.size(); ++i) {
+        hotCueButtons[i]->setBounds(10 + cueWidth * i, rowH * 6 + 5, cueWidth - 4, rowH / 3);
+    }
+    
+    // Sample pads directly underneath the hot cues
+    for (int i = 0; i < padButtons.size(); ++i) {
+        padButtons[i]->setBounds(10 + cueWidth * i, rowH * 6 + rowH / 3 + 9, cueWidth - 4, rowH / 3);
+    }
+    
+    // The platter and background are re-rendered for the new size on the next paint.
+    backgroundLayer = {};
+    /// ======================================================
+}
+
+/**
+ * @brief Throws away the cached layers and redraws the background for a pixel scale.
+ *
+ * The background layer holds the fill, the stretched background artwork and
+ * the deck number. The platter and face are scaled to display size here,
+ * once, at high quality; painting only rotates the platter layer, so the
+ * cache is two images about the size of the platter whatever the angle.
+ *
+ * @param scale The physical pixel scale of the display.
+ */
+void DeckGUI::rebuildLayers(float scale)
+{
+    layerScale = scale;
+    platterLayer = {};
+    faceLayer = {};
+    shownPlatterStep = -1;
+    
+    const int width = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int height = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+    backgroundLayer = juce::Image(juce::Image::ARGB, width, height, true);
+    
+    juce::Graphics g(backgroundLayer);
+    g.addTransform(juce::AffineTransform::scale(scale));
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    
+    platterBounds = {};
+    
+    if (deckImage.isValid()) {
+        g.drawImage(backgroundImage, getLocalBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
+        g.drawImage(deck_number_image, (getWidth()/8) * 6, (getHeight()/8) + 20,
+                    deck_number_image.getWidth()/3, deck_number_image.getHeight()/3,
+                    0, 0, deck_number_image.getWidth(), deck_number_image.getHeight());
+        
+        // Large enough for the platter at any angle and for the face on top.
+        auto bounds = getLocalBounds().toFloat();
+        float uniformScale = std::min(bounds.getWidth() / (deckImage.getWidth() * 2),
+                                      bounds.getHeight() / (deckImage.getHeight() * 2));
+        float diagonal = std::hypot((float) deckImage.getWidth(), (float) deckImage.getHeight());
+        float extent = uniformScale * juce::jmax(diagonal, (float) deck_face_image.getWidth(), (float) deck_face_image.getHeight());
+        
+        platterBounds = juce::Rectangle<int>((int) std::ceil(extent), (int) std::ceil(extent))
+                            .withCentre(bounds.getCentre().toInt());
+        
+        auto renderScaled = [pixelScale = uniformScale * scale](const juce::Image& source) {
+            juce::Image layer(juce::Image::ARGB,
+                              juce::jmax(1, juce::roundToInt(source.getWidth() * pixelScale)),
+                              juce::jmax(1, juce::roundToInt(source.getHeight() * pixelScale)),
+                              true);
+            juce::Graphics lg(layer);
+            lg.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+            lg.drawImage(source, layer.getBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
+            return layer;
+        };
+        
+        platterLayer = renderScaled(deckImage);
+        faceLayer = renderScaled(deck_face_image);
+    }
+}
+
+/**
+ * @brief Gets the angle step nearest the current rotation angle.
+ * @return The step, from 0 to numPlatterSteps - 1.
+ */
+int DeckGUI::getPlatterStep() const
+{
+    const float turns = rotationAngle / juce::MathConstants<float>::twoPi;
+    const int step = juce::roundToInt((turns - std::floor(turns)) * numPlatterSteps);
+    return step % numPlatterSteps;
+}
+
+/**
+ * @brief Handles button clicks for playback and loading.
+ * @param button Pointer to the button that was clicked.
+ */
+void DeckGUI::buttonClicked(juce::Button* button) {
+    if (button == playImageButton.get()) {
+        djAudioPlayer->start();
+        play = true;
+    }
+    
+    if (button == stopImageButton.get()) {
+        DBG("DeckGUI::buttonClicked: You clicked the stop button");
+        djAudioPlayer->stop();
+        play = false;
+    }
+    
+    if ((button == playImageButton.get() || button == stopImageButton.get()) && onStateChanged) {
+        onStateChanged();
+    }
+    
+    if (button == &loadButton) {
+        auto fileChooserFlags = juce::FileBrowserComponent::canSelectFiles;
+        
+        fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser){
+            auto chosenFile = chooser.getResult();
+            loadUrl(juce::URL{chosenFile});
+        });
+    }
+    
+    for (int i = 0; i < hotCueButtons.size(); ++i) {
+        if (button != hotCueButtons[i])
+            continue;
+        
+        if (juce::ModifierKeys::currentModifiers.isShiftDown()) {
+            djAudioPlayer->clearHotCue(i);
+        } else if (djAudioPlayer->hasHotCue(i)) {
+            djAudioPlayer->triggerHotCue(i);
+            play = true;
+            repaint();
+            if (onStateChanged) {
+                onStateChanged();
+            }
+        } else {
+            djAudioPlayer->setHotCue(i, djAudioPlayer->getPosition());
+        }
+        
+        state.hot_cues[i] = djAudioPlayer->getHotCuePosition(i);
+        updateHotCueButtons();
+    }
+    
+    for (int i = 0; i < padButtons.size(); ++i) {
+        if (button != padButtons[i])
+            continue;
+        
+        if (juce::ModifierKeys::currentModifiers.isShiftDown()) {
+            djAudioPlayer->clearPad(i);
+            updatePadButtons();
+        } else if (djAudioPlayer->isPadLoaded(i)) {
+            djAudioPlayer->triggerPad(i);
+        } else {
+            showPadMenu(i);
+        }
+    }
+}
+
+/**
+ * @brief Handles slider value changes.
+ * @param slider Pointer to the slider that was changed.
+ */
+void DeckGUI::sliderValueChanged(juce::Slider* slider) {
+    if (slider == &volumeSlider) {
+        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSlider.getValue());
+        djAudioPlayer->setGain(slider->getValue());
+    }
+    
+    if (slider == &positionSlider) {
+        djAudioPlayer->setPositionRelative(slider->getValue());
+    }
+    
+    if (slider == &speedSlider) {
+        djAudioPlayer->setSpeed(slider->getValue());
+        if (onStateChanged) {
+            onStateChanged();
+        }
+    }
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    if (slider == &reverb) {
+        djAudioPlayer->setReverbAmount(slider->getValue());
+    }
+    
+    if (slider == &flanger) {
+        djAudioPlayer->setFlangerAmount(slider->getValue());
+    }
+    
+    if (slider == &cut) {
+        djAudioPlayer->setTremelo(slider->getValue());
+    }
+}
+
+/**
+ * @brief Determines if the playlist accepts dragged files.
+ *
+ * @param files List of dragged file paths.
+ * @return Always returns true.
+ */
+bool DeckGUI::isInterestedInFileDrag(const juce::StringArray& files) {
+    std::cout << "DeckGUI::isInterestedInFileDrag" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Handles drag-and-drop file loading.
+ *
+ * The first dropped file goes onto the deck; everything dropped, folders
+ * included, is handed to onFilesDropped for import.
+ *
+ * @param files Array of file paths.
+ * @param x X coordinate of the drop location.
+ * @param y Y coordinate of the drop location.
+ */
+void DeckGUI::filesDropped(const juce::StringArray& files, int x, int y) {
+    for (juce::String file : files) {
+        if (juce::File{file}.existsAsFile()) {
+            loadUrl(juce::URL{juce::File{file}});
+            break;
+        }
+    }
+    
+    if (onFilesDropped) {
+        onFilesDropped(files);
+    }
+}
+
+void DeckGUI::mouseDown(const juce::MouseEvent& event) {
+    DBG("Mouse is down");
+    auto centre = getLocalBounds().toFloat().getCentre();
+    startAngle = std::atan2(event.position.y - centre.y, event.position.x - centre.x);
+    initialRotationAngle = rotationAngle;
+    
+    initialRelativePosition = djAudioPlayer->getPositionRelative();
+}
+
+void DeckGUI::mouseDrag(const juce::MouseEvent& event) {
+    auto centre = getLocalBounds().toFloat().getCentre();
+    float currentAngle = std::atan2(event.position.y - centre.y, event.position.x - centre.x);
+    float deltaAngle = currentAngle - startAngle;
+    rotationAngle = initialRotationAngle + deltaAngle;
+    
+    float deltaRelative = deltaAngle / (2 * juce::MathConstants<float>::pi);
+    float newRelative = juce::jlimit(0.0f, 1.0f, initialRelativePosition + deltaRelative);
+    
+    djAudioPlayer->setPositionRelative(newRelative);
+    
+    if (getPlatterStep() != shownPlatterStep)
+        repaint(platterBounds);
+}
+
+/**
+ * @brief Advances the platter and playheads for a display frame.
+ *
+ * The platter turns at a fixed 2 rad/s scaled by the real frame time, so it
+ * keeps the same speed whatever the frame rate. Nothing is touched when the
+ * position has not moved and the platter is still.
+ *
+ * @param elapsedSeconds Time since the previous frame.
+ */
+void DeckGUI::frameTick(double elapsedSeconds)
+{
+    double position = djAudioPlayer->getPositionRelative();
+    
+    if (position != lastPosition) {
+        lastPosition = position;
+        waveformDisplay.setPositionRelative(position);
+        deckDisplay.setPositionRelative(position);
+        setDeckState(position);
+    }
+    
+    if (play) {
+        rotationAngle += 2.0f * (float) elapsedSeconds;
+        
+        if (rotationAngle >= juce::MathConstants<float>::twoPi) {
+            rotationAngle -= juce::MathConstants<float>::twoPi;
+        }
+        
+        // Only the platter moves, and only when it reaches the next angle step.
+        if (getPlatterStep() != shownPlatterStep)
+            repaint(platterBounds);
+    }
+}
+
+void DeckGUI::loadUrl(juce::URL fileURL) {
+    djAudioPlayer->loadURL(fileURL);
+    waveformDisplay.loadUrl(fileURL);
+    deckDisplay.loadUrl(fileURL);
+    trackLoaded(fileURL);
+}
+
+/**
+ * @brief Opens an audio file in the background and seeks to a position once it is ready.
+ *
+ * The waveforms are requested straight away, so they build while the file
+ * is being opened.
+ *
+ * @param fileURL The URL of the audio file.
+ * @param relativePosition Position to start from, between 0 and 1.
+ * @param onReady Called on the message thread once the load has finished or failed.
+ */
+void DeckGUI::loadUrlAsync(juce::URL fileURL, double relativePosition, std::function<void()> onReady) {
+    waveformDisplay.loadUrl(fileURL);
+    deckDisplay.loadUrl(fileURL);
+    
+    djAudioPlayer->loadURLAsync(fileURL, [this, fileURL, relativePosition, onReady](bool loaded) {
+        if (loaded) {
+            trackLoaded(fileURL);
+            setInitialPosition(relativePosition);
+        }
+        if (onReady) {
+            onReady();
+        }
+    });
+}
+
+/**
+ * @brief Brings back the track's hot cues and records the track once the player has it.
+ * @param fileURL The URL of the loaded file.
+ */
+void DeckGUI::trackLoaded(const juce::URL& fileURL) {
+    // Hot cues are stored per track, so only bring them back for the same file.
+    // Older states name the file without its folder.
+    std::string fileName = (fileURL.isLocalFile() ? fileURL.getLocalFile().getFullPathName() : fileURL.getFileName()).toStdString();
+    if (fileName == state.file_name || fileURL.getFileName().toStdString() == state.file_name) {
+        djAudioPlayer->setHotCues(state.hot_cues);
+    } else {
+        state.hot_cues.assign(HotCueSource::numCues, -1.0);
+    }
+    updateHotCueButtons();
+    
+    setDeckState(fileName, djAudioPlayer->getPositionRelative());
+    
+    loadedUrl = fileURL;
+    if (onStateChanged) {
+        onStateChanged();
+    }
+}
+
+/**
+ * @brief Colours the sample pad buttons according to which pads are loaded.
+ */
+void DeckGUI::updatePadButtons() {
+    for (int i = 0; i < padButtons.size(); ++i) {
+        bool isLoaded = djAudioPlayer->isPadLoaded(i);
+        padButtons[i]->setColour(juce::TextButton::buttonColourId,
+                                 isLoaded ? juce::Colour {235, 120, 0} : juce::Colour {50, 50, 50});
+    }
+}
+
+/**
+ * @brief Offers to load a sample onto an empty pad or slice the track across all pads.
+ * @param pad The pad the menu is for.
+ */
+void DeckGUI::showPadMenu(int pad) {
+    juce::PopupMenu menu;
+    menu.addItem(1, "Load sample...");
+    menu.addItem(2, "Slice track from playhead");
+    menu.addSeparator();
+    menu.addItem(3, "Pad memory: " + juce::String((int) (djAudioPlayer->getPadMemoryUsed() / 1024)) + " of "
+                     + juce::String((int) (djAudioPlayer->getPadMemorySize() / 1024)) + " KB", false, false);
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(padButtons[pad]),
+                       [this, pad](int result) {
+        if (result == 1) {
+            fChooser.launchAsync(juce::FileBrowserComponent::canSelectFiles, [this, pad](const juce::FileChooser& chooser) {
+                djAudioPlayer->loadPadSample(pad, chooser.getResult());
+                updatePadButtons();
+            });
+        } else if (result == 2) {
+            djAudioPlayer->sliceTrackToPads(djAudioPlayer->getPosition());
+            updatePadButtons();
+        }
+    });
+}
+
+/**
+ * @brief Colours the hot cue buttons according to which slots are set.
+ */
+void DeckGUI::updateHotCueButtons() {
+    for (int i = 0; i < hotCueButtons.size(); ++i) {
+        bool isSet = djAudioPlayer->hasHotCue(i);
+        hotCueButtons[i]->setColour(juce::TextButton::buttonColourId,
+                                    isSet ? juce::Colour {0, 183, 235} : juce::Colour {50, 50, 50});
+    }
+}
+/**
+ * ==============================================================
+ * Author: Jacques Thurling
+ * 13 Mar 2020
+ * ==============================================================
+ */
+
+/**
+ * @brief Sets the initial playback position, e.g. when a session is restored.
+ * @param relativePosition The initial position as a normalized value between 0 and 1.
+ */
+void DeckGUI::setInitialPosition(double relativePosition) {
+    if (relativePosition > 0.0 && relativePosition < 1.0) {
+        djAudioPlayer->setPositionRelative(relativePosition);
+    }
+    // The playheads catch up on the next frame.
+    setDeckState(djAudioPlayer->getPositionRelative());
+}
+
+void DeckGUI::setDeckState(std::string fileName, double newPosition) {
+    state.file_name = fileName;
+    state.position = newPosition;
+}
+
+void DeckGUI::setDeckState(double newPosition) {
+    state.position = newPosition;
+}
+
+/**
+ * @brief Writes the deck's track, position, cues and controls into the session state.
+ * @param values The session state to add to.
+ */
+void DeckGUI::saveState(juce::NamedValueSet& values) const {
+    const auto key = [this](const juce::String& name) { return SessionStore::key(deck_name, name); };
+    
+    values.set(key("file"), loadedUrl.isLocalFile() ? loadedUrl.getLocalFile().getFullPathName() : juce::String());
+    values.set(key("position"), state.position);
+    values.set(key("playing"), play);
+    values.set(key("volume"), volumeSlider.getValue());
+    values.set(key("speed"), speedSlider.getValue());
+    values.set(key("reverb"), reverb.getValue());
+    values.set(key("flanger"), flanger.getValue());
+    values.set(key("cut"), cut.getValue());
+    for (size_t i = 0; i < state.hot_cues.size(); ++i) {
+        values.set(key("cue" + juce::String((int) i)), state.hot_cues[i]);
+    }
+}
+
+/**
+ * @brief Shows a value set from a MIDI controller, without applying it again.
+ *
+ * The controller has already driven the player from the MIDI thread, so the
+ * sliders are moved without notification.
+ *
+ * @param control The control that moved; ones the deck does not show are ignored.
+ * @param value The value, in the units of the control's slider.
+ */
+void DeckGUI::showControlValue(MidiControlSurface::Control control, double value) {
+    using Control = MidiControlSurface::Control;
+    
+    switch (control) {
+        case Control::play:
+            play = value > 0.5;
+            repaint();
+            break;
+        case Control::pitch:
+            speedSlider.setValue(value, juce::dontSendNotification);
+            break;
+        case Control::reverb:
+            reverb.setValue(value, juce::dontSendNotification);
+            return;
+        case Control::flanger:
+            flanger.setValue(value, juce::dontSendNotification);
+            return;
+        default:
+            return;
+    }
+    
+    if (onStateChanged) {
+        onStateChanged();
+    }
+}
+
+/**
+ * @brief Restores the deck's controls from the session state.
+ * @param values The restored session state.
+ */
+void DeckGUI::restoreState(const juce::NamedValueSet& values) {
+    const auto restore = [&](juce::Slider& slider, const juce::String& name) {
+        if (const auto* value = values.getVarPointer(SessionStore::key(deck_name, name))) {
+            slider.setValue((double) *value, juce::sendNotificationSync);
+        }
+    };
+    
+    restore(volumeSlider, "volume");
+    restore(speedSlider, "speed");
+    restore(reverb, "reverb");
+    restore(flanger, "flanger");
+    restore(cut, "cut");
+}
+
+/// ==============================================================
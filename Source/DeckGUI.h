@@ -1,194 +1,300 @@
-/*
- ==============================================================================
- 
- DeckGUI.h
- Created: 29 Jan 2025 7:21:23am
- Author:  Jacques Thurling
- 
- ==============================================================================
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "DJAudioPlayer.h"
-#include "WaveformDisplay.h"
-#include "CustomLookAndFeel.h"
-#include "DeckWaveformDisplay.h"
-#include "CSVReader.h"
-
-//==============================================================================
-/**
- * @class DeckGUI
- * @brief A graphical user interface for a DJ deck, handling playback, effects, and waveform display.
- */
-class DeckGUI  : public juce::Component,
-                 public juce::Button::Listener,
-                 public juce::Slider::Listener,
-                 public juce::FileDragAndDropTarget,
-                 public juce::Timer
-{
-public:
-    /**
-     * @brief Constructor for DeckGUI.
-     * @param _player Pointer to the DJAudioPlayer handling playback.
-     * @param formatManager Reference to an AudioFormatManager for handling formats.
-     * @param cache Reference to an AudioThumbnailCache for caching waveform thumbnails.
-     * @param deck_name Name of the deck.
-     * @param state Reference to the DeckState for storing deck information.
-     */
-    DeckGUI(DJAudioPlayer* _player, juce::AudioFormatManager& formatManager,
-            juce::AudioThumbnailCache& cache, std::string deck_name, DeckState& state);
-    
-    /**
-     * @brief Destructor for DeckGUI.
-     */
-    ~DeckGUI() override;
-    
-    /**
-     * @brief Paints the graphical elements of the DeckGUI.
-     * @param g JUCE Graphics context.
-     */
-    void paint(juce::Graphics&) override;
-    
-    /**
-     * @brief Handles resizing of the component and child components.
-     */
-    void resized() override;
-    
-    /**
-     * @brief Handles button click events.
-     * @param button Pointer to the clicked button.
-     */
-    void buttonClicked(juce::Button* button) override;
-    
-    /**
-     * @brief Handles slider value changes.
-     * @param slider Pointer to the changed slider.
-     */
-    void sliderValueChanged(juce::Slider* slider) override;
-    
-    /**
-     * @brief Checks if the component is interested in dragged files.
-     * @param files Array of file paths.
-     * @return True if interested, false otherwise.
-     */
-    bool isInterestedInFileDrag(const juce::StringArray& files) override;
-    
-    /**
-     * @brief Handles file drop events.
-     * @param file Array of file paths.
-     * @param x X-coordinate of the drop location.
-     * @param y Y-coordinate of the drop location.
-     */
-    void filesDropped(const juce::StringArray& file, int x, int y) override;
-    
-    /**
-     * @brief Timer callback function for updating components.
-     */
-    void timerCallback() override;
-    
-    /**
-     * @brief Handles mouse press events.
-     * @param event Mouse event details.
-     */
-    void mouseDown(const juce::MouseEvent& event) override;
-    
-    /**
-     * @brief Handles mouse drag events.
-     * @param event Mouse event details.
-     */
-    void mouseDrag(const juce::MouseEvent& event) override;
-    
-    /**
-     * @brief Loads an audio file from a given URL.
-     * @param file The URL of the audio file.
-     */
-    void loadUrl(juce::URL file);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     * @brief Sets the initial playback position.
-     * @param relativePosition The initial position as a normalized value between 0 and 1.
-     */
-    void setInitialPosition(double relativePosition);
-    
-    /**
-     * @brief Sets the deck state with a filename and position.
-     * @param fileName The name of the loaded file.
-     * @param position The playback position.
-     */
-    void setDeckState(std::string fileName, double position);
-    
-    /**
-     * @brief Sets the deck state with only the playback position.
-     * @param position The playback position.
-     */
-    void setDeckState(double position);
-    
-    private:
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    
-    std::vector<std::unique_ptr<juce::LookAndFeel>> lookAndFeels;
-    
-    std::string deck_name;
-    DeckState& state;
-    
-    float rotationAngle = 0.0f;
-    float startAngle = 0.0f;
-    float initialRotationAngle = 0.0f;
-    
-    float initialRelativePosition = 0.0f;
-    
-    DJAudioPlayer* djAudioPlayer;
-    
-    juce::TextButton playButton;
-    juce::TextButton stopButton;
-    juce::TextButton loadButton;
-    
-    juce::Slider volumeSlider;
-    juce::Slider positionSlider;
-    juce::Slider speedSlider;
-    
-    juce::Slider reverb;
-    juce::Slider flanger;
-    juce::Slider cut;
-    
-    juce::Label reverbLabel;
-    juce::Label flangerLabel;
-    juce::Label lfoLabel;
-    juce::Label speedLabel;
-    
-    juce::Image deckImage;
-    juce::Image knobImage;
-    juce::Image backgroundImage;
-    juce::Image deck_face_image;
-    juce::Image deck_spinner_image;
-    
-    juce::Image play_image;
-    juce::Image stop_image;
-    
-    juce::Image deck_number_image;
-    juce::Image deck_overlay;
-    
-    juce::FileChooser fChooser {"Select a file..."};
-    
-    WaveformDisplay waveformDisplay;
-    DeckWaveformDisplay deckDisplay;
-    
-    std::unique_ptr<juce::ImageButton> playImageButton;
-    std::unique_ptr<juce::ImageButton> stopImageButton;
-    
-    bool play = false;
-    /// ==============================================================
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI)
-};
+/*
+ ==============================================================================
+ 
+ DeckGUI.h
+ Created: 29 Jan 2025 7:21:23am
+ Author:  Jacques Thurling
+ 
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "WaveformDisplay.h"
+#include "CustomLookAndFeel.h"
+#include "DeckWaveformDisplay.h"
+#include "CSVReader.h"
+#include "FrameClock.h"
+#include "MidiControlSurface.h"
+#include "SessionStore.h"
+
+//==============================================================================
+/**
+ * @class DeckGUI
+ * @brief A graphical user interface for a DJ deck, handling playback, effects, and waveform display.
+ */
+class DeckGUI  : public juce::Component,
+                 public juce::Button::Listener,
+                 public juce::Slider::Listener,
+                 public juce::FileDragAndDropTarget,
+                 public FrameClock::Listener
+{
+public:
+    /**
+     * @brief Constructor for DeckGUI.
+     * @param _player Pointer to the DJAudioPlayer handling playback.
+     * @param cache Reference to the WaveformCache shared by every waveform view.
+     * @param deck_name Name of the deck.
+     * @param state Reference to the DeckState for storing deck information.
+     */
+    DeckGUI(DJAudioPlayer* _player, WaveformCache& cache,
+            std::string deck_name, DeckState& state);
+    
+    /**
+     * @brief Destructor for DeckGUI.
+     */
+    ~DeckGUI() override;
+    
+    /**
+     * @brief Paints the graphical elements of the DeckGUI.
+     * @param g JUCE Graphics context.
+     */
+    void paint(juce::Graphics&) override;
+    
+    /**
+     * @brief Handles resizing of the component and child components.
+     */
+    void resized() override;
+    
+    /**
+     * @brief Handles button click events.
+     * @param button Pointer to the clicked button.
+     */
+    void buttonClicked(juce::Button* button) override;
+    
+    /**
+     * @brief Handles slider value changes.
+     * @param slider Pointer to the changed slider.
+     */
+    void sliderValueChanged(juce::Slider* slider) override;
+    
+    /**
+     * @brief Checks if the component is interested in dragged files.
+     * @param files Array of file paths.
+     * @return True if interested, false otherwise.
+     */
+    bool isInterestedInFileDrag(const juce::StringArray& files) override;
+    
+    /**
+     * @brief Loads the first dropped audio file and passes every dropped path to onFilesDropped.
+     * @param file Array of file paths.
+     * @param x X-coordinate of the drop location.
+     * @param y Y-coordinate of the drop location.
+     */
+    void filesDropped(const juce::StringArray& file, int x, int y) override;
+    
+    /**
+     * @brief Advances the platter and playheads for a display frame.
+     * @param elapsedSeconds Time since the previous frame.
+     */
+    void frameTick(double elapsedSeconds) override;
+    
+    /**
+     * @brief Handles mouse press events.
+     * @param event Mouse event details.
+     */
+    void mouseDown(const juce::MouseEvent& event) override;
+    
+    /**
+     * @brief Handles mouse drag events.
+     * @param event Mouse event details.
+     */
+    void mouseDrag(const juce::MouseEvent& event) override;
+    
+    /**
+     * @brief Loads an audio file from a given URL.
+     * @param file The URL of the audio file.
+     */
+    void loadUrl(juce::URL file);
+    
+    /**
+     * @brief Opens an audio file in the background and seeks to a position once it is ready.
+     * @param file The URL of the audio file.
+     * @param relativePosition Position to start from, between 0 and 1.
+     * @param onReady Called on the message thread once the load has finished or failed.
+     */
+    void loadUrlAsync(juce::URL file, double relativePosition, std::function<void()> onReady);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     * @brief Sets the initial playback position.
+     * @param relativePosition The initial position as a normalized value between 0 and 1.
+     */
+    void setInitialPosition(double relativePosition);
+    
+    /**
+     * @brief Sets the deck state with a filename and position.
+     * @param fileName The name of the loaded file.
+     * @param position The playback position.
+     */
+    void setDeckState(std::string fileName, double position);
+    
+    /**
+     * @brief Sets the deck state with only the playback position.
+     * @param position The playback position.
+     */
+    void setDeckState(double position);
+    
+    /**
+     * @brief Writes the deck's track, position, cues and controls into the session state.
+     * @param values The session state to add to.
+     */
+    void saveState(juce::NamedValueSet& values) const;
+    
+    /**
+     * @brief Restores the deck's controls from the session state.
+     *
+     * The track and cues come back through the DeckState instead.
+     *
+     * @param values The restored session state.
+     */
+    void restoreState(const juce::NamedValueSet& values);
+    
+    /**
+     * @brief Gets the track loaded on the deck.
+     * @return The track's URL, empty if nothing is loaded.
+     */
+    juce::URL getLoadedUrl() const { return loadedUrl; }
+    
+    /**
+     * @brief Checks whether the deck is playing.
+     * @return True between play and stop.
+     */
+    bool isPlaying() const { return play; }
+    
+    /**
+     * @brief Gets the playback speed.
+     * @return The speed ratio, 1 for the track's own tempo.
+     */
+    double getSpeed() const { return speedSlider.getValue(); }
+    
+    /**
+     * @brief Shows a value set from a MIDI controller, without applying it again.
+     * @param control The control that moved; ones the deck does not show are ignored.
+     * @param value The value, in the units of the control's slider.
+     */
+    void showControlValue(MidiControlSurface::Control control, double value);
+    
+    /** Called with every dropped path, so drops of several files or folders can be imported. */
+    std::function<void(const juce::StringArray&)> onFilesDropped;
+    
+    /** Called when a track is loaded, the deck starts or stops, or the speed changes. */
+    std::function<void()> onStateChanged;
+    
+    private:
+    /**
+     * @brief Brings back the track's hot cues and records the track once the player has it.
+     * @param fileURL The URL of the loaded file.
+     */
+    void trackLoaded(const juce::URL& fileURL);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    
+    std::vector<std::unique_ptr<juce::LookAndFeel>> lookAndFeels;
+    
+    std::string deck_name;
+    DeckState& state;
+    
+    float rotationAngle = 0.0f;
+    float startAngle = 0.0f;
+    float initialRotationAngle = 0.0f;
+    
+    float initialRelativePosition = 0.0f;
+    
+    DJAudioPlayer* djAudioPlayer;
+    
+    juce::TextButton playButton;
+    juce::TextButton stopButton;
+    juce::TextButton loadButton;
+    
+    juce::Slider volumeSlider;
+    juce::Slider positionSlider;
+    juce::Slider speedSlider;
+    
+    juce::Slider reverb;
+    juce::Slider flanger;
+    juce::Slider cut;
+    
+    juce::Label reverbLabel;
+    juce::Label flangerLabel;
+    juce::Label lfoLabel;
+    juce::Label speedLabel;
+    
+    juce::Image deckImage;
+    juce::Image knobImage;
+    juce::Image backgroundImage;
+    juce::Image deck_face_image;
+    juce::Image deck_spinner_image;
+    
+    juce::Image play_image;
+    juce::Image stop_image;
+    
+    juce::Image deck_number_image;
+    juce::Image deck_overlay;
+    
+    juce::FileChooser fChooser {"Select a file..."};
+    
+    WaveformDisplay waveformDisplay;
+    DeckWaveformDisplay deckDisplay;
+    
+    std::unique_ptr<juce::ImageButton> playImageButton;
+    std::unique_ptr<juce::ImageButton> stopImageButton;
+    
+    juce::OwnedArray<juce::TextButton> hotCueButtons;
+    juce::OwnedArray<juce::TextButton> padButtons;
+    
+    bool play = false;
+    juce::URL loadedUrl;                      ///< The track on the deck.
+    double lastPosition = -1.0;               ///< Playback position drawn by the previous frame.
+    
+    /**
+     * @brief Refreshes the hot cue buttons to show which slots are in use.
+     */
+    void updateHotCueButtons();
+    
+    /**
+     * @brief Refreshes the sample pad buttons to show which pads are loaded.
+     */
+    void updatePadButtons();
+    
+    /**
+     * @brief Shows the menu for loading or slicing audio onto a pad.
+     * @param pad The pad the menu is for.
+     */
+    void showPadMenu(int pad);
+    
+    /** Number of angles the platter is drawn at (3 degrees apart); it is only repainted when it reaches the next. */
+    static constexpr int numPlatterSteps = 120;
+    
+    juce::Image backgroundLayer;              ///< Background, stretched artwork and deck number, cached.
+    juce::Image platterLayer;                 ///< Platter artwork scaled to display size, unrotated.
+    juce::Image faceLayer;                    ///< Deck face scaled to display size; it does not turn.
+    juce::Rectangle<int> platterBounds;       ///< Area the platter is drawn in, and its dirty rectangle.
+    float layerScale = 0.0f;                  ///< Physical pixel scale the cached layers were made for.
+    int shownPlatterStep = -1;                ///< Angle step drawn by the last paint.
+    
+    /**
+     * @brief Throws away the cached layers and redraws the background for a pixel scale.
+     * @param scale The physical pixel scale of the display.
+     */
+    void rebuildLayers(float scale);
+    
+    /**
+     * @brief Gets the angle step nearest the current rotation angle.
+     * @return The step, from 0 to numPlatterSteps - 1.
+     */
+    int getPlatterStep() const;
+    /// ==============================================================
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI)
+};
@@ -1,139 +1,217 @@
-/**
- * =================================================================
- * @file DeckWaveformDisplay.cpp
- * @brief Implementation of the DeckWaveformDisplay component.
- *
- * This file implements the waveform display for a deck, handling painting,
- * audio file loading, and change notifications.
- *
- * Created: 22 Feb 2025 1:38:07pm
- * Author: Jacques Thurling
- */
-
-#include <JuceHeader.h>
-#include "DeckWaveformDisplay.h"
-
-//==============================================================================
-/**
- * @brief Constructs a new DeckWaveformDisplay object.
- *
- * This constructor initializes the audio thumbnail with a resolution of 1000 samples,
- * registers a change listener, and sets up the initial state.
- *
- * @param formatManagerToUse Reference to the AudioFormatManager used to manage audio formats.
- * @param cache Reference to the AudioThumbnailCache used for caching thumbnail data.
- */
-DeckWaveformDisplay::DeckWaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-                                         juce::AudioThumbnailCache& cache)
-    : audioThumbnail(1000, formatManagerToUse, cache),
-      fileLoaded(false),
-      position(0)
-{
-    audioThumbnail.addChangeListener(this);
-}
-
-/**
- * @brief Destructor for DeckWaveformDisplay.
- */
-DeckWaveformDisplay::~DeckWaveformDisplay()
-{
-}
-
-/**
- * @brief Paints the component.
- *
- * This function clears the background and either draws the waveform
- * or displays placeholder text if no file has been loaded. When a file is loaded,
- * it draws a partially transparent gradient over the waveform.
- *
- * @param g The graphics context used for drawing.
- */
-void DeckWaveformDisplay::paint (juce::Graphics& g)
-{
-    g.fillAll (juce::Colour {44, 44, 44});   // clear the background
-    g.setColour (juce::Colours::grey);
-
-    if (fileLoaded)
-    {
-        g.beginTransparencyLayer(0.5f);
-
-        // Define a gradient for the waveform display
-        juce::ColourGradient gradient {
-            juce::Colour {0, 183, 235}.withAlpha(0.0f), getWidth() / 1.0f, getHeight() / 1.0f,
-            juce::Colour {0, 183, 235}.withAlpha(1.0f), 0.0f, 0.0f,
-            true
-        };
-
-        g.setGradientFill(gradient);
-        g.setColour (juce::Colour {0, 183, 235});
-        audioThumbnail.drawChannel(g,
-                                   getLocalBounds(),
-                                   audioThumbnail.getTotalLength() * position,
-                                   audioThumbnail.getTotalLength() * position + .5,
-                                   0,
-                                   1.0f);
-        g.endTransparencyLayer();
-    }
-    else
-    {
-        g.setFont (20.0f);
-        g.drawText ("File not loaded...", getLocalBounds(),
-                    juce::Justification::centred, true);
-    }
-}
-
-/**
- * @brief Handles component resizing.
- *
- * This method is called when the component is resized. It should be used
- * to adjust the bounds of any child components.
- */
-void DeckWaveformDisplay::resized()
-{
-    // Adjust the bounds of child components here, if any.
-}
-
-/**
- * @brief Loads an audio file from the specified URL.
- *
- * This function clears the current audio thumbnail and attempts to load a new
- * audio source from the provided URL.
- *
- * @param url The URL from which to load the audio file.
- */
-void DeckWaveformDisplay::loadUrl(juce::URL url)
-{
-    audioThumbnail.clear();
-    fileLoaded = audioThumbnail.setSource(new juce::URLInputSource(url));
-}
-
-/**
- * @brief Callback for change events.
- *
- * This function is called when a change event is broadcasted by the audio thumbnail.
- * It triggers a repaint of the component.
- *
- * @param source Pointer to the ChangeBroadcaster that triggered the event.
- */
-void DeckWaveformDisplay::changeListenerCallback (juce::ChangeBroadcaster *source)
-{
-    std::cout << "wfd: change received! " << std::endl;
-    repaint();
-}
-
-/**
- * @brief Sets the playback position relative to the audio length.
- *
- * This function updates the internal position (if it has changed) and repaints
- * the component to reflect the new position.
- *
- * @param pos The new relative position (expected range is 0.0 to 1.0).
- */
-void DeckWaveformDisplay::setPositionRelative(double pos)
-{
-    if (pos != position)
-    {
-        position = pos;
-        repaint();
-    }
-}
+/**
+ * =================================================================
+ * @file DeckWaveformDisplay.cpp
+ * @brief Implementation of the DeckWaveformDisplay component.
+ *
+ * This file implements the waveform display for a deck, handling painting,
+ * audio file loading, and change notifications.
+ *
+ * Created: 22 Feb 2025 1:38:07pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "DeckWaveformDisplay.h"
+
+//==============================================================================
+/**
+ * @brief Constructs a new DeckWaveformDisplay object.
+ *
+ * @param cacheToUse Reference to the WaveformCache used to build and share pyramids.
+ */
+DeckWaveformDisplay::DeckWaveformDisplay(WaveformCache& cacheToUse)
+    : cache(cacheToUse),
+      fileLoaded(false),
+      position(0)
+{
+}
+
+/**
+ * @brief Destructor for DeckWaveformDisplay.
+ */
+DeckWaveformDisplay::~DeckWaveformDisplay()
+{
+    if (pyramid != nullptr)
+        pyramid->removeChangeListener(this);
+}
+
+/**
+ * @brief Paints the component.
+ *
+ * This function clears the background and either draws the waveform
+ * or displays placeholder text if no file has been loaded. When a file is loaded,
+ * it brings the offscreen strip up to date and blits it at half opacity.
+ *
+ * @param g The graphics context used for drawing.
+ */
+void DeckWaveformDisplay::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colour {44, 44, 44});   // clear the background
+    g.setColour (juce::Colours::grey);
+
+    if (fileLoaded)
+    {
+        updateStrip();
+        g.setOpacity(0.5f);
+        g.drawImageAt(strip, 0, 0);
+    }
+    else
+    {
+        g.setFont (20.0f);
+        g.drawText ("File not loaded...", getLocalBounds(),
+                    juce::Justification::centred, true);
+    }
+}
+
+/**
+ * @brief Handles component resizing.
+ *
+ * This method is called when the component is resized. It should be used
+ * to adjust the bounds of any child components.
+ */
+void DeckWaveformDisplay::resized()
+{
+    stripValid = false;
+}
+
+/**
+ * @brief Loads an audio file from the specified URL.
+ *
+ * This function swaps to the cached pyramid of the new file, which starts
+ * building in the background if no other view has requested it yet.
+ *
+ * @param url The URL from which to load the audio file.
+ */
+void DeckWaveformDisplay::loadUrl(juce::URL url)
+{
+    if (pyramid != nullptr)
+        pyramid->removeChangeListener(this);
+
+    pyramid = url.isLocalFile() ? cache.getPyramid(url.getLocalFile()) : nullptr;
+    fileLoaded = pyramid != nullptr;
+    stripValid = false;
+
+    if (fileLoaded)
+        pyramid->addChangeListener(this);
+
+    repaint();
+}
+
+/**
+ * @brief Callback for change events.
+ *
+ * This function is called when the waveform pyramid has built more of the track.
+ * The strip is redrawn in full on the next paint to pick up the new data.
+ *
+ * @param source Pointer to the ChangeBroadcaster that triggered the event.
+ */
+void DeckWaveformDisplay::changeListenerCallback (juce::ChangeBroadcaster *source)
+{
+    stripValid = false;
+    repaint();
+}
+
+/**
+ * @brief Sets the playback position relative to the audio length.
+ *
+ * This function updates the internal position and repaints only when the
+ * playhead has moved onto a different pixel column.
+ *
+ * @param pos The new relative position (expected range is 0.0 to 1.0).
+ */
+void DeckWaveformDisplay::setPositionRelative(double pos)
+{
+    if (pos != position)
+    {
+        position = pos;
+
+        if (fileLoaded && (! stripValid || getFirstColumn() != stripFirstColumn))
+            repaint();
+    }
+}
+
+/**
+ * @brief Gets the column of the whole track shown at the left edge.
+ *
+ * Columns are visibleSeconds / width wide and counted from the start of the
+ * track, so the strip always stays aligned to the same grid as it scrolls.
+ *
+ * @return The absolute column index.
+ */
+juce::int64 DeckWaveformDisplay::getFirstColumn() const
+{
+    if (pyramid == nullptr || getWidth() <= 0)
+        return 0;
+
+    const double secondsPerColumn = visibleSeconds / getWidth();
+    return (juce::int64) std::floor(pyramid->getLengthInSeconds() * position / secondsPerColumn);
+}
+
+/**
+ * @brief Brings the offscreen strip up to date with the playhead.
+ *
+ * When the playhead has moved by less than a full width, the existing pixels
+ * are shifted in place and only the newly exposed columns are rendered. The
+ * whole strip is rendered only after a resize, a new track or new data.
+ */
+void DeckWaveformDisplay::updateStrip()
+{
+    const int width = getWidth();
+    const int height = getHeight();
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    const juce::int64 firstColumn = getFirstColumn();
+
+    if (strip.getWidth() != width || strip.getHeight() != height)
+    {
+        strip = juce::Image (juce::Image::ARGB, width, height, true);
+        stripValid = false;
+    }
+
+    if (! stripValid)
+    {
+        renderColumns(firstColumn, 0, width);
+    }
+    else
+    {
+        const juce::int64 shift = firstColumn - stripFirstColumn;
+
+        if (std::abs(shift) >= width)
+        {
+            renderColumns(firstColumn, 0, width);
+        }
+        else if (shift > 0)
+        {
+            strip.moveImageSection(0, 0, (int) shift, 0, width - (int) shift, height);
+            renderColumns(firstColumn, width - (int) shift, (int) shift);
+        }
+        else if (shift < 0)
+        {
+            strip.moveImageSection((int) -shift, 0, 0, 0, width + (int) shift, height);
+            renderColumns(firstColumn, 0, (int) -shift);
+        }
+    }
+
+    stripFirstColumn = firstColumn;
+    stripValid = true;
+}
+
+/**
+ * @brief Renders a run of columns of the strip from the pyramid.
+ * @param firstColumn Absolute column at the left edge of the strip.
+ * @param x First strip column to render.
+ * @param numColumns Number of columns to render.
+ */
+void DeckWaveformDisplay::renderColumns(juce::int64 firstColumn, int x, int numColumns)
+{
+    const juce::Rectangle<int> area (x, 0, numColumns, strip.getHeight());
+    strip.clear(area);
+
+    const double secondsPerColumn = visibleSeconds / strip.getWidth();
+    const double start = (double) (firstColumn + x) * secondsPerColumn;
+
+    juce::Graphics g (strip);
+    pyramid->drawBandWaveform(g, area, start, start + numColumns * secondsPerColumn);
+}
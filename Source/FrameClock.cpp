@@ -0,0 +1,86 @@
+/**
+ * =================================================================
+ * @file FrameClock.cpp
+ * @brief Implementation of the FrameClock class.
+ *
+ * Created: 18 Oct 2026 7:12:48pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "FrameClock.h"
+#include "StartupProfiler.h"
+
+/**
+ * @brief Constructor for FrameClock.
+ * @param owner Component whose display drives the clock.
+ */
+FrameClock::FrameClock(juce::Component& owner)
+    : vBlankAttachment(&owner, [this] { onVBlank(); })
+{
+}
+
+/**
+ * @brief Destructor for FrameClock.
+ */
+FrameClock::~FrameClock()
+{
+}
+
+/**
+ * @brief Adds a listener to be ticked every frame.
+ * @param listener The listener to add.
+ */
+void FrameClock::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+/**
+ * @brief Removes a listener.
+ * @param listener The listener to remove.
+ */
+void FrameClock::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
+
+/**
+ * @brief Limits how often the listeners are ticked.
+ * @param framesPerSecond The cap, or 0 to tick on every refresh.
+ */
+void FrameClock::setFrameCap(double framesPerSecond)
+{
+    if (framesPerSecond < 0)
+    {
+        std::cout << "FrameClock::setFrameCap frame cap should not be negative" << std::endl;
+        return;
+    }
+
+    minimumInterval = framesPerSecond > 0 ? 1.0 / framesPerSecond : 0.0;
+}
+
+/**
+ * @brief Called on each vertical blank of the display.
+ *
+ * A small tolerance keeps a 60 fps cap from skipping every other refresh of
+ * a 60 Hz display because of jitter. Long stalls (such as the window being
+ * hidden) are clamped so animations do not jump when ticking resumes. The
+ * first tick also closes the startup profile, since it is the first frame
+ * actually on screen.
+ */
+void FrameClock::onVBlank()
+{
+    const double now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    const double elapsed = now - lastTickSeconds;
+
+    if (elapsed < minimumInterval * 0.9)
+        return;
+
+    lastTickSeconds = now;
+    StartupProfiler::firstFrameShown();
+
+    const double frameTime = juce::jmin(elapsed, 0.1);
+
+    listeners.call([frameTime](Listener& listener) { listener.frameTick(frameTime); });
+}
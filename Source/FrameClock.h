@@ -0,0 +1,96 @@
+/**
+ * =================================================================
+ * @file FrameClock.h
+ * @brief Declaration of the FrameClock class.
+ *
+ * This file declares the single display-synchronised clock that drives every
+ * animated component, in place of per-component timers.
+ *
+ * Created: 18 Oct 2026 7:12:48pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class FrameClock
+ * @brief Ticks its listeners once per display refresh, up to a frame cap.
+ *
+ * The clock follows the vertical blank of the display its owner component is
+ * on. Listeners receive the time elapsed since their previous tick, so
+ * animation advances by real time and stays smooth when frames are dropped
+ * or capped.
+ */
+class FrameClock
+{
+public:
+    /**
+     * @class Listener
+     * @brief Receives a callback for every frame.
+     */
+    class Listener
+    {
+    public:
+        /**
+         * @brief Destructor for Listener.
+         */
+        virtual ~Listener() = default;
+
+        /**
+         * @brief Called on the message thread once per frame.
+         *
+         * Implementations should compare against the state they last drew
+         * and only repaint what has changed.
+         *
+         * @param elapsedSeconds Time since the previous frame.
+         */
+        virtual void frameTick(double elapsedSeconds) = 0;
+    };
+
+    /**
+     * @brief Constructor for FrameClock.
+     * @param owner Component whose display drives the clock.
+     */
+    explicit FrameClock(juce::Component& owner);
+
+    /**
+     * @brief Destructor for FrameClock.
+     */
+    ~FrameClock();
+
+    /**
+     * @brief Adds a listener to be ticked every frame.
+     * @param listener The listener to add.
+     */
+    void addListener(Listener* listener);
+
+    /**
+     * @brief Removes a listener.
+     * @param listener The listener to remove.
+     */
+    void removeListener(Listener* listener);
+
+    /**
+     * @brief Limits how often the listeners are ticked.
+     *
+     * Refreshes that arrive sooner than the cap allows are skipped.
+     *
+     * @param framesPerSecond The cap, or 0 to tick on every refresh.
+     */
+    void setFrameCap(double framesPerSecond);
+
+private:
+    /**
+     * @brief Called on each vertical blank of the display.
+     */
+    void onVBlank();
+
+    juce::ListenerList<Listener> listeners;       ///< Components ticked every frame.
+    double minimumInterval = 1.0 / 60.0;          ///< Shortest time between ticks, in seconds.
+    double lastTickSeconds = 0.0;                 ///< Time of the previous tick.
+    juce::VBlankAttachment vBlankAttachment;      ///< Calls onVBlank() on each refresh.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameClock)
+};
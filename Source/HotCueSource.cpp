@@ -0,0 +1,307 @@
+/**
+ * =================================================================
+ * @file HotCueSource.cpp
+ * @brief Implementation of the HotCueSource class.
+ *
+ * Created: 18 Oct 2026 9:12:04am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "HotCueSource.h"
+
+/**
+ * @brief Constructs a HotCueSource around a transport.
+ * @param source The transport that normally supplies the deck's audio.
+ */
+HotCueSource::HotCueSource(juce::AudioTransportSource* source)
+    : transportSource(source)
+{
+}
+
+/**
+ * @brief Destructor for HotCueSource.
+ */
+HotCueSource::~HotCueSource()
+{
+    for (auto& cue : cues)
+        delete cue.resident.exchange(nullptr);
+}
+
+/**
+ * @brief Prepares the source and the wrapped transport for playback.
+ * @param samplesPerBlockExpected Expected number of samples per block.
+ * @param sampleRate The device sample rate.
+ */
+void HotCueSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    deviceSampleRate = sampleRate;
+
+    for (auto& interpolator : interpolators)
+        interpolator.reset();
+
+    transportSource->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+/**
+ * @brief Fills the next block from the active cue or from the transport.
+ *
+ * While a cue is active the transport is not pulled at all, so it stays
+ * parked at the end of the cue's resident audio. Once the resident audio
+ * runs out the remainder of the block is taken from the transport.
+ *
+ * @param bufferToFill The buffer to be filled with audio data.
+ */
+void HotCueSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (activeCue < 0) {
+        transportSource->getNextAudioBlock(bufferToFill);
+        return;
+    }
+
+    // While paused keep the cue where it is, so playback resumes from the same spot.
+    if (! transportSource->isPlaying()) {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    if (activeResident == nullptr || deviceSampleRate <= 0) {
+        cancelCue();
+        transportSource->getNextAudioBlock(bufferToFill);
+        return;
+    }
+
+    // Still safe if the cue has been replaced since: the buffer lives until cancelCue lets go of it.
+    const auto& audio = activeResident->audio;
+    const double ratio = activeResident->sourceSampleRate / deviceSampleRate;
+    const int available = juce::jmax(0, audio.getNumSamples() - activeReadPosition);
+    const int numToProduce = juce::jmin(bufferToFill.numSamples, (int) (available / ratio));
+    const float gain = transportSource->getGain();
+    int consumed = 0;
+
+    for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+        float* output = bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample);
+
+        if (channel < 2) {
+            const int sourceChannel = juce::jmin(channel, audio.getNumChannels() - 1);
+            consumed = interpolators[channel].process(ratio,
+                                                      audio.getReadPointer(sourceChannel, activeReadPosition),
+                                                      output,
+                                                      numToProduce,
+                                                      available,
+                                                      0);
+            juce::FloatVectorOperations::multiply(output, gain, numToProduce);
+        } else {
+            bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample,
+                                          *bufferToFill.buffer, 1, bufferToFill.startSample, numToProduce);
+        }
+    }
+
+    activeReadPosition += consumed;
+
+    if (numToProduce < bufferToFill.numSamples) {
+        // Resident audio used up: the transport is already waiting at this point.
+        cancelCue();
+        juce::AudioSourceChannelInfo remainder (bufferToFill.buffer,
+                                                bufferToFill.startSample + numToProduce,
+                                                bufferToFill.numSamples - numToProduce);
+        transportSource->getNextAudioBlock(remainder);
+    }
+}
+
+/**
+ * @brief Releases audio resources held by the wrapped transport.
+ */
+void HotCueSource::releaseResources()
+{
+    transportSource->releaseResources();
+}
+
+/**
+ * @brief Stores a hot cue and decodes its resident audio.
+ *
+ * The decoding happens on the calling thread; the audio thread only ever
+ * sees the finished buffer, which is swapped in atomically.
+ *
+ * @param index The cue slot (0 - numCues-1).
+ * @param reader A reader for the loaded track, used only for this call.
+ * @param positionInSeconds Position of the cue in the track.
+ * @return True if the cue was stored.
+ */
+bool HotCueSource::setCue(int index, juce::AudioFormatReader& reader, double positionInSeconds)
+{
+    if (! juce::isPositiveAndBelow(index, numCues) || reader.sampleRate <= 0) {
+        std::cout << "HotCueSource::setCue invalid cue or reader" << std::endl;
+        return false;
+    }
+
+    const auto startSample = (juce::int64) (positionInSeconds * reader.sampleRate);
+
+    if (startSample < 0 || startSample >= reader.lengthInSamples) {
+        std::cout << "HotCueSource::setCue position is outside the track" << std::endl;
+        return false;
+    }
+
+    const int numSamples = (int) juce::jmin((juce::int64) (residentSeconds * reader.sampleRate),
+                                            reader.lengthInSamples - startSample);
+
+    auto resident = std::make_unique<Resident>();
+    resident->audio.setSize(2, numSamples);
+    resident->sourceSampleRate = reader.sampleRate;
+    resident->position = positionInSeconds;
+    reader.read(&resident->audio, 0, numSamples, startSample, true, true);
+
+    const juce::SpinLock::ScopedLockType lock (cueLock);
+    cues[(size_t) index].position = positionInSeconds;
+    retire(cues[(size_t) index].resident.exchange(resident.release()));
+    return true;
+}
+
+/**
+ * @brief Removes a hot cue.
+ * @param index The cue slot (0 - numCues-1).
+ */
+void HotCueSource::clearCue(int index)
+{
+    if (! juce::isPositiveAndBelow(index, numCues))
+        return;
+
+    const juce::SpinLock::ScopedLockType lock (cueLock);
+    cues[(size_t) index].position = -1.0;
+    retire(cues[(size_t) index].resident.exchange(nullptr));
+}
+
+/**
+ * @brief Frees a replaced resident buffer, or keeps it while the audio thread reads it.
+ *
+ * The audio thread announces its buffer before checking that the slot still
+ * holds it, and the slot is swapped before the announcement is checked here,
+ * so a buffer is never freed while the audio thread may be reading it.
+ * Buffers kept earlier are freed once the audio thread has moved on.
+ *
+ * @param resident The buffer, or nullptr.
+ */
+void HotCueSource::retire(Resident* resident)
+{
+    const auto* playing = playingResident.load();
+
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [playing](const auto& kept) { return kept.get() != playing; }),
+                  retired.end());
+
+    if (resident == nullptr)
+        return;
+
+    if (resident == playing)
+        retired.emplace_back(resident);
+    else
+        delete resident;
+}
+
+/**
+ * @brief Removes every hot cue, e.g. when a new track is loaded.
+ */
+void HotCueSource::clearAllCues()
+{
+    for (int i = 0; i < numCues; ++i)
+        clearCue(i);
+}
+
+/**
+ * @brief Checks whether a slot holds a cue.
+ * @param index The cue slot (0 - numCues-1).
+ * @return True if the slot holds a cue.
+ */
+bool HotCueSource::hasCue(int index) const
+{
+    const juce::SpinLock::ScopedLockType lock (cueLock);
+    return juce::isPositiveAndBelow(index, numCues) && cues[(size_t) index].position >= 0;
+}
+
+/**
+ * @brief Gets the track position of a cue.
+ * @param index The cue slot (0 - numCues-1).
+ * @return The position in seconds, or -1 if the slot is empty.
+ */
+double HotCueSource::getCuePosition(int index) const
+{
+    if (! juce::isPositiveAndBelow(index, numCues))
+        return -1.0;
+
+    const juce::SpinLock::ScopedLockType lock (cueLock);
+    return cues[(size_t) index].position >= 0 ? cues[(size_t) index].position : -1.0;
+}
+
+/**
+ * @brief Gets the length of the resident audio of a cue.
+ * @param index The cue slot (0 - numCues-1).
+ * @return The length in seconds, or 0 if the slot is empty.
+ */
+double HotCueSource::getResidentLength(int index) const
+{
+    if (! hasCue(index))
+        return 0.0;
+
+    const juce::SpinLock::ScopedLockType lock (cueLock);
+    const auto* resident = cues[(size_t) index].resident.load();
+
+    if (resident == nullptr)
+        return 0.0;
+
+    return resident->audio.getNumSamples() / resident->sourceSampleRate;
+}
+
+/**
+ * @brief Starts output from a cue's resident buffer.
+ *
+ * The handover position comes from the buffer itself, so the audio thread
+ * never needs cueLock to find it.
+ *
+ * @param index The cue slot (0 - numCues-1).
+ * @return Track position in seconds where the resident audio ends, or -1 if the slot is empty.
+ */
+double HotCueSource::startCue(int index)
+{
+    cancelCue();
+
+    if (! juce::isPositiveAndBelow(index, numCues))
+        return -1.0;
+
+    // Announce the buffer, then check the slot still holds it; if not, it was just replaced.
+    auto& slot = cues[(size_t) index].resident;
+    auto* resident = slot.load();
+
+    for (;;) {
+        playingResident.store(resident);
+        auto* current = slot.load();
+
+        if (current == resident)
+            break;
+
+        resident = current;
+    }
+
+    if (resident == nullptr) {
+        playingResident.store(nullptr);
+        return -1.0;
+    }
+
+    for (auto& interpolator : interpolators)
+        interpolator.reset();
+
+    activeResident = resident;
+    activeCue = index;
+    activeReadPosition = 0;
+
+    return resident->position + resident->audio.getNumSamples() / resident->sourceSampleRate;
+}
+
+/**
+ * @brief Abandons the cue currently playing, if any.
+ */
+void HotCueSource::cancelCue()
+{
+    activeCue = -1;
+    activeResident = nullptr;
+    playingResident.store(nullptr);
+}
@@ -0,0 +1,175 @@
+/**
+ * =================================================================
+ * @file HotCueSource.h
+ * @brief Declaration of the HotCueSource class.
+ *
+ * This file declares an audio source that sits on top of a deck's
+ * AudioTransportSource and can start output from a pre-decoded buffer
+ * for any of its hot cues, so a cue jump is heard in the very next block.
+ *
+ * Created: 18 Oct 2026 9:12:04am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class HotCueSource
+ * @brief Plays hot cues from resident buffers while the transport catches up.
+ *
+ * Each cue keeps a short piece of decoded audio starting at the cue point.
+ * When a cue is triggered the transport is moved to the end of that piece
+ * (refilling in the background) and this source plays the resident audio
+ * until it runs out, then hands over to the transport seamlessly.
+ *
+ * Resident buffers reach the audio thread without a lock: it announces the
+ * buffer it is reading, and a buffer replaced or removed meanwhile is kept
+ * alive until the audio thread lets go of it, so a cue being set never
+ * interrupts the one playing.
+ */
+class HotCueSource : public juce::AudioSource
+{
+public:
+    /** Number of hot cues available per deck. */
+    static constexpr int numCues = 8;
+
+    /** Length of audio kept resident for each cue, in seconds. */
+    static constexpr double residentSeconds = 0.5;
+
+    /**
+     * @brief Constructs a HotCueSource around a transport.
+     * @param source The transport that normally supplies the deck's audio.
+     */
+    explicit HotCueSource(juce::AudioTransportSource* source);
+
+    /**
+     * @brief Destructor for HotCueSource.
+     */
+    ~HotCueSource() override;
+
+    /**
+     * @brief Prepares the source and the wrapped transport for playback.
+     * @param samplesPerBlockExpected Expected number of samples per block.
+     * @param sampleRate The device sample rate.
+     */
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+
+    /**
+     * @brief Fills the next block from the active cue or from the transport.
+     * @param bufferToFill The buffer to be filled with audio data.
+     */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /**
+     * @brief Releases audio resources held by the wrapped transport.
+     */
+    void releaseResources() override;
+
+    /**
+     * @brief Stores a hot cue and decodes its resident audio.
+     *
+     * Must be called from the message thread.
+     *
+     * @param index The cue slot (0 - numCues-1).
+     * @param reader A reader for the loaded track, used only for this call.
+     * @param positionInSeconds Position of the cue in the track.
+     * @return True if the cue was stored.
+     */
+    bool setCue(int index, juce::AudioFormatReader& reader, double positionInSeconds);
+
+    /**
+     * @brief Removes a hot cue.
+     * @param index The cue slot (0 - numCues-1).
+     */
+    void clearCue(int index);
+
+    /**
+     * @brief Removes every hot cue, e.g. when a new track is loaded.
+     */
+    void clearAllCues();
+
+    /**
+     * @brief Checks whether a slot holds a cue.
+     * @param index The cue slot (0 - numCues-1).
+     * @return True if the slot holds a cue.
+     */
+    bool hasCue(int index) const;
+
+    /**
+     * @brief Gets the track position of a cue.
+     * @param index The cue slot (0 - numCues-1).
+     * @return The position in seconds, or -1 if the slot is empty.
+     */
+    double getCuePosition(int index) const;
+
+    /**
+     * @brief Gets the length of the resident audio of a cue.
+     * @param index The cue slot (0 - numCues-1).
+     * @return The length in seconds, or 0 if the slot is empty.
+     */
+    double getResidentLength(int index) const;
+
+    /**
+     * @brief Starts output from a cue's resident buffer.
+     *
+     * Called from the audio thread when a trigger event is drained. The
+     * caller moves the transport to the returned position while the
+     * resident audio plays.
+     *
+     * @param index The cue slot (0 - numCues-1).
+     * @return Track position in seconds where the resident audio ends, or -1 if the slot is empty.
+     */
+    double startCue(int index);
+
+    /**
+     * @brief Abandons the cue currently playing, if any.
+     *
+     * Called from the audio thread when the transport is moved elsewhere.
+     */
+    void cancelCue();
+
+private:
+    /**
+     * @brief Decoded audio starting at a cue point.
+     */
+    struct Resident {
+        juce::AudioBuffer<float> audio;  ///< The audio, in stereo.
+        double sourceSampleRate = 0.0;   ///< Sample rate of the audio.
+        double position = 0.0;           ///< Track position of the first sample, in seconds.
+    };
+
+    /**
+     * @brief A single hot cue and its resident audio.
+     */
+    struct Cue {
+        double position = -1.0;                     ///< Cue position in seconds, -1 when unset.
+        std::atomic<Resident*> resident { nullptr }; ///< Owned resident audio, or nullptr.
+    };
+
+    /**
+     * @brief Frees a replaced resident buffer, or keeps it while the audio thread reads it.
+     *
+     * Call with cueLock held.
+     *
+     * @param resident The buffer, or nullptr.
+     */
+    void retire(Resident* resident);
+
+    juce::AudioTransportSource* transportSource; ///< The transport being wrapped.
+
+    std::array<Cue, numCues> cues;        ///< The cue slots.
+    mutable juce::SpinLock cueLock;       ///< Serialises the other threads' access to the cues; never taken by the audio thread.
+    std::vector<std::unique_ptr<Resident>> retired; ///< Replaced buffers the audio thread may still be reading.
+    std::atomic<Resident*> playingResident { nullptr }; ///< Buffer the audio thread is reading; never freed while set.
+    Resident* activeResident = nullptr;   ///< Buffer of the active cue (audio thread only).
+
+    juce::LagrangeInterpolator interpolators[2]; ///< Converts resident audio to the device rate.
+
+    double deviceSampleRate = 0.0; ///< Sample rate the device is running at.
+    int activeCue = -1;            ///< Cue being played (audio thread only).
+    int activeReadPosition = 0;    ///< Read position inside the active cue (audio thread only).
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HotCueSource)
+};
@@ -1,105 +1,218 @@
-/*
- ==============================================================================
- 
- This file contains the basic startup code for a JUCE application.
- 
- ==============================================================================
- */
-
-#include <JuceHeader.h>
-#include "MainComponent.h"
-
-//==============================================================================
-class New_DJApplication  : public juce::JUCEApplication
-{
-    public:
-    //==============================================================================
-    New_DJApplication() {}
-    
-    const juce::String getApplicationName() override       { return ProjectInfo::projectName; }
-    const juce::String getApplicationVersion() override    { return ProjectInfo::versionString; }
-    bool moreThanOneInstanceAllowed() override             { return true; }
-    
-    //==============================================================================
-    void initialise (const juce::String& commandLine) override
-    {
-        // This method is where you should put your application's initialisation code..
-        
-        mainWindow.reset (new MainWindow (getApplicationName()));
-    }
-    
-    void shutdown() override
-    {
-        // Add your application's shutdown code here..
-        
-        mainWindow = nullptr; // (deletes our window)
-    }
-    
-    //==============================================================================
-    void systemRequestedQuit() override
-    {
-        // This is called when the app is being asked to quit: you can ignore this
-        // request and let the app carry on running, or call quit() to allow the app to close.
-        quit();
-    }
-    
-    void anotherInstanceStarted (const juce::String& commandLine) override
-    {
-        // When another instance of the app is launched while this one is running,
-        // this method is invoked, and the commandLine parameter tells you what
-        // the other instance's command-line arguments were.
-    }
-    
-    //==============================================================================
-    /*
-     This class implements the desktop window that contains an instance of
-     our MainComponent class.
-     */
-    class MainWindow    : public juce::DocumentWindow
-    {
-        public:
-        MainWindow (juce::String name)
-        : DocumentWindow (name,
-                          juce::Desktop::getInstance().getDefaultLookAndFeel()
-                          .findColour (juce::ResizableWindow::backgroundColourId),
-                          DocumentWindow::allButtons)
-        {
-            setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
-            
-#if JUCE_IOS || JUCE_ANDROID
-            setFullScreen (true);
-#else
-            setResizable (true, true);
-            centreWithSize (getWidth(), getHeight());
-#endif
-            
-            setVisible (true);
-        }
-        
-        void closeButtonPressed() override
-        {
-            // This is called when the user tries to close this window. Here, we'll just
-            // ask the app to quit when this happens, but you can change this to do
-            // whatever you need.
-            JUCEApplication::getInstance()->systemRequestedQuit();
-        }
-        
-        /* Note: Be careful if you override any DocumentWindow methods - the base
-         class uses a lot of them, so by overriding you might break its functionality.
-         It's best to do all your work in your content component instead, but if
-         you really have to override any DocumentWindow methods, make sure your
-         subclass also calls the superclass's method.
-         */
-        
-        private:
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
-    };
-    
-    private:
-    std::unique_ptr<MainWindow> mainWindow;
-};
-
-//==============================================================================
-// This macro generates the main() routine that launches the app.
-START_JUCE_APPLICATION (New_DJApplication)
+/*
+ ==============================================================================
+ 
+ This file contains the basic startup code for a JUCE application.
+ 
+ ==============================================================================
+ */
+
+#include <JuceHeader.h>
+#include "MainComponent.h"
+#include "AssetCache.h"
+#include "StartupProfiler.h"
+#include "CSVReader.h"
+#include "MidiControlSurface.h"
+#include "MixAutomation.h"
+#include "WaveformPyramid.h"
+#include "TrackLibrary.h"
+#include "TrackSearchIndex.h"
+
+//==============================================================================
+class New_DJApplication  : public juce::JUCEApplication
+{
+    public:
+    //==============================================================================
+    New_DJApplication() {}
+    
+    const juce::String getApplicationName() override       { return ProjectInfo::projectName; }
+    const juce::String getApplicationVersion() override    { return ProjectInfo::versionString; }
+    bool moreThanOneInstanceAllowed() override             { return true; }
+    
+    //==============================================================================
+    void initialise (const juce::String& commandLine) override
+    {
+        // This method is where you should put your application's initialisation code..
+        
+        // "--csv-benchmark [file.csv]" measures the CSV parser and exits without opening a window.
+        const auto arguments = juce::StringArray::fromTokens(commandLine, true);
+        const int benchmarkIndex = arguments.indexOf("--csv-benchmark");
+        if (benchmarkIndex >= 0)
+        {
+            const auto path = arguments[benchmarkIndex + 1].unquoted();
+            CSVReader::runBenchmark(path.isNotEmpty() && ! path.startsWith("--")
+                                        ? juce::File::getCurrentWorkingDirectory().getChildFile(path)
+                                        : juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("csv_benchmark.csv"));
+            quit();
+            return;
+        }
+        
+        // "--waveform-benchmark [file]" measures the waveform band split and pyramid build and exits.
+        const int waveformIndex = arguments.indexOf("--waveform-benchmark");
+        if (waveformIndex >= 0)
+        {
+            const auto path = arguments[waveformIndex + 1].unquoted();
+            WaveformPyramid::runBenchmark(path.isNotEmpty() && ! path.startsWith("--")
+                                              ? juce::File::getCurrentWorkingDirectory().getChildFile(path)
+                                              : juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("waveform_benchmark.wav"));
+            quit();
+            return;
+        }
+        
+        // "--library-benchmark [tracks]" measures opening a large track library and exits.
+        const int libraryIndex = arguments.indexOf("--library-benchmark");
+        if (libraryIndex >= 0)
+        {
+            const int numTracks = arguments[libraryIndex + 1].getIntValue();
+            TrackLibrary::runBenchmark(numTracks > 0 ? numTracks : 50000);
+            quit();
+            return;
+        }
+        
+        // "--search-benchmark [tracks]" measures library search on a synthetic index and exits.
+        const int searchIndex = arguments.indexOf("--search-benchmark");
+        if (searchIndex >= 0)
+        {
+            const int numTracks = arguments[searchIndex + 1].getIntValue();
+            TrackSearchIndex::runBenchmark(numTracks > 0 ? numTracks : 1000000);
+            quit();
+            return;
+        }
+        
+        // "--midi-latency" measures MIDI input to audio block latency and exits.
+        if (arguments.contains("--midi-latency"))
+        {
+            MidiControlSurface::runLatencyBenchmark();
+            quit();
+            return;
+        }
+        
+        // "--render-mix take.djmix [out.wav] [--block n]" renders a recorded take offline and exits.
+        const int renderIndex = arguments.indexOf("--render-mix");
+        if (renderIndex >= 0)
+        {
+            const auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+            const auto takeFile = workingDirectory.getChildFile(arguments[renderIndex + 1].unquoted());
+            const auto outputPath = arguments[renderIndex + 2].unquoted();
+            const auto outputFile = outputPath.isNotEmpty() && ! outputPath.startsWith("--")
+                                        ? workingDirectory.getChildFile(outputPath)
+                                        : takeFile.withFileExtension("wav");
+            const int blockIndex = arguments.indexOf("--block");
+            const int blockSize = blockIndex >= 0 ? arguments[blockIndex + 1].getIntValue() : 0;
+            
+            AutomationTake take;
+            if (! AutomationTake::readFrom(takeFile, take))
+                std::cout << "Could not read mix take " << takeFile.getFullPathName() << std::endl;
+            else if (! MixAutomation::renderOffline(take, outputFile, blockSize))
+                std::cout << "Could not render mix take to " << outputFile.getFullPathName() << std::endl;
+            else
+                std::cout << "Rendered " << take.events.size() << " control events over " << take.length
+                          << " samples to " << outputFile.getFullPathName() << std::endl;
+            
+            quit();
+            return;
+        }
+        
+        // "--automation-check take.djmix [--block n]" replays a take live and against an offline render, then exits.
+        const int checkIndex = arguments.indexOf("--automation-check");
+        if (checkIndex >= 0)
+        {
+            const auto takeFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments[checkIndex + 1].unquoted());
+            const int blockIndex = arguments.indexOf("--block");
+            const int blockSize = blockIndex >= 0 ? arguments[blockIndex + 1].getIntValue() : 0;
+            
+            AutomationTake take;
+            if (AutomationTake::readFrom(takeFile, take))
+                MixAutomation::runReplayCheck(take, blockSize);
+            else
+                std::cout << "Could not read mix take " << takeFile.getFullPathName() << std::endl;
+            
+            quit();
+            return;
+        }
+        
+        StartupProfiler::mark("JUCE initialised");
+        
+        // Decode the embedded artwork in parallel before the components ask for it.
+        AssetCache::preloadAll();
+        StartupProfiler::mark("assets decoded");
+        
+        mainWindow.reset (new MainWindow (getApplicationName()));
+        StartupProfiler::mark("window created");
+    }
+    
+    void shutdown() override
+    {
+        // Add your application's shutdown code here..
+        
+        mainWindow = nullptr; // (deletes our window)
+        AssetCache::clear();
+    }
+    
+    //==============================================================================
+    void systemRequestedQuit() override
+    {
+        // This is called when the app is being asked to quit: you can ignore this
+        // request and let the app carry on running, or call quit() to allow the app to close.
+        quit();
+    }
+    
+    void anotherInstanceStarted (const juce::String& commandLine) override
+    {
+        // When another instance of the app is launched while this one is running,
+        // this method is invoked, and the commandLine parameter tells you what
+        // the other instance's command-line arguments were.
+    }
+    
+    //==============================================================================
+    /*
+     This class implements the desktop window that contains an instance of
+     our MainComponent class.
+     */
+    class MainWindow    : public juce::DocumentWindow
+    {
+        public:
+        MainWindow (juce::String name)
+        : DocumentWindow (name,
+                          juce::Desktop::getInstance().getDefaultLookAndFeel()
+                          .findColour (juce::ResizableWindow::backgroundColourId),
+                          DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar (true);
+            setContentOwned (new MainComponent(), true);
+            
+#if JUCE_IOS || JUCE_ANDROID
+            setFullScreen (true);
+#else
+            setResizable (true, true);
+            centreWithSize (getWidth(), getHeight());
+#endif
+            
+            setVisible (true);
+        }
+        
+        void closeButtonPressed() override
+        {
+            // This is called when the user tries to close this window. Here, we'll just
+            // ask the app to quit when this happens, but you can change this to do
+            // whatever you need.
+            JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+        
+        /* Note: Be careful if you override any DocumentWindow methods - the base
+         class uses a lot of them, so by overriding you might break its functionality.
+         It's best to do all your work in your content component instead, but if
+         you really have to override any DocumentWindow methods, make sure your
+         subclass also calls the superclass's method.
+         */
+        
+        private:
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
+    };
+    
+    private:
+    std::unique_ptr<MainWindow> mainWindow;
+};
+
+//==============================================================================
+// This macro generates the main() routine that launches the app.
+START_JUCE_APPLICATION (New_DJApplication)
@@ -1,136 +1,355 @@
-/**
- * =================================================================
- * @file MainComponent.cpp
- * @brief Implementation of the MainComponent class.
- *
- * This component sets up the main window of the application, initializes
- * audio settings, and arranges the child components.
- */
-
-#include "MainComponent.h"
-
-/**
- * @brief Constructs a MainComponent object.
- *
- * Sets the window size, handles audio permission requests,
- * configures audio channels, and adds the child components to the main window.
- */
-MainComponent::MainComponent()
-{
-    // Set the size of the main component (width: 1920, height: 1080 pixels).
-    setSize (1920, 1080);
-    
-    // Check if runtime permission is required for recording audio.
-    // If required but not yet granted, request permission and set audio channels based on the result.
-    if (juce::RuntimePermissions::isRequired (juce::RuntimePermissions::recordAudio)
-        && !juce::RuntimePermissions::isGranted (juce::RuntimePermissions::recordAudio))
-    {
-        juce::RuntimePermissions::request (juce::RuntimePermissions::recordAudio,
-                                           [&] (bool granted) { setAudioChannels (granted ? 2 : 0, 2); });
-    }
-    else
-    {
-        // If permission is not required or is already granted, initialize with 1 input and 1 output channel.
-        setAudioChannels (1, 1);
-    }
-    
-    // Add child components and make them visible.
-    addAndMakeVisible(deck1);
-    addAndMakeVisible(deck2);
-    
-    /**
-     * ==============================================================
-     * Author: Jacques Thurling
-     * 13 Mar 2020
-     * ==============================================================
-     */
-    addAndMakeVisible(mixerView);
-    addAndMakeVisible(playlistComponent);
-    /// ==============================================================
-}
-
-/**
- * @brief Destructor for MainComponent.
- *
- * Shuts down the audio device and releases audio resources.
- */
-MainComponent::~MainComponent()
-{
-    shutdownAudio();
-}
-
-/**
- * @brief Prepares the audio system for playback.
- *
- * Called before playback starts to configure the audio mixer with expected settings.
- *
- * @param samplesPerBlockExpected The expected number of samples per audio block.
- * @param sampleRate The audio sample rate.
- */
-void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    // Add two audio players as input sources for the mixer.
-    mixer.addInputSource(&player1, false);
-    mixer.addInputSource(&player2, false);
-    
-    // Prepare the mixer with the expected block size and sample rate.
-    mixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
-}
-
-/**
- * @brief Provides the next block of audio data.
- *
- * Delegates the task of filling the audio buffer to the mixer.
- *
- * @param bufferToFill Structure containing the audio buffer to be filled.
- */
-void MainComponent::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
-{
-    mixer.getNextAudioBlock(bufferToFill);
-}
-
-/**
- * @brief Releases audio resources.
- *
- * Removes all inputs from the mixer and releases resources for the mixer and audio players.
- */
-void MainComponent::releaseResources()
-{
-    mixer.removeAllInputs();
-    mixer.releaseResources();
-    player1.releaseResources();
-    player2.releaseResources();
-}
-
-/**
- * @brief Renders the component.
- *
- * Fills the background with a solid grey color and serves as a placeholder for any additional drawing code.
- *
- * @param g The graphics context used for drawing.
- */
-void MainComponent::paint (juce::Graphics& g)
-{
-    g.fillAll (juce::Colours::grey);
-    // Additional drawing code can be added here if needed.
-}
-
-/**
- * @brief Handles component resizing.
- *
- * Adjusts the positions and sizes of all child components when the main component is resized.
- */
-void MainComponent::resized()
-{
-    // Set bounds for deck1: positioned at the left.
-    deck1.setBounds(0, 0, (getWidth() / 8) * 3, (getHeight() / 5) * 4);
-    
-    // Set bounds for deck2: positioned at the right.
-    deck2.setBounds((getWidth() / 8) * 5, 0, (getWidth() / 8) * 3, (getHeight() / 5) * 4);
-    
-    // Set bounds for mixerView: positioned in the center.
-    mixerView.setBounds((getWidth() / 8) * 3, 0, (getWidth() / 8) * 2, (getHeight() / 5) * 4);
-    
-    // Set bounds for playlistComponent: positioned at the bottom.
-    playlistComponent.setBounds(0, (getHeight() / 5) * 4, getWidth(), (getHeight() / 5) * 1);
-}
+/**
+ * =================================================================
+ * @file MainComponent.cpp
+ * @brief Implementation of the MainComponent class.
+ *
+ * This component sets up the main window of the application, initializes
+ * audio settings, and arranges the child components.
+ */
+
+#include "MainComponent.h"
+#include "StartupProfiler.h"
+#include "AssetCache.h"
+
+/**
+ * @brief Constructs a MainComponent object.
+ *
+ * Sets the window size, handles audio permission requests,
+ * configures audio channels, and adds the child components to the main window.
+ */
+MainComponent::MainComponent()
+{
+    // Set the size of the main component (width: 1920, height: 1080 pixels).
+    setSize (1920, 1080);
+    
+    // Check if runtime permission is required for recording audio.
+    // If required but not yet granted, request permission and set audio channels based on the result.
+    if (juce::RuntimePermissions::isRequired (juce::RuntimePermissions::recordAudio)
+        && !juce::RuntimePermissions::isGranted (juce::RuntimePermissions::recordAudio))
+    {
+        juce::RuntimePermissions::request (juce::RuntimePermissions::recordAudio,
+                                           [&] (bool granted) { setAudioChannels (granted ? 2 : 0, 2); });
+    }
+    else
+    {
+        // If permission is not required or is already granted, initialize with 1 input and 1 output channel.
+        setAudioChannels (1, 1);
+    }
+    
+    // Add child components and make them visible.
+    addAndMakeVisible(deck1);
+    addAndMakeVisible(deck2);
+    
+    /**
+     * ==============================================================
+     * Author: Jacques Thurling
+     * 13 Mar 2020
+     * ==============================================================
+     */
+    addAndMakeVisible(mixerView);
+    addAndMakeVisible(playlistComponent);
+    
+    // Scanned metadata doubles as the library's analysis results, and the library is the only place they are kept.
+    metadataService.onScanned = [this](const juce::File& file, const TrackMetadata& metadata) {
+        library.setAnalysis(library.findTrack(file), metadata);
+        updateDeckTempos(file);
+    };
+    metadataService.findStored = [this](const juce::File& file, TrackMetadata& metadata) {
+        metadata = library.getTrack(library.findTrack(file)).analysis;
+        return metadata.ready;
+    };
+    
+    // Files and folders dropped on a deck join the library as well.
+    deck1.onFilesDropped = deck2.onFilesDropped = [this](const juce::StringArray& files) {
+        library.import(files);
+    };
+    
+    // Suggestions follow whichever deck is playing.
+    deck1.onStateChanged = deck2.onStateChanged = [this] {
+        playlistComponent.updateSuggestions();
+        updateDeckTempos();
+    };
+    
+    // Analysis for the deck and master meters runs off the audio thread.
+    analysisThread.addTimeSliceClient(&player1.getAnalyser());
+    analysisThread.addTimeSliceClient(&player2.getAnalyser());
+    analysisThread.addTimeSliceClient(&masterAnalyser);
+    analysisThread.startThread();
+    
+    // One frame clock animates everything, capped at 60 fps.
+    frameClock.setFrameCap(60.0);
+    frameClock.addListener(&deck1);
+    frameClock.addListener(&deck2);
+    frameClock.addListener(&mixerView);
+    
+    // Bring back the controls from the last session, then keep it up to date.
+    deck1.restoreState(session.getRestoredState());
+    deck2.restoreState(session.getRestoredState());
+    mixerView.restoreState(session.getRestoredState());
+    restoreDecks();
+    startTimer(sessionCaptureIntervalMs);
+    
+    // Controllers drive the players directly; the controls follow on the message thread.
+    midiSurface.onControlChanged = [this](int deck, MidiControlSurface::Control control, double value) {
+        (deck == 0 ? deck1 : deck2).showControlValue(control, value);
+        mixerView.showControlValue(deck, control, value);
+    };
+    midiSurface.openAllDevices();
+    oscRemote.start();
+    
+    // Takes are saved as soon as recording stops.
+    mixerView.onRecordToggled = [this](bool shouldRecord) {
+        if (shouldRecord)
+            automation.startRecording();
+        else
+            saveTake(automation.stopRecording());
+    };
+    mixerView.onReplayClicked = [this] {
+        if (automation.isReplaying())
+            automation.stopPlaying();
+        else
+            chooseTake();
+    };
+    
+    StartupProfiler::mark("main component built");
+    /// ==============================================================
+}
+
+/**
+ * @brief Destructor for MainComponent.
+ *
+ * Shuts down the audio device and releases audio resources.
+ */
+MainComponent::~MainComponent()
+{
+    stopTimer();
+    session.update(captureSession());
+    shutdownAudio();
+    analysisThread.stopThread(1000);
+}
+
+/**
+ * @brief Prepares the audio system for playback.
+ *
+ * Called before playback starts to configure the audio mixer with expected settings.
+ *
+ * @param samplesPerBlockExpected The expected number of samples per audio block.
+ * @param sampleRate The audio sample rate.
+ */
+void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    // Add two audio players as input sources for the mixer.
+    mixer.addInputSource(&player1, false);
+    mixer.addInputSource(&player2, false);
+    
+    // Prepare the mixer with the expected block size and sample rate.
+    mixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    
+    // Prepare the master limiter; its lookahead is a fixed delay on the output.
+    limiter.prepare(sampleRate, samplesPerBlockExpected);
+    masterAnalyser.prepare(sampleRate);
+    automation.prepare(sampleRate);
+    DBG("MainComponent::prepareToPlay master limiter latency: " << limiter.getLatencySamples() << " samples");
+}
+
+/**
+ * @brief Provides the next block of audio data.
+ *
+ * Delegates the task of filling the audio buffer to the mixer, then passes
+ * the mixed signal through the master limiter so the output never clips.
+ * The block is bracketed for mix automation; a take starting to replay
+ * resets the limiter, so the replay matches an offline render of the take.
+ *
+ * @param bufferToFill Structure containing the audio buffer to be filled.
+ */
+void MainComponent::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (automation.beginBlock(bufferToFill))
+        limiter.reset();
+    
+    mixer.getNextAudioBlock(bufferToFill);
+    limiter.process(bufferToFill);
+    automation.endBlock(bufferToFill);
+    masterAnalyser.process(bufferToFill);
+}
+
+/**
+ * @brief Releases audio resources.
+ *
+ * Removes all inputs from the mixer and releases resources for the mixer and audio players.
+ */
+void MainComponent::releaseResources()
+{
+    mixer.removeAllInputs();
+    mixer.releaseResources();
+    limiter.reset();
+    player1.releaseResources();
+    player2.releaseResources();
+}
+
+/**
+ * @brief Opens every deck's saved track at once and seeks each to its saved position.
+ *
+ * Runs once, from the constructor. Each deck opens its file on its own
+ * loader thread, so the decks load side by side and the message thread
+ * stays free; the profiler reports when the last one is ready to play.
+ */
+void MainComponent::restoreDecks()
+{
+    const std::array<std::pair<DeckGUI*, DeckState>, 2> decks {{{&deck1, states[0]}, {&deck2, states[1]}}};
+    auto remaining = std::make_shared<int>(0);
+    
+    for (const auto& [deck, state] : decks)
+    {
+        if (state.file_name.empty())
+            continue;
+        
+        // Sessions store full paths; the CSV file names tracks in the Assets folder.
+        const juce::String fileName (state.file_name);
+        const auto file = juce::File::isAbsolutePath(fileName) ? juce::File(fileName) : AssetCache::getAssetFile(fileName);
+        
+        ++*remaining;
+        deck->loadUrlAsync(juce::URL(file), state.position, [remaining] {
+            if (--*remaining == 0)
+                StartupProfiler::sessionRestored();
+        });
+    }
+}
+
+/**
+ * @brief Captures the deck and mixer state and hands it to the session store.
+ *
+ * Capturing only reads the controls; working out what changed and writing
+ * it happens on the store's thread. The mix automation buttons follow the
+ * automation here too, as a replay ends on its own.
+ */
+void MainComponent::timerCallback()
+{
+    session.update(captureSession());
+    mixerView.showAutomationState(automation.isRecording(), automation.isReplaying());
+}
+
+/**
+ * @brief Collects the current deck and mixer state.
+ * @return The session state.
+ */
+juce::NamedValueSet MainComponent::captureSession() const
+{
+    juce::NamedValueSet values;
+    deck1.saveState(values);
+    deck2.saveState(values);
+    mixerView.saveState(values);
+    return values;
+}
+
+/**
+ * @brief Gives each player the tempo of its track, for the OSC telemetry.
+ *
+ * Tracks loaded from outside the library are scanned on request; this runs
+ * again for the deck playing a file when that file's scan arrives.
+ *
+ * @param scanned If set, only decks playing this file are updated.
+ */
+void MainComponent::updateDeckTempos(const juce::File& scanned)
+{
+    for (auto [deck, player] : { std::pair<DeckGUI*, DJAudioPlayer*> { &deck1, &player1 }, { &deck2, &player2 } }) {
+        const auto& url = deck->getLoadedUrl();
+        
+        if (scanned != juce::File() && (! url.isLocalFile() || url.getLocalFile() != scanned)) {
+            continue;
+        }
+        
+        float bpm = 0.0f;
+        
+        if (url.isLocalFile()) {
+            bpm = metadataService.getMetadata(metadataService.request(url.getLocalFile())).bpm;
+        }
+        
+        player->setTrackTempo(bpm);
+    }
+}
+
+/**
+ * @brief Writes a recorded take to the takes folder.
+ * @param take The take.
+ */
+void MainComponent::saveTake(const AutomationTake& take)
+{
+    // Recording was stopped before the audio thread started the take.
+    if (take.length <= 0) {
+        return;
+    }
+    
+    const auto directory = MixAutomation::getTakesDirectory();
+    directory.createDirectory();
+    
+    const auto file = directory.getChildFile("mix " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".djmix");
+    
+    if (! take.writeTo(file)) {
+        DBG("MainComponent::saveTake could not write " + file.getFullPathName());
+    }
+}
+
+/**
+ * @brief Lets the user pick a saved take and replays it.
+ *
+ * Tracks the take needs are loaded through the decks first, so their
+ * waveforms and hot cues follow; the automation then finds them loaded.
+ */
+void MainComponent::chooseTake()
+{
+    takeChooser = std::make_unique<juce::FileChooser>("Replay mix", MixAutomation::getTakesDirectory(), "*.djmix");
+    
+    takeChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                             [this](const juce::FileChooser& chooser) {
+        AutomationTake take;
+        
+        if (! AutomationTake::readFrom(chooser.getResult(), take))
+            return;
+        
+        for (auto [deck, start] : { std::pair<DeckGUI*, AutomationTake::DeckStart*> { &deck1, &take.decks[0] }, { &deck2, &take.decks[1] } }) {
+            const juce::URL url { juce::File(start->track) };
+            
+            if (start->track.isNotEmpty() && deck->getLoadedUrl() != url)
+                deck->loadUrl(url);
+        }
+        
+        if (! automation.play(take))
+            DBG("MainComponent::chooseTake could not replay " + chooser.getResult().getFullPathName());
+        
+        mixerView.showAutomationState(automation.isRecording(), automation.isReplaying());
+    });
+}
+
+/**
+ * @brief Renders the component.
+ *
+ * Fills the background with a solid grey color and serves as a placeholder for any additional drawing code.
+ *
+ * @param g The graphics context used for drawing.
+ */
+void MainComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::grey);
+    // Additional drawing code can be added here if needed.
+}
+
+/**
+ * @brief Handles component resizing.
+ *
+ * Adjusts the positions and sizes of all child components when the main component is resized.
+ */
+void MainComponent::resized()
+{
+    // Set bounds for deck1: positioned at the left.
+    deck1.setBounds(0, 0, (getWidth() / 8) * 3, (getHeight() / 5) * 4);
+    
+    // Set bounds for deck2: positioned at the right.
+    deck2.setBounds((getWidth() / 8) * 5, 0, (getWidth() / 8) * 3, (getHeight() / 5) * 4);
+    
+    // Set bounds for mixerView: positioned in the center.
+    mixerView.setBounds((getWidth() / 8) * 3, 0, (getWidth() / 8) * 2, (getHeight() / 5) * 4);
+    
+    // Set bounds for playlistComponent: positioned at the bottom.
+    playlistComponent.setBounds(0, (getHeight() / 5) * 4, getWidth(), (getHeight() / 5) * 1);
+}
@@ -1,102 +1,181 @@
-/**
- * =================================================================
- * @file MainComponent.cpp
- * @brief Implementation of the MainComponent class.
- *
- * This component sets up the main window of the application, initializes
- * audio settings, and arranges the child components.
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-
-#include "DJAudioPlayer.h"
-#include "DeckGUI.h"
-#include "Playlist.h"
-#include "MixerView.h"
-#include "CSVReader.h"
-
-//==============================================================================
-/**
- * MainComponent class represents the central component of the application.
- * It manages the audio playback, GUI components, and user interactions.
- */
-class MainComponent  : public juce::AudioAppComponent
-{
-    public:
-    //==============================================================================
-    /**
-     * Constructor: Initializes the MainComponent and sets up the necessary components.
-     */
-    MainComponent();
-    
-    /**
-     * Destructor: Cleans up resources when the MainComponent is destroyed.
-     */
-    ~MainComponent() override;
-    
-    //==============================================================================
-    /**
-     * Prepares the audio system for playback.
-     * Called before playback starts.
-     * @param samplesPerBlockExpected The expected number of samples per block.
-     * @param sampleRate The audio sample rate.
-     */
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-    
-    /**
-     * Processes and provides the next block of audio data.
-     * @param bufferToFill The buffer that needs to be filled with audio data.
-     */
-    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
-    
-    /**
-     * Releases any allocated audio resources when playback stops.
-     */
-    void releaseResources() override;
-    
-    //==============================================================================
-    /**
-     * Handles painting of the component.
-     * @param g The graphics context used for drawing.
-     */
-    void paint (juce::Graphics& g) override;
-    
-    /**
-     * Handles resizing of the component and repositioning of child components.
-     */
-    void resized() override;
-    
-    private:
-    //==============================================================================
-    // Manages audio format readers.
-    juce::AudioFormatManager formatManager;
-    
-    // Caches audio thumbnails for faster waveform rendering.
-    juce::AudioThumbnailCache thumbnailCache {20};
-    
-    // Reads deck states from a CSV file.
-    CSVReader reader;
-    std::vector<DeckState> states = reader.readCSV();
-    
-    // First deck and its associated player.
-    DJAudioPlayer player1;
-    DeckGUI deck1 {&player1, formatManager, thumbnailCache, "deck_a", states[0]};
-    
-    // Second deck and its associated player.
-    DJAudioPlayer player2;
-    DeckGUI deck2 {&player2, formatManager, thumbnailCache, "deck_b", states[1]};
-    
-    // Mixer view that allows volume control and crossfading between decks.
-    MixerView mixerView{&player1, &player2};
-    
-    // Playlist component that manages track loading and display.
-    Playlist playlistComponent {formatManager, thumbnailCache, deck1, deck2, &states};
-    
-    // Mixer that combines audio signals from different sources.
-    juce::MixerAudioSource mixer;
-    
-    // JUCE macro to prevent copying and enable leak detection.
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
-};
+/**
+ * =================================================================
+ * @file MainComponent.cpp
+ * @brief Implementation of the MainComponent class.
+ *
+ * This component sets up the main window of the application, initializes
+ * audio settings, and arranges the child components.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "DJAudioPlayer.h"
+#include "DeckGUI.h"
+#include "Playlist.h"
+#include "MixerView.h"
+#include "CSVReader.h"
+#include "MasterLimiter.h"
+#include "WaveformCache.h"
+#include "FrameClock.h"
+#include "TrackMetadataService.h"
+#include "TrackLibrary.h"
+#include "SessionStore.h"
+#include "MidiControlSurface.h"
+#include "OscRemote.h"
+#include "MixAutomation.h"
+
+//==============================================================================
+/**
+ * MainComponent class represents the central component of the application.
+ * It manages the audio playback, GUI components, and user interactions.
+ */
+class MainComponent  : public juce::AudioAppComponent,
+                       private juce::Timer
+{
+    public:
+    //==============================================================================
+    /**
+     * Constructor: Initializes the MainComponent and sets up the necessary components.
+     */
+    MainComponent();
+    
+    /**
+     * Destructor: Cleans up resources when the MainComponent is destroyed.
+     */
+    ~MainComponent() override;
+    
+    //==============================================================================
+    /**
+     * Prepares the audio system for playback.
+     * Called before playback starts.
+     * @param samplesPerBlockExpected The expected number of samples per block.
+     * @param sampleRate The audio sample rate.
+     */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    
+    /**
+     * Processes and provides the next block of audio data.
+     * @param bufferToFill The buffer that needs to be filled with audio data.
+     */
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+    
+    /**
+     * Releases any allocated audio resources when playback stops.
+     */
+    void releaseResources() override;
+    
+    //==============================================================================
+    /**
+     * Handles painting of the component.
+     * @param g The graphics context used for drawing.
+     */
+    void paint (juce::Graphics& g) override;
+    
+    /**
+     * Handles resizing of the component and repositioning of child components.
+     */
+    void resized() override;
+    
+    private:
+    /**
+     * Captures the deck and mixer state and hands it to the session store.
+     */
+    void timerCallback() override;
+    
+    /**
+     * Collects the current deck and mixer state.
+     * @return The session state.
+     */
+    juce::NamedValueSet captureSession() const;
+    
+    /**
+     * Opens every deck's saved track at once and seeks each to its saved position.
+     */
+    void restoreDecks();
+    
+    /**
+     * Gives each player the tempo of its track, for the OSC telemetry.
+     * @param scanned If set, only decks playing this file are updated.
+     */
+    void updateDeckTempos(const juce::File& scanned = {});
+    
+    /**
+     * Writes a recorded take to the takes folder.
+     * @param take The take.
+     */
+    void saveTake(const AutomationTake& take);
+    
+    /**
+     * Lets the user pick a saved take and replays it.
+     */
+    void chooseTake();
+    
+    //==============================================================================
+    // Manages audio format readers.
+    juce::AudioFormatManager formatManager;
+    
+    // Builds each track's waveform pyramid once and shares it between views.
+    WaveformCache waveformCache {formatManager};
+    
+    // Scans track lengths and tags in the background for the playlist.
+    TrackMetadataService metadataService {formatManager};
+    
+    // Persistent library of tracks, analysis results and crates.
+    TrackLibrary library {formatManager};
+    
+    // Journals the deck and mixer state so a crash restores the set.
+    SessionStore session;
+    
+    // How often the session state is captured; a crash loses at most this much.
+    static constexpr int sessionCaptureIntervalMs = 250;
+    
+    // Deck states from the last session, falling back to the CSV file on the first run.
+    CSVReader reader;
+    std::vector<DeckState> states = session.getDeckStates(reader.readCSV());
+    
+    // First deck and its associated player.
+    DJAudioPlayer player1;
+    DeckGUI deck1 {&player1, waveformCache, "deck_a", states[0]};
+    
+    // Second deck and its associated player.
+    DJAudioPlayer player2;
+    DeckGUI deck2 {&player2, waveformCache, "deck_b", states[1]};
+    
+    // Records and replays both decks' control movements, sample-accurately.
+    MixAutomation automation {&player1, &player2};
+    
+    // Picks a saved take to replay.
+    std::unique_ptr<juce::FileChooser> takeChooser;
+    
+    // Brickwall limiter on the master bus, after the decks are mixed.
+    MasterLimiter limiter;
+    
+    // Metering tap on the master bus, after the limiter.
+    AudioAnalyser masterAnalyser;
+    
+    // Mixer view that allows volume control and crossfading between decks.
+    MixerView mixerView{&player1, &player2, &limiter, &masterAnalyser};
+    
+    // MIDI controller input for both decks and the mixer.
+    MidiControlSurface midiSurface {&player1, &player2};
+    
+    // OSC telemetry out and remote control in, through the same controls as MIDI.
+    OscRemote oscRemote {midiSurface, &player1, &player2};
+    
+    // Playlist component that manages track loading and display.
+    Playlist playlistComponent {formatManager, waveformCache, metadataService, library, deck1, deck2};
+    
+    // Mixer that combines audio signals from different sources.
+    juce::MixerAudioSource mixer;
+    
+    // Background thread doing the metering and spectrum work for every tap.
+    juce::TimeSliceThread analysisThread {"Audio analysis"};
+    
+    // Display-synchronised clock driving the platters, playheads and meters.
+    FrameClock frameClock {*this};
+    
+    // JUCE macro to prevent copying and enable leak detection.
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
+};
@@ -0,0 +1,285 @@
+/**
+ * =================================================================
+ * @file MasterLimiter.cpp
+ * @brief Implementation of the MasterLimiter class.
+ *
+ * Created: 18 Oct 2026 1:47:20pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "MasterLimiter.h"
+
+/**
+ * @brief Constructor for MasterLimiter.
+ *
+ * Designs the polyphase filters used by the true-peak detector. Phase k
+ * estimates the signal k/4 of a sample after the centre tap using a
+ * Hann-windowed sinc, so phase 0 is the centre sample itself.
+ */
+MasterLimiter::MasterLimiter()
+{
+    for (int phase = 0; phase < oversampling; ++phase)
+    {
+        const double fraction = (double) phase / oversampling;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            const double t = tap - interpolatorDelay + fraction;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+            const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * t / (interpolatorDelay + 1)));
+            phaseCoefficients[(size_t) phase][(size_t) tap] = (float) (sinc * window);
+            sum += sinc * window;
+        }
+
+        for (auto& coefficient : phaseCoefficients[(size_t) phase])
+            coefficient = (float) (coefficient / sum);
+    }
+}
+
+/**
+ * @brief Destructor for MasterLimiter.
+ */
+MasterLimiter::~MasterLimiter()
+{
+}
+
+/**
+ * @brief Allocates all buffers and resets the limiter.
+ *
+ * The lookahead is fixed at 2 ms, so the latency only depends on the
+ * sample rate.
+ *
+ * @param newSampleRate The device sample rate.
+ * @param maximumBlockSize The largest block that will be processed at once.
+ */
+void MasterLimiter::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    windowLength = juce::jmax(1, juce::roundToInt(0.002 * sampleRate));
+    latency = interpolatorDelay + windowLength - 1;
+
+    inputHistory.setSize(maxChannels, tapsPerPhase - 1 + maxBlockSize);
+    delayLine.setSize(maxChannels, latency + maxBlockSize);
+
+    peaks.assign((size_t) (windowLength - 1 + maxBlockSize), 0.0f);
+    prefixMax.assign(peaks.size(), 0.0f);
+    suffixMax.assign(peaks.size(), 0.0f);
+    windowMax.assign((size_t) maxBlockSize, 0.0f);
+    boxHistory.assign((size_t) windowLength, 1.0f);
+
+    reset();
+}
+
+/**
+ * @brief Clears the delay line and gain state.
+ */
+void MasterLimiter::reset()
+{
+    inputHistory.clear();
+    delayLine.clear();
+    std::fill(peaks.begin(), peaks.end(), 0.0f);
+    std::fill(boxHistory.begin(), boxHistory.end(), 1.0f);
+    boxIndex = 0;
+    boxSum = windowLength;
+    currentGain = 1.0f;
+    gainReductionDb.store(0.0f);
+}
+
+/**
+ * @brief Limits a block of audio in place.
+ *
+ * Blocks larger than the prepared size are split into chunks so that no
+ * buffer ever needs to grow on the audio thread.
+ *
+ * @param bufferToFill The master bus block to process.
+ */
+void MasterLimiter::process(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (maxBlockSize == 0)
+        return;
+
+    ceiling = ceilingTarget.load();
+    releaseCoefficient = (float) std::exp(-1.0 / (releaseMsTarget.load() * 0.001 * sampleRate));
+
+    for (int offset = 0; offset < bufferToFill.numSamples; offset += maxBlockSize)
+    {
+        const int numSamples = juce::jmin(maxBlockSize, bufferToFill.numSamples - offset);
+        processChunk(*bufferToFill.buffer, bufferToFill.startSample + offset, numSamples);
+    }
+}
+
+/**
+ * @brief Processes a chunk no longer than the prepared block size.
+ * @param buffer The buffer holding the audio.
+ * @param startSample First sample of the chunk.
+ * @param numSamples Length of the chunk.
+ */
+void MasterLimiter::processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+
+    detectTruePeaks(buffer, startSample, numSamples, numChannels);
+    slidingWindowMax(numSamples);
+
+    // Turn the windowed peaks into a gain curve, written back over windowMax.
+    float lowestGain = 1.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float peak = windowMax[(size_t) i];
+        const float required = peak > ceiling ? ceiling / peak : 1.0f;
+
+        // Box filter over the held gain: the average can never exceed the
+        // requirement of any peak inside the window.
+        boxSum += required - boxHistory[(size_t) boxIndex];
+        boxHistory[(size_t) boxIndex] = required;
+        boxIndex = (boxIndex + 1) % windowLength;
+
+        const float target = (float) (boxSum / windowLength);
+
+        if (target < currentGain)
+            currentGain = target;
+        else
+            currentGain = target + (currentGain - target) * releaseCoefficient;
+
+        windowMax[(size_t) i] = currentGain;
+        lowestGain = juce::jmin(lowestGain, currentGain);
+    }
+
+    // Delay the audio by the lookahead and apply the gain curve.
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* delayed = delayLine.getWritePointer(channel);
+        float* output = buffer.getWritePointer(channel, startSample);
+
+        juce::FloatVectorOperations::copy(delayed + latency, output, numSamples);
+        juce::FloatVectorOperations::multiply(output, delayed, windowMax.data(), numSamples);
+        std::memmove(delayed, delayed + numSamples, sizeof(float) * (size_t) latency);
+    }
+
+    // Publish the worst reduction until the UI collects it.
+    const float reductionDb = juce::Decibels::gainToDecibels(lowestGain);
+    float previous = gainReductionDb.load();
+
+    while (reductionDb < previous && ! gainReductionDb.compare_exchange_weak(previous, reductionDb))
+    {
+    }
+}
+
+/**
+ * @brief Measures the true peak of every sample in a chunk.
+ *
+ * Each channel is interpolated at three points between samples; the largest
+ * absolute value over all channels and phases is written to the peak
+ * envelope after the window history.
+ *
+ * @param buffer The buffer holding the audio.
+ * @param startSample First sample of the chunk.
+ * @param numSamples Length of the chunk.
+ * @param numChannels Number of channels to measure.
+ */
+void MasterLimiter::detectTruePeaks(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannels)
+{
+    float* peakOut = peaks.data() + windowLength - 1;
+    juce::FloatVectorOperations::clear(peakOut, numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* history = inputHistory.getWritePointer(channel);
+        juce::FloatVectorOperations::copy(history + tapsPerPhase - 1, buffer.getReadPointer(channel, startSample), numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* newest = history + i + tapsPerPhase - 1;
+            float peak = std::abs(newest[-interpolatorDelay]);
+
+            for (int phase = 1; phase < oversampling; ++phase)
+            {
+                const auto& coefficients = phaseCoefficients[(size_t) phase];
+                float sum = 0.0f;
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    sum += coefficients[(size_t) tap] * newest[-tap];
+
+                peak = juce::jmax(peak, std::abs(sum));
+            }
+
+            peakOut[i] = juce::jmax(peakOut[i], peak);
+        }
+
+        std::memmove(history, history + numSamples, sizeof(float) * (size_t) (tapsPerPhase - 1));
+    }
+}
+
+/**
+ * @brief Computes the maximum of each lookahead window over the peak history.
+ *
+ * Uses the van Herk / Gil-Werman method: running maxima are computed forwards
+ * and backwards within segments of the window length, and every window's
+ * maximum is then one vectorised max of the two, independent of the window
+ * length.
+ *
+ * @param numSamples Number of new peak values.
+ */
+void MasterLimiter::slidingWindowMax(int numSamples)
+{
+    const int length = windowLength - 1 + numSamples;
+
+    for (int i = 0; i < length; ++i)
+        prefixMax[(size_t) i] = (i % windowLength == 0) ? peaks[(size_t) i]
+                                                         : juce::jmax(prefixMax[(size_t) i - 1], peaks[(size_t) i]);
+
+    for (int i = length - 1; i >= 0; --i)
+        suffixMax[(size_t) i] = (i == length - 1 || i % windowLength == windowLength - 1) ? peaks[(size_t) i]
+                                                                                         : juce::jmax(suffixMax[(size_t) i + 1], peaks[(size_t) i]);
+
+    juce::FloatVectorOperations::max(windowMax.data(), suffixMax.data(), prefixMax.data() + windowLength - 1, numSamples);
+
+    // Keep the last windowLength - 1 peaks as history for the next chunk.
+    std::memmove(peaks.data(), peaks.data() + numSamples, sizeof(float) * (size_t) (windowLength - 1));
+}
+
+/**
+ * @brief Sets the highest true-peak level allowed at the output.
+ * @param ceilingDb The ceiling in dBTP (e.g. -1.0).
+ */
+void MasterLimiter::setCeiling(float ceilingDb)
+{
+    ceilingTarget.store(juce::Decibels::decibelsToGain(ceilingDb));
+}
+
+/**
+ * @brief Sets how quickly the gain recovers after a peak.
+ * @param releaseMs The release time in milliseconds.
+ */
+void MasterLimiter::setRelease(float releaseMs)
+{
+    if (releaseMs <= 0)
+    {
+        std::cout << "MasterLimiter::setRelease release should be greater than 0" << std::endl;
+        return;
+    }
+
+    releaseMsTarget.store(releaseMs);
+}
+
+/**
+ * @brief Gets the fixed delay the limiter adds to the master bus.
+ * @return The latency in samples.
+ */
+int MasterLimiter::getLatencySamples() const
+{
+    return latency;
+}
+
+/**
+ * @brief Gets the largest gain reduction applied since the last call.
+ * @return The gain reduction in decibels (0 or negative).
+ */
+float MasterLimiter::getGainReductionDb()
+{
+    return gainReductionDb.exchange(0.0f);
+}
@@ -0,0 +1,150 @@
+/**
+ * =================================================================
+ * @file MasterLimiter.h
+ * @brief Declaration of the MasterLimiter class.
+ *
+ * This file declares the lookahead brickwall limiter that sits on the master
+ * bus, after the two decks have been mixed together.
+ *
+ * Created: 18 Oct 2026 1:47:20pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class MasterLimiter
+ * @brief Lookahead brickwall limiter with true-peak detection.
+ *
+ * Peaks are measured on a 4x oversampled version of the signal so that
+ * inter-sample overs are caught. The required gain is held over the
+ * lookahead window with a sliding-window maximum, smoothed with a box filter
+ * of the same length (which guarantees the gain is already down when the
+ * peak arrives) and released exponentially. The audio is delayed by a fixed
+ * amount, reported by getLatencySamples().
+ */
+class MasterLimiter
+{
+public:
+    /** Maximum number of channels the limiter will process. */
+    static constexpr int maxChannels = 8;
+
+    /** Oversampling factor used by the true-peak detector. */
+    static constexpr int oversampling = 4;
+
+    /** Number of taps per phase of the true-peak interpolator. */
+    static constexpr int tapsPerPhase = 12;
+
+    /**
+     * @brief Constructor for MasterLimiter.
+     */
+    MasterLimiter();
+
+    /**
+     * @brief Destructor for MasterLimiter.
+     */
+    ~MasterLimiter();
+
+    /**
+     * @brief Allocates all buffers and resets the limiter.
+     * @param sampleRate The device sample rate.
+     * @param maximumBlockSize The largest block that will be processed at once.
+     */
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    /**
+     * @brief Clears the delay line and gain state.
+     */
+    void reset();
+
+    /**
+     * @brief Limits a block of audio in place.
+     *
+     * Called from the audio thread. Never allocates or locks.
+     *
+     * @param bufferToFill The master bus block to process.
+     */
+    void process(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * @brief Sets the highest true-peak level allowed at the output.
+     * @param ceilingDb The ceiling in dBTP (e.g. -1.0).
+     */
+    void setCeiling(float ceilingDb);
+
+    /**
+     * @brief Sets how quickly the gain recovers after a peak.
+     * @param releaseMs The release time in milliseconds.
+     */
+    void setRelease(float releaseMs);
+
+    /**
+     * @brief Gets the fixed delay the limiter adds to the master bus.
+     * @return The latency in samples.
+     */
+    int getLatencySamples() const;
+
+    /**
+     * @brief Gets the largest gain reduction applied since the last call.
+     *
+     * Safe to call from any thread. Reading resets the held value, so a UI
+     * polling this sees the worst reduction of each frame.
+     *
+     * @return The gain reduction in decibels (0 or negative).
+     */
+    float getGainReductionDb();
+
+private:
+    /**
+     * @brief Processes a chunk no longer than the prepared block size.
+     * @param buffer The buffer holding the audio.
+     * @param startSample First sample of the chunk.
+     * @param numSamples Length of the chunk.
+     */
+    void processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /**
+     * @brief Measures the true peak of every sample in a chunk.
+     * @param buffer The buffer holding the audio.
+     * @param startSample First sample of the chunk.
+     * @param numSamples Length of the chunk.
+     * @param numChannels Number of channels to measure.
+     */
+    void detectTruePeaks(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannels);
+
+    /**
+     * @brief Computes the maximum of each lookahead window over the peak history.
+     * @param numSamples Number of new peak values.
+     */
+    void slidingWindowMax(int numSamples);
+
+    double sampleRate = 44100.0;   ///< Device sample rate.
+    int maxBlockSize = 0;          ///< Largest chunk processed at once.
+    int windowLength = 1;          ///< Lookahead window length in samples.
+    int interpolatorDelay = tapsPerPhase / 2; ///< Delay of the true-peak interpolator.
+    int latency = 0;               ///< Total delay applied to the audio.
+
+    float ceiling = 0.891f;        ///< Output ceiling as a linear gain (-1 dBTP).
+    float releaseCoefficient = 0.0f; ///< One-pole release coefficient.
+    float currentGain = 1.0f;      ///< Gain applied to the previous sample.
+
+    std::array<std::array<float, tapsPerPhase>, oversampling> phaseCoefficients {}; ///< Polyphase interpolation filters.
+
+    juce::AudioBuffer<float> inputHistory;   ///< Input samples with interpolator history in front.
+    juce::AudioBuffer<float> delayLine;      ///< Delayed audio with lookahead history in front.
+    std::vector<float> peaks;                ///< True-peak envelope with window history in front.
+    std::vector<float> prefixMax;            ///< Scratch for the sliding-window maximum.
+    std::vector<float> suffixMax;            ///< Scratch for the sliding-window maximum.
+    std::vector<float> windowMax;            ///< Peak of each lookahead window.
+    std::vector<float> boxHistory;           ///< Ring buffer of held gains for the box filter.
+    int boxIndex = 0;                        ///< Write position in boxHistory.
+    double boxSum = 0.0;                     ///< Running sum of boxHistory.
+
+    std::atomic<float> gainReductionDb { 0.0f }; ///< Worst reduction since the UI last read it.
+    std::atomic<float> ceilingTarget { 0.891f }; ///< Ceiling requested by the message thread.
+    std::atomic<float> releaseMsTarget { 100.0f }; ///< Release requested by the message thread.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterLimiter)
+};
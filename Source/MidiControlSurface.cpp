@@ -0,0 +1,670 @@
+/**
+ * =================================================================
+ * @file MidiControlSurface.cpp
+ * @brief Implementation of the MidiControlSurface class.
+ *
+ * Created: 19 Oct 2026 2:14:37am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "MidiControlSurface.h"
+
+namespace
+{
+    /** Names of the controls in the mapping file, in Control order. */
+    const char* const controlNames[] = { "play", "cue", "hotcue", "pad", "volume", "pitch", "jog",
+                                         "eqhigh", "eqmid", "eqlow", "reverb", "flanger", "crossfader" };
+
+    /** Pitch range used when a mapping does not give one: +/- 8%, as on most DJ hardware. */
+    constexpr double defaultPitchRange = 0.08;
+
+    /** Jog movement per step used when a mapping does not give one, in seconds. */
+    constexpr double defaultJogSecondsPerStep = 0.005;
+
+    /**
+     * @brief Gets the file the mapping is kept in.
+     * @return The mapping file in the application data folder.
+     */
+    juce::File getMappingFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("New_DJ").getChildFile("midi_mapping.xml");
+    }
+
+    /**
+     * @brief Checks whether a control is a button, acting on presses only.
+     * @param control The control.
+     * @return True for buttons.
+     */
+    bool isButton(MidiControlSurface::Control control)
+    {
+        using Control = MidiControlSurface::Control;
+        return control == Control::play || control == Control::cue
+            || control == Control::hotCue || control == Control::pad;
+    }
+
+    /**
+     * @brief Stands in for an audio device, rendering one player in real time.
+     *
+     * Records when the player's gain last changed, taken at the start of the
+     * block that applied it, which is when the event left the queue.
+     */
+    class SimulatedDevice : public juce::Thread
+    {
+    public:
+        SimulatedDevice(DJAudioPlayer& playerToRender, int samplesPerBlock, double rate)
+            : juce::Thread("Simulated audio device"), player(playerToRender), blockSize(samplesPerBlock), sampleRate(rate)
+        {
+        }
+
+        void run() override
+        {
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            const double periodMs = 1000.0 * blockSize / sampleRate;
+            double nextBlock = juce::Time::getMillisecondCounterHiRes();
+            float lastGain = player.transportSource.getGain();
+
+            while (! threadShouldExit())
+            {
+                nextBlock += periodMs;
+
+                while (juce::Time::getMillisecondCounterHiRes() < nextBlock - 1.5)
+                    juce::Thread::sleep(1);
+
+                while (juce::Time::getMillisecondCounterHiRes() < nextBlock)
+                    juce::Thread::yield();
+
+                const double blockStart = juce::Time::getMillisecondCounterHiRes();
+                buffer.clear();
+                player.getNextAudioBlock(juce::AudioSourceChannelInfo(buffer));
+
+                const float gain = player.transportSource.getGain();
+
+                if (gain != lastGain)
+                {
+                    lastGain = gain;
+                    appliedAt = blockStart;
+                    ++numChanges;
+                }
+            }
+        }
+
+        std::atomic<double> appliedAt {0.0};    ///< Start of the block that last changed the gain.
+        std::atomic<int> numChanges {0};        ///< Gain changes seen so far.
+
+    private:
+        DJAudioPlayer& player;
+        const int blockSize;
+        const double sampleRate;
+    };
+}
+
+/**
+ * @brief Constructs the surface and loads the mapping.
+ *
+ * If there is no mapping file yet the default layout is written to it.
+ *
+ * @param deckA Player driven by deck 0 mappings.
+ * @param deckB Player driven by deck 1 mappings.
+ */
+MidiControlSurface::MidiControlSurface(DJAudioPlayer* deckA, DJAudioPlayer* deckB)
+    : decks { deckA, deckB }
+{
+    const auto file = getMappingFile();
+    auto loaded = readMappings(file);
+
+    if (loaded.empty())
+    {
+        loaded = getDefaultMappings();
+
+        if (! file.existsAsFile())
+            writeMappings(loaded, file);
+    }
+
+    setMappings(std::move(loaded));
+}
+
+/**
+ * @brief Destructor for MidiControlSurface.
+ */
+MidiControlSurface::~MidiControlSurface()
+{
+    for (auto& input : inputs)
+        input->stop();
+
+    inputs.clear();
+    cancelPendingUpdate();
+}
+
+/**
+ * @brief Opens every MIDI input currently connected.
+ */
+void MidiControlSurface::openAllDevices()
+{
+    for (const auto& device : juce::MidiInput::getAvailableDevices())
+        openDevice(device.identifier);
+}
+
+/**
+ * @brief Opens one MIDI input.
+ * @param identifier The device identifier, as in juce::MidiDeviceInfo.
+ * @return True if the device was opened and started.
+ */
+bool MidiControlSurface::openDevice(const juce::String& identifier)
+{
+    for (const auto& input : inputs)
+        if (input->getIdentifier() == identifier)
+            return true;
+
+    auto input = juce::MidiInput::openDevice(identifier, this);
+
+    if (input == nullptr)
+    {
+        DBG("MidiControlSurface: could not open MIDI input " + identifier);
+        return false;
+    }
+
+    DBG("MidiControlSurface: listening to " + input->getName());
+    input->start();
+    inputs.push_back(std::move(input));
+    return true;
+}
+
+/**
+ * @brief Applies a control moved from another remote source, such as OSC.
+ * @param deck The deck (0 or 1); ignored for the crossfader.
+ * @param control The control.
+ * @param index Hot cue or pad slot (0 - 7).
+ * @param value The value (0.0 - 1.0), or the movement in seconds for the jog; buttons act on 0.5 and up.
+ */
+void MidiControlSurface::applyRemote(int deck, Control control, int index, double value)
+{
+    if (! juce::isPositiveAndBelow(deck, 2) || ! juce::isPositiveAndBelow(index, 8))
+        return;
+
+    Mapping mapping;
+    mapping.control = control;
+    mapping.deck = deck;
+    mapping.index = index;
+    // Jog movements arrive in seconds; pitch uses the same range as a controller.
+    mapping.scale = control == Control::jog ? 1.0 : defaultPitchRange;
+
+    apply(mapping, juce::jlimit(0.0, 1.0, value), value, value >= 0.5);
+}
+
+/**
+ * @brief Looks up a control by the name used in mapping files and remote addresses.
+ * @param name The name, e.g. "eqhigh"; case is ignored.
+ * @return The control's index in Control, or -1 if there is no such control.
+ */
+int MidiControlSurface::controlFromName(const juce::String& name)
+{
+    return juce::StringArray(controlNames, numControls).indexOf(name, true);
+}
+
+/**
+ * @brief Gets the default mapping: deck A on channel 1, deck B on channel 2.
+ *
+ * Both decks use the same numbers; the crossfader sits on channel 1.
+ * Faders and EQs are 14-bit, with the low bits 32 controllers up.
+ *
+ * @return The mappings.
+ */
+std::vector<MidiControlSurface::Mapping> MidiControlSurface::getDefaultMappings()
+{
+    std::vector<Mapping> defaults;
+
+    for (int deck = 0; deck < 2; ++deck)
+    {
+        const int channel = deck + 1;
+
+        defaults.push_back({ Control::play, deck, 0, channel, Source::note, 0x0b });
+        defaults.push_back({ Control::cue, deck, 0, channel, Source::note, 0x0c });
+
+        for (int slot = 0; slot < 8; ++slot)
+        {
+            defaults.push_back({ Control::hotCue, deck, slot, channel, Source::note, 0x30 + slot });
+            defaults.push_back({ Control::pad, deck, slot, channel, Source::note, 0x40 + slot });
+        }
+
+        defaults.push_back({ Control::pitch, deck, 0, channel, Source::pitchWheel, 0, -1, defaultPitchRange });
+        defaults.push_back({ Control::jog, deck, 0, channel, Source::controller, 0x06, 0x26, defaultJogSecondsPerStep });
+        defaults.push_back({ Control::eqHigh, deck, 0, channel, Source::controller, 0x10, 0x30 });
+        defaults.push_back({ Control::eqMid, deck, 0, channel, Source::controller, 0x11, 0x31 });
+        defaults.push_back({ Control::eqLow, deck, 0, channel, Source::controller, 0x12, 0x32 });
+        defaults.push_back({ Control::volume, deck, 0, channel, Source::controller, 0x13, 0x33 });
+        defaults.push_back({ Control::reverb, deck, 0, channel, Source::controller, 0x14 });
+        defaults.push_back({ Control::flanger, deck, 0, channel, Source::controller, 0x15 });
+    }
+
+    defaults.push_back({ Control::crossfader, 0, 0, 1, Source::controller, 0x08, 0x28 });
+    return defaults;
+}
+
+/**
+ * @brief Replaces the mapping and rebuilds the routing tables.
+ * @param newMappings The mappings.
+ */
+void MidiControlSurface::setMappings(std::vector<Mapping> newMappings)
+{
+    jassert (inputs.empty()); // the MIDI thread reads the tables without locking
+
+    mappings = std::move(newMappings);
+    noteRoutes.fill({});
+    controllerRoutes.fill({});
+    pitchWheelRoutes.fill({});
+    highBits.assign(mappings.size(), 0);
+
+    for (int i = 0; i < (int) mappings.size(); ++i)
+    {
+        const auto& mapping = mappings[(size_t) i];
+        const size_t channel = (size_t) (mapping.channel - 1);
+
+        switch (mapping.source)
+        {
+            case Source::note:
+                noteRoutes[channel * 128 + (size_t) mapping.number] = { i, false };
+                break;
+            case Source::controller:
+                controllerRoutes[channel * 128 + (size_t) mapping.number] = { i, false };
+                if (mapping.lsbNumber >= 0)
+                    controllerRoutes[channel * 128 + (size_t) mapping.lsbNumber] = { i, true };
+                break;
+            case Source::pitchWheel:
+                pitchWheelRoutes[channel] = { i, false };
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Routes an incoming message to its control.
+ *
+ * For 14-bit controllers the high 7 bits arrive first and reset the low
+ * bits, as the MIDI specification asks. Absolute controls act on both halves,
+ * so a controller that only sends the high bits still works; relative jogs
+ * wait for the low bits, so each movement is only counted once.
+ *
+ * @param source The device the message came from.
+ * @param message The message.
+ */
+void MidiControlSurface::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+{
+    const int channel = message.getChannel();
+
+    if (channel < 1)
+        return;
+
+    const size_t channelBase = (size_t) (channel - 1) * 128;
+
+    if (message.isNoteOnOrOff())
+    {
+        const auto route = noteRoutes[channelBase + (size_t) message.getNoteNumber()];
+
+        if (route.mapping >= 0)
+            apply(mappings[(size_t) route.mapping], message.getFloatVelocity(), 0.0, message.isNoteOn());
+    }
+    else if (message.isController())
+    {
+        const auto route = controllerRoutes[channelBase + (size_t) message.getControllerNumber()];
+
+        if (route.mapping < 0)
+            return;
+
+        const auto& mapping = mappings[(size_t) route.mapping];
+        const int data = message.getControllerValue();
+
+        if (mapping.lsbNumber < 0)
+        {
+            apply(mapping, data / 127.0, data - 64, data >= 64);
+        }
+        else if (route.lsb)
+        {
+            const int value = (highBits[(size_t) route.mapping] << 7) | data;
+            apply(mapping, value / 16383.0, (value - 8192) / 128.0, value >= 8192);
+        }
+        else
+        {
+            highBits[(size_t) route.mapping] = data;
+
+            if (mapping.control != Control::jog)
+                apply(mapping, (data << 7) / 16383.0, 0.0, data >= 64);
+        }
+    }
+    else if (message.isPitchWheel())
+    {
+        const auto route = pitchWheelRoutes[(size_t) (channel - 1)];
+        const int value = message.getPitchWheelValue();
+
+        if (route.mapping >= 0)
+            apply(mappings[(size_t) route.mapping], value / 16383.0, (value - 8192) / 128.0, value >= 8192);
+    }
+}
+
+/**
+ * @brief Applies a decoded message to its control.
+ *
+ * Ranges match the sliders in DeckGUI and MixerView, so a control moved
+ * from hardware sounds the same as the slider it is shown on.
+ *
+ * @param mapping The mapping the message arrived on.
+ * @param value The absolute value (0.0 - 1.0).
+ * @param steps The relative movement, for jog wheels.
+ * @param pressed True for a button press.
+ */
+void MidiControlSurface::apply(const Mapping& mapping, double value, double steps, bool pressed)
+{
+    auto* player = decks[(size_t) mapping.deck];
+
+    if (isButton(mapping.control) && ! pressed)
+        return;
+
+    switch (mapping.control)
+    {
+        case Control::play:
+            if (player->isPlaying())
+                player->stop();
+            else
+                player->start();
+            publish(mapping.deck, Control::play, player->isPlaying() ? 1.0 : 0.0);
+            break;
+
+        case Control::cue:
+            player->cue();
+            publish(mapping.deck, Control::play, player->isPlaying() ? 1.0 : 0.0);
+            break;
+
+        case Control::hotCue:
+            if (player->triggerHotCue(mapping.index))
+                publish(mapping.deck, Control::play, 1.0);
+            break;
+
+        case Control::pad:
+            player->triggerPad(mapping.index, (float) value);
+            break;
+
+        case Control::volume:
+            player->setGain(value);
+            publish(mapping.deck, Control::volume, value);
+            break;
+
+        case Control::pitch:
+        {
+            const double range = mapping.scale > 0.0 ? mapping.scale : defaultPitchRange;
+            const double speed = 1.0 + (value * 2.0 - 1.0) * range;
+            player->setSpeed(speed);
+            publish(mapping.deck, Control::pitch, speed);
+            break;
+        }
+
+        case Control::jog:
+            player->jog(steps * (mapping.scale > 0.0 ? mapping.scale : defaultJogSecondsPerStep));
+            break;
+
+        case Control::eqHigh:
+        {
+            const double amount = juce::jmap(value, 0.1, 1.0);
+            player->setHighPassFilterAmount(amount);
+            publish(mapping.deck, Control::eqHigh, amount);
+            break;
+        }
+
+        case Control::eqMid:
+            player->setMidBandPassFilterAmount(value);
+            publish(mapping.deck, Control::eqMid, value);
+            break;
+
+        case Control::eqLow:
+        {
+            const double amount = juce::jmap(value, 0.1, 0.99);
+            player->setLowPassFilterAmount(1.0 - amount);
+            publish(mapping.deck, Control::eqLow, amount);
+            break;
+        }
+
+        case Control::reverb:
+            player->setReverbAmount(value);
+            publish(mapping.deck, Control::reverb, value);
+            break;
+
+        case Control::flanger:
+            player->setFlangerAmount(value);
+            publish(mapping.deck, Control::flanger, value);
+            break;
+
+        case Control::crossfader:
+            decks[0]->setGain(1.0 - value);
+            decks[1]->setGain(value);
+            publish(0, Control::crossfader, value);
+            break;
+    }
+}
+
+/**
+ * @brief Publishes a control's new value for the GUI.
+ *
+ * Only the newest value is kept, so a fast fader sweep costs the message
+ * thread one update per control rather than one per message.
+ *
+ * @param deck The deck (0 or 1).
+ * @param control The control.
+ * @param value The value, in the units of the control's slider.
+ */
+void MidiControlSurface::publish(int deck, Control control, double value)
+{
+    const size_t slot = (size_t) (deck * numControls + (int) control);
+    shownValues[slot] = (float) value;
+    shownChanged[slot] = true;
+    triggerAsyncUpdate();
+}
+
+/**
+ * @brief Hands the published values to onControlChanged.
+ */
+void MidiControlSurface::handleAsyncUpdate()
+{
+    for (size_t slot = 0; slot < shownChanged.size(); ++slot)
+    {
+        if (! shownChanged[slot].exchange(false))
+            continue;
+
+        if (onControlChanged != nullptr)
+            onControlChanged((int) slot / numControls, (Control) ((int) slot % numControls), shownValues[slot]);
+    }
+}
+
+/**
+ * @brief Reads the mapping from a file.
+ *
+ * Each CONTROL element names its control and one of "note", "cc" or
+ * "pitchwheel"; "lsb" adds the low 7 bits of a 14-bit controller. Entries
+ * that do not make sense are skipped.
+ *
+ * @param file The XML mapping file.
+ * @return The mappings, or an empty vector if the file could not be read.
+ */
+std::vector<MidiControlSurface::Mapping> MidiControlSurface::readMappings(const juce::File& file)
+{
+    std::vector<Mapping> loaded;
+    const auto xml = juce::parseXMLIfTagMatches(file, "MIDIMAPPING");
+
+    if (xml == nullptr)
+        return loaded;
+
+    for (const auto* element : xml->getChildWithTagNameIterator("CONTROL"))
+    {
+        Mapping mapping;
+        const int control = controlFromName(element->getStringAttribute("control"));
+
+        if (control < 0)
+            continue;
+
+        mapping.control = (Control) control;
+        mapping.deck = element->getIntAttribute("deck", 0);
+        mapping.index = element->getIntAttribute("index", 0);
+        mapping.channel = element->getIntAttribute("channel", 1);
+        mapping.lsbNumber = element->getIntAttribute("lsb", -1);
+        mapping.scale = element->getDoubleAttribute("scale", 0.0);
+
+        if (element->hasAttribute("note"))
+        {
+            mapping.source = Source::note;
+            mapping.number = element->getIntAttribute("note");
+        }
+        else if (element->hasAttribute("cc"))
+        {
+            mapping.source = Source::controller;
+            mapping.number = element->getIntAttribute("cc");
+        }
+        else if (element->getBoolAttribute("pitchwheel"))
+        {
+            mapping.source = Source::pitchWheel;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (! juce::isPositiveAndBelow(mapping.deck, 2)
+            || ! juce::isPositiveAndBelow(mapping.index, 8)
+            || ! juce::isPositiveAndBelow(mapping.channel - 1, 16)
+            || ! juce::isPositiveAndBelow(mapping.number, 128)
+            || mapping.lsbNumber >= 128)
+        {
+            DBG("MidiControlSurface: skipping invalid mapping " + element->toString());
+            continue;
+        }
+
+        loaded.push_back(mapping);
+    }
+
+    return loaded;
+}
+
+/**
+ * @brief Writes a mapping to a file.
+ * @param mappings The mappings.
+ * @param file The XML mapping file.
+ */
+void MidiControlSurface::writeMappings(const std::vector<Mapping>& mappings, const juce::File& file)
+{
+    juce::XmlElement xml ("MIDIMAPPING");
+
+    for (const auto& mapping : mappings)
+    {
+        auto* element = xml.createNewChildElement("CONTROL");
+        element->setAttribute("control", controlNames[(int) mapping.control]);
+
+        if (mapping.control != Control::crossfader)
+            element->setAttribute("deck", mapping.deck);
+
+        if (mapping.control == Control::hotCue || mapping.control == Control::pad)
+            element->setAttribute("index", mapping.index);
+
+        element->setAttribute("channel", mapping.channel);
+
+        switch (mapping.source)
+        {
+            case Source::note:       element->setAttribute("note", mapping.number); break;
+            case Source::controller: element->setAttribute("cc", mapping.number); break;
+            case Source::pitchWheel: element->setAttribute("pitchwheel", true); break;
+        }
+
+        if (mapping.lsbNumber >= 0)
+            element->setAttribute("lsb", mapping.lsbNumber);
+
+        if (mapping.scale > 0.0)
+            element->setAttribute("scale", mapping.scale);
+    }
+
+    file.getParentDirectory().createDirectory();
+
+    if (! xml.writeTo(file))
+        DBG("MidiControlSurface: could not write " + file.getFullPathName());
+}
+
+/**
+ * @brief Measures the time from a MIDI message to the audio block that applies it.
+ *
+ * Deck A's volume fader is moved between its ends and the time from sending
+ * each message to the start of the audio block whose gain changed is
+ * recorded. That block begins by draining the event queue, so the figure
+ * covers MIDI delivery, routing and the wait for the next block.
+ */
+void MidiControlSurface::runLatencyBenchmark()
+{
+    constexpr int blockSize = 256;
+    constexpr double sampleRate = 48000.0;
+    constexpr int numProbes = 200;
+
+    DJAudioPlayer deckA, deckB;
+    deckA.prepareToPlay(blockSize, sampleRate);
+    deckB.prepareToPlay(blockSize, sampleRate);
+
+    MidiControlSurface surface (&deckA, &deckB);
+    surface.setMappings(getDefaultMappings());
+
+    // Loop a virtual output port back into the surface where the platform allows it.
+    const juce::String portName ("New_DJ latency probe");
+    auto port = juce::MidiOutput::createNewDevice(portName);
+    bool viaPort = false;
+
+    if (port != nullptr)
+        for (const auto& input : juce::MidiInput::getAvailableDevices())
+            if (input.name.contains(portName) && surface.openDevice(input.identifier))
+                viaPort = true;
+
+    SimulatedDevice device (deckA, blockSize, sampleRate);
+    device.startThread();
+    juce::Thread::sleep(50);
+
+    const double periodMs = 1000.0 * blockSize / sampleRate;
+    juce::Random random;
+    std::vector<double> latencies;
+
+    for (int i = 0; i < numProbes; ++i)
+    {
+        // Land at a random point in the block, as real input does.
+        juce::Thread::sleep(2 + random.nextInt(5));
+
+        const int changesBefore = device.numChanges;
+        const auto message = juce::MidiMessage::controllerEvent(1, 0x13, i % 2 == 0 ? 0 : 127);
+        const double sentAt = juce::Time::getMillisecondCounterHiRes();
+
+        if (viaPort)
+            port->sendMessageNow(message);
+        else
+            surface.handleIncomingMidiMessage(nullptr, message);
+
+        while (device.numChanges == changesBefore && juce::Time::getMillisecondCounterHiRes() - sentAt < 500.0)
+            juce::Thread::yield();
+
+        if (device.numChanges != changesBefore)
+            latencies.push_back(juce::jmax(0.0, device.appliedAt - sentAt));
+    }
+
+    device.stopThread(1000);
+
+    std::cout << "MIDI latency benchmark: " << (viaPort ? "virtual port " + portName : juce::String("direct injection, no virtual port"))
+              << ", " << blockSize << " samples at " << sampleRate << " Hz (block "
+              << juce::String(periodMs, 2) << " ms)" << std::endl;
+
+    if (latencies.empty())
+    {
+        std::cout << "  no messages reached the audio thread" << std::endl;
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+
+    for (const auto latency : latencies)
+        total += latency;
+
+    std::cout << "  " << latencies.size() << "/" << numProbes << " messages, input to audio block: min "
+              << juce::String(latencies.front(), 2) << " ms, mean "
+              << juce::String(total / (double) latencies.size(), 2) << " ms, 99th percentile "
+              << juce::String(latencies[juce::jmin(latencies.size() - 1, latencies.size() * 99 / 100)], 2) << " ms, max "
+              << juce::String(latencies.back(), 2) << " ms" << std::endl;
+}
@@ -0,0 +1,218 @@
+/**
+ * =================================================================
+ * @file MidiControlSurface.h
+ * @brief Declaration of the MidiControlSurface class.
+ *
+ * This file declares the MIDI controller input, which maps notes, controllers
+ * and pitch wheels from DJ hardware onto the two decks and the mixer.
+ *
+ * Created: 19 Oct 2026 2:14:37am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+
+/**
+ * @class MidiControlSurface
+ * @brief Drives the decks and mixer from MIDI controllers.
+ *
+ * Incoming messages are looked up in a flat routing table and applied on the
+ * MIDI thread itself: deck controls go straight into each player's event
+ * queue, so a jog or fader movement is heard in the next audio block without
+ * waiting for the message thread. The GUI catches up afterwards: the latest
+ * value of each control is published through atomics and handed to
+ * onControlChanged on the message thread.
+ *
+ * Controllers may be 7-bit or 14-bit, with the low 7 bits on a second
+ * controller number as in the MIDI specification; the pitch wheel is always
+ * 14-bit. Jog wheels are relative, centred on 64 (or 8192 for 14-bit).
+ *
+ * The mapping is read from midi_mapping.xml in the application data folder,
+ * which is written with the default layout on first run so it can be edited.
+ */
+class MidiControlSurface : private juce::MidiInputCallback,
+                           private juce::AsyncUpdater
+{
+public:
+    /**
+     * @brief The controls a MIDI message can be mapped to.
+     */
+    enum class Control {
+        play,       /**< Toggles play and stop. */
+        cue,        /**< Sets or returns to the cue point. */
+        hotCue,     /**< Triggers the hot cue in the mapping's slot. */
+        pad,        /**< Plays the sample pad in the mapping's slot. */
+        volume,     /**< Deck volume. */
+        pitch,      /**< Deck speed, around 1 by the mapping's range. */
+        jog,        /**< Relative jog wheel. */
+        eqHigh,     /**< High-pass filter. */
+        eqMid,      /**< Mid band-pass mix. */
+        eqLow,      /**< Low-pass filter. */
+        reverb,     /**< Reverb mix. */
+        flanger,    /**< Flanger mix. */
+        crossfader  /**< Crossfader; the mapping's deck is ignored. */
+    };
+
+    static constexpr int numControls = 13; ///< Number of values in Control.
+
+    /**
+     * @brief The kind of message a mapping listens to.
+     */
+    enum class Source {
+        note,       /**< Note on and off; buttons act on note on. */
+        controller, /**< Control change; buttons act on values of 64 and up. */
+        pitchWheel  /**< 14-bit pitch wheel. */
+    };
+
+    /**
+     * @brief One control mapped to one message.
+     */
+    struct Mapping {
+        Control control = Control::play; ///< What the message drives.
+        int deck = 0;                    ///< 0 for deck A, 1 for deck B.
+        int index = 0;                   ///< Hot cue or pad slot (0 - 7).
+        int channel = 1;                 ///< MIDI channel (1 - 16).
+        Source source = Source::note;    ///< Kind of message.
+        int number = 0;                  ///< Note or controller number; for 14-bit, the high 7 bits.
+        int lsbNumber = -1;              ///< Controller carrying the low 7 bits, or -1 for 7-bit.
+        double scale = 0.0;              ///< Pitch range as a fraction, or jog seconds per step; 0 for the default.
+    };
+
+    /**
+     * @brief Constructs the surface and loads the mapping. No devices are opened yet.
+     * @param deckA Player driven by deck 0 mappings.
+     * @param deckB Player driven by deck 1 mappings.
+     */
+    MidiControlSurface(DJAudioPlayer* deckA, DJAudioPlayer* deckB);
+
+    /**
+     * @brief Destructor for MidiControlSurface. Closes every open device.
+     */
+    ~MidiControlSurface() override;
+
+    /**
+     * @brief Opens every MIDI input currently connected.
+     */
+    void openAllDevices();
+
+    /**
+     * @brief Opens one MIDI input.
+     * @param identifier The device identifier, as in juce::MidiDeviceInfo.
+     * @return True if the device was opened and started.
+     */
+    bool openDevice(const juce::String& identifier);
+
+    /**
+     * @brief Applies a control moved from another remote source, such as OSC.
+     *
+     * Behaves as a mapped controller would, including publishing the new
+     * value for the GUI. Safe to call from any thread.
+     *
+     * @param deck The deck (0 or 1); ignored for the crossfader.
+     * @param control The control.
+     * @param index Hot cue or pad slot (0 - 7).
+     * @param value The value (0.0 - 1.0), or the movement in seconds for the jog; buttons act on 0.5 and up.
+     */
+    void applyRemote(int deck, Control control, int index, double value);
+
+    /**
+     * @brief Looks up a control by the name used in mapping files and remote addresses.
+     * @param name The name, e.g. "eqhigh"; case is ignored.
+     * @return The control's index in Control, or -1 if there is no such control.
+     */
+    static int controlFromName(const juce::String& name);
+
+    /**
+     * @brief Gets the default mapping: deck A on channel 1, deck B on channel 2.
+     * @return The mappings.
+     */
+    static std::vector<Mapping> getDefaultMappings();
+
+    /**
+     * @brief Measures the time from a MIDI message to the audio block that applies it.
+     *
+     * Sends volume changes through a virtual MIDI port into a surface driving
+     * a player rendered by a simulated audio device, and prints the latency.
+     * Where virtual ports are not available, or the port cannot be opened as
+     * an input, the messages are injected at the MIDI callback instead.
+     */
+    static void runLatencyBenchmark();
+
+    /** Called on the message thread with a control's new value, in the units of its slider. */
+    std::function<void(int deck, Control control, double value)> onControlChanged;
+
+private:
+    /**
+     * @brief Routing table entry for one channel and note or controller number.
+     */
+    struct Route {
+        int mapping = -1;   ///< Index into mappings, or -1 if unmapped.
+        bool lsb = false;   ///< True if this number carries the low 7 bits.
+    };
+
+    /**
+     * @brief Routes an incoming message to its control. Called on the MIDI thread.
+     * @param source The device the message came from.
+     * @param message The message.
+     */
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+
+    /**
+     * @brief Hands the published values to onControlChanged.
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * @brief Replaces the mapping and rebuilds the routing tables. Call before opening devices.
+     * @param newMappings The mappings.
+     */
+    void setMappings(std::vector<Mapping> newMappings);
+
+    /**
+     * @brief Applies a decoded message to its control.
+     * @param mapping The mapping the message arrived on.
+     * @param value The absolute value (0.0 - 1.0).
+     * @param steps The relative movement, for jog wheels.
+     * @param pressed True for a button press.
+     */
+    void apply(const Mapping& mapping, double value, double steps, bool pressed);
+
+    /**
+     * @brief Publishes a control's new value for the GUI.
+     * @param deck The deck (0 or 1).
+     * @param control The control.
+     * @param value The value, in the units of the control's slider.
+     */
+    void publish(int deck, Control control, double value);
+
+    /**
+     * @brief Reads the mapping from a file.
+     * @param file The XML mapping file.
+     * @return The mappings, or an empty vector if the file could not be read.
+     */
+    static std::vector<Mapping> readMappings(const juce::File& file);
+
+    /**
+     * @brief Writes a mapping to a file.
+     * @param mappings The mappings.
+     * @param file The XML mapping file.
+     */
+    static void writeMappings(const std::vector<Mapping>& mappings, const juce::File& file);
+
+    std::array<DJAudioPlayer*, 2> decks;                    ///< Players for deck A and deck B.
+    std::vector<Mapping> mappings;                          ///< Current mapping.
+    std::array<Route, 16 * 128> noteRoutes;                 ///< Indexed by channel and note number.
+    std::array<Route, 16 * 128> controllerRoutes;           ///< Indexed by channel and controller number.
+    std::array<Route, 16> pitchWheelRoutes;                 ///< Indexed by channel.
+    std::vector<int> highBits;                              ///< Last high 7 bits of each 14-bit mapping; MIDI thread only.
+
+    std::array<std::atomic<float>, 2 * numControls> shownValues {};     ///< Latest value of each deck's controls.
+    std::array<std::atomic<bool>, 2 * numControls> shownChanged {};     ///< Set when a value has not yet been shown.
+
+    std::vector<std::unique_ptr<juce::MidiInput>> inputs;   ///< Open devices.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiControlSurface)
+};
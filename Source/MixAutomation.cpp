@@ -0,0 +1,955 @@
+/**
+ * =================================================================
+ * @file MixAutomation.cpp
+ * @brief Implementation of the MixAutomation class and the AutomationTake structure.
+ *
+ * Created: 19 Oct 2026 5:26:51am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "MixAutomation.h"
+#include "DJAudioPlayer.h"
+#include "MasterLimiter.h"
+
+namespace
+{
+    constexpr int takeMagic = 0x314d4a44; // "DJM1"
+
+    /**
+     * @brief Writes an unsigned number in 7-bit groups, low group first.
+     * @param output The stream to write to.
+     * @param value The number.
+     */
+    void writeVarint(juce::OutputStream& output, juce::uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            output.writeByte((char) ((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+
+        output.writeByte((char) value);
+    }
+
+    /**
+     * @brief Reads a number written by writeVarint.
+     * @param input The stream to read from.
+     * @param value Receives the number.
+     * @return False if the stream ended or the number does not fit in 64 bits.
+     */
+    bool readVarint(juce::InputStream& input, juce::uint64& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (input.isExhausted())
+                return false;
+
+            const auto byte = (juce::uint8) input.readByte();
+            value |= (juce::uint64) (byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Stands in for an audio device, rendering the live mix path in real time.
+     *
+     * Each block runs as MainComponent's audio callback does. From the block
+     * a take starts replaying on, the output is copied into a ring the
+     * checking thread reads, so the device never waits on the check.
+     */
+    class ReplayDevice : public juce::Thread
+    {
+    public:
+        ReplayDevice(MixAutomation& automationToUse, juce::AudioSource& mixerToRender, MasterLimiter& limiterToUse,
+                     int channels, int samplesPerBlock, double rate, juce::int64 lengthToCapture)
+            : juce::Thread("Simulated audio device"), automation(automationToUse), mixer(mixerToRender), limiter(limiterToUse),
+              numChannels(channels), blockSize(samplesPerBlock), sampleRate(rate), length(lengthToCapture),
+              fifo(juce::roundToInt(rate * ringSeconds)), ring(channels, juce::roundToInt(rate * ringSeconds))
+        {
+        }
+
+        void run() override
+        {
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            const double periodMs = 1000.0 * blockSize / sampleRate;
+            double nextBlock = juce::Time::getMillisecondCounterHiRes();
+            bool capturing = false;
+
+            while (! threadShouldExit() && captured < length && ! overran)
+            {
+                nextBlock += periodMs;
+
+                while (juce::Time::getMillisecondCounterHiRes() < nextBlock - 1.5)
+                    juce::Thread::sleep(1);
+
+                while (juce::Time::getMillisecondCounterHiRes() < nextBlock)
+                    juce::Thread::yield();
+
+                const juce::AudioSourceChannelInfo info (buffer);
+
+                if (automation.beginBlock(info))
+                {
+                    limiter.reset();
+                    capturing = true;
+                }
+
+                mixer.getNextAudioBlock(info);
+                limiter.process(info);
+                automation.endBlock(info);
+
+                if (capturing)
+                    capture(buffer, (int) juce::jmin((juce::int64) blockSize, length - captured));
+            }
+        }
+
+        /**
+         * @brief Moves the captured samples that are ready into a buffer.
+         * @param destination Receives the samples from its start; its size caps how many are moved.
+         * @return The number of samples moved.
+         */
+        int readCaptured(juce::AudioBuffer<float>& destination)
+        {
+            const auto scope = fifo.read(juce::jmin(fifo.getNumReady(), destination.getNumSamples()));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                if (scope.blockSize1 > 0)
+                    destination.copyFrom(channel, 0, ring, channel, scope.startIndex1, scope.blockSize1);
+
+                if (scope.blockSize2 > 0)
+                    destination.copyFrom(channel, scope.blockSize1, ring, channel, scope.startIndex2, scope.blockSize2);
+            }
+
+            return scope.blockSize1 + scope.blockSize2;
+        }
+
+        std::atomic<juce::int64> captured {0}; ///< Samples of the take copied into the ring so far.
+        std::atomic<bool> overran {false};      ///< True if the check fell a whole ring behind.
+
+    private:
+        void capture(const juce::AudioBuffer<float>& block, int numSamples)
+        {
+            if (fifo.getFreeSpace() < numSamples)
+            {
+                overran = true;
+                return;
+            }
+
+            const auto scope = fifo.write(numSamples);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                if (scope.blockSize1 > 0)
+                    ring.copyFrom(channel, scope.startIndex1, block, channel, 0, scope.blockSize1);
+
+                if (scope.blockSize2 > 0)
+                    ring.copyFrom(channel, scope.startIndex2, block, channel, scope.blockSize1, scope.blockSize2);
+            }
+
+            captured += numSamples;
+        }
+
+        MixAutomation& automation;
+        juce::AudioSource& mixer;
+        MasterLimiter& limiter;
+        const int numChannels;
+        const int blockSize;
+        const double sampleRate;
+        const juce::int64 length;
+        juce::AbstractFifo fifo;
+        juce::AudioBuffer<float> ring;
+
+        static constexpr double ringSeconds = 4.0;
+    };
+}
+
+/**
+ * @brief Writes the take in its compact binary form.
+ *
+ * Events are stored as the samples since the previous event, a byte holding
+ * the deck and event type, and the value, so a typical event takes six
+ * bytes. The file is written beside the target and renamed over it.
+ *
+ * @param file The file to write; replaced if it exists.
+ * @return True if the take was written.
+ */
+bool AutomationTake::writeTo(const juce::File& file) const
+{
+    juce::TemporaryFile temporary (file);
+
+    {
+        juce::FileOutputStream output (temporary.getFile());
+
+        if (! output.openedOk())
+            return false;
+
+        output.writeInt(takeMagic);
+        output.writeDouble(sampleRate);
+        output.writeCompressedInt(blockSize);
+        output.writeCompressedInt(numChannels);
+        output.writeInt64(length);
+
+        for (const auto& deck : decks)
+        {
+            output.writeString(deck.track);
+            output.writeDouble(deck.position);
+            output.writeBool(deck.playing);
+        }
+
+        output.writeCompressedInt((int) events.size());
+        juce::int64 previous = 0;
+
+        for (const auto& event : events)
+        {
+            writeVarint(output, (juce::uint64) (event.sample - previous));
+            output.writeByte((char) ((event.deck << 4) | (int) event.event.type));
+            output.writeFloat(event.event.value);
+            previous = event.sample;
+        }
+
+        output.flush();
+
+        if (output.getStatus().failed())
+            return false;
+    }
+
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+/**
+ * @brief Reads a take written by writeTo.
+ *
+ * Takes that are cut short, out of order or hold events that are not
+ * automated are rejected as a whole.
+ *
+ * @param file The file to read.
+ * @param take Receives the take.
+ * @return True if the file held a complete, valid take.
+ */
+bool AutomationTake::readFrom(const juce::File& file, AutomationTake& take)
+{
+    juce::MemoryBlock data;
+
+    if (! file.existsAsFile() || ! file.loadFileAsData(data))
+        return false;
+
+    juce::MemoryInputStream input (data, false);
+
+    if (input.readInt() != takeMagic)
+        return false;
+
+    AutomationTake loaded;
+    loaded.sampleRate = input.readDouble();
+    loaded.blockSize = input.readCompressedInt();
+    loaded.numChannels = input.readCompressedInt();
+    loaded.length = input.readInt64();
+
+    if (loaded.sampleRate <= 0.0 || loaded.blockSize <= 0 || loaded.numChannels <= 0 || loaded.length < 0)
+        return false;
+
+    for (auto& deck : loaded.decks)
+    {
+        deck.track = input.readString();
+        deck.position = input.readDouble();
+        deck.playing = input.readBool();
+    }
+
+    const int count = input.readCompressedInt();
+
+    // Each event takes at least six bytes, so a bad count cannot make us reserve much.
+    if (count < 0 || count > input.getNumBytesRemaining() / 6)
+        return false;
+
+    loaded.events.reserve((size_t) count);
+    juce::int64 sample = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        juce::uint64 delta;
+
+        if (! readVarint(input, delta) || input.getNumBytesRemaining() < 5)
+            return false;
+
+        sample += (juce::int64) delta;
+        const int packed = (juce::uint8) input.readByte();
+
+        AutomationEvent event;
+        event.sample = sample;
+        event.deck = packed >> 4;
+        event.event.type = (DeckEvent::Type) (packed & 0x0f);
+        event.event.value = input.readFloat();
+
+        if (event.deck > 1 || sample > loaded.length || ! MixAutomation::isAutomated(event.event))
+            return false;
+
+        loaded.events.push_back(event);
+    }
+
+    take = std::move(loaded);
+    return true;
+}
+
+/**
+ * @brief Constructs the automation and hooks it into both players.
+ * @param deckA Player recorded as deck 0.
+ * @param deckB Player recorded as deck 1.
+ */
+MixAutomation::MixAutomation(DJAudioPlayer* deckA, DJAudioPlayer* deckB)
+    : juce::Thread("Mix automation"), decks { deckA, deckB }, recordRing((size_t) recordCapacity)
+{
+    for (int deck = 0; deck < 2; ++deck)
+        decks[(size_t) deck]->setAutomation(this, deck);
+}
+
+/**
+ * @brief Destructor for MixAutomation.
+ */
+MixAutomation::~MixAutomation()
+{
+    for (int deck = 0; deck < 2; ++deck)
+        decks[(size_t) deck]->setAutomation(nullptr, deck);
+
+    stopRecorder();
+}
+
+/**
+ * @brief Checks whether an event is one that is recorded and replayed.
+ * @param event The event.
+ * @return True for level, speed, jog, filter and effect events.
+ */
+bool MixAutomation::isAutomated(const DeckEvent& event)
+{
+    switch (event.type)
+    {
+        case DeckEvent::Type::setGain:
+        case DeckEvent::Type::setSpeed:
+        case DeckEvent::Type::jog:
+        case DeckEvent::Type::setHighPass:
+        case DeckEvent::Type::setMidBandPass:
+        case DeckEvent::Type::setLowPass:
+        case DeckEvent::Type::setReverb:
+        case DeckEvent::Type::setFlanger:
+        case DeckEvent::Type::setTremolo:
+            return true;
+        case DeckEvent::Type::triggerHotCue:
+        case DeckEvent::Type::cancelHotCue:
+        case DeckEvent::Type::triggerPad:
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets the folder takes are saved to.
+ * @return The folder in the application data folder.
+ */
+juce::File MixAutomation::getTakesDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+               .getChildFile("New_DJ").getChildFile("Mixes");
+}
+
+/**
+ * @brief Sets the sample rate recorded into takes.
+ * @param newSampleRate The audio device's sample rate.
+ */
+void MixAutomation::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+/**
+ * @brief Starts a take at the next audio block.
+ *
+ * The tracks are noted here; the audio thread notes where each deck is and
+ * how its controls are set when the take actually starts.
+ */
+void MixAutomation::startRecording()
+{
+    if (isRecording())
+        return;
+
+    // Anything a previous take's audio thread pushed after it was collected is dropped.
+    drainRecorded();
+
+    {
+        const juce::ScopedLock sl (recordLock);
+        recordedEvents.clear();
+    }
+
+    recording = {};
+    recording.sampleRate = sampleRate;
+
+    for (size_t deck = 0; deck < decks.size(); ++deck)
+    {
+        const auto url = decks[deck]->getLoadedURL();
+        recording.decks[deck].track = url.isLocalFile() ? url.getLocalFile().getFullPathName() : juce::String();
+    }
+
+    droppedEvents = 0;
+    recordedLength = 0;
+    startThread();
+    request = Request::record;
+}
+
+/**
+ * @brief Ends the take and collects it.
+ *
+ * The recorder thread is stopped once the last events are drained, so it
+ * does not keep waking between takes.
+ *
+ * @return The take.
+ */
+AutomationTake MixAutomation::stopRecording()
+{
+    // A take the audio thread never started has nothing to collect.
+    auto pending = Request::record;
+
+    if (request.compare_exchange_strong(pending, Request::none))
+    {
+        stopRecorder();
+        return {};
+    }
+
+    request = Request::stopRecording;
+
+    for (int waitedMs = 0; mode == Mode::recording && waitedMs < 1000; waitedMs += 5)
+        juce::Thread::sleep(5);
+
+    drainRecorded();
+
+    auto take = recording;
+    take.length = recordedLength;
+    take.blockSize = recordedBlockSize;
+    take.numChannels = recordedChannels;
+
+    for (size_t deck = 0; deck < decks.size(); ++deck)
+    {
+        take.decks[deck].position = recordedStarts[deck].position;
+        take.decks[deck].playing = recordedStarts[deck].playing;
+    }
+
+    {
+        const juce::ScopedLock sl (recordLock);
+        take.events = std::move(recordedEvents);
+        recordedEvents.clear();
+    }
+
+    if (droppedEvents > 0)
+        DBG("MixAutomation: " + juce::String(droppedEvents.load()) + " events did not fit the ring and were lost");
+
+    stopRecorder();
+    return take;
+}
+
+/**
+ * @brief Checks whether a take is being recorded.
+ * @return True while recording.
+ */
+bool MixAutomation::isRecording() const
+{
+    return mode == Mode::recording || request == Request::record;
+}
+
+/**
+ * @brief Loads the take's tracks, parks the decks at their start positions and replays it.
+ *
+ * The decks are stopped and seeked here, on the message thread, so that by
+ * the time replay starts their read-ahead has refilled from the new
+ * position. Decks that were playing are started here too, but held silent
+ * and parked; the audio thread releases them on the take's first sample,
+ * so it never has to take the transport's lock.
+ *
+ * @param take The take.
+ * @param settleMs Delay before the first replayed block.
+ * @return False if recording, or if a track could not be loaded.
+ */
+bool MixAutomation::play(const AutomationTake& take, int settleMs)
+{
+    if (isRecording() || take.sampleRate <= 0.0)
+        return false;
+
+    stopPlaying();
+
+    if (sampleRate > 0.0 && take.sampleRate != sampleRate)
+        DBG("MixAutomation: take was recorded at " + juce::String(take.sampleRate) + " Hz, replaying at " + juce::String(sampleRate) + " Hz");
+
+    // Every track is loaded before either transport is touched, so a failed load leaves both decks as they were.
+    for (size_t deck = 0; deck < decks.size(); ++deck)
+    {
+        const auto& start = take.decks[deck];
+
+        if (start.track.isNotEmpty())
+        {
+            const juce::URL url { juce::File(start.track) };
+
+            if (decks[deck]->getLoadedURL() != url && ! decks[deck]->loadURL(url))
+                return false;
+        }
+    }
+
+    for (size_t deck = 0; deck < decks.size(); ++deck)
+    {
+        const auto& start = take.decks[deck];
+
+        decks[deck]->stop();
+        decks[deck]->setPosition(start.position);
+
+        if (start.playing)
+        {
+            decks[deck]->holdTransport(true);
+            decks[deck]->start();
+        }
+    }
+
+    // Swapped in under the lock; the audio thread only ever tries it.
+    auto installed = take;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (replayLock);
+        std::swap(replayTake, installed);
+    }
+
+    replayNotBefore = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax(0, settleMs);
+    request = Request::replay;
+    return true;
+}
+
+/**
+ * @brief Stops replaying.
+ *
+ * Decks still held for a replay that never started are stopped and released.
+ */
+void MixAutomation::stopPlaying()
+{
+    request = Request::stopReplay;
+
+    AutomationTake removed;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (replayLock);
+        std::swap(replayTake, removed);
+    }
+
+    for (auto* deck : decks)
+    {
+        if (deck->isTransportHeld())
+        {
+            deck->stop();
+            deck->holdTransport(false);
+        }
+    }
+}
+
+/**
+ * @brief Checks whether a take is being replayed.
+ * @return True while replaying, or waiting to.
+ */
+bool MixAutomation::isReplaying() const
+{
+    return mode == Mode::replaying || request == Request::replay;
+}
+
+/**
+ * @brief Renders a take without an audio device, through fresh decks and a master limiter.
+ *
+ * The decks read their tracks inside the render instead of ahead on a
+ * background thread, so the result never depends on thread timing.
+ *
+ * @param take The take.
+ * @param output The WAV file to write, as 32-bit float.
+ * @param blockSize Block size to render at, or 0 for the take's own.
+ * @return True if the whole take was rendered.
+ */
+bool MixAutomation::renderOffline(const AutomationTake& take, const juce::File& output, int blockSize)
+{
+    if (take.sampleRate <= 0.0 || take.length <= 0)
+        return false;
+
+    const int block = blockSize > 0 ? blockSize : juce::jmax(1, take.blockSize);
+
+    DJAudioPlayer deckA, deckB;
+    deckA.setReadAhead(false);
+    deckB.setReadAhead(false);
+
+    MixAutomation automation {&deckA, &deckB};
+    automation.prepare(take.sampleRate);
+
+    juce::MixerAudioSource mixer;
+    mixer.addInputSource(&deckA, false);
+    mixer.addInputSource(&deckB, false);
+    mixer.prepareToPlay(block, take.sampleRate);
+
+    MasterLimiter limiter;
+    limiter.prepare(take.sampleRate, block);
+
+    if (! automation.play(take, 0))
+        return false;
+
+    output.deleteFile();
+    auto stream = output.createOutputStream();
+
+    if (stream == nullptr)
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor(stream.get(), take.sampleRate,
+                                                                         (unsigned int) take.numChannels, 32, {}, 0));
+
+    if (writer == nullptr)
+        return false;
+
+    stream.release();
+
+    juce::AudioBuffer<float> buffer (take.numChannels, block);
+
+    for (juce::int64 done = 0; done < take.length; )
+    {
+        const int numSamples = (int) juce::jmin((juce::int64) block, take.length - done);
+        const juce::AudioSourceChannelInfo info (&buffer, 0, numSamples);
+
+        if (automation.beginBlock(info))
+            limiter.reset();
+
+        mixer.getNextAudioBlock(info);
+        limiter.process(info);
+        automation.endBlock(info);
+
+        if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+            return false;
+
+        done += numSamples;
+    }
+
+    mixer.removeAllInputs();
+    return true;
+}
+
+/**
+ * @brief Replays a take through the live audio path and compares it with an offline render.
+ *
+ * Fresh decks reading ahead on their background threads, a mixer and a
+ * master limiter are driven block by block, through beginBlock and
+ * endBlock, by a simulated device running in real time, exactly as the
+ * audio callback drives them. The replay is compared sample for sample
+ * with renderOffline's output at the same block size; a difference means
+ * the live replay depended on thread timing, such as a read-ahead that did
+ * not keep up.
+ *
+ * @param take The take.
+ * @param blockSize Block size to run at, or 0 for the take's own.
+ */
+void MixAutomation::runReplayCheck(const AutomationTake& take, int blockSize)
+{
+    const int block = blockSize > 0 ? blockSize : juce::jmax(1, take.blockSize);
+    const double seconds = take.sampleRate > 0.0 ? (double) take.length / take.sampleRate : 0.0;
+
+    std::cout << "Mix replay check: " << take.length << " samples (" << juce::String(seconds, 1) << " s), "
+              << block << " sample blocks at " << take.sampleRate << " Hz" << std::endl;
+
+    juce::TemporaryFile rendered (".wav");
+
+    if (! renderOffline(take, rendered.getFile(), block))
+    {
+        std::cout << "  could not render the take offline" << std::endl;
+        return;
+    }
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor(rendered.getFile().createInputStream().release(), true));
+
+    if (reader == nullptr)
+    {
+        std::cout << "  could not read the offline render back" << std::endl;
+        return;
+    }
+
+    DJAudioPlayer deckA, deckB;
+
+    MixAutomation automation {&deckA, &deckB};
+    automation.prepare(take.sampleRate);
+
+    juce::MixerAudioSource mixer;
+    mixer.addInputSource(&deckA, false);
+    mixer.addInputSource(&deckB, false);
+    mixer.prepareToPlay(block, take.sampleRate);
+
+    MasterLimiter limiter;
+    limiter.prepare(take.sampleRate, block);
+
+    if (! automation.play(take))
+    {
+        std::cout << "  could not load the take's tracks" << std::endl;
+        return;
+    }
+
+    ReplayDevice device (automation, mixer, limiter, take.numChannels, block, take.sampleRate, take.length);
+    device.startThread();
+
+    // The check only reads what the device has already rendered, so it cannot hold the device up.
+    juce::AudioBuffer<float> live (take.numChannels, block * 16);
+    juce::AudioBuffer<float> offline (take.numChannels, block * 16);
+    const double deadline = juce::Time::getMillisecondCounterHiRes() + 1000.0 * seconds + defaultSettleMs + 5000.0;
+
+    juce::int64 compared = 0, numDifferent = 0, firstDifference = -1;
+    int firstChannel = 0;
+    float firstLive = 0.0f, firstOffline = 0.0f, largestDifference = 0.0f;
+
+    while (compared < take.length && ! device.overran && juce::Time::getMillisecondCounterHiRes() < deadline)
+    {
+        const int numSamples = device.readCaptured(live);
+
+        if (numSamples == 0)
+        {
+            juce::Thread::sleep(5);
+            continue;
+        }
+
+        reader->read(&offline, 0, numSamples, compared, true, true);
+
+        for (int channel = 0; channel < take.numChannels; ++channel)
+        {
+            const float* liveSamples = live.getReadPointer(channel);
+            const float* offlineSamples = offline.getReadPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (liveSamples[i] == offlineSamples[i])
+                    continue;
+
+                ++numDifferent;
+                largestDifference = juce::jmax(largestDifference, std::abs(liveSamples[i] - offlineSamples[i]));
+
+                if (firstDifference < 0 || compared + i < firstDifference)
+                {
+                    firstDifference = compared + i;
+                    firstChannel = channel;
+                    firstLive = liveSamples[i];
+                    firstOffline = offlineSamples[i];
+                }
+            }
+        }
+
+        compared += numSamples;
+    }
+
+    device.stopThread(1000);
+    mixer.removeAllInputs();
+
+    if (compared < take.length)
+        std::cout << "  the live replay stopped after " << compared << " of " << take.length << " samples"
+                  << (device.overran ? " (the check fell behind the device)" : "") << std::endl;
+
+    if (firstDifference < 0)
+    {
+        if (compared == take.length)
+            std::cout << "  the live replay matches the offline render sample for sample" << std::endl;
+
+        return;
+    }
+
+    std::cout << "  first difference at sample " << firstDifference << " ("
+              << juce::String((double) firstDifference / take.sampleRate, 3) << " s), channel " << firstChannel
+              << ": live " << firstLive << ", offline " << firstOffline << std::endl;
+    std::cout << "  " << numDifferent << " of " << compared * take.numChannels << " samples differ, largest difference "
+              << largestDifference << std::endl;
+}
+
+/**
+ * @brief Starts a block.
+ *
+ * Takes the replay lock for the whole block if it is free, then applies any
+ * change of mode the message thread asked for. Replay only starts once the
+ * settle time has passed and the lock is held.
+ *
+ * @param bufferToFill The block about to be rendered.
+ * @return True if a take starts replaying with this block.
+ */
+bool MixAutomation::beginBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    blockStart = clock;
+    replayLocked = replayLock.tryEnter();
+
+    auto pending = request.load();
+    bool replayStarted = false;
+
+    if (pending == Request::replay && (! replayLocked || juce::Time::getMillisecondCounter() < replayNotBefore))
+        pending = Request::none;
+
+    if (pending != Request::none && request.compare_exchange_strong(pending, Request::none))
+    {
+        switch (pending)
+        {
+            case Request::record:
+                clock = blockStart = 0;
+                recordedBlockSize = bufferToFill.numSamples;
+                recordedChannels = bufferToFill.buffer->getNumChannels();
+
+                for (size_t deck = 0; deck < decks.size(); ++deck)
+                    recordedStarts[deck] = { {}, decks[deck]->getPosition(), decks[deck]->isPlaying() };
+
+                mode = Mode::recording;
+
+                // The controls as they stand open the take, so it replays from the same settings.
+                for (int deck = 0; deck < 2; ++deck)
+                    for (const auto& event : decks[(size_t) deck]->getControlState())
+                        pushRecorded({ 0, deck, event });
+                break;
+            case Request::stopRecording:
+                if (mode == Mode::recording)
+                    mode = Mode::idle;
+                break;
+            case Request::replay:
+                startReplay();
+                replayStarted = true;
+                break;
+            case Request::stopReplay:
+                if (mode == Mode::replaying)
+                    mode = Mode::idle;
+                break;
+            case Request::none:
+                break;
+        }
+    }
+
+    if (mode == Mode::replaying && replayLocked && clock >= replayTake.length)
+        mode = Mode::idle;
+
+    replayingThisBlock = replayLocked && mode == Mode::replaying;
+    return replayStarted;
+}
+
+/**
+ * @brief Starts replaying the installed take.
+ *
+ * Each deck's effects are reset and its gain set to the take's opening
+ * value, so the replay does not depend on what was playing before; decks
+ * that were playing when the take was recorded were started and held by
+ * play, and are released here so they start on its first sample.
+ */
+void MixAutomation::startReplay()
+{
+    clock = blockStart = 0;
+    replayCursors = {};
+
+    for (int deck = 0; deck < 2; ++deck)
+    {
+        float gain = 1.0f;
+
+        for (const auto& event : replayTake.events)
+        {
+            if (event.sample > 0)
+                break;
+
+            if (event.deck == deck && event.event.type == DeckEvent::Type::setGain)
+                gain = event.event.value;
+        }
+
+        auto* player = decks[(size_t) deck];
+        player->resetProcessing(gain);
+        player->holdTransport(false);
+    }
+
+    mode = Mode::replaying;
+}
+
+/**
+ * @brief Ends a block started by beginBlock.
+ * @param bufferToFill The rendered block.
+ */
+void MixAutomation::endBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (mode != Mode::idle)
+    {
+        clock += bufferToFill.numSamples;
+
+        if (mode == Mode::recording)
+            recordedLength = clock;
+    }
+
+    replayingThisBlock = false;
+
+    if (replayLocked)
+    {
+        replayLock.exit();
+        replayLocked = false;
+    }
+}
+
+/**
+ * @brief Logs a control event applied at the start of this block.
+ * @param deck The deck (0 or 1).
+ * @param event The event.
+ */
+void MixAutomation::record(int deck, const DeckEvent& event)
+{
+    pushRecorded({ blockStart, deck, event });
+}
+
+/**
+ * @brief Copies an event into the ring.
+ *
+ * Both decks render on the audio thread, so the ring has a single writer.
+ * If the recorder thread has fallen behind the event is counted and lost.
+ *
+ * @param event The event.
+ */
+void MixAutomation::pushRecorded(const AutomationEvent& event)
+{
+    const auto scope = recordFifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        recordRing[(size_t) scope.startIndex1] = event;
+    else if (scope.blockSize2 > 0)
+        recordRing[(size_t) scope.startIndex2] = event;
+    else
+        ++droppedEvents;
+}
+
+/**
+ * @brief Stops the recorder thread; the next take starts it again.
+ */
+void MixAutomation::stopRecorder()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(2000);
+}
+
+/**
+ * @brief Recorder thread: drains the ring every recorderIntervalMs.
+ */
+void MixAutomation::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(recorderIntervalMs);
+        drainRecorded();
+    }
+}
+
+/**
+ * @brief Moves every event in the ring into the recorded take.
+ *
+ * The ring only allows one reader at a time, so the recorder thread and
+ * stopRecording take turns on recordLock.
+ */
+void MixAutomation::drainRecorded()
+{
+    const juce::ScopedLock sl (recordLock);
+    const auto scope = recordFifo.read(recordFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        recordedEvents.push_back(recordRing[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        recordedEvents.push_back(recordRing[(size_t) (scope.startIndex2 + i)]);
+}
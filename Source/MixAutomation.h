@@ -0,0 +1,331 @@
+/**
+ * =================================================================
+ * @file MixAutomation.h
+ * @brief Declaration of the MixAutomation class and the AutomationTake structure.
+ *
+ * This file declares the mix automation recorder, which logs every control
+ * movement on both decks with the audio sample it took effect at, and plays
+ * a recorded take back, live or offline, at exactly those samples.
+ *
+ * Created: 19 Oct 2026 5:26:51am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckEventQueue.h"
+
+class DJAudioPlayer;
+
+/**
+ * @brief One recorded control movement.
+ */
+struct AutomationEvent {
+    juce::int64 sample = 0; /**< Sample of the take the event takes effect at. */
+    int deck = 0;           /**< 0 for deck A, 1 for deck B. */
+    DeckEvent event { DeckEvent::Type::setGain }; /**< The control event, as applied by the deck. */
+};
+
+/**
+ * @brief A recorded mix: where each deck started and every control movement after that.
+ */
+struct AutomationTake {
+    /**
+     * @brief State of one deck's transport at the first sample of the take.
+     */
+    struct DeckStart {
+        juce::String track;     /**< Full path of the loaded track, empty if none. */
+        double position = 0.0;  /**< Playhead position in seconds. */
+        bool playing = false;   /**< True if the deck was playing. */
+    };
+
+    double sampleRate = 0.0;    /**< Sample rate the take was recorded at. */
+    int blockSize = 0;          /**< Size of the first audio block of the recording. */
+    int numChannels = 2;        /**< Output channels of the recording. */
+    juce::int64 length = 0;     /**< Length of the take in samples. */
+    std::array<DeckStart, 2> decks; /**< Deck A and deck B. */
+    std::vector<AutomationEvent> events; /**< Control movements, in sample order. */
+
+    /**
+     * @brief Writes the take in its compact binary form.
+     * @param file The file to write; replaced if it exists.
+     * @return True if the take was written.
+     */
+    bool writeTo(const juce::File& file) const;
+
+    /**
+     * @brief Reads a take written by writeTo.
+     * @param file The file to read.
+     * @param take Receives the take.
+     * @return True if the file held a complete, valid take.
+     */
+    static bool readFrom(const juce::File& file, AutomationTake& take);
+};
+
+/**
+ * @class MixAutomation
+ * @brief Records and replays the control movements of both decks, sample-accurately.
+ *
+ * The audio callback brackets each block with beginBlock and endBlock, which
+ * keep a sample clock running while a take records or replays. While
+ * recording, each deck hands every control event it applies to record(),
+ * which copies it into a wait-free ring stamped with the clock; a background
+ * thread drains the ring, so the audio thread never allocates or waits.
+ *
+ * While replaying, each deck asks replayEvents() for the events due in the
+ * block and renders the block in sections split at them, so every event
+ * lands on the exact sample it was recorded at. Live control events are
+ * ignored meanwhile, so the take plays as recorded.
+ *
+ * Replay starts every deck from a reset effects chain, and the offline
+ * renderer drives fresh decks through this same path, so a replay and an
+ * offline render of a take produce the same samples when they run at the
+ * take's block size and the read-ahead keeps up.
+ *
+ * Only the level, speed, jog, filter and effect controls are recorded. Hot
+ * cues, pads and transport moves (play, stop, seek) are not.
+ */
+class MixAutomation : private juce::Thread
+{
+public:
+    /**
+     * @brief Constructs the automation and hooks it into both players.
+     * @param deckA Player recorded as deck 0.
+     * @param deckB Player recorded as deck 1.
+     */
+    MixAutomation(DJAudioPlayer* deckA, DJAudioPlayer* deckB);
+
+    /**
+     * @brief Destructor for MixAutomation. Unhooks the players and stops the recorder thread.
+     */
+    ~MixAutomation() override;
+
+    /**
+     * @brief Checks whether an event is one that is recorded and replayed.
+     * @param event The event.
+     * @return True for level, speed, jog, filter and effect events.
+     */
+    static bool isAutomated(const DeckEvent& event);
+
+    /**
+     * @brief Gets the folder takes are saved to.
+     * @return The folder in the application data folder.
+     */
+    static juce::File getTakesDirectory();
+
+    /**
+     * @brief Sets the sample rate recorded into takes. Call from prepareToPlay.
+     * @param sampleRate The audio device's sample rate.
+     */
+    void prepare(double sampleRate);
+
+    /**
+     * @brief Starts a take at the next audio block.
+     */
+    void startRecording();
+
+    /**
+     * @brief Ends the take and collects it.
+     *
+     * Waits briefly for the audio thread to close the take; if the audio
+     * device is not running, the take ends at the last rendered block. If
+     * the audio thread never started the take, it is cancelled and an empty
+     * take (length 0) is returned at once. The recorder thread is stopped
+     * either way; it only runs while a take records.
+     *
+     * @return The take.
+     */
+    AutomationTake stopRecording();
+
+    /**
+     * @brief Checks whether a take is being recorded. Safe from any thread.
+     * @return True while recording.
+     */
+    bool isRecording() const;
+
+    /**
+     * @brief Loads the take's tracks, parks the decks at their start positions and replays it.
+     *
+     * Replay starts once the decks have had settleMs to refill their
+     * read-ahead buffers after the seek. Decks that were playing in the take
+     * are started here but held silent until its first block.
+     *
+     * @param take The take.
+     * @param settleMs Delay before the first replayed block.
+     * @return False if recording, or if a track could not be loaded.
+     */
+    bool play(const AutomationTake& take, int settleMs = defaultSettleMs);
+
+    /**
+     * @brief Stops replaying. The decks carry on from where the take left them.
+     */
+    void stopPlaying();
+
+    /**
+     * @brief Checks whether a take is being replayed. Safe from any thread.
+     * @return True while replaying, or waiting to.
+     */
+    bool isReplaying() const;
+
+    /**
+     * @brief Renders a take without an audio device, through fresh decks and a master limiter.
+     * @param take The take.
+     * @param output The WAV file to write, as 32-bit float.
+     * @param blockSize Block size to render at, or 0 for the take's own.
+     * @return True if the whole take was rendered.
+     */
+    static bool renderOffline(const AutomationTake& take, const juce::File& output, int blockSize = 0);
+
+    /**
+     * @brief Replays a take through the live audio path and compares it with an offline render.
+     *
+     * Runs fresh decks, a mixer and a master limiter through beginBlock and
+     * endBlock on a simulated audio device in real time, and prints the first
+     * sample where the replay differs from renderOffline's output, or that
+     * the two match.
+     *
+     * @param take The take.
+     * @param blockSize Block size to run at, or 0 for the take's own.
+     */
+    static void runReplayCheck(const AutomationTake& take, int blockSize = 0);
+
+    /**
+     * @brief Starts a block. Audio thread only; call before the decks render.
+     * @param bufferToFill The block about to be rendered.
+     * @return True if a take starts replaying with this block, so the master bus should be reset.
+     */
+    bool beginBlock(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * @brief Ends a block started by beginBlock. Audio thread only.
+     * @param bufferToFill The rendered block.
+     */
+    void endBlock(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * @brief Checks whether this block is being recorded. Audio thread only.
+     * @return True while recording.
+     */
+    bool isRecordingBlock() const { return mode.load(std::memory_order_relaxed) == Mode::recording; }
+
+    /**
+     * @brief Checks whether this block is being replayed. Audio thread only.
+     * @return True while replaying.
+     */
+    bool isReplayingBlock() const { return mode.load(std::memory_order_relaxed) == Mode::replaying; }
+
+    /**
+     * @brief Logs a control event applied at the start of this block. Audio thread only.
+     * @param deck The deck (0 or 1).
+     * @param event The event.
+     */
+    void record(int deck, const DeckEvent& event);
+
+    /**
+     * @brief Applies a deck's replayed events due at an offset into this block.
+     *
+     * Audio thread only; does nothing unless the block is being replayed.
+     *
+     * @param deck The deck (0 or 1).
+     * @param offset Offset into the block of the section about to be rendered.
+     * @param numSamples Length of the block.
+     * @param callback Callable invoked as callback(const DeckEvent&) for each due event.
+     * @return Offset of the deck's next event within the block, or numSamples if there is none.
+     */
+    template <typename Callback>
+    int replayEvents(int deck, int offset, int numSamples, Callback&& callback)
+    {
+        if (! replayingThisBlock)
+            return numSamples;
+
+        const auto& events = replayTake.events;
+        auto& cursor = replayCursors[(size_t) deck];
+
+        for (; cursor < events.size(); ++cursor)
+        {
+            const auto& event = events[cursor];
+
+            if (event.deck != deck)
+                continue;
+
+            const auto due = event.sample - blockStart;
+
+            if (due > offset)
+                return (int) juce::jmin(due, (juce::int64) numSamples);
+
+            callback(event.event);
+        }
+
+        return numSamples;
+    }
+
+private:
+    /**
+     * @brief What the audio thread is doing with takes.
+     */
+    enum class Mode { idle, recording, replaying };
+
+    /**
+     * @brief A change of mode asked for by the message thread.
+     */
+    enum class Request { none, record, stopRecording, replay, stopReplay };
+
+    /**
+     * @brief Recorder thread: drains the ring every recorderIntervalMs.
+     */
+    void run() override;
+
+    /**
+     * @brief Stops the recorder thread; the next take starts it again.
+     */
+    void stopRecorder();
+
+    /**
+     * @brief Moves every event in the ring into the recorded take.
+     */
+    void drainRecorded();
+
+    /**
+     * @brief Copies an event into the ring. Audio thread only.
+     * @param event The event.
+     */
+    void pushRecorded(const AutomationEvent& event);
+
+    /**
+     * @brief Starts replaying the installed take. Audio thread only.
+     */
+    void startReplay();
+
+    std::array<DJAudioPlayer*, 2> decks;            ///< Players for deck 0 and deck 1.
+    double sampleRate = 0.0;                        ///< Sample rate recorded into takes.
+
+    std::atomic<Request> request { Request::none }; ///< Pending change of mode.
+    std::atomic<Mode> mode { Mode::idle };          ///< Current mode; written by the audio thread.
+    juce::int64 clock = 0;                          ///< Samples since the take started; audio thread only.
+    juce::int64 blockStart = 0;                     ///< Clock at the start of this block; audio thread only.
+
+    juce::AbstractFifo recordFifo { recordCapacity };           ///< Index bookkeeping for the ring.
+    std::vector<AutomationEvent> recordRing;                    ///< Events waiting for the recorder thread.
+    std::atomic<int> droppedEvents { 0 };                       ///< Events lost to a full ring.
+    std::atomic<juce::int64> recordedLength { 0 };              ///< Length of the take so far.
+    std::array<AutomationTake::DeckStart, 2> recordedStarts;    ///< Transport at the take's start; written by the audio thread.
+    int recordedBlockSize = 0;                                  ///< First block size of the take; written by the audio thread.
+    int recordedChannels = 2;                                   ///< Output channels of the take; written by the audio thread.
+    AutomationTake recording;                                   ///< Tracks of the take being recorded; message thread only.
+    juce::CriticalSection recordLock;                           ///< Serialises readers of the ring and guards recordedEvents.
+    std::vector<AutomationEvent> recordedEvents;                ///< Events drained from the ring.
+
+    juce::SpinLock replayLock;                      ///< Held by the audio thread from beginBlock to endBlock.
+    bool replayLocked = false;                      ///< True if this block holds replayLock; audio thread only.
+    bool replayingThisBlock = false;                ///< True if this block replays replayTake; audio thread only.
+    AutomationTake replayTake;                      ///< Take being replayed; changed under replayLock.
+    std::array<size_t, 2> replayCursors {};         ///< Next event for each deck; audio thread only.
+    std::atomic<juce::uint32> replayNotBefore { 0 };///< Millisecond counter replay may start at.
+
+    static constexpr int recordCapacity = 8192;     ///< Events the ring holds between drains.
+    static constexpr int recorderIntervalMs = 50;   ///< How often the recorder thread drains the ring.
+    static constexpr int defaultSettleMs = 250;     ///< Time the read-ahead gets to refill before replay.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixAutomation)
+};
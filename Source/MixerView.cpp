@@ -1,315 +1,547 @@
-/**
- * =================================================================
- * @file MixerView.cpp
- * @brief Implementation of the MixerView component.
- *
- * This file implements the MixerView component that manages the audio mixing
- * controls and filters for two DJ audio players. It includes setup for sliders,
- * labels, and a background image.
- *
- * Created: 5 Feb 2025 5:14:06pm
- * Author: Jacques Thurling
- */
-
-#include <JuceHeader.h>
-#include "MixerView.h"
-
-//==============================================================================
-/**
- * @brief Constructs a new MixerView object.
- *
- * This constructor initializes the mixer view by setting up various sliders for volume,
- * cross-fading, and filter controls. It also configures labels, applies a custom look
- * and feel, and loads a background image.
- *
- * @param _player1 Pointer to the first DJAudioPlayer object.
- * @param _player2 Pointer to the second DJAudioPlayer object.
- */
-MixerView::MixerView(DJAudioPlayer* _player1, DJAudioPlayer* _player2)
-    : djAudioPlayer1(_player1), djAudioPlayer2(_player2)
-{
-    // Create a custom look and feel with a specified transparency factor.
-    auto customLookAndFeel = std::make_unique<CustomLookAndFeel>(0.6f);
-    
-    // Set slider styles for volume sliders.
-    volumeSliderA.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
-    volumeSliderB.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
-    
-    // Apply the custom look and feel to the volume and mixer sliders.
-    volumeSliderA.setLookAndFeel(customLookAndFeel.get());
-    volumeSliderB.setLookAndFeel(customLookAndFeel.get());
-    mixerSlider.setLookAndFeel(customLookAndFeel.get());
-    
-    // Set slider styles for track filter controls (rotary style).
-    trackAHighPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    trackAMidPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    trackALowPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    
-    trackBHighPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    trackBMidPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    trackBLowPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
-    
-    // Apply custom look and feel to the track filter sliders.
-    trackAHighPassSlider.setLookAndFeel(customLookAndFeel.get());
-    trackAMidPassSlider.setLookAndFeel(customLookAndFeel.get());
-    trackALowPassSlider.setLookAndFeel(customLookAndFeel.get());
-    
-    trackBHighPassSlider.setLookAndFeel(customLookAndFeel.get());
-    trackBMidPassSlider.setLookAndFeel(customLookAndFeel.get());
-    trackBLowPassSlider.setLookAndFeel(customLookAndFeel.get());
-    
-    // Remove text boxes from sliders.
-    mixerSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    volumeSliderA.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    volumeSliderB.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    
-    trackAHighPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    trackAMidPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    trackALowPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    
-    trackBHighPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    trackBMidPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    trackBLowPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
-    
-    // Set ranges for the mixer and volume sliders.
-    mixerSlider.setRange(0, 1);
-    volumeSliderA.setRange(0, 1);
-    volumeSliderB.setRange(0, 1);
-    
-    // Set ranges for the track filter sliders.
-    trackAHighPassSlider.setRange(0.1, 1);
-    trackAMidPassSlider.setRange(0, 1);
-    trackALowPassSlider.setRange(0.1, 0.99);
-    
-    trackBHighPassSlider.setRange(0.1, 1);
-    trackBMidPassSlider.setRange(0, 1);
-    trackBLowPassSlider.setRange(0.1, 0.99);
-    
-    // Configure labels for the mixer and volume sliders.
-    mixerLabel.setText("Cross-Fade", juce::dontSendNotification);
-    mixerLabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
-    mixerLabel.attachToComponent(&mixerSlider, false);
-    mixerLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    volumeSliderALabel.setText("Volume Deck A", juce::dontSendNotification);
-    volumeSliderALabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
-    volumeSliderALabel.attachToComponent(&volumeSliderA, false);
-    volumeSliderALabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    volumeSliderBLabel.setText("Volume Deck B", juce::dontSendNotification);
-    volumeSliderBLabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
-    volumeSliderBLabel.attachToComponent(&volumeSliderB, false);
-    volumeSliderBLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    // Configure labels for track A filter sliders.
-    trackAHighPassSliderLabel.setText("Deck A - High", juce::dontSendNotification);
-    trackAHighPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackAHighPassSliderLabel.attachToComponent(&trackAHighPassSlider, false);
-    trackAHighPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    trackAMidPassSliderLabel.setText("Deck A - Mid", juce::dontSendNotification);
-    trackAMidPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackAMidPassSliderLabel.attachToComponent(&trackAMidPassSlider, false);
-    trackAMidPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    trackALowPassSliderLabel.setText("Deck A - Low", juce::dontSendNotification);
-    trackALowPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackALowPassSliderLabel.attachToComponent(&trackALowPassSlider, false);
-    trackALowPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    // Configure labels for track B filter sliders.
-    trackBHighPassSliderLabel.setText("Deck B - High", juce::dontSendNotification);
-    trackBHighPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackBHighPassSliderLabel.attachToComponent(&trackBHighPassSlider, false);
-    trackBHighPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    trackBMidPassSliderLabel.setText("Deck B - Mid", juce::dontSendNotification);
-    trackBMidPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackBMidPassSliderLabel.attachToComponent(&trackBMidPassSlider, false);
-    trackBMidPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    trackBLowPassSliderLabel.setText("Deck B - Low", juce::dontSendNotification);
-    trackBLowPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
-    trackBLowPassSliderLabel.attachToComponent(&trackBLowPassSlider, false);
-    trackBLowPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
-    
-    // Add sliders and labels to the component.
-    addAndMakeVisible(mixerSlider);
-    addAndMakeVisible(mixerLabel);
-    
-    addAndMakeVisible(volumeSliderA);
-    addAndMakeVisible(volumeSliderB);
-    
-    addAndMakeVisible(trackAHighPassSlider);
-    addAndMakeVisible(trackAMidPassSlider);
-    addAndMakeVisible(trackALowPassSlider);
-    
-    addAndMakeVisible(trackBHighPassSlider);
-    addAndMakeVisible(trackBMidPassSlider);
-    addAndMakeVisible(trackBLowPassSlider);
-    
-    // Set default slider values.
-    mixerSlider.setValue(0.5f);
-    volumeSliderA.setValue(0.5f);
-    volumeSliderB.setValue(0.5f);
-    
-    // Register this object as a listener for slider events.
-    volumeSliderA.addListener(this);
-    volumeSliderB.addListener(this);
-    mixerSlider.addListener(this);
-    
-    trackAHighPassSlider.addListener(this);
-    trackAMidPassSlider.addListener(this);
-    trackALowPassSlider.addListener(this);
-    
-    trackBHighPassSlider.addListener(this);
-    trackBMidPassSlider.addListener(this);
-    trackBLowPassSlider.addListener(this);
-    
-    // Store the custom look and feel for proper lifetime management.
-    lookAndFeels.emplace_back(std::move(customLookAndFeel));
-    
-    // Load the background image from the application's resource directory.
-    juce::File appDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile)
-                            .getParentDirectory().getParentDirectory();
-    
-    juce::File imageFile = appDir.getChildFile("Resources/otodecks.png");
-    otodecksImage = juce::ImageCache::getFromFile(imageFile);
-}
-
-/**
- * @brief Destructor for MixerView.
- */
-MixerView::~MixerView()
-{
-}
-
-/**
- * @brief Paints the MixerView component.
- *
- * This method fills the background with a solid color and draws the background image
- * centered at the top of the component.
- *
- * @param g The graphics context used for drawing.
- */
-void MixerView::paint (juce::Graphics& g)
-{
-    // Fill the background with a light grey color.
-    g.fillAll (juce::Colour {233, 233, 233});
-    
-    // Draw the background image centered horizontally at y-coordinate 20.
-    g.drawImage(otodecksImage, (getWidth()/2) - ((otodecksImage.getWidth()/3)/2), 20,
-                otodecksImage.getWidth()/3, otodecksImage.getHeight()/3,
-                0, 0, otodecksImage.getWidth(), otodecksImage.getHeight());
-}
-
-/**
- * @brief Resizes and positions child components.
- *
- * This method calculates and sets the bounds for all child components (sliders and labels)
- * based on the current size of the MixerView.
- */
-void MixerView::resized()
-{
-    // Calculate relative dimensions based on the current component size.
-    float rowH = getHeight() / 8;
-    float width = getWidth() / 4;
-    
-    // Set bounds for the mixer slider and its label.
-    mixerSlider.setBounds(width, rowH * 7, width * 2, rowH);
-    mixerLabel.setBounds(mixerSlider.getX() + (mixerSlider.getWidth()/2) / 2 + 10,
-                         mixerSlider.getBottom() - 90,
-                         mixerSlider.getWidth(), 20);
-    
-    // Set bounds for the volume sliders and their labels.
-    volumeSliderA.setBounds(0, rowH * 1, getWidth() / 4, rowH * 5);
-    volumeSliderB.setBounds((getWidth()/4) * 3, rowH * 1, getWidth()/4, rowH * 5);
-    
-    volumeSliderALabel.setBounds(volumeSliderA.getX(), volumeSliderA.getY() - 20,
-                                 mixerSlider.getWidth(), 20);
-    volumeSliderBLabel.setBounds(volumeSliderB.getX(), volumeSliderB.getY() - 20,
-                                 mixerSlider.getWidth(), 20);
-    
-    // Set bounds for track A filter sliders and labels.
-    trackAHighPassSlider.setBounds((getWidth()/4) * 1, rowH * 1, (getWidth()/4), rowH);
-    trackAHighPassSliderLabel.setBounds(trackAHighPassSlider.getX() + 10,
-                                        trackAHighPassSlider.getY() + 90,
-                                        mixerSlider.getWidth(), 20);
-    
-    trackAMidPassSlider.setBounds((getWidth()/4) * 1, rowH * 2, (getWidth()/4), rowH);
-    trackAMidPassSliderLabel.setBounds(trackAMidPassSlider.getX() + 12,
-                                       trackAMidPassSlider.getY() + 90,
-                                       mixerSlider.getWidth(), 20);
-    
-    trackALowPassSlider.setBounds((getWidth()/4) * 1, rowH * 3, (getWidth()/4), rowH);
-    trackALowPassSliderLabel.setBounds(trackALowPassSlider.getX() + 12,
-                                       trackALowPassSlider.getY() + 90,
-                                       mixerSlider.getWidth(), 20);
-    
-    // Set bounds for track B filter sliders and labels.
-    trackBHighPassSlider.setBounds((getWidth()/4) * 2, rowH * 1, (getWidth()/4), rowH);
-    trackBHighPassSliderLabel.setBounds(trackBHighPassSlider.getX() + 10,
-                                        trackBHighPassSlider.getY() + 90,
-                                        mixerSlider.getWidth(), 20);
-    
-    trackBMidPassSlider.setBounds((getWidth()/4) * 2, rowH * 2, (getWidth()/4), rowH);
-    trackBMidPassSliderLabel.setBounds(trackBMidPassSlider.getX() + 12,
-                                       trackBMidPassSlider.getY() + 90,
-                                       mixerSlider.getWidth(), 20);
-    
-    trackBLowPassSlider.setBounds((getWidth()/4) * 2, rowH * 3, (getWidth()/4), rowH);
-    trackBLowPassSliderLabel.setBounds(trackBLowPassSlider.getX() + 12,
-                                       trackBLowPassSlider.getY() + 90,
-                                       mixerSlider.getWidth(), 20);
-}
-
-/**
- * @brief Handles slider value changes.
- *
- * This callback is invoked when any of the registered sliders changes its value.
- * It updates the corresponding parameters in the associated DJAudioPlayer objects.
- *
- * @param slider Pointer to the slider that triggered the event.
- */
-void MixerView::sliderValueChanged(juce::Slider* slider)
-{
-    if (slider == &volumeSliderA) {
-        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSliderA.getValue());
-        djAudioPlayer1->setGain(slider->getValue());
-    }
-    
-    if (slider == &volumeSliderB) {
-        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSliderB.getValue());
-        djAudioPlayer2->setGain(slider->getValue());
-    }
-    
-    if (slider == &mixerSlider) {
-        // Cross-fade: Adjust the gains of both players based on the mixer slider value.
-        djAudioPlayer1->setGain(1.0f - slider->getValue());
-        djAudioPlayer2->setGain(slider->getValue());
-    }
-    
-    if (slider == &trackAHighPassSlider) {
-        djAudioPlayer1->setHighPassFilterAmount(slider->getValue());
-    }
-    
-    if (slider == &trackAMidPassSlider) {
-        djAudioPlayer1->setMidBandPassFilterAmount(slider->getValue());
-    }
-    
-    if (slider == &trackALowPassSlider) {
-        djAudioPlayer1->setLowPassFilterAmount(1.0f - slider->getValue());
-    }
-    
-    if (slider == &trackBHighPassSlider) {
-        djAudioPlayer2->setHighPassFilterAmount(slider->getValue());
-    }
-    
-    if (slider == &trackBMidPassSlider) {
-        djAudioPlayer2->setMidBandPassFilterAmount(slider->getValue());
-    }
-    
-    if (slider == &trackBLowPassSlider) {
-        djAudioPlayer2->setLowPassFilterAmount(1.0f - slider->getValue());
-    }
-}
+/**
+ * =================================================================
+ * @file MixerView.cpp
+ * @brief Implementation of the MixerView component.
+ *
+ * This file implements the MixerView component that manages the audio mixing
+ * controls and filters for two DJ audio players. It includes setup for sliders,
+ * labels, and a background image.
+ *
+ * Created: 5 Feb 2025 5:14:06pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "MixerView.h"
+#include "AssetCache.h"
+
+//==============================================================================
+/**
+ * @brief Constructs a new MixerView object.
+ *
+ * This constructor initializes the mixer view by setting up various sliders for volume,
+ * cross-fading, and filter controls. It also configures labels, applies a custom look
+ * and feel, and loads a background image.
+ *
+ * @param _player1 Pointer to the first DJAudioPlayer object.
+ * @param _player2 Pointer to the second DJAudioPlayer object.
+ * @param _limiter Pointer to the master bus limiter, used for metering.
+ * @param _masterAnalyser Pointer to the analysis tap on the master bus.
+ */
+MixerView::MixerView(DJAudioPlayer* _player1, DJAudioPlayer* _player2, MasterLimiter* _limiter, AudioAnalyser* _masterAnalyser)
+    : djAudioPlayer1(_player1), djAudioPlayer2(_player2), limiter(_limiter),
+      analysers {&_player1->getAnalyser(), _masterAnalyser, &_player2->getAnalyser()}
+{
+    // Create a custom look and feel with a specified transparency factor.
+    auto customLookAndFeel = std::make_unique<CustomLookAndFeel>(0.6f);
+    
+    // Set slider styles for volume sliders.
+    volumeSliderA.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
+    volumeSliderB.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
+    
+    // Apply the custom look and feel to the volume and mixer sliders.
+    volumeSliderA.setLookAndFeel(customLookAndFeel.get());
+    volumeSliderB.setLookAndFeel(customLookAndFeel.get());
+    mixerSlider.setLookAndFeel(customLookAndFeel.get());
+    
+    // Set slider styles for track filter controls (rotary style).
+    trackAHighPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    trackAMidPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    trackALowPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    
+    trackBHighPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    trackBMidPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    trackBLowPassSlider.setSliderStyle(juce::Slider::SliderStyle::Rotary);
+    
+    // Apply custom look and feel to the track filter sliders.
+    trackAHighPassSlider.setLookAndFeel(customLookAndFeel.get());
+    trackAMidPassSlider.setLookAndFeel(customLookAndFeel.get());
+    trackALowPassSlider.setLookAndFeel(customLookAndFeel.get());
+    
+    trackBHighPassSlider.setLookAndFeel(customLookAndFeel.get());
+    trackBMidPassSlider.setLookAndFeel(customLookAndFeel.get());
+    trackBLowPassSlider.setLookAndFeel(customLookAndFeel.get());
+    
+    // Remove text boxes from sliders.
+    mixerSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    volumeSliderA.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    volumeSliderB.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    
+    trackAHighPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    trackAMidPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    trackALowPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    
+    trackBHighPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    trackBMidPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    trackBLowPassSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    
+    // Set ranges for the mixer and volume sliders.
+    mixerSlider.setRange(0, 1);
+    volumeSliderA.setRange(0, 1);
+    volumeSliderB.setRange(0, 1);
+    
+    // Set ranges for the track filter sliders.
+    trackAHighPassSlider.setRange(0.1, 1);
+    trackAMidPassSlider.setRange(0, 1);
+    trackALowPassSlider.setRange(0.1, 0.99);
+    
+    trackBHighPassSlider.setRange(0.1, 1);
+    trackBMidPassSlider.setRange(0, 1);
+    trackBLowPassSlider.setRange(0.1, 0.99);
+    
+    // Configure labels for the mixer and volume sliders.
+    mixerLabel.setText("Cross-Fade", juce::dontSendNotification);
+    mixerLabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
+    mixerLabel.attachToComponent(&mixerSlider, false);
+    mixerLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    volumeSliderALabel.setText("Volume Deck A", juce::dontSendNotification);
+    volumeSliderALabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
+    volumeSliderALabel.attachToComponent(&volumeSliderA, false);
+    volumeSliderALabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    volumeSliderBLabel.setText("Volume Deck B", juce::dontSendNotification);
+    volumeSliderBLabel.setFont(juce::Font("Helvetica", 16.0f, juce::Font::plain));
+    volumeSliderBLabel.attachToComponent(&volumeSliderB, false);
+    volumeSliderBLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    // Configure labels for track A filter sliders.
+    trackAHighPassSliderLabel.setText("Deck A - High", juce::dontSendNotification);
+    trackAHighPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackAHighPassSliderLabel.attachToComponent(&trackAHighPassSlider, false);
+    trackAHighPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    trackAMidPassSliderLabel.setText("Deck A - Mid", juce::dontSendNotification);
+    trackAMidPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackAMidPassSliderLabel.attachToComponent(&trackAMidPassSlider, false);
+    trackAMidPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    trackALowPassSliderLabel.setText("Deck A - Low", juce::dontSendNotification);
+    trackALowPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackALowPassSliderLabel.attachToComponent(&trackALowPassSlider, false);
+    trackALowPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    // Configure labels for track B filter sliders.
+    trackBHighPassSliderLabel.setText("Deck B - High", juce::dontSendNotification);
+    trackBHighPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackBHighPassSliderLabel.attachToComponent(&trackBHighPassSlider, false);
+    trackBHighPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    trackBMidPassSliderLabel.setText("Deck B - Mid", juce::dontSendNotification);
+    trackBMidPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackBMidPassSliderLabel.attachToComponent(&trackBMidPassSlider, false);
+    trackBMidPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    trackBLowPassSliderLabel.setText("Deck B - Low", juce::dontSendNotification);
+    trackBLowPassSliderLabel.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    trackBLowPassSliderLabel.attachToComponent(&trackBLowPassSlider, false);
+    trackBLowPassSliderLabel.setColour(juce::Label::textColourId, juce::Colour {50,50,50});
+    
+    // Add sliders and labels to the component.
+    addAndMakeVisible(mixerSlider);
+    addAndMakeVisible(mixerLabel);
+    
+    addAndMakeVisible(volumeSliderA);
+    addAndMakeVisible(volumeSliderB);
+    
+    addAndMakeVisible(trackAHighPassSlider);
+    addAndMakeVisible(trackAMidPassSlider);
+    addAndMakeVisible(trackALowPassSlider);
+    
+    addAndMakeVisible(trackBHighPassSlider);
+    addAndMakeVisible(trackBMidPassSlider);
+    addAndMakeVisible(trackBLowPassSlider);
+    
+    // Set default slider values.
+    mixerSlider.setValue(0.5f);
+    volumeSliderA.setValue(0.5f);
+    volumeSliderB.setValue(0.5f);
+    
+    // Register this object as a listener for slider events.
+    volumeSliderA.addListener(this);
+    volumeSliderB.addListener(this);
+    mixerSlider.addListener(this);
+    
+    trackAHighPassSlider.addListener(this);
+    trackAMidPassSlider.addListener(this);
+    trackALowPassSlider.addListener(this);
+    
+    trackBHighPassSlider.addListener(this);
+    trackBMidPassSlider.addListener(this);
+    trackBLowPassSlider.addListener(this);
+    
+    // Store the custom look and feel for proper lifetime management.
+    lookAndFeels.emplace_back(std::move(customLookAndFeel));
+    
+    // Load the background image from the embedded assets.
+    otodecksImage = AssetCache::getImage("otodecks.png");
+    
+    // Spectrum is off by default; toggling it only repaints the meter area.
+    spectrumToggle.setColour(juce::ToggleButton::textColourId, juce::Colour {50, 50, 50});
+    spectrumToggle.setColour(juce::ToggleButton::tickColourId, juce::Colour {50, 50, 50});
+    spectrumToggle.onClick = [this] { repaint(meterBounds); };
+    addAndMakeVisible(spectrumToggle);
+    
+    // Mix automation is handled by the owner; the buttons only report clicks.
+    recordButton.setClickingTogglesState(true);
+    recordButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::firebrick);
+    recordButton.onClick = [this] {
+        if (onRecordToggled)
+            onRecordToggled(recordButton.getToggleState());
+    };
+    replayButton.onClick = [this] {
+        if (onReplayClicked)
+            onReplayClicked();
+    };
+    addAndMakeVisible(recordButton);
+    addAndMakeVisible(replayButton);
+}
+
+/**
+ * @brief Destructor for MixerView.
+ */
+MixerView::~MixerView()
+{
+}
+
+/**
+ * @brief Paints the MixerView component.
+ *
+ * This method fills the background with a solid color and draws the background image
+ * centered at the top of the component.
+ *
+ * @param g The graphics context used for drawing.
+ */
+void MixerView::paint (juce::Graphics& g)
+{
+    // Fill the background with a light grey color.
+    g.fillAll (juce::Colour {233, 233, 233});
+    
+    // Draw the background image centered horizontally at y-coordinate 20.
+    g.drawImage(otodecksImage, (getWidth()/2) - ((otodecksImage.getWidth()/3)/2), 20,
+                otodecksImage.getWidth()/3, otodecksImage.getHeight()/3,
+                0, 0, otodecksImage.getWidth(), otodecksImage.getHeight());
+    
+    // Master limiter gain-reduction meter, filling from the right (0 to -12 dB).
+    g.setColour(juce::Colour {50, 50, 50});
+    g.drawText("Limiter", gainReductionBounds.withY(gainReductionBounds.getY() - 18).withHeight(16),
+               juce::Justification::centredLeft, false);
+    g.setColour(juce::Colour {44, 44, 44});
+    g.fillRect(gainReductionBounds);
+    
+    float reductionProportion = juce::jlimit(0.0f, 1.0f, -displayedGainReduction / 12.0f);
+    auto reductionBar = gainReductionBounds.toFloat();
+    g.setColour(juce::Colour {235, 120, 0});
+    g.fillRect(reductionBar.removeFromRight(reductionBar.getWidth() * reductionProportion));
+    
+    drawMeters(g);
+}
+
+/**
+ * @brief Draws the deck and master level meters and the optional spectrum.
+ *
+ * Each meter shows RMS as a filled bar and the peak as a line, on a scale
+ * from -60 dB to 0 dB. The master's short-term loudness is written above
+ * the meters.
+ *
+ * @param g The graphics context used for drawing.
+ */
+void MixerView::drawMeters(juce::Graphics& g)
+{
+    if (meterBounds.isEmpty())
+        return;
+    
+    auto area = meterBounds;
+    auto header = area.removeFromTop(20);
+    
+    g.setColour(juce::Colour {50, 50, 50});
+    g.setFont(juce::Font("Helvetica", 14.0f, juce::Font::plain));
+    g.drawText(juce::String(meterFrames[1].shortTermLoudness, 1) + " LUFS", header.removeFromLeft(100),
+               juce::Justification::centredLeft, false);
+    
+    auto labels = area.removeFromBottom(16);
+    const char* meterNames[] = {"A", "M", "B"};
+    
+    auto toProportion = [](float gain) {
+        return juce::jlimit(0.0f, 1.0f, (juce::Decibels::gainToDecibels(gain, -60.0f) + 60.0f) / 60.0f);
+    };
+    
+    for (int i = 0; i < 3; ++i) {
+        auto meter = area.removeFromLeft(16).toFloat();
+        area.removeFromLeft(6);
+        
+        g.setColour(juce::Colour {44, 44, 44});
+        g.fillRect(meter);
+        
+        g.setColour(juce::Colour {0, 183, 235});
+        g.fillRect(meter.withTop(meter.getBottom() - meter.getHeight() * toProportion(meterFrames[(size_t) i].rms)));
+        
+        float peakY = meter.getBottom() - meter.getHeight() * toProportion(displayedPeaks[(size_t) i]);
+        g.setColour(displayedPeaks[(size_t) i] >= 1.0f ? juce::Colours::red : juce::Colours::lightgreen);
+        g.fillRect(meter.getX(), peakY - 1.0f, meter.getWidth(), 2.0f);
+        
+        g.setColour(juce::Colour {50, 50, 50});
+        g.drawText(meterNames[i], labels.removeFromLeft(22).withWidth(16), juce::Justification::centred, false);
+    }
+    
+    if (!spectrumToggle.getToggleState())
+        return;
+    
+    // Master spectrum, bands drawn as bars on a -90 dB to 0 dB scale.
+    area.removeFromLeft(4);
+    auto spectrumArea = area.toFloat();
+    g.setColour(juce::Colour {44, 44, 44});
+    g.fillRect(spectrumArea);
+    
+    const auto& spectrum = meterFrames[1].spectrum;
+    float bandWidth = spectrumArea.getWidth() / (float) spectrum.size();
+    g.setColour(juce::Colour {235, 120, 0});
+    
+    for (size_t band = 0; band < spectrum.size(); ++band) {
+        float proportion = juce::jlimit(0.0f, 1.0f, (spectrum[band] + 90.0f) / 90.0f);
+        float barHeight = spectrumArea.getHeight() * proportion;
+        g.fillRect(spectrumArea.getX() + bandWidth * band, spectrumArea.getBottom() - barHeight,
+                   juce::jmax(1.0f, bandWidth - 1.0f), barHeight);
+    }
+}
+
+/**
+ * @brief Resizes and positions child components.
+ *
+ * This method calculates and sets the bounds for all child components (sliders and labels)
+ * based on the current size of the MixerView.
+ */
+void MixerView::resized()
+{
+    // Calculate relative dimensions based on the current component size.
+    float rowH = getHeight() / 8;
+    float width = getWidth() / 4;
+    
+    // Gain-reduction meter sits above the cross-fader.
+    gainReductionBounds = juce::Rectangle<int>(width, rowH * 6 + 10, width * 2, 10);
+    
+    // Mix automation buttons get their own row, so they never cover the loudness readout.
+    recordButton.setBounds(width, rowH * 4 + 10, 50, 20);
+    replayButton.setBounds(recordButton.getRight() + 5, recordButton.getY(), 60, 20);
+    
+    // Level meters and spectrum fill the space between the buttons and the limiter meter.
+    meterBounds = juce::Rectangle<int>(width, recordButton.getBottom() + 4, width * 2, rowH * 2 - 54);
+    spectrumToggle.setBounds(meterBounds.getRight() - 90, meterBounds.getY(), 90, 20);
+    
+    // Set bounds for the mixer slider and its label.
+    mixerSlider.setBounds(width, rowH * 7, width * 2, rowH);
+    mixerLabel.setBounds(mixerSlider.getX() + (mixerSlider.getWidth()/2) / 2 + 10,
+                         mixerSlider.getBottom() - 90,
+                         mixerSlider.getWidth(), 20);
+    
+    // Set bounds for the volume sliders and their labels.
+    volumeSliderA.setBounds(0, rowH * 1, getWidth() / 4, rowH * 5);
+    volumeSliderB.setBounds((getWidth()/4) * 3, rowH * 1, getWidth()/4, rowH * 5);
+    
+    volumeSliderALabel.setBounds(volumeSliderA.getX(), volumeSliderA.getY() - 20,
+                                 mixerSlider.getWidth(), 20);
+    volumeSliderBLabel.setBounds(volumeSliderB.getX(), volumeSliderB.getY() - 20,
+                                 mixerSlider.getWidth(), 20);
+    
+    // Set bounds for track A filter sliders and labels.
+    trackAHighPassSlider.setBounds((getWidth()/4) * 1, rowH * 1, (getWidth()/4), rowH);
+    trackAHighPassSliderLabel.setBounds(trackAHighPassSlider.getX() + 10,
+                                        trackAHighPassSlider.getY() + 90,
+                                        mixerSlider.getWidth(), 20);
+    
+    trackAMidPassSlider.setBounds((getWidth()/4) * 1, rowH * 2, (getWidth()/4), rowH);
+    trackAMidPassSliderLabel.setBounds(trackAMidPassSlider.getX() + 12,
+                                       trackAMidPassSlider.getY() + 90,
+                                       mixerSlider.getWidth(), 20);
+    
+    trackALowPassSlider.setBounds((getWidth()/4) * 1, rowH * 3, (getWidth()/4), rowH);
+    trackALowPassSliderLabel.setBounds(trackALowPassSlider.getX() + 12,
+                                       trackALowPassSlider.getY() + 90,
+                                       mixerSlider.getWidth(), 20);
+    
+    // Set bounds for track B filter sliders and labels.
+    trackBHighPassSlider.setBounds((getWidth()/4) * 2, rowH * 1, (getWidth()/4), rowH);
+    trackBHighPassSliderLabel.setBounds(trackBHighPassSlider.getX() + 10,
+                                        trackBHighPassSlider.getY() + 90,
+                                        mixerSlider.getWidth(), 20);
+    
+    trackBMidPassSlider.setBounds((getWidth()/4) * 2, rowH * 2, (getWidth()/4), rowH);
+    trackBMidPassSliderLabel.setBounds(trackBMidPassSlider.getX() + 12,
+                                       trackBMidPassSlider.getY() + 90,
+                                       mixerSlider.getWidth(), 20);
+    
+    trackBLowPassSlider.setBounds((getWidth()/4) * 2, rowH * 3, (getWidth()/4), rowH);
+    trackBLowPassSliderLabel.setBounds(trackBLowPassSlider.getX() + 12,
+                                       trackBLowPassSlider.getY() + 90,
+                                       mixerSlider.getWidth(), 20);
+}
+
+/**
+ * @brief Handles slider value changes.
+ *
+ * This callback is invoked when any of the registered sliders changes its value.
+ * It updates the corresponding parameters in the associated DJAudioPlayer objects.
+ *
+ * @param slider Pointer to the slider that triggered the event.
+ */
+void MixerView::sliderValueChanged(juce::Slider* slider)
+{
+    if (slider == &volumeSliderA) {
+        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSliderA.getValue());
+        djAudioPlayer1->setGain(slider->getValue());
+    }
+    
+    if (slider == &volumeSliderB) {
+        DBG("DeckGUI::sliderValueChanged : Gain slider value changed: " << volumeSliderB.getValue());
+        djAudioPlayer2->setGain(slider->getValue());
+    }
+    
+    if (slider == &mixerSlider) {
+        // Cross-fade: Adjust the gains of both players based on the mixer slider value.
+        djAudioPlayer1->setGain(1.0f - slider->getValue());
+        djAudioPlayer2->setGain(slider->getValue());
+    }
+    
+    if (slider == &trackAHighPassSlider) {
+        djAudioPlayer1->setHighPassFilterAmount(slider->getValue());
+    }
+    
+    if (slider == &trackAMidPassSlider) {
+        djAudioPlayer1->setMidBandPassFilterAmount(slider->getValue());
+    }
+    
+    if (slider == &trackALowPassSlider) {
+        djAudioPlayer1->setLowPassFilterAmount(1.0f - slider->getValue());
+    }
+    
+    if (slider == &trackBHighPassSlider) {
+        djAudioPlayer2->setHighPassFilterAmount(slider->getValue());
+    }
+    
+    if (slider == &trackBMidPassSlider) {
+        djAudioPlayer2->setMidBandPassFilterAmount(slider->getValue());
+    }
+    
+    if (slider == &trackBLowPassSlider) {
+        djAudioPlayer2->setLowPassFilterAmount(1.0f - slider->getValue());
+    }
+}
+
+/**
+ * @brief Polls the limiter and analysers and repaints the meters that changed.
+ *
+ * The limiter publishes its worst reduction through an atomic and the
+ * analysers publish through triple buffers, so this never waits on the audio
+ * or analysis threads. Meters fall back slowly so short peaks remain visible;
+ * the fall is scaled by the frame time so it looks the same at any frame rate.
+ *
+ * @param elapsedSeconds Time since the previous frame.
+ */
+void MixerView::frameTick(double elapsedSeconds)
+{
+    bool metersChanged = false;
+    float frames = (float) elapsedSeconds * 60.0f;
+    float peakFall = std::pow(0.9f, frames);
+    float reductionFall = std::pow(0.85f, frames);
+    
+    for (size_t i = 0; i < analysers.size(); ++i) {
+        if (analysers[i]->getLatestFrame(meterFrames[i])) {
+            displayedPeaks[i] = juce::jmax(meterFrames[i].peak, displayedPeaks[i] * peakFall);
+            metersChanged = true;
+        }
+    }
+    
+    if (metersChanged) {
+        repaint(meterBounds);
+    }
+    
+    float reduction = limiter->getGainReductionDb();
+    float newDisplay = juce::jmin(reduction, displayedGainReduction * reductionFall);
+    
+    if (std::abs(newDisplay - displayedGainReduction) > 0.05f) {
+        displayedGainReduction = newDisplay;
+        repaint(gainReductionBounds.expanded(0, 20));
+    }
+}
+
+const std::array<std::pair<juce::Slider MixerView::*, const char*>, 9> MixerView::sessionSliders {{
+    {&MixerView::mixerSlider, "crossfader"},
+    {&MixerView::volumeSliderA, "volume_a"},
+    {&MixerView::volumeSliderB, "volume_b"},
+    {&MixerView::trackAHighPassSlider, "high_a"},
+    {&MixerView::trackAMidPassSlider, "mid_a"},
+    {&MixerView::trackALowPassSlider, "low_a"},
+    {&MixerView::trackBHighPassSlider, "high_b"},
+    {&MixerView::trackBMidPassSlider, "mid_b"},
+    {&MixerView::trackBLowPassSlider, "low_b"}
+}};
+
+/**
+ * @brief Writes the crossfader, volumes and filters into the session state.
+ * @param values The session state to add to.
+ */
+void MixerView::saveState(juce::NamedValueSet& values) const
+{
+    for (const auto& [slider, name] : sessionSliders) {
+        values.set(SessionStore::key("mixer", name), (this->*slider).getValue());
+    }
+}
+
+/**
+ * @brief Restores the crossfader, volumes and filters from the session state.
+ *
+ * The crossfader comes first, so restored deck volumes are not overridden
+ * by the gains it sets.
+ *
+ * @param values The restored session state.
+ */
+void MixerView::restoreState(const juce::NamedValueSet& values)
+{
+    for (const auto& [slider, name] : sessionSliders) {
+        if (const auto* value = values.getVarPointer(SessionStore::key("mixer", name))) {
+            (this->*slider).setValue((double) *value, juce::sendNotificationSync);
+        }
+    }
+}
+
+/**
+ * @brief Shows a value set from a MIDI controller, without applying it again.
+ *
+ * The controller has already driven the players from the MIDI thread, so
+ * the sliders are moved without notification.
+ *
+ * @param deck The deck the control belongs to (0 or 1).
+ * @param control The control that moved; ones the mixer does not show are ignored.
+ * @param value The value, in the units of the control's slider.
+ */
+void MixerView::showControlValue(int deck, MidiControlSurface::Control control, double value)
+{
+    using Control = MidiControlSurface::Control;
+    juce::Slider* slider = nullptr;
+    
+    switch (control) {
+        case Control::volume:     slider = deck == 0 ? &volumeSliderA : &volumeSliderB; break;
+        case Control::eqHigh:     slider = deck == 0 ? &trackAHighPassSlider : &trackBHighPassSlider; break;
+        case Control::eqMid:      slider = deck == 0 ? &trackAMidPassSlider : &trackBMidPassSlider; break;
+        case Control::eqLow:      slider = deck == 0 ? &trackALowPassSlider : &trackBLowPassSlider; break;
+        case Control::crossfader: slider = &mixerSlider; break;
+        default: break;
+    }
+    
+    if (slider != nullptr) {
+        slider->setValue(value, juce::dontSendNotification);
+    }
+}
+
+/**
+ * @brief Shows whether a mix take is being recorded or replayed.
+ * @param recording True while recording.
+ * @param replaying True while replaying.
+ */
+void MixerView::showAutomationState(bool recording, bool replaying)
+{
+    recordButton.setToggleState(recording, juce::dontSendNotification);
+    recordButton.setEnabled(! replaying);
+    replayButton.setButtonText(replaying ? "Stop" : "Replay");
+    replayButton.setEnabled(! recording);
+}
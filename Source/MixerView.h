@@ -1,120 +1,205 @@
-/**
- * =================================================================
- * @file MixerView.h
- * @brief Header file for the MixerView component.
- *
- * This file declares the MixerView class, which provides a graphical interface for
- * mixing audio from two DJAudioPlayer instances. It includes controls for volume,
- * cross-fading, and filter adjustments, along with their corresponding labels.
- *
- * Created: 5 Feb 2025 5:14:06pm
- * Author: Jacques Thurling
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "DJAudioPlayer.h"
-#include "CustomLookAndFeel.h"
-#include "CSVReader.h"
-
-/**
- * @class MixerView
- * @brief Component for mixing audio between two DJAudioPlayer objects.
- *
- * The MixerView class creates a user interface for audio mixing, providing sliders for
- * volume control, cross-fading, and various filters. Each slider is accompanied by a label,
- * and a custom look and feel is applied for consistent styling.
- */
-class MixerView  : public juce::Component, public juce::Slider::Listener
-{
-public:
-    /**
-     * @brief Constructs a new MixerView object.
-     *
-     * @param _player1 Pointer to the first DJAudioPlayer.
-     * @param _player2 Pointer to the second DJAudioPlayer.
-     */
-    MixerView(DJAudioPlayer* _player1, DJAudioPlayer* _player2);
-
-    /**
-     * @brief Destroys the MixerView object.
-     */
-    ~MixerView() override;
-    
-    /**
-     * @brief Paints the MixerView component.
-     *
-     * This method is responsible for drawing the background and any images associated
-     * with the MixerView.
-     *
-     * @param g The graphics context used for drawing.
-     */
-    void paint (juce::Graphics&) override;
-    
-    /**
-     * @brief Resizes the MixerView component.
-     *
-     * This method sets the bounds of all child components when the MixerView is resized.
-     */
-    void resized() override;
-    
-    /**
-     * @brief Handles slider value changes.
-     *
-     * This callback is invoked when any of the registered sliders change value, updating
-     * the corresponding parameters in the associated DJAudioPlayer instances.
-     *
-     * @param slider Pointer to the slider that triggered the event.
-     */
-    void sliderValueChanged(juce::Slider* slider) override;
-    
-private:
-    /// Vector storing custom look and feel objects for managing component styling.
-    std::vector<std::unique_ptr<juce::LookAndFeel>> lookAndFeels;
-    
-    /// Pointer to the first DJAudioPlayer.
-    DJAudioPlayer* djAudioPlayer1;
-    
-    /// Pointer to the second DJAudioPlayer.
-    DJAudioPlayer* djAudioPlayer2;
-    
-    /// Slider used for cross-fading between the two decks.
-    juce::Slider mixerSlider;
-    
-    /// Label for the cross-fade slider.
-    juce::Label mixerLabel;
-    
-    /// Volume sliders for Deck A and Deck B.
-    juce::Slider volumeSliderA;
-    juce::Slider volumeSliderB;
-    
-    /// Labels for the volume sliders.
-    juce::Label volumeSliderALabel;
-    juce::Label volumeSliderBLabel;
-    
-    /// Sliders for Deck A filter adjustments (High, Mid, Low).
-    juce::Slider trackAHighPassSlider;
-    juce::Slider trackAMidPassSlider;
-    juce::Slider trackALowPassSlider;
-    
-    /// Labels for the Deck A filter sliders.
-    juce::Label trackAHighPassSliderLabel;
-    juce::Label trackAMidPassSliderLabel;
-    juce::Label trackALowPassSliderLabel;
-    
-    /// Sliders for Deck B filter adjustments (High, Mid, Low).
-    juce::Slider trackBHighPassSlider;
-    juce::Slider trackBMidPassSlider;
-    juce::Slider trackBLowPassSlider;
-    
-    /// Labels for the Deck B filter sliders.
-    juce::Label trackBHighPassSliderLabel;
-    juce::Label trackBMidPassSliderLabel;
-    juce::Label trackBLowPassSliderLabel;
-    
-    /// Background image used in the MixerView.
-    juce::Image otodecksImage;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerView)
-};
+/**
+ * =================================================================
+ * @file MixerView.h
+ * @brief Header file for the MixerView component.
+ *
+ * This file declares the MixerView class, which provides a graphical interface for
+ * mixing audio from two DJAudioPlayer instances. It includes controls for volume,
+ * cross-fading, and filter adjustments, along with their corresponding labels.
+ *
+ * Created: 5 Feb 2025 5:14:06pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "CustomLookAndFeel.h"
+#include "CSVReader.h"
+#include "MasterLimiter.h"
+#include "AudioAnalyser.h"
+#include "FrameClock.h"
+#include "SessionStore.h"
+#include "MidiControlSurface.h"
+
+/**
+ * @class MixerView
+ * @brief Component for mixing audio between two DJAudioPlayer objects.
+ *
+ * The MixerView class creates a user interface for audio mixing, providing sliders for
+ * volume control, cross-fading, and various filters. Each slider is accompanied by a label,
+ * and a custom look and feel is applied for consistent styling.
+ */
+class MixerView  : public juce::Component, public juce::Slider::Listener, public FrameClock::Listener
+{
+public:
+    /**
+     * @brief Constructs a new MixerView object.
+     *
+     * @param _player1 Pointer to the first DJAudioPlayer.
+     * @param _player2 Pointer to the second DJAudioPlayer.
+     * @param _limiter Pointer to the master bus limiter, used for metering.
+     * @param _masterAnalyser Pointer to the analysis tap on the master bus.
+     */
+    MixerView(DJAudioPlayer* _player1, DJAudioPlayer* _player2, MasterLimiter* _limiter, AudioAnalyser* _masterAnalyser);
+
+    /**
+     * @brief Destroys the MixerView object.
+     */
+    ~MixerView() override;
+    
+    /**
+     * @brief Paints the MixerView component.
+     *
+     * This method is responsible for drawing the background and any images associated
+     * with the MixerView.
+     *
+     * @param g The graphics context used for drawing.
+     */
+    void paint (juce::Graphics&) override;
+    
+    /**
+     * @brief Resizes the MixerView component.
+     *
+     * This method sets the bounds of all child components when the MixerView is resized.
+     */
+    void resized() override;
+    
+    /**
+     * @brief Handles slider value changes.
+     *
+     * This callback is invoked when any of the registered sliders change value, updating
+     * the corresponding parameters in the associated DJAudioPlayer instances.
+     *
+     * @param slider Pointer to the slider that triggered the event.
+     */
+    void sliderValueChanged(juce::Slider* slider) override;
+    
+    /**
+     * @brief Polls the limiter and analysers and repaints the meters that changed.
+     * @param elapsedSeconds Time since the previous frame.
+     */
+    void frameTick(double elapsedSeconds) override;
+    
+    /**
+     * @brief Writes the crossfader, volumes and filters into the session state.
+     * @param values The session state to add to.
+     */
+    void saveState(juce::NamedValueSet& values) const;
+    
+    /**
+     * @brief Restores the crossfader, volumes and filters from the session state.
+     * @param values The restored session state.
+     */
+    void restoreState(const juce::NamedValueSet& values);
+    
+    /**
+     * @brief Shows a value set from a MIDI controller, without applying it again.
+     * @param deck The deck the control belongs to (0 or 1).
+     * @param control The control that moved; ones the mixer does not show are ignored.
+     * @param value The value, in the units of the control's slider.
+     */
+    void showControlValue(int deck, MidiControlSurface::Control control, double value);
+    
+    /**
+     * @brief Shows whether a mix take is being recorded or replayed.
+     * @param recording True while recording.
+     * @param replaying True while replaying.
+     */
+    void showAutomationState(bool recording, bool replaying);
+    
+    /** Called when the record button is toggled, with true to start recording. */
+    std::function<void(bool shouldRecord)> onRecordToggled;
+    
+    /** Called when the replay button is clicked. */
+    std::function<void()> onReplayClicked;
+    
+private:
+    /**
+     * @brief Draws the deck and master level meters and the optional spectrum.
+     * @param g The graphics context used for drawing.
+     */
+    void drawMeters(juce::Graphics& g);
+    
+    /// Vector storing custom look and feel objects for managing component styling.
+    std::vector<std::unique_ptr<juce::LookAndFeel>> lookAndFeels;
+    
+    /// Pointer to the first DJAudioPlayer.
+    DJAudioPlayer* djAudioPlayer1;
+    
+    /// Pointer to the second DJAudioPlayer.
+    DJAudioPlayer* djAudioPlayer2;
+    
+    /// Pointer to the master bus limiter.
+    MasterLimiter* limiter;
+    
+    /// Gain reduction currently shown on the meter, in decibels.
+    float displayedGainReduction = 0.0f;
+    
+    /// Area of the gain-reduction meter, so only it is repainted.
+    juce::Rectangle<int> gainReductionBounds;
+    
+    /// Analysis taps for Deck A, the master bus and Deck B, in meter order.
+    std::array<AudioAnalyser*, 3> analysers;
+    
+    /// Latest analysis frame for each tap.
+    std::array<AnalysisFrame, 3> meterFrames;
+    
+    /// Peak level currently shown on each meter, with fall-back applied.
+    std::array<float, 3> displayedPeaks {};
+    
+    /// Area of the level meters and spectrum, so only it is repainted.
+    juce::Rectangle<int> meterBounds;
+    
+    /// Shows or hides the master spectrum next to the meters.
+    juce::ToggleButton spectrumToggle {"Spectrum"};
+    
+    /// Records the control movements of both decks into a take.
+    juce::TextButton recordButton {"Rec"};
+    
+    /// Replays a recorded take, or stops the one replaying.
+    juce::TextButton replayButton {"Replay"};
+    
+    /// Slider used for cross-fading between the two decks.
+    juce::Slider mixerSlider;
+    
+    /// Label for the cross-fade slider.
+    juce::Label mixerLabel;
+    
+    /// Volume sliders for Deck A and Deck B.
+    juce::Slider volumeSliderA;
+    juce::Slider volumeSliderB;
+    
+    /// Labels for the volume sliders.
+    juce::Label volumeSliderALabel;
+    juce::Label volumeSliderBLabel;
+    
+    /// Sliders for Deck A filter adjustments (High, Mid, Low).
+    juce::Slider trackAHighPassSlider;
+    juce::Slider trackAMidPassSlider;
+    juce::Slider trackALowPassSlider;
+    
+    /// Labels for the Deck A filter sliders.
+    juce::Label trackAHighPassSliderLabel;
+    juce::Label trackAMidPassSliderLabel;
+    juce::Label trackALowPassSliderLabel;
+    
+    /// Sliders for Deck B filter adjustments (High, Mid, Low).
+    juce::Slider trackBHighPassSlider;
+    juce::Slider trackBMidPassSlider;
+    juce::Slider trackBLowPassSlider;
+    
+    /// Labels for the Deck B filter sliders.
+    juce::Label trackBHighPassSliderLabel;
+    juce::Label trackBMidPassSliderLabel;
+    juce::Label trackBLowPassSliderLabel;
+    
+    /// Each slider kept in the session state, with its value name.
+    static const std::array<std::pair<juce::Slider MixerView::*, const char*>, 9> sessionSliders;
+    
+    /// Background image used in the MixerView.
+    juce::Image otodecksImage;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerView)
+};
@@ -0,0 +1,268 @@
+/**
+ * =================================================================
+ * @file OscRemote.cpp
+ * @brief Implementation of the OscRemote class.
+ *
+ * Created: 19 Oct 2026 4:02:18am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "OscRemote.h"
+
+/**
+ * @brief Constructs the server and loads its settings.
+ * @param controlsToUse Applies incoming control messages.
+ * @param deckA Player reported as deck "a".
+ * @param deckB Player reported as deck "b".
+ */
+OscRemote::OscRemote(MidiControlSurface& controlsToUse, DJAudioPlayer* deckA, DJAudioPlayer* deckB)
+    : juce::Thread("OSC telemetry"), controls(controlsToUse), decks { deckA, deckB }
+{
+    for (const juce::String prefix : { "/deck/a/", "/deck/b/" })
+    {
+        addresses.push_back({ juce::OSCAddressPattern(prefix + "position"),
+                              juce::OSCAddressPattern(prefix + "length"),
+                              juce::OSCAddressPattern(prefix + "playing"),
+                              juce::OSCAddressPattern(prefix + "speed"),
+                              juce::OSCAddressPattern(prefix + "bpm"),
+                              juce::OSCAddressPattern(prefix + "beat"),
+                              juce::OSCAddressPattern(prefix + "beatphase"),
+                              juce::OSCAddressPattern(prefix + "peak"),
+                              juce::OSCAddressPattern(prefix + "rms") });
+    }
+
+    settings = loadSettings(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                .getChildFile("New_DJ").getChildFile("osc.xml"));
+}
+
+/**
+ * @brief Destructor for OscRemote.
+ */
+OscRemote::~OscRemote()
+{
+    receiver.removeListener(this);
+    receiver.disconnect();
+
+    signalThreadShouldExit();
+    notify();
+    stopThread(2000);
+
+    sender.disconnect();
+}
+
+/**
+ * @brief Opens the sockets and starts sending telemetry, unless disabled in the settings.
+ * @return True if control messages are being received.
+ */
+bool OscRemote::start()
+{
+    if (! settings.enabled)
+        return false;
+
+    if (! receiveSocket.bindToPort(settings.receivePort, settings.bindAddress)
+        || ! receiver.connectToSocket(receiveSocket))
+    {
+        DBG("OscRemote: could not listen on " + settings.bindAddress + ":" + juce::String(settings.receivePort));
+        return false;
+    }
+
+    receiver.addListener(this);
+
+    if (! sendSocket.bindToPort(0, settings.bindAddress)
+        || ! sender.connectToSocket(sendSocket, settings.sendHost, settings.sendPort))
+    {
+        DBG("OscRemote: could not send to " + settings.sendHost + ":" + juce::String(settings.sendPort));
+        return true;
+    }
+
+    startThread();
+    return true;
+}
+
+/**
+ * @brief Telemetry thread: sends a bundle each tick.
+ *
+ * The thread sleeps out the rest of each tick, and always for at least
+ * three times as long as the tick's work took, so it never uses more than a
+ * quarter of a core however slow sending becomes.
+ */
+void OscRemote::run()
+{
+    const double periodMs = 1000.0 / juce::jlimit(1.0, maxRateHz, settings.rateHz);
+
+    while (! threadShouldExit())
+    {
+        const double started = juce::Time::getMillisecondCounterHiRes();
+        sendTelemetry();
+        const double busyMs = juce::Time::getMillisecondCounterHiRes() - started;
+
+        wait(juce::jmax(1, juce::roundToInt(juce::jmax(periodMs - busyMs, 3.0 * busyMs))));
+    }
+}
+
+/**
+ * @brief Builds and sends one telemetry bundle.
+ *
+ * A deck that has published nothing new since the last tick (e.g. because
+ * the audio device is stopped) is reported with its last known state.
+ */
+void OscRemote::sendTelemetry()
+{
+    juce::OSCBundle bundle;
+
+    for (size_t i = 0; i < decks.size(); ++i)
+    {
+        decks[i]->getLatestTelemetry(latest[i]);
+
+        const auto& telemetry = latest[i];
+        const auto& address = addresses[i];
+        const double tempo = decks[i]->getTrackTempo();
+        const double beats = tempo > 0.0 ? telemetry.position * tempo / 60.0 : 0.0;
+
+        bundle.addElement(juce::OSCMessage(address.position, (float) telemetry.position));
+        bundle.addElement(juce::OSCMessage(address.length, (float) telemetry.length));
+        bundle.addElement(juce::OSCMessage(address.playing, (juce::int32) (telemetry.playing ? 1 : 0)));
+        bundle.addElement(juce::OSCMessage(address.speed, (float) telemetry.speed));
+        bundle.addElement(juce::OSCMessage(address.bpm, (float) (tempo * telemetry.speed)));
+        bundle.addElement(juce::OSCMessage(address.beat, (juce::int32) std::floor(beats)));
+        bundle.addElement(juce::OSCMessage(address.beatPhase, (float) (beats - std::floor(beats))));
+        bundle.addElement(juce::OSCMessage(address.peak, telemetry.peak));
+        bundle.addElement(juce::OSCMessage(address.rms, telemetry.rms));
+    }
+
+    sender.send(bundle);
+}
+
+/**
+ * @brief Applies one control message.
+ *
+ * Once maxMessagesPerSecond messages have arrived in one second, the
+ * receiver's thread stops reading the socket for the rest of that second.
+ * The socket's receive buffer then fills and the system drops further
+ * datagrams unread, so a runaway sender can neither flood the decks'
+ * control queues nor make the receiver parse its flood. At most a receive
+ * buffer's worth of backlog is parsed when reading resumes.
+ *
+ * @param message The message.
+ */
+void OscRemote::oscMessageReceived(const juce::OSCMessage& message)
+{
+    const auto now = juce::Time::getMillisecondCounter();
+
+    if (now - rateWindowStart >= 1000)
+    {
+        rateWindowStart = now;
+        messagesInWindow = 0;
+    }
+
+    if (++messagesInWindow > maxMessagesPerSecond)
+    {
+        while (juce::Time::getMillisecondCounter() - rateWindowStart < 1000 && ! juce::Thread::currentThreadShouldExit())
+            juce::Thread::sleep(10);
+
+        return;
+    }
+
+    double value = 1.0;
+
+    if (! message.isEmpty())
+    {
+        const auto& argument = message[0];
+
+        if (argument.isFloat32())
+            value = argument.getFloat32();
+        else if (argument.isInt32())
+            value = argument.getInt32();
+        else
+            return;
+    }
+
+    auto parts = juce::StringArray::fromTokens(message.getAddressPattern().toString(), "/", "");
+    parts.removeEmptyStrings();
+
+    using Control = MidiControlSurface::Control;
+
+    if (parts.size() == 2 && parts[0] == "mixer" && parts[1] == "crossfader")
+    {
+        controls.applyRemote(0, Control::crossfader, 0, value);
+        return;
+    }
+
+    if (parts.size() < 3 || parts[0] != "deck")
+        return;
+
+    const int deck = parts[1] == "a" ? 0 : (parts[1] == "b" ? 1 : -1);
+    const int control = MidiControlSurface::controlFromName(parts[2]);
+
+    if (deck < 0 || control < 0 || control == (int) Control::crossfader)
+        return;
+
+    controls.applyRemote(deck, (Control) control, parts[3].getIntValue(), value);
+}
+
+/**
+ * @brief Applies every message in a bundle.
+ * @param bundle The bundle.
+ */
+void OscRemote::oscBundleReceived(const juce::OSCBundle& bundle)
+{
+    applyBundle(bundle, 0);
+}
+
+/**
+ * @brief Applies every message in a bundle and in the bundles nested in it.
+ * @param bundle The bundle.
+ * @param depth How deeply the bundle is nested.
+ */
+void OscRemote::applyBundle(const juce::OSCBundle& bundle, int depth)
+{
+    if (depth >= maxBundleDepth)
+        return;
+
+    for (const auto& element : bundle)
+    {
+        if (element.isMessage())
+            oscMessageReceived(element.getMessage());
+        else if (element.isBundle())
+            applyBundle(element.getBundle(), depth + 1);
+    }
+}
+
+/**
+ * @brief Reads the settings file, writing the defaults first if there is none.
+ * @param file The settings file.
+ * @return The settings.
+ */
+OscRemote::Settings OscRemote::loadSettings(const juce::File& file)
+{
+    Settings loaded;
+    const auto xml = juce::parseXMLIfTagMatches(file, "OSC");
+
+    if (xml == nullptr)
+    {
+        if (! file.existsAsFile())
+        {
+            juce::XmlElement defaults ("OSC");
+            defaults.setAttribute("enabled", loaded.enabled);
+            defaults.setAttribute("bindAddress", loaded.bindAddress);
+            defaults.setAttribute("receivePort", loaded.receivePort);
+            defaults.setAttribute("sendHost", loaded.sendHost);
+            defaults.setAttribute("sendPort", loaded.sendPort);
+            defaults.setAttribute("rateHz", loaded.rateHz);
+
+            file.getParentDirectory().createDirectory();
+            defaults.writeTo(file);
+        }
+
+        return loaded;
+    }
+
+    loaded.enabled = xml->getBoolAttribute("enabled", loaded.enabled);
+    loaded.bindAddress = xml->getStringAttribute("bindAddress", loaded.bindAddress);
+    loaded.receivePort = xml->getIntAttribute("receivePort", loaded.receivePort);
+    loaded.sendHost = xml->getStringAttribute("sendHost", loaded.sendHost);
+    loaded.sendPort = xml->getIntAttribute("sendPort", loaded.sendPort);
+    loaded.rateHz = xml->getDoubleAttribute("rateHz", loaded.rateHz);
+    return loaded;
+}
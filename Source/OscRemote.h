@@ -0,0 +1,156 @@
+/**
+ * =================================================================
+ * @file OscRemote.h
+ * @brief Declaration of the OscRemote class.
+ *
+ * This file declares the OSC-over-UDP server that streams deck telemetry to
+ * lighting and visual rigs and takes remote control messages in.
+ *
+ * Created: 19 Oct 2026 4:02:18am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "MidiControlSurface.h"
+
+/**
+ * @class OscRemote
+ * @brief OSC telemetry out and remote control in, over UDP.
+ *
+ * Telemetry is sent as one bundle per tick from a dedicated thread, which
+ * reads each deck's wait-free telemetry snapshot, so neither the audio nor
+ * the message thread ever waits on the network. Per deck ("a" or "b") it
+ * sends:
+ *
+ *   /deck/a/position f    playhead in seconds
+ *   /deck/a/length f      track length in seconds
+ *   /deck/a/playing i     1 while playing
+ *   /deck/a/speed f       speed ratio
+ *   /deck/a/bpm f         tempo at the current speed, 0 when unknown
+ *   /deck/a/beat i        beats since the start of the track
+ *   /deck/a/beatphase f   position within the current beat (0 - 1)
+ *   /deck/a/peak f        output peak (linear)
+ *   /deck/a/rms f         output RMS (linear)
+ *
+ * Beats are counted from the start of the track, as there is no beat grid.
+ *
+ * Control messages use the names of the MIDI mapping, e.g. /deck/a/volume f,
+ * /deck/b/play, /deck/a/hotcue/3, /deck/a/jog f (seconds) or
+ * /mixer/crossfader f. Values are 0 - 1 like a controller; buttons need no
+ * argument. They are applied through the MIDI control surface, so they take
+ * the same route into the decks' control queues as the UI and a controller.
+ * Past 2000 messages in a second the socket is not read again until the
+ * second is over, so the excess is dropped by the system without parsing.
+ *
+ * Both sockets are bound to one interface, localhost unless osc.xml in the
+ * application data folder says otherwise. The file is written with the
+ * defaults on first run.
+ */
+class OscRemote : private juce::Thread,
+                  private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
+{
+public:
+    /**
+     * @brief Where the server listens and sends, and how often.
+     */
+    struct Settings {
+        bool enabled = true;                    ///< False to leave the server off.
+        juce::String bindAddress { "127.0.0.1" }; ///< Address of the interface both sockets bind to.
+        int receivePort = 9000;                 ///< Port control messages arrive on.
+        juce::String sendHost { "127.0.0.1" };  ///< Host telemetry is sent to.
+        int sendPort = 9001;                    ///< Port telemetry is sent to.
+        double rateHz = 30.0;                   ///< Telemetry bundles per second.
+    };
+
+    /**
+     * @brief Constructs the server and loads its settings. Nothing is opened yet.
+     * @param controls Applies incoming control messages.
+     * @param deckA Player reported as deck "a".
+     * @param deckB Player reported as deck "b".
+     */
+    OscRemote(MidiControlSurface& controls, DJAudioPlayer* deckA, DJAudioPlayer* deckB);
+
+    /**
+     * @brief Destructor for OscRemote. Stops the telemetry thread and closes both sockets.
+     */
+    ~OscRemote() override;
+
+    /**
+     * @brief Opens the sockets and starts sending telemetry, unless disabled in the settings.
+     * @return True if control messages are being received.
+     */
+    bool start();
+
+    /**
+     * @brief Gets the settings in use.
+     * @return The settings.
+     */
+    const Settings& getSettings() const { return settings; }
+
+private:
+    /**
+     * @brief Telemetry thread: sends a bundle each tick.
+     */
+    void run() override;
+
+    /**
+     * @brief Builds and sends one telemetry bundle.
+     */
+    void sendTelemetry();
+
+    /**
+     * @brief Applies one control message. Called on the receiver's thread.
+     * @param message The message.
+     */
+    void oscMessageReceived(const juce::OSCMessage& message) override;
+
+    /**
+     * @brief Applies every message in a bundle. Called on the receiver's thread.
+     * @param bundle The bundle.
+     */
+    void oscBundleReceived(const juce::OSCBundle& bundle) override;
+
+    /**
+     * @brief Applies every message in a bundle and in the bundles nested in it.
+     * @param bundle The bundle.
+     * @param depth How deeply the bundle is nested.
+     */
+    void applyBundle(const juce::OSCBundle& bundle, int depth);
+
+    /**
+     * @brief Reads the settings file, writing the defaults first if there is none.
+     * @param file The settings file.
+     * @return The settings.
+     */
+    static Settings loadSettings(const juce::File& file);
+
+    /**
+     * @brief Addresses of one deck's telemetry, parsed once.
+     */
+    struct DeckAddresses {
+        juce::OSCAddressPattern position, length, playing, speed, bpm, beat, beatPhase, peak, rms;
+    };
+
+    MidiControlSurface& controls;                       ///< Applies control messages.
+    std::array<DJAudioPlayer*, 2> decks;                ///< Players for deck "a" and deck "b".
+    std::array<DeckTelemetry, 2> latest;                ///< Newest telemetry of each deck; telemetry thread only.
+    std::vector<DeckAddresses> addresses;               ///< Telemetry addresses of each deck.
+    Settings settings;                                  ///< Where to listen and send.
+
+    juce::DatagramSocket receiveSocket;                 ///< Bound to the interface and receive port.
+    juce::DatagramSocket sendSocket;                    ///< Bound to the interface, any port.
+    juce::OSCReceiver receiver { "OSC remote control" };///< Reads control messages on its own thread.
+    juce::OSCSender sender;                             ///< Sends telemetry; telemetry thread only.
+
+    juce::uint32 rateWindowStart = 0;                   ///< Start of the current second; receiver thread only.
+    int messagesInWindow = 0;                           ///< Messages taken this second; receiver thread only.
+
+    static constexpr double maxRateHz = 120.0;          ///< Fastest telemetry rate allowed.
+    static constexpr int maxMessagesPerSecond = 2000;   ///< Beyond this the socket is left unread until the second is over.
+    static constexpr int maxBundleDepth = 4;            ///< Deeper nested bundles are ignored.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscRemote)
+};
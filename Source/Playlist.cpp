@@ -1,296 +1,745 @@
-/**
- * =================================================================
- * @file Playlist.cpp
- * @brief Implementation of the Playlist class for managing audio tracks.
- *
- * This class handles loading, displaying, and managing an audio playlist,
- * including interactions with two decks.
- *
- * @author Jacques Thurling
- * @date 4 Feb 2025
- */
-
-#include <JuceHeader.h>
-#include "Playlist.h"
-
-/**
- * @brief Constructs a Playlist object.
- *
- * Initializes the playlist with predefined tracks, configures the table UI,
- * and registers basic audio formats.
- *
- * @param formatManager Reference to an AudioFormatManager.
- * @param cache Reference to an AudioThumbnailCache.
- * @param deck1 Reference to the first DeckGUI.
- * @param deck2 Reference to the second DeckGUI.
- * @param _states Pointer to a vector of DeckState objects.
- */
-Playlist::Playlist(juce::AudioFormatManager& formatManager, juce::AudioThumbnailCache& cache, DeckGUI& deck1, DeckGUI& deck2, std::vector<DeckState> *_states) :
-audioThumbnail(cache), audioFormatManager(formatManager), deck1(deck1), deck2(deck2), states(_states)
-{
-    formatManager.registerBasicFormats();
-    juce::File executableFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-    juce::File projectDir = executableFile.getParentDirectory();
-    juce::String correctPath;
-    while (projectDir.getFileName() != "New_DJ" && projectDir.getParentDirectory() != projectDir) {
-        projectDir = projectDir.getParentDirectory();
-    }
-    
-    if (projectDir.getFileName() == "New_DJ") {
-        correctPath = projectDir.getFullPathName();
-    } else {
-        // Handle the case where the New_DJ folder wasn't found
-        DBG("New_DJ folder not found in the directory structure");
-    }
-    
-    // Load predefined tracks into the playlist
-    std::vector<std::string> trackNames = {"Escape.mp3", "Cool.mp3", "Faster.mp3", "History.mp3", "Funk.mp3", "Louder.mp3", "Love.mp3"};
-    for (const auto& track : trackNames) {
-        juce::File file(correctPath.toStdString() + "/Assets/" + track);
-        playlistFiles.push_back({file, juce::URL(file)});
-    }
-    
-    tableComponent.updateContent();
-    repaint();
-    
-    // Configure table component UI
-    addAndMakeVisible(tableComponent);
-    tableComponent.getHeader().addColumn("Track Title", 1, 200);
-    tableComponent.getHeader().addColumn("Track Length", 2, 200);
-    tableComponent.getHeader().addColumn("Waveform", 3, 200);
-    tableComponent.getHeader().addColumn("Load Deck A", 4, 200);
-    tableComponent.getHeader().addColumn("Load Deck B", 5, 200);
-    tableComponent.setModel(this);
-}
-
-/**
- * @brief Destructor for Playlist.
- *
- * Cleans up by detaching the table model.
- */
-Playlist::~Playlist()
-{
-    tableComponent.setModel(nullptr);
-}
-
-/**
- * @brief Paints the background of the Playlist component.
- *
- * @param g Graphics context.
- */
-void Playlist::paint(juce::Graphics& g)
-{
-    g.fillAll(juce::Colours::grey);
-}
-
-/**
- * @brief Resizes and arranges the table component.
- */
-void Playlist::resized()
-{
-    tableComponent.setBounds(0, 0, getWidth(), getHeight());
-    for (int i = 1; i <= 5; ++i) {
-        tableComponent.getHeader().setColumnWidth(i, getWidth() / 5);
-    }
-    tableComponent.getHeader().setColour(juce::TableHeaderComponent::backgroundColourId, juce::Colours::white);
-}
-
-/**
- * @brief Returns the number of rows in the playlist.
- *
- * @return Number of tracks in the playlist.
- */
-int Playlist::getNumRows()
-{
-    return playlistFiles.size();
-}
-
-/**
- * @brief Handles the background color of a row.
- *
- * @param g Graphics context.
- * @param rowNumber Index of the row.
- * @param width Row width.
- * @param height Row height.
- * @param rowIsSelected True if the row is selected.
- */
-void Playlist::paintRowBackground(juce::Graphics& g, int rowNumber, int width, int height, bool rowIsSelected)
-{
-    g.fillAll(rowIsSelected ? juce::Colours::lightblue : (rowNumber % 2 == 0 ? juce::Colours::darkgrey : juce::Colours::grey));
-}
-
-/**
- * @brief Paints a cell in the table.
- *
- * @param g Graphics context.
- * @param rowNumber Row index.
- * @param columnId Column index.
- * @param width Cell width.
- * @param height Cell height.
- * @param rowIsSelected True if the row is selected.
- */
-void Playlist::paintCell(juce::Graphics& g, int rowNumber, int columnId, int width, int height, bool rowIsSelected)
-{
-    g.setColour(juce::Colours::white);
-    if (columnId == 1) {
-        g.drawText(playlistFiles[rowNumber].fileUrl.getFileName(), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-    } else if (columnId == 2) {
-        if (auto* reader = audioFormatManager.createReaderFor(playlistFiles[rowNumber].file)) {
-            double lengthInSeconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
-            g.drawText(juce::String::formatted("%d:%02d", static_cast<int>(lengthInSeconds / 60), static_cast<int>(lengthInSeconds) % 60), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-            delete reader;
-        }
-    }
-}
-
-/**
- * @brief Refreshes a table cell component.
- *
- * @param rowNumber Row index.
- * @param columnId Column index.
- * @param isRowSelected True if the row is selected.
- * @param existingComponentToUpdate Pointer to the existing component.
- * @return Updated component pointer.
- */
-juce::Component* Playlist::refreshComponentForCell(int rowNumber, int columnId, bool isRowSelected, juce::Component* existingComponentToUpdate) {
-    if (columnId == 3) {
-        if (existingComponentToUpdate == nullptr) {
-            auto* waveform = new WaveformDisplay(audioFormatManager, audioThumbnail);
-            juce::URL fileUrl = playlistFiles[rowNumber].fileUrl;
-            waveform->loadUrl(fileUrl);
-            existingComponentToUpdate = waveform;
-        }
-    }
-    
-    if (columnId == 4) {
-        if (existingComponentToUpdate == nullptr) {
-            juce::TextButton* btn = new juce::TextButton("Load Deck A");
-            existingComponentToUpdate = btn;
-            juce::String id{std::to_string(rowNumber) + "-" + std::to_string(columnId)};
-            btn->setComponentID(id);
-            btn->addListener(this);
-        }
-    }
-    
-    if (columnId == 5) {
-        if (existingComponentToUpdate == nullptr) {
-            juce::TextButton* btn = new juce::TextButton("Load Deck B");
-            existingComponentToUpdate = btn;
-            juce::String id{std::to_string(rowNumber) + "-" + std::to_string(columnId)};
-            btn->setComponentID(id);
-            btn->addListener(this);
-        }
-    }
-    
-    return existingComponentToUpdate;
-}
-
-/**
- * @brief Handles table cell clicks.
- *
- * @param rowNumber Row index.
- * @param columnId Column index.
- * @param event Mouse event details.
- */
-void Playlist::cellClicked(int rowNumber, int columnId, const juce::MouseEvent& event) {
-    DBG(columnId);
-}
-
-/**
- * @brief Handles button clicks for loading tracks into decks.
- *
- * @param button Pointer to the clicked button.
- */
-void Playlist::buttonClicked(juce::Button* button)
-{
-    std::vector<std::string> temp = split(button->getComponentID().toStdString(), '-');
-    int rowIndex = std::stoi(temp[0]);
-    int columnIndex = std::stoi(temp[1]);
-    
-    if (columnIndex == 4) {
-        deck1.loadUrl(playlistFiles[rowIndex].fileUrl);
-    } else if (columnIndex == 5) {
-        deck2.loadUrl(playlistFiles[rowIndex].fileUrl);
-    }
-}
-
-/**
- * @brief Determines if the playlist accepts dragged files.
- *
- * @param files List of dragged file paths.
- * @return Always returns true.
- */
-bool Playlist::isInterestedInFileDrag(const juce::StringArray& files) {
-    std::cout << "Playlist::isInterestedInFileDrag" << std::endl;
-    return true;
-}
-
-/**
- * @brief Handles file drops for adding tracks to the playlist.
- *
- * @param files List of dropped file paths.
- * @param x Drop position x-coordinate.
- * @param y Drop position y-coordinate.
- */
-void Playlist::filesDropped(const juce::StringArray& files, int x, int y)
-{
-    for (const auto& file : files) {
-        playlistFiles.push_back({juce::File(file), juce::URL(juce::File(file))});
-        tableComponent.updateContent();
-        repaint();
-        return;
-    }
-}
-
-/**
- * @brief Splits a string by a delimiter.
- *
- * @param s Input string.
- * @param delimiter Character used as the delimiter.
- * @return Vector of split substrings.
- */
-std::vector<std::string> Playlist::split(const std::string &s, char delimiter)
-{
-    std::vector<std::string> tokens;
-    std::istringstream stream(s);
-    std::string token;
-    while (std::getline(stream, token, delimiter)) {
-        tokens.push_back(token);
-    }
-    return tokens;
-}
-
-/**
- * @brief Loads deck states from saved settings.
- */
-void Playlist::setDeckStates() {
-    juce::File executableFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-    juce::File projectDir = executableFile.getParentDirectory();
-    juce::String correctPath;
-    while (projectDir.getFileName() != "New_DJ" && projectDir.getParentDirectory() != projectDir) {
-        projectDir = projectDir.getParentDirectory();
-    }
-    
-    if (projectDir.getFileName() == "New_DJ") {
-        correctPath = projectDir.getFullPathName();
-    } else {
-        // Handle the case where the New_DJ folder wasn't found
-        DBG("New_DJ folder not found in the directory structure");
-    }
-    
-    for (auto const &state : *states) {
-        if (state.deck_name == "deck_a") {
-            juce::File file(correctPath.toStdString() + "/Assets/" + state.file_name);
-            juce::URL fileUrl = juce::URL{file};
-            
-            deck1.loadUrl(fileUrl);
-        }
-        
-        if (state.deck_name == "deck_b") {
-            juce::File file(correctPath.toStdString() + "/Assets/" + state.file_name);
-            juce::URL fileUrl = juce::URL{file};
-            
-            deck2.loadUrl(fileUrl);
-        }
-    }
-}
+/**
+ * =================================================================
+ * @file Playlist.cpp
+ * @brief Implementation of the Playlist class for managing audio tracks.
+ *
+ * This class handles loading, displaying, and managing an audio playlist,
+ * including interactions with two decks.
+ *
+ * @author Jacques Thurling
+ * @date 4 Feb 2025
+ */
+
+#include <JuceHeader.h>
+#include "Playlist.h"
+#include "AssetCache.h"
+
+namespace
+{
+    /**
+     * @brief Packs the first eight bytes of lowercased text into an integer that sorts like the text.
+     * @param text The text.
+     * @return The sort key.
+     */
+    juce::uint64 makeTextSortKey(const juce::String& text)
+    {
+        const auto utf8 = text.toLowerCase().toUTF8();
+        juce::uint64 key = 0;
+        int i = 0;
+        for (; i < 8 && utf8[i] != 0; ++i) {
+            key = (key << 8) | (juce::uint8) utf8[i];
+        }
+        return key << (8 * (8 - i));
+    }
+    
+    /**
+     * @brief Turns a non-negative number into an integer that sorts like the number.
+     * @param value The number.
+     * @return The sort key.
+     */
+    juce::uint64 makeNumberSortKey(double value)
+    {
+        // The bit patterns of non-negative doubles order the same way as their values.
+        value = juce::jmax(0.0, value);
+        juce::uint64 key;
+        std::memcpy(&key, &value, sizeof(key));
+        return key;
+    }
+}
+
+/**
+ * @brief Constructs a Playlist object.
+ *
+ * Fills the playlist from the track library, configures the table UI,
+ * and registers basic audio formats. A new library starts out watching the
+ * Assets folder.
+ *
+ * @param formatManager Reference to an AudioFormatManager.
+ * @param cache Reference to the shared WaveformCache.
+ * @param metadata Reference to the TrackMetadataService.
+ * @param library Reference to the TrackLibrary.
+ * @param deck1 Reference to the first DeckGUI.
+ * @param deck2 Reference to the second DeckGUI.
+ */
+Playlist::Playlist(juce::AudioFormatManager& formatManager, WaveformCache& cache, TrackMetadataService& metadata, TrackLibrary& library, DeckGUI& deck1, DeckGUI& deck2) :
+waveformCache(cache), metadataService(metadata), trackLibrary(library), audioFormatManager(formatManager), deck1(deck1), deck2(deck2)
+{
+    formatManager.registerBasicFormats();
+    metadataService.addChangeListener(this);
+    trackLibrary.addChangeListener(this);
+    
+    // Type-to-filter search over the whole library
+    addAndMakeVisible(searchBox);
+    searchBox.setTextToShowWhenEmpty("Search title, artist, album, key:8a, bpm:120-128, time:3:00-5:00", juce::Colours::grey);
+    searchBox.onTextChange = [this] { applySearch(); };
+    
+    // Bulk import of files and folder trees, with progress while their scans run
+    addAndMakeVisible(importButton);
+    importButton.onClick = [this] { showImportChooser(); };
+    addChildComponent(scanProgressBar);
+    
+    // Rank the library by how well each track mixes after the master deck
+    addAndMakeVisible(suggestButton);
+    suggestButton.setClickingTogglesState(true);
+    suggestButton.onClick = [this] {
+        if (suggestButton.getToggleState() && sortColumn != 0) {
+            tableComponent.getHeader().setSortColumnId(0, true);
+        }
+        applySearch();
+    };
+    
+    // Start from the library, seeding a new one with the bundled tracks
+    trackLibrary.startScanning();
+    if (trackLibrary.getFolders().isEmpty()) {
+        trackLibrary.addFolder(AssetCache::getProjectDirectory().getChildFile("Assets"));
+    }
+    reloadTracks();
+    
+    // Configure table component UI
+    addAndMakeVisible(tableComponent);
+    const int unsortable = juce::TableHeaderComponent::defaultFlags | juce::TableHeaderComponent::notSortable;
+    tableComponent.getHeader().addColumn("Track Title", 1, 200);
+    tableComponent.getHeader().addColumn("Track Length", 2, 200);
+    tableComponent.getHeader().addColumn("BPM", 6, 80);
+    tableComponent.getHeader().addColumn("Key", 7, 80);
+    tableComponent.getHeader().addColumn("Date Added", 8, 140);
+    tableComponent.getHeader().addColumn("Waveform", 3, 200, 30, -1, unsortable);
+    tableComponent.getHeader().addColumn("Load Deck A", 4, 200, 30, -1, unsortable);
+    tableComponent.getHeader().addColumn("Load Deck B", 5, 200, 30, -1, unsortable);
+    tableComponent.setMultipleSelectionEnabled(true);
+    tableComponent.setModel(this);
+}
+
+/**
+ * @brief Destructor for Playlist.
+ *
+ * Cleans up by detaching the table model.
+ */
+Playlist::~Playlist()
+{
+    for (auto& [path, thumbnail] : thumbnails) {
+        thumbnail.pyramid->removeChangeListener(this);
+    }
+    trackLibrary.removeChangeListener(this);
+    metadataService.removeChangeListener(this);
+    tableComponent.setModel(nullptr);
+}
+
+/**
+ * @brief Paints the background of the Playlist component.
+ *
+ * @param g Graphics context.
+ */
+void Playlist::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::grey);
+}
+
+/**
+ * @brief Resizes and arranges the table component.
+ */
+void Playlist::resized()
+{
+    auto searchRow = getLocalBounds().removeFromTop(searchBoxHeight);
+    importButton.setBounds(searchRow.removeFromRight(importButtonWidth).reduced(2));
+    suggestButton.setBounds(searchRow.removeFromRight(suggestButtonWidth).reduced(2));
+    scanProgressBar.setBounds(searchRow.removeFromRight(progressBarWidth).reduced(2));
+    searchBox.setBounds(searchRow);
+    tableComponent.setBounds(0, searchBoxHeight, getWidth(), getHeight() - searchBoxHeight);
+    const int fixedWidth = 80 + 80 + 140;
+    for (int i = 1; i <= 5; ++i) {
+        tableComponent.getHeader().setColumnWidth(i, (getWidth() - fixedWidth) / 5);
+    }
+    tableComponent.getHeader().setColour(juce::TableHeaderComponent::backgroundColourId, juce::Colours::white);
+    updateWaveformPriorities();
+}
+
+/**
+ * @brief Returns the number of rows in the playlist.
+ *
+ * @return Number of tracks in the playlist.
+ */
+int Playlist::getNumRows()
+{
+    return (int) rows.size();
+}
+
+/**
+ * @brief Handles the background color of a row.
+ *
+ * @param g Graphics context.
+ * @param rowNumber Index of the row.
+ * @param width Row width.
+ * @param height Row height.
+ * @param rowIsSelected True if the row is selected.
+ */
+void Playlist::paintRowBackground(juce::Graphics& g, int rowNumber, int width, int height, bool rowIsSelected)
+{
+    g.fillAll(rowIsSelected ? juce::Colours::lightblue : (rowNumber % 2 == 0 ? juce::Colours::darkgrey : juce::Colours::grey));
+}
+
+/**
+ * @brief Paints a cell in the table.
+ *
+ * Reads only the metadata table, so painting never touches the disk. Rows
+ * still being scanned show a placeholder until the scan arrives. Waveforms
+ * come from cached thumbnails and the load buttons are drawn in place.
+ *
+ * @param g Graphics context.
+ * @param rowNumber Row index.
+ * @param columnId Column index.
+ * @param width Cell width.
+ * @param height Cell height.
+ * @param rowIsSelected True if the row is selected.
+ */
+void Playlist::paintCell(juce::Graphics& g, int rowNumber, int columnId, int width, int height, bool rowIsSelected)
+{
+    if (rowNumber < 0 || rowNumber >= (int) rows.size())
+        return;
+    
+    const auto& metadata = metadataService.getMetadata(playlistFiles[rows[rowNumber]].metadataId);
+    
+    g.setColour(juce::Colours::white);
+    if (columnId == 1) {
+        juce::String title = playlistFiles[rows[rowNumber]].fileUrl.getFileName();
+        if (metadata.ready) {
+            title = metadata.artist.isEmpty() ? metadata.title : metadata.artist + " - " + metadata.title;
+        }
+        g.drawText(title, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+    } else if (columnId == 2) {
+        juce::String length = "...";
+        if (metadata.ready) {
+            const int lengthInSeconds = static_cast<int>(metadata.durationSeconds);
+            length = juce::String::formatted("%d:%02d", lengthInSeconds / 60, lengthInSeconds % 60);
+        }
+        g.drawText(length, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+    } else if (columnId == 6) {
+        if (metadata.bpm > 0.0f) {
+            g.drawText(juce::String(metadata.bpm, 1), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        }
+    } else if (columnId == 7) {
+        g.drawText(metadata.key, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+    } else if (columnId == 8) {
+        const auto added = trackLibrary.getTrack(playlistFiles[rows[rowNumber]].trackId).added;
+        if (added > 0) {
+            g.drawText(juce::Time(added).formatted("%Y-%m-%d %H:%M"), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        }
+    } else if (columnId == 3) {
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const juce::Image thumbnail = getThumbnail(rowNumber, width, height, scale);
+        if (thumbnail.isValid()) {
+            g.drawImage(thumbnail, juce::Rectangle<float>(0.0f, 0.0f, (float) width, (float) height));
+        }
+    } else if (columnId == 4 || columnId == 5) {
+        auto& lookAndFeel = getLookAndFeel();
+        const auto button = getLoadButtonBounds(width, height).toFloat();
+        g.setColour(lookAndFeel.findColour(juce::TextButton::buttonColourId));
+        g.fillRoundedRectangle(button, 4.0f);
+        g.setColour(lookAndFeel.findColour(juce::ComboBox::outlineColourId));
+        g.drawRoundedRectangle(button.reduced(0.5f), 4.0f, 1.0f);
+        g.setColour(lookAndFeel.findColour(juce::TextButton::textColourOffId));
+        g.drawText(columnId == 4 ? "Load Deck A" : "Load Deck B", button, juce::Justification::centred, true);
+    }
+}
+
+/**
+ * @brief Reprioritises waveform builds when the table scrolls.
+ */
+void Playlist::listWasScrolled()
+{
+    updateWaveformPriorities();
+}
+
+/**
+ * @brief Handles table cell clicks, loading the row onto a deck if a load button was hit.
+ *
+ * @param rowNumber Row index.
+ * @param columnId Column index.
+ * @param event Mouse event details.
+ */
+void Playlist::cellClicked(int rowNumber, int columnId, const juce::MouseEvent& event) {
+    if ((columnId != 4 && columnId != 5) || rowNumber < 0 || rowNumber >= (int) rows.size()) {
+        return;
+    }
+    
+    const auto cell = tableComponent.getCellPosition(columnId, rowNumber, true);
+    const auto position = event.getEventRelativeTo(&tableComponent).getPosition() - cell.getPosition();
+    if (! getLoadButtonBounds(cell.getWidth(), cell.getHeight()).contains(position)) {
+        return;
+    }
+    
+    if (columnId == 4) {
+        deck1.loadUrl(playlistFiles[rows[rowNumber]].fileUrl);
+    } else {
+        deck2.loadUrl(playlistFiles[rows[rowNumber]].fileUrl);
+    }
+}
+
+/**
+ * @brief Reloads the rows when the library changes and repaints when metadata or a waveform has arrived.
+ *
+ * @param source The library, the metadata service or a waveform pyramid.
+ */
+void Playlist::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &trackLibrary) {
+        reloadTracks();
+        return;
+    }
+    
+    if (source == &metadataService) {
+        updateScanProgress();
+        indexScannedTracks();
+        updateSuggestions();
+        if (searchBox.getText().isNotEmpty() || sortColumn != 0 || suggestButton.getToggleState()) {
+            applySearch();
+            return;
+        }
+    }
+    
+    for (auto& [path, thumbnail] : thumbnails) {
+        if (thumbnail.pyramid.get() == source) {
+            thumbnail.stale = true;
+        }
+    }
+    tableComponent.repaint();
+}
+
+/**
+ * @brief Determines if the playlist accepts dragged files.
+ *
+ * @param files List of dragged file paths.
+ * @return Always returns true.
+ */
+bool Playlist::isInterestedInFileDrag(const juce::StringArray& files) {
+    std::cout << "Playlist::isInterestedInFileDrag" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Imports any number of dropped files and folders into the library.
+ *
+ * Folders are searched recursively and watched from then on. Rows appear
+ * as the library finds each batch of tracks and fill in as their scans
+ * arrive.
+ *
+ * @param files List of dropped file paths.
+ * @param x Drop position x-coordinate.
+ * @param y Drop position y-coordinate.
+ */
+void Playlist::filesDropped(const juce::StringArray& files, int x, int y)
+{
+    trackLibrary.import(files);
+}
+
+/**
+ * @brief Opens a chooser and imports the files and folders picked.
+ */
+void Playlist::showImportChooser()
+{
+    importChooser = std::make_unique<juce::FileChooser>("Import tracks", juce::File(), audioFormatManager.getWildcardForAllFormats());
+    const int flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+                    | juce::FileBrowserComponent::canSelectDirectories | juce::FileBrowserComponent::canSelectMultipleItems;
+    
+    importChooser->launchAsync(flags, [this](const juce::FileChooser& chooser) {
+        juce::StringArray paths;
+        for (const auto& file : chooser.getResults()) {
+            paths.add(file.getFullPathName());
+        }
+        trackLibrary.import(paths);
+    });
+}
+
+/**
+ * @brief Updates the scan progress bar, hiding it when nothing is pending.
+ *
+ * A batch starts when scans are requested while none are pending, so the
+ * bar counts only the tracks of the current import.
+ */
+void Playlist::updateScanProgress()
+{
+    const int pending = metadataService.getNumPending();
+    const size_t finished = metadataService.getNumFinished();
+    
+    if (pending == 0) {
+        scanBatchStart = finished;
+        scanProgressBar.setVisible(false);
+        return;
+    }
+    
+    const int done = (int) (finished - scanBatchStart);
+    scanProgress = (double) done / (double) (done + pending);
+    scanProgressBar.setTextToDisplay("Scanning " + juce::String(done) + " of " + juce::String(done + pending));
+    scanProgressBar.setVisible(true);
+}
+
+/**
+ * @brief Rebuilds the rows from the library's tracks.
+ *
+ * Tracks the library has analysed take their results from it, so only new
+ * or changed tracks queue a scan. Tracks new to the search index are added
+ * and ones that have gone are removed.
+ */
+void Playlist::reloadTracks()
+{
+    const auto trackIds = trackLibrary.getTrackIds();
+    
+    for (const auto& item : playlistFiles) {
+        if (! trackLibrary.getTrack(item.trackId).removed) {
+            continue;
+        }
+        searchIndex.remove(item.trackId);
+        suggestionIndex.remove(item.trackId);
+    }
+    
+    playlistFiles.clear();
+    playlistFiles.reserve(trackIds.size());
+    sortKeysValid = false;
+    fileForTrack.clear();
+    fileForMetadata.clear();
+    
+    for (int id : trackIds) {
+        const auto& track = trackLibrary.getTrack(id);
+        const auto& file = track.file;
+        const int metadataId = metadataService.request(file);
+        
+        // The library drops the analysis of a file that has changed on disk.
+        if (! track.analysis.ready && metadataService.getMetadata(metadataId).ready) {
+            metadataService.rescan(file);
+        }
+        
+        fileForTrack[id] = (int) playlistFiles.size();
+        fileForMetadata[metadataId] = (int) playlistFiles.size();
+        playlistFiles.push_back({file, juce::URL(file), metadataId, id});
+        
+        if (! searchIndex.contains(id)) {
+            indexTrack(playlistFiles.back());
+        }
+    }
+    
+    updateScanProgress();
+    applySearch();
+}
+
+/**
+ * @brief Shows the rows matching the search box.
+ *
+ * Rows are sorted by the current sort column and the selected tracks stay
+ * selected wherever they move to.
+ */
+void Playlist::applySearch()
+{
+    std::unordered_set<int> selectedTracks;
+    const auto selection = tableComponent.getSelectedRows();
+    for (int i = 0; i < selection.size(); ++i) {
+        const int row = selection[i];
+        if (row >= 0 && row < (int) rows.size()) {
+            selectedTracks.insert(playlistFiles[rows[row]].trackId);
+        }
+    }
+    
+    rows.clear();
+    const auto matches = searchIndex.search(searchBox.getText());
+    if (suggestButton.getToggleState()) {
+        // Suggestions come best first, so they replace the sort order.
+        for (int trackId : suggestionIndex.suggest(suggestBpm, suggestKey)) {
+            auto found = fileForTrack.find(trackId);
+            if (found != fileForTrack.end() && std::binary_search(matches.begin(), matches.end(), trackId)) {
+                rows.push_back(found->second);
+            }
+        }
+    } else {
+        for (int trackId : matches) {
+            auto found = fileForTrack.find(trackId);
+            if (found != fileForTrack.end()) {
+                rows.push_back(found->second);
+            }
+        }
+        sortRows();
+    }
+    tableComponent.updateContent();
+    
+    juce::SparseSet<int> newSelection;
+    if (! selectedTracks.empty()) {
+        for (int row = 0; row < (int) rows.size(); ++row) {
+            if (selectedTracks.count(playlistFiles[rows[row]].trackId) != 0) {
+                newSelection.addRange({row, row + 1});
+            }
+        }
+    }
+    tableComponent.setSelectedRows(newSelection, juce::dontSendNotification);
+    tableComponent.repaint();
+    updateWaveformPriorities();
+}
+
+/**
+ * @brief Re-sorts the rows when a column header is clicked.
+ *
+ * @param newSortColumnId Column to sort by, or 0 for library order.
+ * @param isForwards True for ascending order.
+ */
+void Playlist::sortOrderChanged(int newSortColumnId, bool isForwards)
+{
+    if (newSortColumnId != 0) {
+        suggestButton.setToggleState(false, juce::dontSendNotification);
+    }
+    if (newSortColumnId != sortColumn) {
+        sortKeysValid = false;
+    }
+    sortColumn = newSortColumnId;
+    sortForwards = isForwards;
+    applySearch();
+}
+
+/**
+ * @brief Sorts rows by the sort column, recomputing the keys if needed.
+ *
+ * Each entry gets one 64-bit key, so nearly every comparison is a single
+ * integer compare; text that shares its first eight bytes falls back to a
+ * full comparison. The sort is stable, so ties stay in library order.
+ */
+void Playlist::sortRows()
+{
+    if (sortColumn == 0) {
+        return;
+    }
+    
+    const bool textColumn = sortColumn == 1 || sortColumn == 7;
+    
+    if (! sortKeysValid) {
+        sortKeys.resize(playlistFiles.size());
+        for (size_t i = 0; i < playlistFiles.size(); ++i) {
+            const auto& item = playlistFiles[i];
+            const auto& metadata = metadataService.getMetadata(item.metadataId);
+            if (textColumn) {
+                sortKeys[i] = makeTextSortKey(getSortText(item, sortColumn));
+            } else if (sortColumn == 2) {
+                sortKeys[i] = makeNumberSortKey(metadata.durationSeconds);
+            } else if (sortColumn == 6) {
+                sortKeys[i] = makeNumberSortKey(metadata.bpm);
+            } else {
+                sortKeys[i] = (juce::uint64) juce::jmax((juce::int64) 0, trackLibrary.getTrack(item.trackId).added);
+            }
+        }
+        sortKeysValid = true;
+    }
+    
+    auto lessThan = [this, textColumn](int a, int b) {
+        if (sortKeys[(size_t) a] != sortKeys[(size_t) b]) {
+            return sortKeys[(size_t) a] < sortKeys[(size_t) b];
+        }
+        return textColumn && getSortText(playlistFiles[a], sortColumn).compareIgnoreCase(getSortText(playlistFiles[b], sortColumn)) < 0;
+    };
+    
+    if (sortForwards) {
+        std::stable_sort(rows.begin(), rows.end(), lessThan);
+    } else {
+        std::stable_sort(rows.begin(), rows.end(), [&lessThan](int a, int b) { return lessThan(b, a); });
+    }
+}
+
+/**
+ * @brief Gets the text a track sorts by in a text column.
+ *
+ * @param item The track's playlist entry.
+ * @param columnId The column.
+ * @return The text.
+ */
+juce::String Playlist::getSortText(const PlaylistFileInformation& item, int columnId) const
+{
+    const auto& metadata = metadataService.getMetadata(item.metadataId);
+    if (columnId == 7) {
+        return metadata.key;
+    }
+    return metadata.ready ? metadata.title : item.file.getFileNameWithoutExtension();
+}
+
+/**
+ * @brief Adds a track to the search index, using its file name until it has been scanned.
+ *
+ * @param item The track's playlist entry.
+ */
+void Playlist::indexTrack(const PlaylistFileInformation& item)
+{
+    const auto& metadata = metadataService.getMetadata(item.metadataId);
+    if (metadata.ready) {
+        searchIndex.update(item.trackId, metadata);
+        suggestionIndex.update(item.trackId, metadata);
+        return;
+    }
+    
+    TrackMetadata placeholder;
+    placeholder.title = item.file.getFileNameWithoutExtension();
+    searchIndex.update(item.trackId, placeholder);
+}
+
+/**
+ * @brief Re-indexes the tracks whose scans have arrived since the last call.
+ */
+void Playlist::indexScannedTracks()
+{
+    std::vector<int> finished;
+    const bool complete = metadataService.getFinishedSince(scannedCount, finished);
+    scannedCount = metadataService.getNumFinished();
+    
+    // Fallen too far behind to know which tracks changed, so re-index them all.
+    if (! complete) {
+        for (const auto& item : playlistFiles) {
+            indexTrack(item);
+        }
+        sortKeysValid = false;
+        return;
+    }
+    
+    for (int metadataId : finished) {
+        auto found = fileForMetadata.find(metadataId);
+        if (found != fileForMetadata.end()) {
+            indexTrack(playlistFiles[found->second]);
+            sortKeysValid = false;
+        }
+    }
+}
+
+/**
+ * @brief Picks the master deck and, if its key or tempo has changed, re-ranks the suggestions.
+ *
+ * The master is the deck that is playing. While both play it stays the one
+ * that was playing first, and while neither does it stays the last one that
+ * played. Speed changes pitch as well as tempo, so the key is transposed by
+ * the nearest whole number of semitones.
+ */
+void Playlist::updateSuggestions()
+{
+    if (deck1.isPlaying() != deck2.isPlaying()) {
+        masterDeck = deck1.isPlaying() ? &deck1 : &deck2;
+    } else if (masterDeck == nullptr && ! deck1.getLoadedUrl().isEmpty()) {
+        masterDeck = &deck1;
+    } else if (masterDeck == nullptr && ! deck2.getLoadedUrl().isEmpty()) {
+        masterDeck = &deck2;
+    }
+    
+    float bpm = 0.0f;
+    int key = -1;
+    if (masterDeck != nullptr && masterDeck->getLoadedUrl().isLocalFile()) {
+        // Tracks loaded from outside the library are scanned too; the result arrives as a change message.
+        const auto& metadata = metadataService.getMetadata(metadataService.request(masterDeck->getLoadedUrl().getLocalFile()));
+        const double speed = juce::jmax(0.01, masterDeck->getSpeed());
+        bpm = (float) (metadata.bpm * speed);
+        key = TrackSuggestionIndex::transpose(TrackSuggestionIndex::toCamelot(metadata.key),
+                                              juce::roundToInt(12.0 * std::log2(speed)));
+    }
+    
+    if (key == suggestKey && std::abs(bpm - suggestBpm) < 0.05f) {
+        return;
+    }
+    
+    suggestBpm = bpm;
+    suggestKey = key;
+    
+    juce::String target;
+    if (key >= 0) {
+        target << " " << TrackSuggestionIndex::camelotName(key);
+    }
+    if (bpm > 0.0f) {
+        target << " " << juce::String(bpm, 1);
+    }
+    suggestButton.setButtonText(target.isEmpty() ? "Suggest" : "Suggest:" + target);
+    
+    if (suggestButton.getToggleState()) {
+        applySearch();
+    }
+}
+
+/**
+ * @brief Tells the waveform cache which rows are on screen and which are next.
+ */
+void Playlist::updateWaveformPriorities()
+{
+    auto* viewport = tableComponent.getViewport();
+    const int rowHeight = tableComponent.getRowHeight();
+    if (viewport == nullptr || rowHeight <= 0 || rows.empty()) {
+        return;
+    }
+    
+    const int numRows = (int) rows.size();
+    const int firstVisible = juce::jlimit(0, numRows - 1, viewport->getViewPositionY() / rowHeight);
+    const int lastVisible = juce::jlimit(0, numRows - 1, (viewport->getViewPositionY() + viewport->getViewHeight()) / rowHeight);
+    const int pageSize = lastVisible - firstVisible + 1;
+    
+    juce::Array<juce::File> visible, prefetch;
+    for (int row = firstVisible; row <= lastVisible; ++row) {
+        visible.add(playlistFiles[rows[row]].file);
+    }
+    for (int row = juce::jmax(0, firstVisible - pageSize); row < firstVisible; ++row) {
+        prefetch.add(playlistFiles[rows[row]].file);
+    }
+    for (int row = lastVisible + 1; row <= juce::jmin(numRows - 1, lastVisible + pageSize); ++row) {
+        prefetch.add(playlistFiles[rows[row]].file);
+    }
+    
+    waveformCache.prioritise(visible, prefetch);
+}
+
+/**
+ * @brief Gets a row's waveform thumbnail, rendering it if it is out of date.
+ *
+ * Thumbnails are kept for the most recently painted rows only, so memory
+ * stays flat however long the playlist is.
+ *
+ * @param rowNumber Row index.
+ * @param width Cell width.
+ * @param height Cell height.
+ * @param scale Physical pixels per logical pixel.
+ * @return The thumbnail image, or an invalid image if the track cannot be found.
+ */
+juce::Image Playlist::getThumbnail(int rowNumber, int width, int height, float scale)
+{
+    const auto& file = playlistFiles[rows[rowNumber]].file;
+    auto found = thumbnails.find(file.getFullPathName());
+    
+    if (found == thumbnails.end()) {
+        auto pyramid = waveformCache.getPyramid(file, WaveformCache::Priority::visible);
+        if (pyramid == nullptr) {
+            return {};
+        }
+        
+        if (thumbnails.size() >= maxThumbnails) {
+            auto oldest = std::min_element(thumbnails.begin(), thumbnails.end(), [](const auto& a, const auto& b) {
+                return a.second.lastPainted < b.second.lastPainted;
+            });
+            oldest->second.pyramid->removeChangeListener(this);
+            thumbnails.erase(oldest);
+        }
+        
+        pyramid->addChangeListener(this);
+        found = thumbnails.emplace(file.getFullPathName(), Thumbnail {std::move(pyramid)}).first;
+    }
+    
+    auto& thumbnail = found->second;
+    thumbnail.lastPainted = ++paintCounter;
+    
+    const int imageWidth = juce::jmax(1, juce::roundToInt(width * scale));
+    const int imageHeight = juce::jmax(1, juce::roundToInt(height * scale));
+    
+    if (thumbnail.stale || thumbnail.image.getWidth() != imageWidth || thumbnail.image.getHeight() != imageHeight) {
+        thumbnail.image = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true);
+        juce::Graphics imageGraphics(thumbnail.image);
+        imageGraphics.fillAll(juce::Colour {30, 30, 30});
+        thumbnail.pyramid->drawBandWaveform(imageGraphics, thumbnail.image.getBounds(), 0, thumbnail.pyramid->getLengthInSeconds(), 0.45f);
+        thumbnail.stale = false;
+    }
+    
+    return thumbnail.image;
+}
+
+/**
+ * @brief Gets the area of a load button within its cell.
+ *
+ * @param width Cell width.
+ * @param height Cell height.
+ * @return The button's bounds.
+ */
+juce::Rectangle<int> Playlist::getLoadButtonBounds(int width, int height)
+{
+    return juce::Rectangle<int>(0, 0, width, height).reduced(4, 2);
+}
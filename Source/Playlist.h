@@ -1,160 +1,275 @@
-/*
- ============================================================================
- 
- Playlist.h
- Created: 4 Feb 2025 6:12:32pm
- Author:  Jacques Thurling
- 
- ==============================================================================
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "WaveformDisplay.h"
-#include "DeckGUI.h"
-
-/**
- * @struct PlaylistFileInformation
- * @brief Stores file information for playlist items.
- */
-struct PlaylistFileInformation {
-    juce::File file; ///< File object representing the playlist item.
-    juce::URL fileUrl; ///< URL to the file.
-};
-
-/**
- * @class Playlist
- * @brief Manages a playlist of audio files, providing UI and drag-and-drop support.
- */
-class Playlist : public juce::Component, public juce::TableListBoxModel, public juce::Button::Listener, public juce::FileDragAndDropTarget
-{
-public:
-    /**
-     * @brief Constructor for the Playlist class.
-     * @param formatManager Reference to the audio format manager.
-     * @param cache Reference to the audio thumbnail cache.
-     * @param deck1 Reference to the first deck.
-     * @param deck2 Reference to the second deck.
-     * @param _states Pointer to the vector storing deck states.
-     */
-    Playlist(juce::AudioFormatManager& formatManager, juce::AudioThumbnailCache& cache, DeckGUI& deck1, DeckGUI& deck2, std::vector<DeckState> *_states);
-    
-    /**
-     * @brief Destructor for the Playlist class.
-     */
-    ~Playlist() override;
-    
-    /**
-     * @brief Paints the component.
-     * @param g Graphics context.
-     */
-    void paint (juce::Graphics&) override;
-    
-    /**
-     * @brief Handles component resizing.
-     */
-    void resized() override;
-    
-    /**
-     * @brief Returns the number of rows in the playlist table.
-     * @return Number of rows.
-     */
-    int getNumRows() override;
-    
-    /**
-     * @brief Paints the background of a row.
-     * @param g Graphics context.
-     * @param rowNumber Row index.
-     * @param width Row width.
-     * @param height Row height.
-     * @param rowIsSelected Whether the row is selected.
-     */
-    void paintRowBackground(juce::Graphics&, int rowNumber, int width, int height, bool rowIsSelected) override;
-    
-    /**
-     * @brief Paints a cell in the table.
-     * @param g Graphics context.
-     * @param rowNumber Row index.
-     * @param columnId Column ID.
-     * @param width Cell width.
-     * @param height Cell height.
-     * @param rowIsSelected Whether the row is selected.
-     */
-    void paintCell(juce::Graphics&, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override;
-    
-    /**
-     * @brief Handles cell clicks.
-     * @param rowNumber Row index.
-     * @param columnId Column ID.
-     * @param event Mouse event.
-     */
-    virtual void cellClicked (int rowNumber, int columnId, const juce::MouseEvent&);
-    
-    /**
-     * @brief Refreshes the component for a table cell.
-     * @param rowNumber Row index.
-     * @param columnId Column ID.
-     * @param isRowSelected Whether the row is selected.
-     * @param existingComponentToUpdate Existing component to update.
-     * @return Pointer to the updated component.
-     */
-    juce::Component* refreshComponentForCell (int rowNumber, int columnId, bool isRowSelected, Component* existingComponentToUpdate) override;
-    
-    /**
-     * @brief Checks if the component is interested in file drag events.
-     * @param files List of dragged files.
-     * @return True if interested, false otherwise.
-     */
-    bool isInterestedInFileDrag (const juce::StringArray& files) override;
-    
-    /**
-     * @brief Handles files being dropped onto the component.
-     * @param file List of dropped files.
-     * @param x X position.
-     * @param y Y position.
-     */
-    void filesDropped (const juce::StringArray& file, int x, int y) override;
-    
-    /**
-     * @brief Handles button clicks.
-     * @param button Pointer to the clicked button.
-     */
-    void buttonClicked(juce::Button* button) override;
-    
-    /**
-     * @brief Called when the parent hierarchy changes.
-     */
-    void parentHierarchyChanged() override
-    {
-        setDeckStates();
-    }
-    
-    /**
-     * @brief Sets the deck states based on the playlist.
-     */
-    void setDeckStates();
-    
-private:
-    juce::AudioThumbnailCache& audioThumbnail; ///< Reference to the audio thumbnail cache.
-    juce::AudioFormatManager& audioFormatManager; ///< Reference to the audio format manager.
-    
-    std::vector<DeckState> *states; ///< Pointer to the vector of deck states.
-    
-    DeckGUI& deck1; ///< Reference to the first deck.
-    DeckGUI& deck2; ///< Reference to the second deck.
-    
-    juce::TableListBox tableComponent; ///< Table component for displaying the playlist.
-    
-    std::vector<PlaylistFileInformation> playlistFiles; ///< List of files in the playlist.
-    
-    /**
-     * @brief Splits a string by a given delimiter.
-     * @param s String to split.
-     * @param delimiter Character delimiter.
-     * @return Vector of split strings.
-     */
-    std::vector<std::string> split(const std::string &s, char delimiter);
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Playlist)
-};
+/*
+ ============================================================================
+ 
+ Playlist.h
+ Created: 4 Feb 2025 6:12:32pm
+ Author:  Jacques Thurling
+ 
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+#include "DeckGUI.h"
+#include "TrackMetadataService.h"
+#include "TrackLibrary.h"
+#include "TrackSearchIndex.h"
+#include "TrackSuggestionIndex.h"
+
+/**
+ * @struct PlaylistFileInformation
+ * @brief Stores file information for playlist items.
+ */
+struct PlaylistFileInformation {
+    juce::File file; ///< File object representing the playlist item.
+    juce::URL fileUrl; ///< URL to the file.
+    int metadataId = -1; ///< ID of the file's metadata in the TrackMetadataService.
+    int trackId = -1; ///< ID of the track in the TrackLibrary.
+};
+
+/**
+ * @class Playlist
+ * @brief Manages a playlist of audio files, providing UI and drag-and-drop support.
+ *
+ * Rows have no child components: waveforms are drawn from cached thumbnail
+ * images and the load buttons are drawn in paintCell and hit-tested in
+ * cellClicked.
+ */
+class Playlist : public juce::Component, public juce::TableListBoxModel, public juce::FileDragAndDropTarget, public juce::ChangeListener
+{
+public:
+    /**
+     * @brief Constructor for the Playlist class.
+     * @param formatManager Reference to the audio format manager.
+     * @param cache Reference to the shared waveform cache.
+     * @param metadata Reference to the track metadata service.
+     * @param library Reference to the track library the rows come from.
+     * @param deck1 Reference to the first deck.
+     * @param deck2 Reference to the second deck.
+     */
+    Playlist(juce::AudioFormatManager& formatManager, WaveformCache& cache, TrackMetadataService& metadata, TrackLibrary& library, DeckGUI& deck1, DeckGUI& deck2);
+    
+    /**
+     * @brief Destructor for the Playlist class.
+     */
+    ~Playlist() override;
+    
+    /**
+     * @brief Paints the component.
+     * @param g Graphics context.
+     */
+    void paint (juce::Graphics&) override;
+    
+    /**
+     * @brief Handles component resizing.
+     */
+    void resized() override;
+    
+    /**
+     * @brief Returns the number of rows in the playlist table.
+     * @return Number of rows.
+     */
+    int getNumRows() override;
+    
+    /**
+     * @brief Paints the background of a row.
+     * @param g Graphics context.
+     * @param rowNumber Row index.
+     * @param width Row width.
+     * @param height Row height.
+     * @param rowIsSelected Whether the row is selected.
+     */
+    void paintRowBackground(juce::Graphics&, int rowNumber, int width, int height, bool rowIsSelected) override;
+    
+    /**
+     * @brief Paints a cell in the table.
+     * @param g Graphics context.
+     * @param rowNumber Row index.
+     * @param columnId Column ID.
+     * @param width Cell width.
+     * @param height Cell height.
+     * @param rowIsSelected Whether the row is selected.
+     */
+    void paintCell(juce::Graphics&, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override;
+    
+    /**
+     * @brief Handles cell clicks, loading the row onto a deck if a load button was hit.
+     * @param rowNumber Row index.
+     * @param columnId Column ID.
+     * @param event Mouse event.
+     */
+    void cellClicked (int rowNumber, int columnId, const juce::MouseEvent&) override;
+    
+    /**
+     * @brief Reprioritises waveform builds when the table scrolls.
+     */
+    void listWasScrolled() override;
+    
+    /**
+     * @brief Re-sorts the rows when a column header is clicked.
+     * @param newSortColumnId Column to sort by, or 0 for library order.
+     * @param isForwards True for ascending order.
+     */
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override;
+    
+    /**
+     * @brief Checks if the component is interested in file drag events.
+     * @param files List of dragged files.
+     * @return True if interested, false otherwise.
+     */
+    bool isInterestedInFileDrag (const juce::StringArray& files) override;
+    
+    /**
+     * @brief Imports any number of dropped files and folders into the library.
+     * @param file List of dropped files.
+     * @param x X position.
+     * @param y Y position.
+     */
+    void filesDropped (const juce::StringArray& file, int x, int y) override;
+    
+    /**
+     * @brief Reloads the rows when the library changes and repaints when metadata or a waveform has arrived.
+     * @param source The library, the metadata service or a waveform pyramid.
+     */
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    
+    /**
+     * @brief Picks the master deck and, if its key or tempo has changed, re-ranks the suggestions.
+     */
+    void updateSuggestions();
+    
+private:
+    WaveformCache& waveformCache; ///< Reference to the shared waveform cache.
+    TrackMetadataService& metadataService; ///< Reference to the track metadata service.
+    TrackLibrary& trackLibrary; ///< Reference to the track library.
+    juce::AudioFormatManager& audioFormatManager; ///< Reference to the audio format manager.
+    
+    DeckGUI& deck1; ///< Reference to the first deck.
+    DeckGUI& deck2; ///< Reference to the second deck.
+    
+    juce::TextEditor searchBox; ///< Type-to-filter search box above the table.
+    static constexpr int searchBoxHeight = 28; ///< Height of the search box.
+    
+    juce::TextButton importButton {"Import..."}; ///< Opens a chooser for files and folders to import.
+    std::unique_ptr<juce::FileChooser> importChooser; ///< The open import chooser, kept alive while it is shown.
+    static constexpr int importButtonWidth = 90; ///< Width of the import button.
+    
+    juce::TextButton suggestButton {"Suggest"}; ///< Toggles ranking rows by how well they mix after the master deck.
+    static constexpr int suggestButtonWidth = 130; ///< Width of the suggest button.
+    
+    double scanProgress = 0.0; ///< Fraction of the current batch of metadata scans that has arrived.
+    juce::ProgressBar scanProgressBar {scanProgress}; ///< Shown beside the search box while scans are pending.
+    size_t scanBatchStart = 0; ///< Finished scans when the current batch began.
+    static constexpr int progressBarWidth = 220; ///< Width of the progress bar.
+    
+    juce::TableListBox tableComponent; ///< Table component for displaying the playlist.
+    
+    std::vector<PlaylistFileInformation> playlistFiles; ///< List of files in the playlist.
+    std::vector<int> rows; ///< Indexes into playlistFiles of the rows shown, in display order.
+    std::unordered_map<int, int> fileForTrack; ///< Index into playlistFiles by library track ID.
+    std::unordered_map<int, int> fileForMetadata; ///< Index into playlistFiles by metadata ID.
+    
+    TrackSearchIndex searchIndex; ///< Search index over every track, keyed by library track ID.
+    TrackSuggestionIndex suggestionIndex; ///< Key and tempo grid over every scanned track, keyed by library track ID.
+    
+    DeckGUI* masterDeck = nullptr; ///< Deck the suggestions follow: the one playing, or the last one that was.
+    float suggestBpm = 0.0f; ///< Master deck's tempo at its current speed, 0 if unknown.
+    int suggestKey = -1; ///< Master deck's Camelot key at its current speed, -1 if unknown.
+    
+    int sortColumn = 0; ///< Column the rows are sorted by, or 0 for library order.
+    bool sortForwards = true; ///< True when sorted ascending.
+    std::vector<juce::uint64> sortKeys; ///< Sort key of each entry in playlistFiles for sortColumn.
+    bool sortKeysValid = false; ///< False when sortKeys needs recomputing.
+    size_t scannedCount = 0; ///< Finished metadata scans already added to the search index.
+    
+    /**
+     * @struct Thumbnail
+     * @brief A row's waveform, pre-rendered for paintCell.
+     */
+    struct Thumbnail {
+        std::shared_ptr<WaveformPyramid> pyramid; ///< The track's pyramid, listened to for progress.
+        juce::Image image; ///< The rendered waveform, at physical pixel size.
+        bool stale = true; ///< True when the pyramid has changed since the image was rendered.
+        juce::uint32 lastPainted = 0; ///< Paint counter value when last drawn, for eviction.
+    };
+    
+    static constexpr size_t maxThumbnails = 256; ///< Thumbnails kept; a few screens' worth of rows.
+    std::unordered_map<juce::String, Thumbnail> thumbnails; ///< Thumbnails by full path.
+    juce::uint32 paintCounter = 0; ///< Incremented on each thumbnail draw.
+    
+    /**
+     * @brief Gets a row's waveform thumbnail, rendering it if it is out of date.
+     * @param rowNumber Row index.
+     * @param width Cell width.
+     * @param height Cell height.
+     * @param scale Physical pixels per logical pixel.
+     * @return The thumbnail image, or an invalid image if the track cannot be found.
+     */
+    juce::Image getThumbnail(int rowNumber, int width, int height, float scale);
+    
+    /**
+     * @brief Gets the area of a load button within its cell.
+     * @param width Cell width.
+     * @param height Cell height.
+     * @return The button's bounds.
+     */
+    static juce::Rectangle<int> getLoadButtonBounds(int width, int height);
+    
+    /**
+     * @brief Rebuilds the rows from the library's tracks.
+     */
+    void reloadTracks();
+    
+    /**
+     * @brief Opens a chooser and imports the files and folders picked.
+     */
+    void showImportChooser();
+    
+    /**
+     * @brief Updates the scan progress bar, hiding it when nothing is pending.
+     */
+    void updateScanProgress();
+    
+    /**
+     * @brief Shows the rows matching the search box.
+     */
+    void applySearch();
+    
+    /**
+     * @brief Sorts rows by the sort column, recomputing the keys if needed.
+     *
+     * Only the index permutation in rows is sorted; playlistFiles is untouched.
+     */
+    void sortRows();
+    
+    /**
+     * @brief Gets the text a track sorts by in a text column.
+     * @param item The track's playlist entry.
+     * @param columnId The column.
+     * @return The text.
+     */
+    juce::String getSortText(const PlaylistFileInformation& item, int columnId) const;
+    
+    /**
+     * @brief Adds a track to the search index, using its file name until it has been scanned.
+     * @param item The track's playlist entry.
+     */
+    void indexTrack(const PlaylistFileInformation& item);
+    
+    /**
+     * @brief Re-indexes the tracks whose scans have arrived since the last call.
+     */
+    void indexScannedTracks();
+    
+    /**
+     * @brief Tells the waveform cache which rows are on screen and which are next.
+     *
+     * Rows within one screen above or below are prefetched; builds for all
+     * other rows are cancelled.
+     */
+    void updateWaveformPriorities();
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Playlist)
+};
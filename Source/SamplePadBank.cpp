@@ -0,0 +1,261 @@
+/**
+ * =================================================================
+ * @file SamplePadBank.cpp
+ * @brief Implementation of the SamplePadBank class.
+ *
+ * Created: 18 Oct 2026 11:02:51am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "SamplePadBank.h"
+
+/**
+ * @brief Constructs the bank and allocates its sample pool.
+ *
+ * This is the only allocation the bank ever makes.
+ */
+SamplePadBank::SamplePadBank()
+    : pool(2, numPads * maxPadSamples)
+{
+    pool.clear();
+}
+
+/**
+ * @brief Destructor for SamplePadBank.
+ */
+SamplePadBank::~SamplePadBank()
+{
+}
+
+/**
+ * @brief Stores the device sample rate that pad audio is converted to.
+ * @param sampleRate The device sample rate.
+ */
+void SamplePadBank::prepareToPlay(double sampleRate)
+{
+    deviceSampleRate = sampleRate;
+}
+
+/**
+ * @brief Mixes every active voice into a block of audio.
+ *
+ * Pad audio is already at the device rate, so each voice is a single
+ * vectorised multiply-add per channel. Voices above the current polyphony
+ * limit fade out over this block and are then freed.
+ *
+ * @param buffer The buffer to mix into.
+ * @param startSample First sample of the region to fill.
+ * @param numSamples Number of samples to fill.
+ */
+void SamplePadBank::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const juce::SpinLock::ScopedTryLockType lock (poolLock);
+
+    // A pad is being loaded right now: skip the pads for this block rather than wait.
+    if (! lock.isLocked())
+        return;
+
+    const int limit = juce::jlimit(1, maxVoices, polyphony.load());
+
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        auto& voice = voices[(size_t) i];
+
+        if (voice.pad < 0)
+            continue;
+
+        const int length = padLengths[(size_t) voice.pad];
+        const int num = juce::jmin(numSamples, length - voice.position);
+
+        if (num <= 0)
+        {
+            voice.pad = -1;
+            continue;
+        }
+
+        const int poolOffset = voice.pad * maxPadSamples + voice.position;
+
+        // The limit was lowered under this voice: fade it out rather than cut it.
+        if (i >= limit)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.addFromWithRamp(channel, startSample, pool.getReadPointer(juce::jmin(channel, 1), poolOffset),
+                                       num, voice.gain, 0.0f);
+
+            voice.pad = -1;
+            continue;
+        }
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(channel, startSample),
+                                                         pool.getReadPointer(juce::jmin(channel, 1), poolOffset),
+                                                         voice.gain,
+                                                         num);
+        }
+
+        voice.position += num;
+
+        if (voice.position >= length)
+            voice.pad = -1;
+    }
+}
+
+/**
+ * @brief Starts a voice for a pad, stealing the oldest voice if needed.
+ * @param pad The pad to play (0 - numPads-1).
+ * @param velocity Gain applied to the voice (0.0 - 1.0).
+ */
+void SamplePadBank::triggerPad(int pad, float velocity)
+{
+    if (! juce::isPositiveAndBelow(pad, numPads))
+        return;
+
+    const int limit = juce::jlimit(1, maxVoices, polyphony.load());
+    Voice* target = nullptr;
+
+    for (int i = 0; i < limit; ++i)
+    {
+        auto& voice = voices[(size_t) i];
+
+        if (voice.pad < 0)
+        {
+            target = &voice;
+            break;
+        }
+
+        if (target == nullptr || voice.age < target->age)
+            target = &voice;
+    }
+
+    target->pad = pad;
+    target->position = 0;
+    target->gain = juce::jlimit(0.0f, 1.0f, velocity);
+    target->age = ++voiceCounter;
+}
+
+/**
+ * @brief Decodes part of a file into a pad's region of the pool.
+ *
+ * Decoding and sample-rate conversion happen in scratch buffers on the
+ * calling thread; only the final copy into the pool is done under the lock.
+ *
+ * @param pad The pad to load (0 - numPads-1).
+ * @param reader Reader for the source audio.
+ * @param startSample First sample to read from the source.
+ * @param numSamples Number of source samples to read.
+ * @return True if the pad was loaded.
+ */
+bool SamplePadBank::loadPad(int pad, juce::AudioFormatReader& reader, juce::int64 startSample, juce::int64 numSamples)
+{
+    if (! juce::isPositiveAndBelow(pad, numPads) || reader.sampleRate <= 0)
+    {
+        std::cout << "SamplePadBank::loadPad invalid pad or reader" << std::endl;
+        return false;
+    }
+
+    numSamples = juce::jmin(numSamples, reader.lengthInSamples - startSample);
+
+    if (startSample < 0 || numSamples <= 0)
+    {
+        std::cout << "SamplePadBank::loadPad region is outside the source" << std::endl;
+        return false;
+    }
+
+    const double ratio = reader.sampleRate / deviceSampleRate;
+
+    // Only decode what fits into the pad once converted to the device rate.
+    numSamples = juce::jmin(numSamples, (juce::int64) (maxPadSamples * ratio));
+
+    juce::AudioBuffer<float> decoded (2, (int) numSamples);
+    reader.read(&decoded, 0, (int) numSamples, startSample, true, true);
+
+    const int length = juce::jmin(maxPadSamples, (int) (numSamples / ratio));
+    juce::AudioBuffer<float> converted (2, length);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        juce::LagrangeInterpolator interpolator;
+        interpolator.process(ratio, decoded.getReadPointer(channel), converted.getWritePointer(channel),
+                             length, (int) numSamples, 0);
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock (poolLock);
+
+        for (int channel = 0; channel < 2; ++channel)
+            pool.copyFrom(channel, pad * maxPadSamples, converted, channel, 0, length);
+
+        padLengths[(size_t) pad] = length;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Empties a pad.
+ *
+ * Voices still playing the pad stop at the start of the next block.
+ *
+ * @param pad The pad to clear (0 - numPads-1).
+ */
+void SamplePadBank::clearPad(int pad)
+{
+    if (! juce::isPositiveAndBelow(pad, numPads))
+        return;
+
+    const juce::SpinLock::ScopedLockType lock (poolLock);
+    padLengths[(size_t) pad] = 0;
+}
+
+/**
+ * @brief Checks whether a pad holds audio.
+ * @param pad The pad to check (0 - numPads-1).
+ * @return True if the pad is loaded.
+ */
+bool SamplePadBank::isPadLoaded(int pad) const
+{
+    return juce::isPositiveAndBelow(pad, numPads) && padLengths[(size_t) pad] > 0;
+}
+
+/**
+ * @brief Limits the number of voices that may sound at once.
+ *
+ * Voices already sounding above the new limit fade out over the next block.
+ *
+ * @param numVoices Number of voices (1 - maxVoices).
+ */
+void SamplePadBank::setPolyphony(int numVoices)
+{
+    if (numVoices < 1 || numVoices > maxVoices)
+    {
+        std::cout << "SamplePadBank::setPolyphony voices should be between 1 and " << maxVoices << std::endl;
+        return;
+    }
+
+    polyphony.store(numVoices);
+}
+
+/**
+ * @brief Gets the size of the preallocated sample pool.
+ * @return The pool size in bytes.
+ */
+size_t SamplePadBank::getPoolSizeInBytes() const
+{
+    return (size_t) pool.getNumChannels() * (size_t) pool.getNumSamples() * sizeof(float);
+}
+
+/**
+ * @brief Gets how much of the sample pool holds pad audio.
+ * @return The used size in bytes.
+ */
+size_t SamplePadBank::getUsedBytes() const
+{
+    size_t usedSamples = 0;
+
+    for (auto length : padLengths)
+        usedSamples += (size_t) length;
+
+    return usedSamples * (size_t) pool.getNumChannels() * sizeof(float);
+}
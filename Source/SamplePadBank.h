@@ -0,0 +1,148 @@
+/**
+ * =================================================================
+ * @file SamplePadBank.h
+ * @brief Declaration of the SamplePadBank class.
+ *
+ * This file declares a bank of sample pads for a deck. Pad audio lives in a
+ * single preallocated pool and is mixed on the audio thread by a fixed set
+ * of voices.
+ *
+ * Created: 18 Oct 2026 11:02:51am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class SamplePadBank
+ * @brief A bank of one-shot / slice pads with bounded memory and polyphony.
+ *
+ * Each pad owns a fixed region of one preallocated stereo pool, so loading a
+ * pad never allocates once the bank is constructed and the memory used by a
+ * deck's pads is known up front. Pads are played by a small pool of voices;
+ * when every voice is busy the oldest one is stolen.
+ */
+class SamplePadBank
+{
+public:
+    /** Number of pads per deck. */
+    static constexpr int numPads = 8;
+
+    /** Maximum number of voices that can sound at once. */
+    static constexpr int maxVoices = 16;
+
+    /** Capacity of each pad's region of the pool, in samples at the device rate. */
+    static constexpr int maxPadSamples = 1 << 17;
+
+    /** Length of each slice when slicing the loaded track, in seconds. */
+    static constexpr double sliceSeconds = 0.5;
+
+    /**
+     * @brief Constructs the bank and allocates its sample pool.
+     */
+    SamplePadBank();
+
+    /**
+     * @brief Destructor for SamplePadBank.
+     */
+    ~SamplePadBank();
+
+    /**
+     * @brief Stores the device sample rate that pad audio is converted to.
+     * @param sampleRate The device sample rate.
+     */
+    void prepareToPlay(double sampleRate);
+
+    /**
+     * @brief Mixes every active voice into a block of audio.
+     *
+     * Called from the audio thread. Never allocates and never blocks.
+     *
+     * @param buffer The buffer to mix into.
+     * @param startSample First sample of the region to fill.
+     * @param numSamples Number of samples to fill.
+     */
+    void renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /**
+     * @brief Starts a voice for a pad, stealing the oldest voice if needed.
+     *
+     * Called from the audio thread when a pad event is drained.
+     *
+     * @param pad The pad to play (0 - numPads-1).
+     * @param velocity Gain applied to the voice (0.0 - 1.0).
+     */
+    void triggerPad(int pad, float velocity);
+
+    /**
+     * @brief Decodes part of a file into a pad's region of the pool.
+     *
+     * Must be called from the message thread. Audio longer than the pad's
+     * capacity is truncated.
+     *
+     * @param pad The pad to load (0 - numPads-1).
+     * @param reader Reader for the source audio.
+     * @param startSample First sample to read from the source.
+     * @param numSamples Number of source samples to read.
+     * @return True if the pad was loaded.
+     */
+    bool loadPad(int pad, juce::AudioFormatReader& reader, juce::int64 startSample, juce::int64 numSamples);
+
+    /**
+     * @brief Empties a pad.
+     * @param pad The pad to clear (0 - numPads-1).
+     */
+    void clearPad(int pad);
+
+    /**
+     * @brief Checks whether a pad holds audio.
+     * @param pad The pad to check (0 - numPads-1).
+     * @return True if the pad is loaded.
+     */
+    bool isPadLoaded(int pad) const;
+
+    /**
+     * @brief Limits the number of voices that may sound at once.
+     *
+     * Voices already sounding above the new limit fade out over the next block.
+     *
+     * @param numVoices Number of voices (1 - maxVoices).
+     */
+    void setPolyphony(int numVoices);
+
+    /**
+     * @brief Gets the size of the preallocated sample pool.
+     * @return The pool size in bytes.
+     */
+    size_t getPoolSizeInBytes() const;
+
+    /**
+     * @brief Gets how much of the sample pool holds pad audio.
+     * @return The used size in bytes.
+     */
+    size_t getUsedBytes() const;
+
+private:
+    /**
+     * @brief A playing instance of a pad.
+     */
+    struct Voice {
+        int pad = -1;            ///< Pad being played, -1 when the voice is free.
+        int position = 0;        ///< Read position inside the pad.
+        float gain = 0.0f;       ///< Gain applied to the voice.
+        juce::uint32 age = 0;    ///< Trigger order, used to find the oldest voice.
+    };
+
+    juce::AudioBuffer<float> pool;          ///< Stereo pool holding every pad's audio.
+    std::array<int, numPads> padLengths {}; ///< Number of valid samples in each pad.
+    std::array<Voice, maxVoices> voices;    ///< Voice pool (audio thread only).
+
+    juce::SpinLock poolLock;                ///< Guards pool writes against the audio thread.
+    std::atomic<int> polyphony { maxVoices }; ///< Current voice limit.
+    juce::uint32 voiceCounter = 0;          ///< Incremented on each trigger (audio thread only).
+    double deviceSampleRate = 44100.0;      ///< Rate pad audio is converted to.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplePadBank)
+};
@@ -0,0 +1,288 @@
+/**
+ * =================================================================
+ * @file SessionStore.cpp
+ * @brief Implementation of the SessionStore class.
+ *
+ * Created: 19 Oct 2026 12:31:44am
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "SessionStore.h"
+
+namespace
+{
+    constexpr int snapshotMagic = 0x31535353; // "SSS1"
+    constexpr int journalMagic = 0x314a5353;  // "SSJ1"
+}
+
+/**
+ * @brief Constructor for SessionStore.
+ */
+SessionStore::SessionStore()
+    : juce::Thread("Session store")
+{
+    const auto directory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("New_DJ");
+    directory.createDirectory();
+    snapshotFile = directory.getChildFile("session.snapshot");
+    journalFile = directory.getChildFile("session.journal");
+
+    load();
+    written = restored;
+    startThread();
+}
+
+/**
+ * @brief Destructor for SessionStore.
+ */
+SessionStore::~SessionStore()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+}
+
+/**
+ * @brief Builds the name of one value in the state.
+ * @param owner The deck name, e.g. "deck_a", or "mixer".
+ * @param name The value's name, e.g. "position".
+ * @return The value's name in the state.
+ */
+juce::Identifier SessionStore::key(const juce::String& owner, const juce::String& name)
+{
+    return owner + "_" + name;
+}
+
+/**
+ * @brief Gets the restored track, position and hot cues of each deck.
+ * @param fallback States to use for decks the session does not cover, e.g. from the CSV file.
+ * @return One state for "deck_a" and one for "deck_b", in that order.
+ */
+std::vector<DeckState> SessionStore::getDeckStates(const std::vector<DeckState>& fallback) const
+{
+    std::vector<DeckState> states;
+
+    for (const std::string deckName : { "deck_a", "deck_b" })
+    {
+        DeckState state { deckName, 0.0, "" };
+
+        for (const auto& row : fallback)
+            if (row.deck_name == deckName)
+                state = row;
+
+        if (const auto* file = restored.getVarPointer(key(deckName, "file")))
+        {
+            state.file_name = file->toString().toStdString();
+            state.position = restored.getWithDefault(key(deckName, "position"), 0.0);
+
+            for (size_t i = 0; i < state.hot_cues.size(); ++i)
+                state.hot_cues[i] = restored.getWithDefault(key(deckName, "cue" + juce::String((int) i)), -1.0);
+        }
+
+        states.push_back(state);
+    }
+
+    return states;
+}
+
+/**
+ * @brief Hands the current state to the writer thread.
+ * @param state The complete current state.
+ */
+void SessionStore::update(const juce::NamedValueSet& state)
+{
+    {
+        const juce::ScopedLock sl (pendingLock);
+        pending = state;
+        hasPending = true;
+    }
+
+    notify();
+}
+
+/**
+ * @brief Writer thread: journals each handed-over state and takes snapshots.
+ *
+ * A snapshot is taken first, which also clears any torn record a crash
+ * left at the end of the journal, and again on the way out.
+ */
+void SessionStore::run()
+{
+    writeSnapshot();
+
+    while (! threadShouldExit())
+    {
+        wait(-1);
+        writePending();
+    }
+
+    writePending();
+    writeSnapshot();
+}
+
+/**
+ * @brief Reads the snapshot and replays the journal over it.
+ */
+void SessionStore::load()
+{
+    readRecords(snapshotFile, snapshotMagic, restored);
+    readRecords(journalFile, journalMagic, restored);
+}
+
+/**
+ * @brief Journals the values that changed in the pending state.
+ */
+void SessionStore::writePending()
+{
+    juce::NamedValueSet state;
+
+    {
+        const juce::ScopedLock sl (pendingLock);
+
+        if (! hasPending)
+            return;
+
+        state = std::move(pending);
+        pending.clear();
+        hasPending = false;
+    }
+
+    juce::NamedValueSet changed;
+
+    for (const auto& value : state)
+    {
+        const auto* current = written.getVarPointer(value.name);
+
+        if (current == nullptr || *current != value.value)
+            changed.set(value.name, value.value);
+    }
+
+    if (changed.isEmpty())
+        return;
+
+    for (const auto& value : changed)
+        written.set(value.name, value.value);
+
+    if (journal != nullptr && journal->openedOk())
+    {
+        writeRecord(*journal, changed);
+        journal->flush();
+        ++numJournalRecords;
+    }
+
+    if (numJournalRecords >= maxJournalRecords
+        || juce::Time::getMillisecondCounter() - lastSnapshotTime >= snapshotIntervalMs)
+        writeSnapshot();
+}
+
+/**
+ * @brief Writes every value to a new snapshot and starts an empty journal.
+ *
+ * The snapshot is written beside the old one and renamed over it, so there
+ * is always one complete snapshot on disk.
+ */
+void SessionStore::writeSnapshot()
+{
+    juce::TemporaryFile temporary (snapshotFile);
+    bool snapshotWritten = false;
+
+    {
+        juce::FileOutputStream output (temporary.getFile());
+
+        if (output.openedOk())
+        {
+            output.writeInt(snapshotMagic);
+            writeRecord(output, written);
+            output.flush();
+            snapshotWritten = output.getStatus().wasOk();
+        }
+    }
+
+    if (! snapshotWritten || ! temporary.overwriteTargetFileWithTemporary())
+    {
+        DBG("SessionStore: could not write " + snapshotFile.getFullPathName());
+        return;
+    }
+
+    journal = std::make_unique<juce::FileOutputStream>(journalFile);
+
+    if (journal->openedOk() && journal->setPosition(0) && journal->truncate().wasOk())
+    {
+        journal->writeInt(journalMagic);
+        journal->flush();
+    }
+
+    numJournalRecords = 0;
+    lastSnapshotTime = juce::Time::getMillisecondCounter();
+}
+
+/**
+ * @brief Writes one length-prefixed record of values.
+ * @param output The stream to write to.
+ * @param values The values.
+ */
+void SessionStore::writeRecord(juce::OutputStream& output, const juce::NamedValueSet& values)
+{
+    juce::MemoryOutputStream payload;
+    payload.writeCompressedInt(values.size());
+
+    for (const auto& value : values)
+    {
+        payload.writeString(value.name.toString());
+        value.value.writeToStream(payload);
+    }
+
+    output.writeInt((int) payload.getDataSize());
+    output.write(payload.getData(), payload.getDataSize());
+}
+
+/**
+ * @brief Applies every complete record in a file.
+ *
+ * Reading stops at the first record that is cut short or does not parse.
+ *
+ * @param file The snapshot or journal.
+ * @param magic The number the file must start with.
+ * @param values Receives the values.
+ */
+void SessionStore::readRecords(const juce::File& file, int magic, juce::NamedValueSet& values)
+{
+    juce::MemoryBlock data;
+
+    if (! file.existsAsFile() || ! file.loadFileAsData(data))
+        return;
+
+    juce::MemoryInputStream input (data, false);
+
+    if (input.readInt() != magic)
+        return;
+
+    while (input.getNumBytesRemaining() >= 4)
+    {
+        const int size = input.readInt();
+
+        if (size < 0 || size > input.getNumBytesRemaining())
+            break;
+
+        juce::MemoryInputStream payload (static_cast<const char*>(data.getData()) + input.getPosition(), (size_t) size, false);
+        input.skipNextBytes(size);
+
+        const int count = payload.readCompressedInt();
+        juce::NamedValueSet record;
+
+        for (int i = 0; i < count && ! payload.isExhausted(); ++i)
+        {
+            const auto name = payload.readString();
+            const auto value = juce::var::readFromStream(payload);
+
+            if (name.isNotEmpty())
+                record.set(name, value);
+        }
+
+        if (count < 0 || record.size() != count)
+            break;
+
+        for (const auto& value : record)
+            values.set(value.name, value.value);
+    }
+}
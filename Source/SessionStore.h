@@ -0,0 +1,136 @@
+/**
+ * =================================================================
+ * @file SessionStore.h
+ * @brief Declaration of the SessionStore class.
+ *
+ * This file declares the crash-safe store for the deck and mixer state,
+ * which replaces the read-only dj_program_state.csv as the record of the
+ * current set.
+ *
+ * Created: 19 Oct 2026 12:31:44am
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CSVReader.h"
+
+/**
+ * @class SessionStore
+ * @brief Keeps the session's deck and mixer state on disk, journal first.
+ *
+ * The state is a flat set of named values, e.g. "deck_a_position" or
+ * "mixer_crossfader". The message thread hands over a copy a few times a
+ * second; a writer thread works out which values changed and appends just
+ * those to a journal. Every so often the writer folds everything into a
+ * snapshot, written beside the old one and renamed over it, and starts a
+ * fresh journal.
+ *
+ * At startup the snapshot is read and the journal replayed over it, up to
+ * the last complete record, so a crash loses at most the last capture.
+ * Replaying is idempotent: each record holds absolute values, so a journal
+ * left behind by a crash between the rename and the reset does no harm.
+ */
+class SessionStore : private juce::Thread
+{
+public:
+    /**
+     * @brief Constructor for SessionStore.
+     *
+     * Restores the last session and starts the writer thread.
+     */
+    SessionStore();
+
+    /**
+     * @brief Destructor for SessionStore.
+     *
+     * Writes anything still pending and leaves a fresh snapshot.
+     */
+    ~SessionStore() override;
+
+    /**
+     * @brief Builds the name of one value in the state.
+     * @param owner The deck name, e.g. "deck_a", or "mixer".
+     * @param name The value's name, e.g. "position".
+     * @return The value's name in the state.
+     */
+    static juce::Identifier key(const juce::String& owner, const juce::String& name);
+
+    /**
+     * @brief Gets the state restored at startup.
+     * @return The restored values; empty on the first run.
+     */
+    const juce::NamedValueSet& getRestoredState() const { return restored; }
+
+    /**
+     * @brief Gets the restored track, position and hot cues of each deck.
+     * @param fallback States to use for decks the session does not cover, e.g. from the CSV file.
+     * @return One state for "deck_a" and one for "deck_b", in that order.
+     */
+    std::vector<DeckState> getDeckStates(const std::vector<DeckState>& fallback) const;
+
+    /**
+     * @brief Hands the current state to the writer thread.
+     *
+     * Only the newest state is kept if the writer falls behind. Call from
+     * the message thread.
+     *
+     * @param state The complete current state.
+     */
+    void update(const juce::NamedValueSet& state);
+
+private:
+    /**
+     * @brief Writer thread: journals each handed-over state and takes snapshots.
+     */
+    void run() override;
+
+    /**
+     * @brief Reads the snapshot and replays the journal over it.
+     */
+    void load();
+
+    /**
+     * @brief Journals the values that changed in the pending state.
+     */
+    void writePending();
+
+    /**
+     * @brief Writes every value to a new snapshot and starts an empty journal.
+     */
+    void writeSnapshot();
+
+    /**
+     * @brief Writes one length-prefixed record of values.
+     * @param output The stream to write to.
+     * @param values The values.
+     */
+    static void writeRecord(juce::OutputStream& output, const juce::NamedValueSet& values);
+
+    /**
+     * @brief Applies every complete record in a file.
+     * @param file The snapshot or journal.
+     * @param magic The number the file must start with.
+     * @param values Receives the values.
+     */
+    static void readRecords(const juce::File& file, int magic, juce::NamedValueSet& values);
+
+    juce::File snapshotFile;                        ///< The last compacted state.
+    juce::File journalFile;                         ///< Changes since the snapshot.
+    juce::NamedValueSet restored;                   ///< State found at startup.
+
+    juce::CriticalSection pendingLock;              ///< Guards pending and hasPending.
+    juce::NamedValueSet pending;                    ///< Newest state not yet journaled.
+    bool hasPending = false;                        ///< True when pending holds a new state.
+
+    juce::NamedValueSet written;                    ///< State on disk; writer thread only.
+    std::unique_ptr<juce::FileOutputStream> journal;///< Open journal; writer thread only.
+    int numJournalRecords = 0;                      ///< Records since the snapshot.
+    juce::uint32 lastSnapshotTime = 0;              ///< Millisecond counter at the snapshot.
+
+    static constexpr int maxJournalRecords = 1000;              ///< Records before a snapshot is forced.
+    static constexpr juce::uint32 snapshotIntervalMs = 30000;   ///< Longest time between snapshots.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionStore)
+};
@@ -0,0 +1,80 @@
+/**
+ * =================================================================
+ * @file StartupProfiler.cpp
+ * @brief Implementation of the StartupProfiler class.
+ *
+ * Created: 18 Oct 2026 8:02:15pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "StartupProfiler.h"
+
+namespace
+{
+    /** Set during static initialisation, before main() runs. */
+    const double processStartMs = juce::Time::getMillisecondCounterHiRes();
+
+    /** Set once the report has been printed. */
+    bool reported = false;
+}
+
+/**
+ * @brief Gets the phases recorded so far.
+ * @return The phases in order.
+ */
+std::vector<StartupProfiler::Phase>& StartupProfiler::getPhases()
+{
+    static std::vector<Phase> phases;
+    return phases;
+}
+
+/**
+ * @brief Records that a phase of startup has finished.
+ * @param phase Name of the phase.
+ */
+void StartupProfiler::mark(const juce::String& phase)
+{
+    if (! reported)
+        getPhases().push_back({ phase, juce::Time::getMillisecondCounterHiRes() - processStartMs });
+}
+
+/**
+ * @brief Records the first frame and prints the report.
+ *
+ * Each line shows how long the phase took and when it finished.
+ */
+void StartupProfiler::firstFrameShown()
+{
+    if (reported)
+        return;
+
+    mark("first frame");
+    reported = true;
+
+    double previousMs = 0.0;
+
+    for (const auto& phase : getPhases())
+    {
+        std::cout << "Startup: " << phase.name << " took " << juce::String(phase.endMs - previousMs, 1)
+                  << " ms (at " << juce::String(phase.endMs, 1) << " ms)" << std::endl;
+        previousMs = phase.endMs;
+    }
+
+    if (previousMs > targetMs)
+        std::cout << "Startup: time to first frame " << juce::String(previousMs, 1)
+                  << " ms is over the " << juce::String(targetMs, 0) << " ms target" << std::endl;
+
+    getPhases().clear();
+}
+
+/**
+ * @brief Records that the restored session is loaded and ready to play.
+ */
+void StartupProfiler::sessionRestored()
+{
+    const double nowMs = juce::Time::getMillisecondCounterHiRes() - processStartMs;
+    mark("session restored");
+
+    std::cout << "Startup: session restored and ready to play at " << juce::String(nowMs, 1) << " ms" << std::endl;
+}
@@ -0,0 +1,66 @@
+/**
+ * =================================================================
+ * @file StartupProfiler.h
+ * @brief Declaration of the StartupProfiler class.
+ *
+ * This file declares the timer that records how long each phase of startup
+ * takes, up to the first frame being shown.
+ *
+ * Created: 18 Oct 2026 8:02:15pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class StartupProfiler
+ * @brief Records named startup phases and reports time-to-first-frame.
+ *
+ * Times are measured from when the process loaded. The report is printed
+ * once, when the first frame is shown, and warns if the target was missed.
+ * Call only from the message thread.
+ */
+class StartupProfiler
+{
+public:
+    /** Time-to-first-frame the app should stay under, in milliseconds. */
+    static constexpr double targetMs = 500.0;
+
+    /**
+     * @brief Records that a phase of startup has finished.
+     * @param phase Name of the phase.
+     */
+    static void mark(const juce::String& phase);
+
+    /**
+     * @brief Records the first frame and prints the report.
+     *
+     * Later calls do nothing.
+     */
+    static void firstFrameShown();
+
+    /**
+     * @brief Records that the restored session is loaded and ready to play.
+     *
+     * Prints the end-to-end time from process start, which the first-frame
+     * report does not cover since decks finish loading in the background.
+     */
+    static void sessionRestored();
+
+private:
+    /**
+     * @brief A finished phase.
+     */
+    struct Phase {
+        juce::String name;   ///< Name of the phase.
+        double endMs = 0.0;  ///< Time since process start when it finished.
+    };
+
+    /**
+     * @brief Gets the phases recorded so far.
+     * @return The phases in order.
+     */
+    static std::vector<Phase>& getPhases();
+};
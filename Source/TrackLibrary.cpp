@@ -0,0 +1,1132 @@
+/**
+ * =================================================================
+ * @file TrackLibrary.cpp
+ * @brief Implementation of the TrackLibrary class.
+ *
+ * Created: 18 Oct 2026 9:52:08pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include "StartupProfiler.h"
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <cstdlib>
+#endif
+
+namespace
+{
+    /** Tag at the start of the library file; changes whenever the layout does. */
+    constexpr int libraryMagic = 0x32424c54; // "TLB2"
+
+    /** Tag of the first layout, whose track records have no time added. */
+    constexpr int libraryMagicV1 = 0x31424c54; // "TLB1"
+
+    /** Changes are handed to the message thread in batches of about this many. */
+    constexpr size_t changeBatchSize = 512;
+
+    /** How often folders are rescanned where they cannot be watched (ms). */
+    constexpr int rescanIntervalMs = 30000;
+
+    /** Time opening the library should stay under, in milliseconds. */
+    constexpr double loadTargetMs = 1000.0;
+
+    /**
+     * @brief Resolves every symbolic link in a folder's path.
+     * @param folder The folder.
+     * @return The folder's canonical path, so two paths to one folder compare equal.
+     */
+    juce::String getCanonicalPath(const juce::File& folder)
+    {
+       #if JUCE_LINUX || JUCE_MAC
+        if (char* resolved = realpath(folder.getFullPathName().toRawUTF8(), nullptr))
+        {
+            const juce::String path (juce::CharPointer_UTF8 (resolved));
+            free(resolved);
+            return path;
+        }
+       #endif
+
+        return folder.getLinkedTarget().getFullPathName();
+    }
+}
+
+/**
+ * @brief Constructor for TrackLibrary.
+ * @param formatManagerToUse Format manager deciding which files are audio files.
+ * @param libraryFile The library file, or a default in the user's application data.
+ */
+TrackLibrary::TrackLibrary(juce::AudioFormatManager& formatManagerToUse, const juce::File& libraryFile)
+    : juce::Thread("Track library scanner"),
+      formatManager(formatManagerToUse),
+      file(libraryFile != juce::File() ? libraryFile
+                                       : juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                             .getChildFile("New_DJ").getChildFile("library.db"))
+{
+    const double loadStartMs = juce::Time::getMillisecondCounterHiRes();
+    load();
+
+    // Compact here as well as on close, so a session that crashes never lets the log grow unchecked.
+    if (isMostlyStale())
+        compact();
+
+    const double loadMs = juce::Time::getMillisecondCounterHiRes() - loadStartMs;
+    std::cout << "Track library: " << getTrackIds().size() << " tracks opened in " << juce::String(loadMs, 1) << " ms"
+              << (loadMs > loadTargetMs ? ", over the " + juce::String(loadTargetMs, 0) + " ms target" : juce::String())
+              << std::endl;
+
+    file.getParentDirectory().createDirectory();
+    log = std::make_unique<juce::FileOutputStream>(file);
+
+    if (log->openedOk() && log->getPosition() == 0)
+        log->writeInt(libraryMagic);
+
+   #if JUCE_LINUX
+    inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   #endif
+
+    StartupProfiler::mark("track library loaded");
+}
+
+/**
+ * @brief Destructor for TrackLibrary.
+ */
+TrackLibrary::~TrackLibrary()
+{
+    stopThread(4000);
+    cancelPendingUpdate();
+
+   #if JUCE_LINUX
+    if (inotifyHandle >= 0)
+        close(inotifyHandle);
+   #endif
+
+    if (isMostlyStale())
+        compact();
+}
+
+/**
+ * @brief Starts the scanner and rescans the watched folders.
+ */
+void TrackLibrary::startScanning()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    for (const auto& root : roots)
+        queueScan(root);
+
+    startThread();
+}
+
+/**
+ * @brief Adds a folder to watch, scanning it and its subfolders.
+ * @param folder The folder.
+ */
+void TrackLibrary::addFolder(const juce::File& folder)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    const auto path = folder.getFullPathName();
+
+    if (! roots.contains(path))
+    {
+        juce::MemoryOutputStream payload;
+        payload.writeString(path);
+        append(rootRecord, payload.getMemoryBlock());
+        log->flush();
+    }
+
+    queueScan(path);
+}
+
+/**
+ * @brief Imports any mix of files and folders.
+ * @param paths Full paths of the files and folders.
+ */
+void TrackLibrary::import(const juce::StringArray& paths)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    juce::StringArray files;
+
+    for (const auto& path : paths)
+    {
+        if (juce::File(path).isDirectory())
+            addFolder(juce::File(path));
+        else
+            files.add(path);
+    }
+
+    if (files.isEmpty())
+        return;
+
+    {
+        const juce::ScopedLock sl (queueLock);
+        pendingFiles.addArray(files);
+    }
+
+    queueScan({});
+}
+
+/**
+ * @brief Gets the IDs of all tracks that are still present, in the order they were added.
+ * @return The track IDs.
+ */
+std::vector<int> TrackLibrary::getTrackIds() const
+{
+    std::vector<int> ids;
+    ids.reserve(tracks.size());
+
+    for (size_t i = 0; i < tracks.size(); ++i)
+        if (! tracks[i].removed)
+            ids.push_back((int) i);
+
+    return ids;
+}
+
+/**
+ * @brief Gets a track by ID.
+ * @param id A track ID.
+ * @return The track; an unknown ID gives a removed, empty track.
+ */
+const TrackLibrary::Track& TrackLibrary::getTrack(int id) const
+{
+    static const Track empty;
+
+    if (id < 0 || id >= (int) tracks.size())
+        return empty;
+
+    return tracks[(size_t) id];
+}
+
+/**
+ * @brief Looks up a track by file.
+ * @param fileToFind The audio file.
+ * @return The track's ID, or -1 if it is not in the library.
+ */
+int TrackLibrary::findTrack(const juce::File& fileToFind) const
+{
+    auto found = trackIds.find(fileToFind.getFullPathName());
+    return found != trackIds.end() ? found->second : -1;
+}
+
+/**
+ * @brief Stores analysis results for a track.
+ * @param id The track's ID.
+ * @param analysis The results.
+ */
+void TrackLibrary::setAnalysis(int id, const TrackMetadata& analysis)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (id < 0 || id >= (int) tracks.size() || ! analysis.ready)
+        return;
+
+    juce::MemoryOutputStream payload;
+    payload.writeInt(id);
+    analysis.writeTo(payload);
+
+    // Compare the serialised values so an unchanged result costs no record.
+    const auto& current = tracks[(size_t) id].analysis;
+
+    if (current.ready)
+    {
+        juce::MemoryOutputStream existing;
+        existing.writeInt(id);
+        current.writeTo(existing);
+
+        if (existing.getMemoryBlock() == payload.getMemoryBlock())
+            return;
+    }
+
+    append(analysisRecord, payload.getMemoryBlock());
+    log->flush();
+}
+
+/**
+ * @brief Gets the names of all crates.
+ * @return The crate names, sorted.
+ */
+juce::StringArray TrackLibrary::getCrateNames() const
+{
+    juce::StringArray names;
+
+    for (const auto& [name, ids] : crates)
+        names.add(name);
+
+    return names;
+}
+
+/**
+ * @brief Gets the tracks in a crate.
+ * @param crate The crate's name.
+ * @return The track IDs, in the order they were added.
+ */
+std::vector<int> TrackLibrary::getCrate(const juce::String& crate) const
+{
+    auto found = crates.find(crate);
+    return found != crates.end() ? found->second : std::vector<int>();
+}
+
+/**
+ * @brief Adds a track to a crate, creating the crate if needed.
+ * @param crate The crate's name.
+ * @param id The track's ID.
+ */
+void TrackLibrary::addToCrate(const juce::String& crate, int id)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    juce::MemoryOutputStream payload;
+    payload.writeString(crate);
+    payload.writeInt(id);
+    append(crateAddRecord, payload.getMemoryBlock());
+    log->flush();
+}
+
+/**
+ * @brief Removes a track from a crate.
+ * @param crate The crate's name.
+ * @param id The track's ID.
+ */
+void TrackLibrary::removeFromCrate(const juce::String& crate, int id)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    juce::MemoryOutputStream payload;
+    payload.writeString(crate);
+    payload.writeInt(id);
+    append(crateRemoveRecord, payload.getMemoryBlock());
+    log->flush();
+}
+
+/**
+ * @brief Scanner thread: scans queued folders and imported files, then waits for changes.
+ *
+ * On Linux it blocks on the inotify handle between scans and relists any
+ * folder an event names, or queues every watched folder again if the
+ * kernel's event queue overflowed; elsewhere it rescans the watched folders on a
+ * timer, which is cheap because unchanged folders are skipped.
+ */
+void TrackLibrary::run()
+{
+    while (! threadShouldExit())
+    {
+        juce::String next;
+
+        {
+            const juce::ScopedLock sl (queueLock);
+
+            if (! pendingScans.isEmpty())
+            {
+                next = pendingScans[0];
+                pendingScans.remove(0);
+            }
+        }
+
+        if (next.isNotEmpty())
+        {
+            std::vector<Change> changes;
+            std::unordered_set<juce::String> visited;
+            scanFolder(juce::File(next), changes, false, visited);
+            postChanges(changes);
+            continue;
+        }
+
+        juce::StringArray files;
+        juce::String extensions;
+
+        {
+            const juce::ScopedLock sl (queueLock);
+            files.swapWith(pendingFiles);
+            extensions = audioExtensions;
+        }
+
+        if (! files.isEmpty())
+        {
+            std::vector<Change> changes;
+
+            for (const auto& path : files)
+            {
+                const juce::File importedFile (path);
+
+                if (importedFile.existsAsFile() && importedFile.hasFileExtension(extensions))
+                    changes.push_back({ trackRecord, path, importedFile.getSize(),
+                                        importedFile.getLastModificationTime().toMilliseconds() });
+
+                if (changes.size() >= changeBatchSize)
+                    postChanges(changes);
+            }
+
+            postChanges(changes);
+            continue;
+        }
+
+       #if JUCE_LINUX
+        if (inotifyHandle >= 0)
+        {
+            pollfd descriptor { inotifyHandle, POLLIN, 0 };
+
+            if (poll(&descriptor, 1, 250) <= 0)
+                continue;
+
+            alignas(inotify_event) char buffer[8192];
+            juce::StringArray changedFolders;
+            bool overflowed = false;
+            ssize_t bytesRead;
+
+            while ((bytesRead = read(inotifyHandle, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* position = buffer; position < buffer + bytesRead;)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(position);
+                    auto watched = watches.find(event->wd);
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                        overflowed = true;
+                    else if (watched != watches.end())
+                    {
+                        if ((event->mask & IN_IGNORED) != 0)
+                        {
+                            watchedFolders.erase(watched->second);
+                            watches.erase(watched);
+                        }
+                        else
+                        {
+                            changedFolders.addIfNotAlreadyThere(watched->second);
+                        }
+                    }
+
+                    position += sizeof(inotify_event) + event->len;
+                }
+            }
+
+            // A file rewritten in place does not touch its folder's time, so list the folder regardless.
+            std::vector<Change> changes;
+            std::unordered_set<juce::String> visited;
+
+            for (const auto& folder : changedFolders)
+                scanFolder(juce::File(folder), changes, true, visited);
+
+            postChanges(changes);
+
+            // The kernel dropped events, so any folder may have changed unseen; rescan everything.
+            if (overflowed)
+            {
+                DBG("TrackLibrary: inotify queue overflowed, rescanning all folders");
+                const juce::ScopedLock sl (lock);
+
+                for (const auto& root : roots)
+                    queueScan(root);
+            }
+
+            continue;
+        }
+       #endif
+
+        if (wait(rescanIntervalMs))
+            continue;
+
+        const juce::ScopedLock sl (lock);
+
+        for (const auto& root : roots)
+            queueScan(root);
+    }
+}
+
+/**
+ * @brief Scans a folder and, recursively, its subfolders.
+ *
+ * A folder whose modification time matches the last scan is not listed;
+ * its known subfolders are still visited. A folder reached a second time,
+ * e.g. through a symbolic link back up the tree, is skipped.
+ *
+ * @param folder The folder.
+ * @param changes Receives what has changed.
+ * @param force True to list the folder even if its time has not changed.
+ * @param visited Canonical paths of the folders scanned so far in this pass.
+ */
+void TrackLibrary::scanFolder(const juce::File& folder, std::vector<Change>& changes, bool force,
+                              std::unordered_set<juce::String>& visited)
+{
+    if (threadShouldExit())
+        return;
+
+    const auto path = folder.getFullPathName();
+
+    if (! folder.isDirectory())
+    {
+        changes.push_back({ folderRemovedRecord, path });
+        return;
+    }
+
+    if (! visited.insert(getCanonicalPath(folder)).second)
+        return;
+
+   #if JUCE_LINUX
+    if (inotifyHandle >= 0 && watchedFolders.count(path) == 0)
+    {
+        const int watch = inotify_add_watch(inotifyHandle, path.toRawUTF8(),
+                                            IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO);
+        if (watch >= 0)
+        {
+            watches[watch] = path;
+            watchedFolders.insert(path);
+        }
+    }
+   #endif
+
+    const auto modified = folder.getLastModificationTime().toMilliseconds();
+    juce::StringArray previousSubfolders;
+    std::unordered_map<juce::String, std::pair<juce::int64, juce::int64>> knownFiles;
+    bool unchanged = false;
+
+    {
+        const juce::ScopedLock sl (lock);
+        auto found = folders.find(path);
+
+        if (found != folders.end())
+        {
+            previousSubfolders = found->second.subfolders;
+            unchanged = found->second.modified == modified;
+        }
+
+        if (! unchanged || force)
+        {
+            auto inFolder = tracksInFolder.find(path);
+
+            if (inFolder != tracksInFolder.end())
+                for (int id : inFolder->second)
+                    if (! tracks[(size_t) id].removed)
+                        knownFiles[tracks[(size_t) id].file.getFullPathName()] = { tracks[(size_t) id].size,
+                                                                                   tracks[(size_t) id].modified };
+        }
+    }
+
+    if (unchanged && ! force)
+    {
+        for (const auto& subfolder : previousSubfolders)
+            scanFolder(juce::File(subfolder), changes, false, visited);
+
+        return;
+    }
+
+    juce::String extensions;
+
+    {
+        const juce::ScopedLock sl (queueLock);
+        extensions = audioExtensions;
+    }
+
+    juce::StringArray subfolders;
+
+    for (const auto& entry : juce::RangedDirectoryIterator(folder, false, "*",
+                                                           juce::File::findFilesAndDirectories | juce::File::ignoreHiddenFiles))
+    {
+        const auto& entryFile = entry.getFile();
+
+        if (entry.isDirectory())
+        {
+            subfolders.add(entryFile.getFullPathName());
+            continue;
+        }
+
+        if (! entryFile.hasFileExtension(extensions))
+            continue;
+
+        const auto filePath = entryFile.getFullPathName();
+        const auto size = entry.getFileSize();
+        const auto fileModified = entry.getModificationTime().toMilliseconds();
+        auto known = knownFiles.find(filePath);
+
+        if (known != knownFiles.end())
+        {
+            const bool same = known->second.first == size && known->second.second == fileModified;
+            knownFiles.erase(known);
+
+            if (same)
+                continue;
+        }
+
+        changes.push_back({ trackRecord, filePath, size, fileModified });
+    }
+
+    for (const auto& [gone, identity] : knownFiles)
+        changes.push_back({ trackRemovedRecord, gone });
+
+    for (const auto& previous : previousSubfolders)
+        if (! subfolders.contains(previous))
+            changes.push_back({ folderRemovedRecord, previous });
+
+    changes.push_back({ folderRecord, path, 0, modified, subfolders });
+
+    if (changes.size() >= changeBatchSize)
+        postChanges(changes);
+
+    for (const auto& subfolder : subfolders)
+        scanFolder(juce::File(subfolder), changes, false, visited);
+}
+
+/**
+ * @brief Hands changes to the message thread.
+ * @param changes The changes; emptied.
+ */
+void TrackLibrary::postChanges(std::vector<Change>& changes)
+{
+    if (changes.empty())
+        return;
+
+    {
+        const juce::ScopedLock sl (queueLock);
+        pendingChanges.insert(pendingChanges.end(),
+                              std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+    }
+
+    changes.clear();
+    triggerAsyncUpdate();
+}
+
+/**
+ * @brief Applies the scanner's changes on the message thread.
+ *
+ * Changes that are already in the library (e.g. from a folder scanned
+ * twice before the first result arrived) are dropped without a record.
+ */
+void TrackLibrary::handleAsyncUpdate()
+{
+    std::vector<Change> changes;
+
+    {
+        const juce::ScopedLock sl (queueLock);
+        changes.swap(pendingChanges);
+    }
+
+    bool tracksChanged = false;
+
+    for (const auto& change : changes)
+    {
+        if (change.type == trackRecord)
+        {
+            const int id = findTrack(juce::File(change.path));
+
+            if (id >= 0 && ! tracks[(size_t) id].removed
+                && tracks[(size_t) id].size == change.size && tracks[(size_t) id].modified == change.modified)
+                continue;
+
+            putTrack(change.path, change.size, change.modified);
+            tracksChanged = true;
+        }
+        else if (change.type == trackRemovedRecord)
+        {
+            const int id = findTrack(juce::File(change.path));
+
+            if (id >= 0 && ! tracks[(size_t) id].removed)
+            {
+                removeTrack(id);
+                tracksChanged = true;
+            }
+        }
+        else if (change.type == folderRecord)
+        {
+            auto found = folders.find(change.path);
+
+            if (found != folders.end() && found->second.modified == change.modified
+                && found->second.subfolders == change.subfolders)
+                continue;
+
+            juce::MemoryOutputStream payload;
+            payload.writeString(change.path);
+            payload.writeInt64(change.modified);
+            payload.writeInt(change.subfolders.size());
+
+            for (const auto& subfolder : change.subfolders)
+                payload.writeString(subfolder);
+
+            append(folderRecord, payload.getMemoryBlock());
+        }
+        else if (change.type == folderRemovedRecord)
+        {
+            // Remove the folder, everything under it and all their tracks.
+            juce::StringArray gone { change.path };
+
+            for (int i = 0; i < gone.size(); ++i)
+            {
+                auto found = folders.find(gone[i]);
+
+                if (found != folders.end())
+                    gone.addArray(found->second.subfolders);
+
+                auto inFolder = tracksInFolder.find(gone[i]);
+
+                if (inFolder != tracksInFolder.end())
+                {
+                    for (int id : inFolder->second)
+                    {
+                        if (! tracks[(size_t) id].removed)
+                        {
+                            removeTrack(id);
+                            tracksChanged = true;
+                        }
+                    }
+                }
+
+                if (found != folders.end())
+                {
+                    juce::MemoryOutputStream payload;
+                    payload.writeString(gone[i]);
+                    append(folderRemovedRecord, payload.getMemoryBlock());
+                }
+            }
+        }
+    }
+
+    log->flush();
+
+    if (tracksChanged)
+        sendChangeMessage();
+}
+
+/**
+ * @brief Replays the library file into the indexes.
+ *
+ * The whole file is read in one go and parsed from memory. A record cut
+ * short by a crash is cut off the end of the file. A file in the first
+ * layout is read and rewritten in the current one; a file that is not a
+ * library at all is moved aside, never deleted, and a new library started.
+ */
+void TrackLibrary::load()
+{
+    juce::MemoryBlock data;
+
+    if (! file.existsAsFile() || ! file.loadFileAsData(data))
+        return;
+
+    juce::MemoryInputStream input (data, false);
+    const int magic = input.readInt();
+
+    if (magic != libraryMagic && magic != libraryMagicV1)
+    {
+        const auto aside = file.getSiblingFile(file.getFileName() + ".unreadable").getNonexistentSibling();
+        DBG("TrackLibrary: " + file.getFullPathName() + " is not a library file, moved to " + aside.getFileName());
+
+        if (! file.moveFileTo(aside))
+            std::cout << "Track library: cannot read or move " << file.getFullPathName() << std::endl;
+
+        return;
+    }
+
+    auto validEnd = input.getPosition();
+
+    while (input.getNumBytesRemaining() >= 5)
+    {
+        const auto type = (RecordType) input.readByte();
+        const int size = input.readInt();
+
+        if (size < 0 || size > input.getNumBytesRemaining())
+            break;
+
+        juce::MemoryInputStream payload (static_cast<const char*>(data.getData()) + input.getPosition(), (size_t) size, false);
+        apply(type, payload);
+        input.skipNextBytes(size);
+
+        validEnd = input.getPosition();
+        ++numRecords;
+    }
+
+    if (validEnd < (juce::int64) data.getSize())
+    {
+        juce::FileOutputStream output (file);
+
+        if (output.openedOk() && output.setPosition(validEnd))
+            output.truncate();
+    }
+
+    if (magic == libraryMagicV1)
+        compact();
+}
+
+/**
+ * @brief Applies one record to the indexes.
+ *
+ * Runs on the message thread; holds the lock while the scanner could be
+ * reading.
+ *
+ * @param type Kind of record.
+ * @param input The record's payload.
+ */
+void TrackLibrary::apply(RecordType type, juce::InputStream& input)
+{
+    const juce::ScopedLock sl (lock);
+
+    switch (type)
+    {
+        case trackRecord:
+        {
+            const int id = input.readInt();
+            const juce::File trackFile (input.readString());
+            const auto size = input.readInt64();
+            const auto modified = input.readInt64();
+            // Records from the first layout end here; their time added is unknown.
+            const auto added = input.getNumBytesRemaining() >= 8 ? input.readInt64() : 0;
+
+            if (id < 0)
+                break;
+
+            if (id >= (int) tracks.size())
+                tracks.resize((size_t) id + 1);
+
+            auto& track = tracks[(size_t) id];
+
+            // A changed file's analysis no longer applies.
+            if (track.size != size || track.modified != modified)
+                track.analysis = {};
+
+            if (track.file != trackFile)
+            {
+                track.file = trackFile;
+                trackIds[trackFile.getFullPathName()] = id;
+                tracksInFolder[trackFile.getParentDirectory().getFullPathName()].push_back(id);
+            }
+
+            track.size = size;
+            track.modified = modified;
+            track.added = added;
+            track.removed = false;
+            break;
+        }
+
+        case trackRemovedRecord:
+        {
+            const int id = input.readInt();
+
+            if (id >= 0 && id < (int) tracks.size())
+                tracks[(size_t) id].removed = true;
+
+            break;
+        }
+
+        case analysisRecord:
+        {
+            const int id = input.readInt();
+            auto analysis = TrackMetadata::readFrom(input);
+
+            if (id >= 0 && id < (int) tracks.size())
+                tracks[(size_t) id].analysis = std::move(analysis);
+
+            break;
+        }
+
+        case folderRecord:
+        {
+            const auto path = input.readString();
+            auto& folder = folders[path];
+            folder.modified = input.readInt64();
+            folder.subfolders.clearQuick();
+
+            for (int i = input.readInt(); --i >= 0;)
+                folder.subfolders.add(input.readString());
+
+            break;
+        }
+
+        case folderRemovedRecord:
+            folders.erase(input.readString());
+            break;
+
+        case rootRecord:
+            roots.addIfNotAlreadyThere(input.readString());
+            break;
+
+        case crateAddRecord:
+        {
+            const auto crate = input.readString();
+            const int id = input.readInt();
+            auto& ids = crates[crate];
+
+            if (std::find(ids.begin(), ids.end(), id) == ids.end())
+                ids.push_back(id);
+
+            break;
+        }
+
+        case crateRemoveRecord:
+        {
+            const auto crate = input.readString();
+            const int id = input.readInt();
+            auto found = crates.find(crate);
+
+            if (found != crates.end())
+            {
+                auto& ids = found->second;
+                ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+
+                if (ids.empty())
+                    crates.erase(found);
+            }
+
+            break;
+        }
+
+        default:
+            DBG("TrackLibrary: skipping unknown record type " + juce::String((int) type));
+            break;
+    }
+}
+
+/**
+ * @brief Applies a record to the indexes and appends it to the library file.
+ *
+ * The caller flushes the file once it has appended a batch.
+ *
+ * @param type Kind of record.
+ * @param payload The record's payload.
+ */
+void TrackLibrary::append(RecordType type, const juce::MemoryBlock& payload)
+{
+    juce::MemoryInputStream input (payload, false);
+    apply(type, input);
+
+    if (log != nullptr && log->openedOk())
+    {
+        log->writeByte((char) type);
+        log->writeInt((int) payload.getSize());
+        log->write(payload.getData(), payload.getSize());
+        ++numRecords;
+    }
+}
+
+/**
+ * @brief Records that a file was found or changed.
+ * @param path Full path of the file.
+ * @param size File size.
+ * @param modified Modification time (ms).
+ * @return The track's ID.
+ */
+int TrackLibrary::putTrack(const juce::String& path, juce::int64 size, juce::int64 modified)
+{
+    auto found = trackIds.find(path);
+    const int id = found != trackIds.end() ? found->second : (int) tracks.size();
+    const auto added = found != trackIds.end() ? tracks[(size_t) id].added : juce::Time::currentTimeMillis();
+
+    juce::MemoryOutputStream payload;
+    payload.writeInt(id);
+    payload.writeString(path);
+    payload.writeInt64(size);
+    payload.writeInt64(modified);
+    payload.writeInt64(added);
+    append(trackRecord, payload.getMemoryBlock());
+    return id;
+}
+
+/**
+ * @brief Marks a track and its file as gone.
+ *
+ * The ID is kept, so crates still find the track if the file comes back.
+ *
+ * @param id The track's ID.
+ */
+void TrackLibrary::removeTrack(int id)
+{
+    juce::MemoryOutputStream payload;
+    payload.writeInt(id);
+    append(trackRemovedRecord, payload.getMemoryBlock());
+}
+
+/**
+ * @brief Checks whether most of the library file is out of date.
+ *
+ * Counts the records a snapshot would need and compares them with the
+ * records in the file.
+ *
+ * @return True once compacting would at least halve the file.
+ */
+bool TrackLibrary::isMostlyStale() const
+{
+    int liveRecords = (int) folders.size() + roots.size();
+
+    for (const auto& track : tracks)
+        if (track.file != juce::File())
+            liveRecords += track.removed || track.analysis.ready ? 2 : 1;
+
+    for (const auto& [name, ids] : crates)
+        liveRecords += (int) ids.size();
+
+    return numRecords > 2 * liveRecords + 1000;
+}
+
+/**
+ * @brief Writes every live record to a fresh library file.
+ *
+ * Written through a temporary file so a crash never leaves half a library.
+ */
+void TrackLibrary::compact()
+{
+    log.reset();
+    juce::TemporaryFile temporary (file);
+    int recordsWritten = 0;
+
+    {
+        juce::FileOutputStream output (temporary.getFile());
+
+        if (! output.openedOk())
+            return;
+
+        output.writeInt(libraryMagic);
+
+        auto write = [&output, &recordsWritten](RecordType type, const juce::MemoryOutputStream& payload) {
+            output.writeByte((char) type);
+            output.writeInt((int) payload.getDataSize());
+            output.write(payload.getData(), payload.getDataSize());
+            ++recordsWritten;
+        };
+
+        for (const auto& root : roots)
+        {
+            juce::MemoryOutputStream payload;
+            payload.writeString(root);
+            write(rootRecord, payload);
+        }
+
+        for (const auto& [path, folder] : folders)
+        {
+            juce::MemoryOutputStream payload;
+            payload.writeString(path);
+            payload.writeInt64(folder.modified);
+            payload.writeInt(folder.subfolders.size());
+
+            for (const auto& subfolder : folder.subfolders)
+                payload.writeString(subfolder);
+
+            write(folderRecord, payload);
+        }
+
+        // Removed tracks are kept too, so IDs stay the same.
+        for (size_t id = 0; id < tracks.size(); ++id)
+        {
+            const auto& track = tracks[id];
+
+            if (track.file == juce::File())
+                continue;
+
+            juce::MemoryOutputStream payload;
+            payload.writeInt((int) id);
+            payload.writeString(track.file.getFullPathName());
+            payload.writeInt64(track.size);
+            payload.writeInt64(track.modified);
+            payload.writeInt64(track.added);
+            write(trackRecord, payload);
+
+            if (track.removed)
+            {
+                juce::MemoryOutputStream removed;
+                removed.writeInt((int) id);
+                write(trackRemovedRecord, removed);
+            }
+            else if (track.analysis.ready)
+            {
+                juce::MemoryOutputStream analysis;
+                analysis.writeInt((int) id);
+                track.analysis.writeTo(analysis);
+                write(analysisRecord, analysis);
+            }
+        }
+
+        for (const auto& [name, ids] : crates)
+        {
+            for (int id : ids)
+            {
+                juce::MemoryOutputStream payload;
+                payload.writeString(name);
+                payload.writeInt(id);
+                write(crateAddRecord, payload);
+            }
+        }
+    }
+
+    if (temporary.overwriteTargetFileWithTemporary())
+        numRecords = recordsWritten;
+}
+
+/**
+ * @brief Queues a folder for the scanner.
+ * @param path Full path of the folder, or empty just to wake the scanner.
+ */
+void TrackLibrary::queueScan(const juce::String& path)
+{
+    {
+        const juce::ScopedLock sl (queueLock);
+
+        // Refreshed here so formats registered after construction are picked up.
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            audioExtensions = formatManager.getWildcardForAllFormats().removeCharacters("*");
+
+        if (path.isNotEmpty())
+            pendingScans.addIfNotAlreadyThere(path);
+    }
+
+    notify();
+}
+
+/**
+ * @brief Measures how long a large library takes to open and prints the result.
+ * @param numTracks Number of tracks in the synthetic library.
+ */
+void TrackLibrary::runBenchmark(int numTracks)
+{
+    juce::AudioFormatManager formatManager;
+    const auto libraryFile = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("library_benchmark.db");
+    libraryFile.deleteFile();
+
+    {
+        TrackLibrary library (formatManager, libraryFile);
+        juce::Random random (42);
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            const auto path = "/Music/Crate " + juce::String(i % 97) + "/track_" + juce::String(i) + ".mp3";
+            const int id = library.putTrack(path, 4000000 + random.nextInt(8000000), 1760000000000 + i);
+
+            TrackMetadata analysis;
+            analysis.ready = true;
+            analysis.durationSeconds = 120.0 + i % 300;
+            analysis.sampleRate = 44100.0;
+            analysis.numChannels = 2;
+            analysis.bitrateKbps = 320;
+            analysis.title = "Title " + juce::String(i);
+            analysis.artist = "Artist " + juce::String(i % 311);
+            analysis.album = "Album " + juce::String(i % 1009);
+            analysis.key = juce::String(1 + i % 12) + (i % 2 == 0 ? "A" : "B");
+            analysis.bpm = 80.0f + random.nextFloat() * 80.0f;
+
+            juce::MemoryOutputStream payload;
+            payload.writeInt(id);
+            analysis.writeTo(payload);
+            library.append(analysisRecord, payload.getMemoryBlock());
+        }
+
+        library.log->flush();
+    }
+
+    std::cout << "Library benchmark: " << numTracks << " tracks, "
+              << juce::String((double) libraryFile.getSize() / (1024.0 * 1024.0), 1) << " MB" << std::endl;
+
+    double bestMs = 0.0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const double startMs = juce::Time::getMillisecondCounterHiRes();
+        TrackLibrary library (formatManager, libraryFile);
+        const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+        bestMs = i == 0 ? elapsedMs : juce::jmin(bestMs, elapsedMs);
+    }
+
+    std::cout << "  open: " << juce::String(bestMs, 1) << " ms (target " << juce::String(loadTargetMs, 0) << " ms)" << std::endl;
+    libraryFile.deleteFile();
+}
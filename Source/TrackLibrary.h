@@ -0,0 +1,311 @@
+/**
+ * =================================================================
+ * @file TrackLibrary.h
+ * @brief Declaration of the TrackLibrary class.
+ *
+ * This file declares the persistent library of tracks, their analysis
+ * results and crates, and the scanner that keeps it in step with the
+ * folders on disk.
+ *
+ * Created: 18 Oct 2026 9:52:08pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackMetadataService.h"
+
+/**
+ * @class TrackLibrary
+ * @brief Persistent, indexed store of tracks, analysis results and crates.
+ *
+ * The library is kept in an append-only log: every change is one
+ * length-prefixed record added to the end of the file, and opening the
+ * library replays the log into in-memory indexes. A record cut short by a
+ * crash is dropped on the next open. Once most of the log is out of date it
+ * is rewritten as a snapshot of the live records, when the library is opened
+ * or closed.
+ *
+ * Watched folders are scanned on a background thread. A folder whose
+ * modification time has not changed since the last scan is not listed
+ * again; in a changed folder only files whose size or modification time
+ * differ are updated. On Linux folders are also watched with inotify, so
+ * changes made while the app is running are picked up straight away;
+ * elsewhere the folders are rescanned every so often.
+ *
+ * Track IDs are stable for the life of the library. All public methods must
+ * be called from the message thread; a change message is sent whenever the
+ * scanner has changed the tracks.
+ */
+class TrackLibrary : public juce::ChangeBroadcaster,
+                     private juce::AsyncUpdater,
+                     private juce::Thread
+{
+public:
+    /**
+     * @brief A track in the library.
+     */
+    struct Track {
+        juce::File file;            ///< The audio file.
+        juce::int64 size = 0;       ///< File size when last scanned.
+        juce::int64 modified = 0;   ///< Modification time when last scanned (ms).
+        juce::int64 added = 0;      ///< When the track first entered the library (ms).
+        TrackMetadata analysis;     ///< Analysis results; analysis.ready is false until analysed.
+        bool removed = true;        ///< True once the file has gone (or for an unused ID).
+    };
+
+    /**
+     * @brief Constructor for TrackLibrary.
+     *
+     * Opens the library file, compacting it if it is mostly out of date, and
+     * prints how long that took. The scanner waits for startScanning().
+     *
+     * @param formatManager Format manager deciding which files are audio files.
+     * @param libraryFile The library file, or a default in the user's application data.
+     */
+    explicit TrackLibrary(juce::AudioFormatManager& formatManager, const juce::File& libraryFile = {});
+
+    /**
+     * @brief Destructor for TrackLibrary.
+     *
+     * Stops the scanner and compacts the library file if it is mostly out of date.
+     */
+    ~TrackLibrary() override;
+
+    /**
+     * @brief Starts the scanner and rescans the watched folders.
+     *
+     * Call once the format manager has its formats registered; folders added
+     * before this are scanned when it is called.
+     */
+    void startScanning();
+
+    /**
+     * @brief Adds a folder to watch, scanning it and its subfolders.
+     * @param folder The folder.
+     */
+    void addFolder(const juce::File& folder);
+
+    /**
+     * @brief Gets the watched folders.
+     * @return The folders passed to addFolder().
+     */
+    const juce::StringArray& getFolders() const { return roots; }
+
+    /**
+     * @brief Imports any mix of files and folders.
+     *
+     * Folders are added as watched folders and scanned recursively. Files
+     * are checked and added on the scanner thread, so a drop of thousands
+     * of files never blocks the message thread; tracks appear in batches
+     * through change messages. Files that are not audio files are skipped.
+     *
+     * @param paths Full paths of the files and folders.
+     */
+    void import(const juce::StringArray& paths);
+
+    /**
+     * @brief Gets the IDs of all tracks that are still present, in the order they were added.
+     * @return The track IDs.
+     */
+    std::vector<int> getTrackIds() const;
+
+    /**
+     * @brief Gets a track by ID.
+     * @param id A track ID.
+     * @return The track; an unknown ID gives a removed, empty track.
+     */
+    const Track& getTrack(int id) const;
+
+    /**
+     * @brief Looks up a track by file.
+     * @param file The audio file.
+     * @return The track's ID, or -1 if it is not in the library.
+     */
+    int findTrack(const juce::File& file) const;
+
+    /**
+     * @brief Stores analysis results for a track.
+     *
+     * Nothing is written if the results have not changed.
+     *
+     * @param id The track's ID.
+     * @param analysis The results.
+     */
+    void setAnalysis(int id, const TrackMetadata& analysis);
+
+    /**
+     * @brief Gets the names of all crates.
+     * @return The crate names, sorted.
+     */
+    juce::StringArray getCrateNames() const;
+
+    /**
+     * @brief Gets the tracks in a crate.
+     * @param crate The crate's name.
+     * @return The track IDs, in the order they were added.
+     */
+    std::vector<int> getCrate(const juce::String& crate) const;
+
+    /**
+     * @brief Adds a track to a crate, creating the crate if needed.
+     * @param crate The crate's name.
+     * @param id The track's ID.
+     */
+    void addToCrate(const juce::String& crate, int id);
+
+    /**
+     * @brief Removes a track from a crate.
+     * @param crate The crate's name.
+     * @param id The track's ID.
+     */
+    void removeFromCrate(const juce::String& crate, int id);
+
+    /**
+     * @brief Measures how long a large library takes to open and prints the result.
+     *
+     * Writes a synthetic library of analysed tracks to a temporary file, then
+     * opens it a few times and reports the best time.
+     *
+     * @param numTracks Number of tracks in the synthetic library.
+     */
+    static void runBenchmark(int numTracks);
+
+private:
+    /** Kinds of record in the library file. */
+    enum RecordType : juce::uint8
+    {
+        trackRecord = 1,        ///< A track was found or changed.
+        trackRemovedRecord,     ///< A track's file has gone.
+        analysisRecord,         ///< A track's analysis results.
+        folderRecord,           ///< A folder was scanned.
+        folderRemovedRecord,    ///< A folder has gone.
+        rootRecord,             ///< A folder was added to the watch list.
+        crateAddRecord,         ///< A track was added to a crate.
+        crateRemoveRecord       ///< A track was removed from a crate.
+    };
+
+    /**
+     * @brief A scanned folder.
+     */
+    struct Folder {
+        juce::int64 modified = 0;      ///< Modification time when last listed (ms).
+        juce::StringArray subfolders;  ///< Full paths of its subfolders.
+    };
+
+    /**
+     * @brief A change found by the scanner, waiting for the message thread.
+     */
+    struct Change {
+        RecordType type = trackRecord;  ///< trackRecord, trackRemovedRecord, folderRecord or folderRemovedRecord.
+        juce::String path;              ///< The file or folder.
+        juce::int64 size = 0;           ///< File size, for tracks.
+        juce::int64 modified = 0;       ///< Modification time (ms).
+        juce::StringArray subfolders;   ///< Subfolders, for folders.
+    };
+
+    /**
+     * @brief Scanner thread: scans queued folders and imported files, then waits for changes.
+     */
+    void run() override;
+
+    /**
+     * @brief Scans a folder and, recursively, its subfolders.
+     * @param folder The folder.
+     * @param changes Receives what has changed.
+     * @param force True to list the folder even if its time has not changed.
+     * @param visited Canonical paths of the folders scanned so far in this pass.
+     */
+    void scanFolder(const juce::File& folder, std::vector<Change>& changes, bool force,
+                    std::unordered_set<juce::String>& visited);
+
+    /**
+     * @brief Hands changes to the message thread.
+     * @param changes The changes; emptied.
+     */
+    void postChanges(std::vector<Change>& changes);
+
+    /**
+     * @brief Applies the scanner's changes on the message thread.
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * @brief Replays the library file into the indexes.
+     */
+    void load();
+
+    /**
+     * @brief Applies one record to the indexes.
+     * @param type Kind of record.
+     * @param input The record's payload.
+     */
+    void apply(RecordType type, juce::InputStream& input);
+
+    /**
+     * @brief Applies a record to the indexes and appends it to the library file.
+     * @param type Kind of record.
+     * @param payload The record's payload.
+     */
+    void append(RecordType type, const juce::MemoryBlock& payload);
+
+    /**
+     * @brief Records that a file was found or changed.
+     * @param path Full path of the file.
+     * @param size File size.
+     * @param modified Modification time (ms).
+     * @return The track's ID.
+     */
+    int putTrack(const juce::String& path, juce::int64 size, juce::int64 modified);
+
+    /**
+     * @brief Marks a track and its file as gone.
+     * @param id The track's ID.
+     */
+    void removeTrack(int id);
+
+    /**
+     * @brief Checks whether most of the library file is out of date.
+     * @return True once compacting would at least halve the file.
+     */
+    bool isMostlyStale() const;
+
+    /**
+     * @brief Writes every live record to a fresh library file.
+     */
+    void compact();
+
+    /**
+     * @brief Queues a folder for the scanner.
+     * @param path Full path of the folder, or empty just to wake the scanner.
+     */
+    void queueScan(const juce::String& path);
+
+    juce::AudioFormatManager& formatManager;                   ///< Decides which files are audio files.
+    juce::File file;                                           ///< The library file.
+    std::unique_ptr<juce::FileOutputStream> log;               ///< Appends to the library file.
+    int numRecords = 0;                                        ///< Records in the library file.
+
+    juce::CriticalSection lock;                                ///< Guards the indexes against the scanner.
+    std::vector<Track> tracks;                                 ///< Tracks by ID.
+    std::unordered_map<juce::String, int> trackIds;            ///< Track ID by full path.
+    std::unordered_map<juce::String, std::vector<int>> tracksInFolder; ///< Track IDs by parent folder path.
+    std::unordered_map<juce::String, Folder> folders;          ///< Scanned folders by full path.
+    std::map<juce::String, std::vector<int>> crates;           ///< Track IDs by crate name.
+    juce::StringArray roots;                                   ///< Watched folders.
+
+    juce::CriticalSection queueLock;                           ///< Guards pendingScans, pendingFiles, pendingChanges and audioExtensions.
+    juce::StringArray pendingScans;                            ///< Folders waiting to be scanned.
+    juce::StringArray pendingFiles;                            ///< Imported files waiting to be checked.
+    std::vector<Change> pendingChanges;                        ///< Changes waiting for the message thread.
+    juce::String audioExtensions;                              ///< Extensions of audio files, e.g. ".wav;.mp3".
+
+   #if JUCE_LINUX
+    int inotifyHandle = -1;                                    ///< inotify instance watching the folders.
+    std::unordered_map<int, juce::String> watches;             ///< Watched folder by watch descriptor (scanner thread only).
+    std::unordered_set<juce::String> watchedFolders;           ///< Folders with a watch (scanner thread only).
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLibrary)
+};
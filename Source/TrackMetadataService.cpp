@@ -0,0 +1,501 @@
+/**
+ * =================================================================
+ * @file TrackMetadataService.cpp
+ * @brief Implementation of the TrackMetadataService class.
+ *
+ * Created: 18 Oct 2026 9:14:33pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "TrackMetadataService.h"
+
+namespace
+{
+    /**
+     * @brief Decodes the text of an ID3 text frame.
+     * @param data Frame body, starting with the encoding byte.
+     * @param size Size of the frame body.
+     * @return The text, trimmed.
+     */
+    juce::String decodeId3Text(const juce::uint8* data, int size)
+    {
+        if (size < 2)
+            return {};
+
+        const int encoding = data[0];
+        ++data;
+        --size;
+
+        juce::String text;
+
+        if (encoding == 3)
+        {
+            text = juce::String::fromUTF8(reinterpret_cast<const char*>(data), size);
+        }
+        else if (encoding == 1 || encoding == 2)
+        {
+            // UTF-16, with a byte order mark for encoding 1 and big endian for 2.
+            bool bigEndian = encoding == 2;
+
+            if (encoding == 1 && size >= 2)
+            {
+                bigEndian = data[0] == 0xfe && data[1] == 0xff;
+                data += 2;
+                size -= 2;
+            }
+
+            for (int i = 0; i + 1 < size; i += 2)
+            {
+                const auto unit = (juce::juce_wchar) (bigEndian ? (data[i] << 8) | data[i + 1]
+                                                                : (data[i + 1] << 8) | data[i]);
+                if (unit == 0)
+                    break;
+
+                text += juce::String::charToString(unit);
+            }
+        }
+        else
+        {
+            // ISO-8859-1 maps directly onto the first 256 code points.
+            for (int i = 0; i < size && data[i] != 0; ++i)
+                text += juce::String::charToString((juce::juce_wchar) data[i]);
+        }
+
+        return text.trim();
+    }
+
+    /**
+     * @brief Reads a 28-bit "syncsafe" integer used by ID3v2 sizes.
+     * @param bytes Four bytes, seven bits each.
+     * @return The value.
+     */
+    int readSyncsafe(const juce::uint8* bytes)
+    {
+        return ((bytes[0] & 0x7f) << 21) | ((bytes[1] & 0x7f) << 14) | ((bytes[2] & 0x7f) << 7) | (bytes[3] & 0x7f);
+    }
+
+    /**
+     * @brief Undoes ID3v2 unsynchronisation, which stores a zero after every 0xff byte.
+     * @param data The stored bytes.
+     * @param size Number of stored bytes.
+     * @return The original bytes.
+     */
+    juce::MemoryBlock resynchronise(const juce::uint8* data, int size)
+    {
+        juce::MemoryBlock result ((size_t) size);
+        auto* bytes = static_cast<juce::uint8*>(result.getData());
+        int length = 0;
+
+        for (int i = 0; i < size; ++i)
+        {
+            bytes[length++] = data[i];
+
+            if (data[i] == 0xff && i + 1 < size && data[i + 1] == 0x00)
+                ++i;
+        }
+
+        result.setSize((size_t) length);
+        return result;
+    }
+
+    /**
+     * @brief Fills in tags from an ID3v2 tag at the start of a file.
+     *
+     * Handles versions 2.2, 2.3 and 2.4 and the title, artist, album, tempo
+     * and key frames. Other frames are skipped. Unsynchronisation is undone
+     * over the whole tag for 2.2 and 2.3, and per frame for 2.4, whose frame
+     * sizes count the stored bytes. Sizes that point outside the tag end the
+     * read.
+     *
+     * @param input Stream positioned at the start of the file.
+     * @param metadata Receives the tags that were found.
+     */
+    void readId3v2(juce::InputStream& input, TrackMetadata& metadata)
+    {
+        juce::uint8 header[10];
+
+        if (input.read(header, 10) != 10 || std::memcmp(header, "ID3", 3) != 0)
+            return;
+
+        const int version = header[3];
+        const int tagSize = juce::jmin(readSyncsafe(header + 6), 1 << 20);
+        juce::MemoryBlock block;
+
+        if (input.readIntoMemoryBlock(block, tagSize) != (size_t) tagSize)
+            return;
+
+        const bool unsynchronised = (header[5] & 0x80) != 0;
+
+        if (unsynchronised && version < 4)
+            block = resynchronise(static_cast<const juce::uint8*>(block.getData()), tagSize);
+
+        const auto* tag = static_cast<const juce::uint8*>(block.getData());
+        const int tagLength = (int) block.getSize();
+        int position = 0;
+
+        if ((header[5] & 0x40) != 0)
+        {
+            if (tagLength < 4)
+                return;
+
+            // Read unsigned and checked before use, so a corrupt size cannot index outside the tag.
+            const auto extendedSize = version == 4 ? (juce::uint64) readSyncsafe(tag)
+                                                   : (juce::uint64) juce::ByteOrder::bigEndianInt(tag) + 4;
+
+            if (extendedSize > (juce::uint64) tagLength)
+                return;
+
+            position = (int) extendedSize;
+        }
+
+        const int idLength = version == 2 ? 3 : 4;
+        const int frameHeaderSize = version == 2 ? 6 : 10;
+
+        while (position + frameHeaderSize <= tagLength && tag[position] != 0)
+        {
+            const juce::String id (reinterpret_cast<const char*>(tag + position), (size_t) idLength);
+            const auto* sizeBytes = tag + position + idLength;
+            const auto frameSize = version == 2 ? (juce::uint32) ((sizeBytes[0] << 16) | (sizeBytes[1] << 8) | sizeBytes[2])
+                                 : version == 4 ? (juce::uint32) readSyncsafe(sizeBytes)
+                                                : juce::ByteOrder::bigEndianInt(sizeBytes);
+
+            const int body = position + frameHeaderSize;
+
+            if (frameSize == 0 || frameSize > (juce::uint32) (tagLength - body))
+                break;
+
+            const bool wanted = id == "TIT2" || id == "TT2" || id == "TPE1" || id == "TP1" || id == "TALB" || id == "TAL"
+                             || id == "TBPM" || id == "TBP" || id == "TKEY" || id == "TKE";
+
+            if (wanted)
+            {
+                const auto* text = tag + body;
+                int textSize = (int) frameSize;
+                juce::MemoryBlock frame;
+
+                if (version == 4)
+                {
+                    const int formatFlags = tag[position + 9];
+
+                    // Data length indicator: four bytes ahead of the text.
+                    if ((formatFlags & 0x01) != 0)
+                    {
+                        text += 4;
+                        textSize -= 4;
+                    }
+
+                    if (textSize > 0 && (unsynchronised || (formatFlags & 0x02) != 0))
+                    {
+                        frame = resynchronise(text, textSize);
+                        text = static_cast<const juce::uint8*>(frame.getData());
+                        textSize = (int) frame.getSize();
+                    }
+                }
+
+                if (textSize > 0)
+                {
+                    const auto value = decodeId3Text(text, textSize);
+
+                    if (id == "TIT2" || id == "TT2")
+                        metadata.title = value;
+                    else if (id == "TPE1" || id == "TP1")
+                        metadata.artist = value;
+                    else if (id == "TALB" || id == "TAL")
+                        metadata.album = value;
+                    else if (id == "TBPM" || id == "TBP")
+                        metadata.bpm = value.getFloatValue();
+                    else
+                        metadata.key = value;
+                }
+            }
+
+            position = body + (int) frameSize;
+        }
+    }
+
+    /**
+     * @brief Fills in missing tags from an ID3v1 tag at the end of a file.
+     * @param input Stream over the file.
+     * @param metadata Receives the tags that were found.
+     */
+    void readId3v1(juce::InputStream& input, TrackMetadata& metadata)
+    {
+        const juce::int64 length = input.getTotalLength();
+        juce::uint8 tag[128];
+
+        if (length < 128 || ! input.setPosition(length - 128) || input.read(tag, 128) != 128
+            || std::memcmp(tag, "TAG", 3) != 0)
+            return;
+
+        auto field = [&tag](int offset) {
+            juce::String text;
+
+            for (int i = offset; i < offset + 30 && tag[i] != 0; ++i)
+                text += juce::String::charToString((juce::juce_wchar) tag[i]);
+
+            return text.trim();
+        };
+
+        if (metadata.title.isEmpty())  metadata.title = field(3);
+        if (metadata.artist.isEmpty()) metadata.artist = field(33);
+        if (metadata.album.isEmpty())  metadata.album = field(63);
+    }
+}
+
+/**
+ * @brief Writes the values (not the ready flag) to a stream.
+ * @param output The stream to write to.
+ */
+void TrackMetadata::writeTo(juce::OutputStream& output) const
+{
+    output.writeDouble(durationSeconds);
+    output.writeDouble(sampleRate);
+    output.writeInt(numChannels);
+    output.writeInt(bitrateKbps);
+    output.writeString(title);
+    output.writeString(artist);
+    output.writeString(album);
+    output.writeString(key);
+    output.writeFloat(bpm);
+}
+
+/**
+ * @brief Reads values written by writeTo().
+ * @param input The stream to read from.
+ * @return The metadata, marked ready.
+ */
+TrackMetadata TrackMetadata::readFrom(juce::InputStream& input)
+{
+    TrackMetadata metadata;
+    metadata.ready = true;
+    metadata.durationSeconds = input.readDouble();
+    metadata.sampleRate = input.readDouble();
+    metadata.numChannels = input.readInt();
+    metadata.bitrateKbps = input.readInt();
+    metadata.title = input.readString();
+    metadata.artist = input.readString();
+    metadata.album = input.readString();
+    metadata.key = input.readString();
+    metadata.bpm = input.readFloat();
+    return metadata;
+}
+
+/**
+ * @class TrackMetadataService::ScanJob
+ * @brief Thread pool job that scans one file.
+ */
+class TrackMetadataService::ScanJob : public juce::ThreadPoolJob
+{
+public:
+    /**
+     * @brief Constructor for ScanJob.
+     * @param ownerService The service to report to.
+     * @param trackId ID of the track.
+     * @param fileToScan The file to scan.
+     */
+    ScanJob(TrackMetadataService& ownerService, int trackId, const juce::File& fileToScan)
+        : juce::ThreadPoolJob("Metadata " + fileToScan.getFileName()),
+          owner(ownerService), id(trackId), file(fileToScan)
+    {
+    }
+
+    /**
+     * @brief Scans the file and queues the result for the message thread.
+     * @return Always jobHasFinished.
+     */
+    JobStatus runJob() override
+    {
+        Result result;
+        result.id = id;
+        result.path = file.getFullPathName();
+        result.metadata = owner.readMetadata(file, file.getSize());
+
+        {
+            const juce::ScopedLock sl (owner.resultLock);
+            owner.results.push_back(std::move(result));
+        }
+
+        owner.triggerAsyncUpdate();
+        return jobHasFinished;
+    }
+
+private:
+    TrackMetadataService& owner;  ///< The service to report to.
+    int id;                       ///< ID of the track.
+    juce::File file;              ///< The file to scan.
+};
+
+/**
+ * @brief Constructor for TrackMetadataService.
+ * @param formatManagerToUse Format manager used to open files for scanning.
+ */
+TrackMetadataService::TrackMetadataService(juce::AudioFormatManager& formatManagerToUse)
+    : formatManager(formatManagerToUse)
+{
+}
+
+/**
+ * @brief Destructor for TrackMetadataService.
+ */
+TrackMetadataService::~TrackMetadataService()
+{
+    pool.removeAllJobs(true, 5000);
+    cancelPendingUpdate();
+    onScanned = nullptr;
+    handleAsyncUpdate();
+}
+
+/**
+ * @brief Gets the ID of a file's metadata, queueing a scan on first request.
+ * @param file The audio file.
+ * @return The ID to pass to getMetadata().
+ */
+int TrackMetadataService::request(const juce::File& file)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    const auto path = file.getFullPathName();
+    auto found = ids.find(path);
+
+    if (found != ids.end())
+        return found->second;
+
+    const int id = (int) table.size();
+    table.emplace_back();
+    ids.emplace(path, id);
+
+    if (findStored != nullptr && findStored(file, table.back()) && table.back().ready)
+        return id;
+
+    table.back() = {};
+    ++numPending;
+    pool.addJob(new ScanJob(*this, id, file), true);
+    return id;
+}
+
+/**
+ * @brief Gets the IDs whose scans arrived after a position, in the order they arrived.
+ * @param position A value getNumFinished() returned earlier.
+ * @param ids Receives the IDs.
+ * @return False if some of the IDs are no longer kept.
+ */
+bool TrackMetadataService::getFinishedSince(size_t position, std::vector<int>& ids) const
+{
+    ids.clear();
+
+    if (position < numForgotten)
+        return false;
+
+    ids.assign(finishedIds.begin() + (std::ptrdiff_t) juce::jmin(position - numForgotten, finishedIds.size()), finishedIds.end());
+    return true;
+}
+
+/**
+ * @brief Scans a file again, e.g. once it has changed on disk.
+ * @param file The audio file.
+ */
+void TrackMetadataService::rescan(const juce::File& file)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto found = ids.find(file.getFullPathName());
+
+    if (found == ids.end())
+        return;
+
+    table[(size_t) found->second] = {};
+    ++numPending;
+    pool.addJob(new ScanJob(*this, found->second, file), true);
+}
+
+/**
+ * @brief Gets the metadata for an ID.
+ * @param id An ID returned by request().
+ * @return The metadata, or an empty record if the ID is unknown.
+ */
+const TrackMetadata& TrackMetadataService::getMetadata(int id) const
+{
+    static const TrackMetadata empty;
+
+    if (id < 0 || id >= (int) table.size())
+        return empty;
+
+    return table[(size_t) id];
+}
+
+/**
+ * @brief Reads format details and tags from a file.
+ * @param file The file to read.
+ * @param size The file size in bytes.
+ * @return The metadata.
+ */
+TrackMetadata TrackMetadataService::readMetadata(const juce::File& file, juce::int64 size)
+{
+    TrackMetadata metadata;
+    metadata.ready = true;
+
+    if (std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor(file) })
+    {
+        metadata.sampleRate = reader->sampleRate;
+        metadata.numChannels = (int) reader->numChannels;
+
+        if (reader->sampleRate > 0)
+            metadata.durationSeconds = (double) reader->lengthInSamples / reader->sampleRate;
+
+        if (metadata.durationSeconds > 0)
+            metadata.bitrateKbps = juce::roundToInt((double) size * 8.0 / metadata.durationSeconds / 1000.0);
+
+        // Formats with their own metadata (e.g. WAV INFO chunks) fill gaps the ID3 tags leave.
+        metadata.title = reader->metadataValues.getValue("title", {});
+        metadata.artist = reader->metadataValues.getValue("artist", {});
+    }
+
+    juce::FileInputStream input (file);
+
+    if (input.openedOk())
+    {
+        readId3v2(input, metadata);
+        readId3v1(input, metadata);
+    }
+
+    if (metadata.title.isEmpty())
+        metadata.title = file.getFileNameWithoutExtension();
+
+    return metadata;
+}
+
+/**
+ * @brief Applies finished scans on the message thread.
+ *
+ * Every result is passed to onScanned and one change message covers them
+ * all.
+ */
+void TrackMetadataService::handleAsyncUpdate()
+{
+    std::vector<Result> finished;
+
+    {
+        const juce::ScopedLock sl (resultLock);
+        finished.swap(results);
+    }
+
+    if (finished.empty())
+        return;
+
+    for (const auto& result : finished)
+    {
+        table[(size_t) result.id] = result.metadata;
+        finishedIds.push_back(result.id);
+        --numPending;
+    }
+
+    for (; finishedIds.size() > maxFinishedHistory; ++numForgotten)
+        finishedIds.pop_front();
+
+    if (onScanned != nullptr)
+        for (const auto& result : finished)
+            onScanned(juce::File(result.path), result.metadata);
+
+    sendChangeMessage();
+}
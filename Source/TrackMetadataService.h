@@ -0,0 +1,183 @@
+/**
+ * =================================================================
+ * @file TrackMetadataService.h
+ * @brief Declaration of the TrackMetadata structure and TrackMetadataService class.
+ *
+ * This file declares the background scanner that works out each track's
+ * length, format details and tags, so the playlist never opens audio files
+ * while painting.
+ *
+ * Created: 18 Oct 2026 9:14:33pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+
+/**
+ * @brief Format details and tags of one audio file.
+ */
+struct TrackMetadata {
+    bool ready = false;            /**< True once the file has been scanned. */
+    double durationSeconds = 0.0;  /**< Length of the track. */
+    double sampleRate = 0.0;       /**< Sample rate of the file. */
+    int numChannels = 0;           /**< Number of channels. */
+    int bitrateKbps = 0;           /**< Average bitrate, from the file size and length. */
+    juce::String title;            /**< Title tag, or the file name when untagged. */
+    juce::String artist;           /**< Artist tag. */
+    juce::String album;            /**< Album tag. */
+    juce::String key;              /**< Musical key tag (e.g. "8A" or "Am"). */
+    float bpm = 0.0f;              /**< Tempo tag, 0 when unknown. */
+
+    /**
+     * @brief Writes the values (not the ready flag) to a stream.
+     * @param output The stream to write to.
+     */
+    void writeTo(juce::OutputStream& output) const;
+
+    /**
+     * @brief Reads values written by writeTo().
+     * @param input The stream to read from.
+     * @return The metadata, marked ready.
+     */
+    static TrackMetadata readFrom(juce::InputStream& input);
+};
+
+/**
+ * @class TrackMetadataService
+ * @brief Scans tracks on a background pool and serves their metadata.
+ *
+ * request() hands back a small integer ID straight away; getMetadata() is a
+ * plain vector lookup by that ID, so it is safe to call from paint code.
+ * Results are applied on the message thread and announced with a change
+ * message. The service keeps nothing between runs: results are handed to
+ * onScanned for the track library to store, and findStored lets request()
+ * take a stored result instead of opening the file again.
+ */
+class TrackMetadataService : public juce::ChangeBroadcaster,
+                             private juce::AsyncUpdater
+{
+public:
+    /**
+     * @brief Constructor for TrackMetadataService.
+     * @param formatManager Format manager used to open files for scanning.
+     */
+    explicit TrackMetadataService(juce::AudioFormatManager& formatManager);
+
+    /**
+     * @brief Destructor for TrackMetadataService.
+     *
+     * Stops the scanners.
+     */
+    ~TrackMetadataService() override;
+
+    /**
+     * @brief Gets the ID of a file's metadata, queueing a scan on first request.
+     *
+     * Call from the message thread. A result findStored supplies is ready
+     * straight away and queues no scan.
+     *
+     * @param file The audio file.
+     * @return The ID to pass to getMetadata().
+     */
+    int request(const juce::File& file);
+
+    /**
+     * @brief Scans a file again, e.g. once it has changed on disk.
+     *
+     * Call from the message thread. The file's metadata is not ready until
+     * the new scan arrives. Does nothing for a file never requested.
+     *
+     * @param file The audio file.
+     */
+    void rescan(const juce::File& file);
+
+    /**
+     * @brief Gets the metadata for an ID.
+     *
+     * Call from the message thread. Check TrackMetadata::ready before using
+     * the values.
+     *
+     * @param id An ID returned by request().
+     * @return The metadata, or an empty record if the ID is unknown.
+     */
+    const TrackMetadata& getMetadata(int id) const;
+
+    /**
+     * @brief Gets the number of scans that have arrived so far.
+     *
+     * Listeners can keep this as a position and pass it to getFinishedSince()
+     * to see only what is new since the last change message.
+     *
+     * @return The number of finished scans, counting from the start.
+     */
+    size_t getNumFinished() const { return numForgotten + finishedIds.size(); }
+
+    /**
+     * @brief Gets the IDs whose scans arrived after a position, in the order they arrived.
+     *
+     * Only the last maxFinishedHistory IDs are kept, so a listener that falls
+     * further behind than that is told to refresh everything instead.
+     *
+     * @param position A value getNumFinished() returned earlier.
+     * @param ids Receives the IDs.
+     * @return False if some of the IDs are no longer kept.
+     */
+    bool getFinishedSince(size_t position, std::vector<int>& ids) const;
+
+    /**
+     * @brief Gets the number of requested scans that have not arrived yet.
+     * @return The number of pending scans.
+     */
+    int getNumPending() const { return numPending; }
+
+    /** Called on the message thread with each scan result, e.g. to store it elsewhere. */
+    std::function<void(const juce::File&, const TrackMetadata&)> onScanned;
+
+    /** Called on the message thread before a file is scanned; return true with a stored result to skip the scan. */
+    std::function<bool(const juce::File&, TrackMetadata&)> findStored;
+
+private:
+    class ScanJob;
+
+    /**
+     * @brief A finished scan waiting to be applied on the message thread.
+     */
+    struct Result {
+        int id = -1;                ///< ID of the track.
+        juce::String path;          ///< Full path of the file.
+        TrackMetadata metadata;     ///< The scan result.
+    };
+
+    /**
+     * @brief Reads format details and tags from a file.
+     * @param file The file to read.
+     * @param size The file size in bytes.
+     * @return The metadata.
+     */
+    TrackMetadata readMetadata(const juce::File& file, juce::int64 size);
+
+    /**
+     * @brief Applies finished scans on the message thread.
+     */
+    void handleAsyncUpdate() override;
+
+    juce::AudioFormatManager& formatManager;           ///< Opens files for scanning.
+
+    std::vector<TrackMetadata> table;                  ///< Metadata by ID.
+    std::unordered_map<juce::String, int> ids;         ///< ID by full path.
+    std::deque<int> finishedIds;                       ///< The latest IDs in the order their scans arrived.
+    size_t numForgotten = 0;                           ///< Finished IDs dropped from the front of finishedIds.
+    static constexpr size_t maxFinishedHistory = 65536;///< Finished IDs kept for listeners.
+    int numPending = 0;                                ///< Scans queued whose results have not arrived.
+
+    juce::CriticalSection resultLock;                  ///< Guards results.
+    std::vector<Result> results;                       ///< Scans waiting for the message thread.
+
+    /** Runs the scans; bulk imports are disk- and decode-bound, so use most cores but leave one for audio. */
+    juce::ThreadPool pool { juce::jlimit(2, 8, juce::SystemStats::getNumCpus() - 1) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackMetadataService)
+};
@@ -0,0 +1,600 @@
+/**
+ * =================================================================
+ * @file TrackSearchIndex.cpp
+ * @brief Implementation of the TrackSearchIndex class.
+ *
+ * Created: 18 Oct 2026 10:41:19pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "TrackSearchIndex.h"
+
+namespace
+{
+    /** Bits per character in a posting key; enough for any Unicode code point. */
+    constexpr int bitsPerChar = 21;
+
+    /** Set in the keys of word prefixes, which trigram keys never use. */
+    constexpr juce::uint64 prefixFlag = (juce::uint64) 1 << 63;
+
+    /** Rebuilds never run for fewer stale entries than this. */
+    constexpr int minStaleForRebuild = 1024;
+
+    /** Time a query should stay under, in milliseconds. */
+    constexpr double queryTargetMs = 1.0;
+
+    /**
+     * @brief Packs a character into a posting key slot.
+     * @param c The character.
+     * @return The character's bits.
+     */
+    juce::uint64 packChar(juce::juce_wchar c)
+    {
+        return (juce::uint64) c & (((juce::uint64) 1 << bitsPerChar) - 1);
+    }
+
+    /**
+     * @brief Calls a function with the prefix and trigram keys of a word.
+     * @param word A normalised word.
+     * @param callback Called with each key.
+     */
+    template <typename Callback>
+    void forEachKey(const juce::String& word, Callback&& callback)
+    {
+        const int length = word.length();
+
+        if (length >= 1)
+            callback(prefixFlag | (packChar(word[0]) << bitsPerChar));
+
+        if (length >= 2)
+            callback(prefixFlag | (packChar(word[0]) << bitsPerChar) | packChar(word[1]));
+
+        for (int i = 0; i + 2 < length; ++i)
+            callback((packChar(word[i]) << (2 * bitsPerChar)) | (packChar(word[i + 1]) << bitsPerChar) | packChar(word[i + 2]));
+    }
+}
+
+/**
+ * @brief Adds a track or replaces its values.
+ * @param id The track's ID.
+ * @param metadata The values to index.
+ */
+void TrackSearchIndex::update(int id, const TrackMetadata& metadata)
+{
+    if (id < 0)
+        return;
+
+    Document document;
+    document.text = " " + normalise(metadata.title + " " + metadata.artist + " " + metadata.album + " " + metadata.key);
+    document.key = normalise(metadata.key).trim();
+    document.bpm = metadata.bpm;
+    document.durationSeconds = metadata.durationSeconds;
+    document.live = true;
+
+    if (id >= (int) documents.size())
+        documents.resize((size_t) id + 1);
+
+    auto& current = documents[(size_t) id];
+
+    if (current.live)
+    {
+        if (current.text == document.text && current.bpm == document.bpm
+            && current.durationSeconds == document.durationSeconds)
+            return;
+
+        document.changed = true;
+        ++numStale;
+    }
+    else
+    {
+        // A revived ID may still have postings from before it was removed.
+        document.changed = current.changed;
+        ++numLive;
+        liveIdsValid = false;
+    }
+
+    current = std::move(document);
+    addPostings(id, current);
+
+    if (numStale > numLive && numStale > minStaleForRebuild)
+        rebuild();
+}
+
+/**
+ * @brief Removes a track.
+ *
+ * Its postings stay until the next rebuild, so the tombstone is marked
+ * changed; if the ID comes back before then, its postings are not trusted.
+ *
+ * @param id The track's ID.
+ */
+void TrackSearchIndex::remove(int id)
+{
+    if (! contains(id))
+        return;
+
+    documents[(size_t) id] = {};
+    documents[(size_t) id].changed = true;
+    --numLive;
+    ++numStale;
+    liveIdsValid = false;
+}
+
+/**
+ * @brief Checks whether a track is in the index.
+ * @param id The track's ID.
+ * @return True if the track has been added and not removed.
+ */
+bool TrackSearchIndex::contains(int id) const
+{
+    return id >= 0 && id < (int) documents.size() && documents[(size_t) id].live;
+}
+
+/**
+ * @brief Finds the tracks matching a query.
+ *
+ * The shortest posting lists are intersected first, so a rare word narrows
+ * the candidates before the common ones are touched. Range indexes are only
+ * used when there are no words or key; otherwise the candidates are checked
+ * directly. An empty query copies the list of live IDs without checking
+ * them.
+ *
+ * @param query The query; an empty query matches every track.
+ * @return The matching IDs, in ascending order.
+ */
+std::vector<int> TrackSearchIndex::search(const juce::String& query)
+{
+    juce::StringArray words;
+    juce::String key;
+    Range bpmRange, durationRange;
+    bool hasBpm = false, hasDuration = false;
+
+    for (const auto& token : juce::StringArray::fromTokens(query.toLowerCase(), false))
+    {
+        // Unfinished filters such as "bpm:" are ignored rather than matching nothing.
+        if (token.startsWith("bpm:"))
+            hasBpm = parseRange(token.substring(4), false, bpmRange) || hasBpm;
+        else if (token.startsWith("time:"))
+            hasDuration = parseRange(token.substring(5), true, durationRange) || hasDuration;
+        else if (token.startsWith("key:"))
+            key = normalise(token.substring(4)).trim();
+        else
+            words.addTokens(normalise(token), " ", "");
+    }
+
+    words.removeEmptyStrings();
+
+    if (words.isEmpty() && key.isEmpty() && ! hasBpm && ! hasDuration)
+    {
+        if (! liveIdsValid)
+        {
+            liveIds.clear();
+            liveIds.reserve((size_t) numLive);
+
+            for (size_t id = 0; id < documents.size(); ++id)
+                if (documents[id].live)
+                    liveIds.push_back((int) id);
+
+            liveIdsValid = true;
+        }
+
+        return liveIds;
+    }
+
+    std::vector<const std::vector<int>*> lists;
+
+    if (key.isNotEmpty())
+    {
+        const auto* posting = getKeyPosting(key);
+
+        if (posting == nullptr)
+            return {};
+
+        lists.push_back(posting);
+    }
+
+    for (const auto& word : words)
+    {
+        for (auto postingKey : getKeysFor(word))
+        {
+            const auto* posting = getPosting(postingKey);
+
+            if (posting == nullptr)
+                return {};
+
+            lists.push_back(posting);
+        }
+    }
+
+    std::vector<int> candidates;
+
+    if (! lists.empty())
+    {
+        std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        candidates = *lists.front();
+        std::vector<int> intersection;
+
+        for (size_t i = 1; i < lists.size() && ! candidates.empty(); ++i)
+        {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+    else if (hasBpm)
+    {
+        candidates = getRange(bpmIndex, bpmRange);
+    }
+    else
+    {
+        candidates = getRange(durationIndex, durationRange);
+    }
+
+    // Drop removed tracks and values outside the ranges. The postings are exact for the key and for
+    // words of up to three characters, so the text is only checked for longer words, which share
+    // trigrams without containing the word, and for tracks changed since their older postings.
+    auto matches = [&](int id) {
+        const auto& document = documents[(size_t) id];
+
+        if (! document.live)
+            return false;
+
+        if (hasBpm && (document.bpm < bpmRange.low || document.bpm > bpmRange.high))
+            return false;
+
+        if (hasDuration && (document.durationSeconds < durationRange.low || document.durationSeconds > durationRange.high))
+            return false;
+
+        if (document.changed && key.isNotEmpty() && document.key != key)
+            return false;
+
+        for (const auto& word : words)
+            if ((document.changed || word.length() > 3) && ! document.text.contains(word.length() >= 3 ? word : " " + word))
+                return false;
+
+        return true;
+    };
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int id) { return ! matches(id); }),
+                     candidates.end());
+    return candidates;
+}
+
+/**
+ * @brief Lowercases text and replaces punctuation with spaces.
+ *
+ * '#' is kept so keys such as "F#m" survive.
+ *
+ * @param text The text.
+ * @return The normalised text.
+ */
+juce::String TrackSearchIndex::normalise(const juce::String& text)
+{
+    juce::String result;
+    result.preallocateBytes(text.getNumBytesAsUTF8() + 1);
+    bool lastWasSpace = false;
+
+    for (auto c : text)
+    {
+        const bool keep = juce::CharacterFunctions::isLetterOrDigit(c) || c == '#';
+
+        if (keep)
+            result += juce::String::charToString(juce::CharacterFunctions::toLowerCase(c));
+        else if (! lastWasSpace)
+            result += " ";
+
+        lastWasSpace = ! keep;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Gets the posting keys a query word needs.
+ * @param word A normalised word.
+ * @return Trigram keys, or a single prefix key for words under three characters.
+ */
+std::vector<juce::uint64> TrackSearchIndex::getKeysFor(const juce::String& word)
+{
+    std::vector<juce::uint64> keys;
+    const bool useTrigrams = word.length() >= 3;
+
+    // Short words use their prefix key; longer ones use only their trigrams.
+    forEachKey(word, [&](juce::uint64 key) {
+        if (((key & prefixFlag) != 0) != useTrigrams)
+            keys.push_back(key);
+    });
+
+    return keys;
+}
+
+/**
+ * @brief Parses "128", "120-130" or, with times, "3:30-5:00".
+ *
+ * A single value matches within half a unit either side; an open end
+ * ("120-" or "-130") leaves that side unbounded.
+ *
+ * @param text The range text.
+ * @param isTime True to read m:ss values.
+ * @param range Receives the range.
+ * @return True if the text was a valid range.
+ */
+bool TrackSearchIndex::parseRange(const juce::String& text, bool isTime, Range& range)
+{
+    auto parseValue = [isTime](const juce::String& value, double& result) {
+        if (value.isEmpty() || ! value.containsOnly(isTime ? "0123456789.:" : "0123456789."))
+            return false;
+
+        result = isTime && value.contains(":")
+                   ? value.upToFirstOccurrenceOf(":", false, false).getDoubleValue() * 60.0
+                       + value.fromFirstOccurrenceOf(":", false, false).getDoubleValue()
+                   : value.getDoubleValue();
+        return true;
+    };
+
+    if (! text.contains("-"))
+    {
+        double value = 0.0;
+
+        if (! parseValue(text, value))
+            return false;
+
+        range.low = value - 0.5;
+        range.high = value + 0.5;
+        return true;
+    }
+
+    const auto lowText = text.upToFirstOccurrenceOf("-", false, false);
+    const auto highText = text.fromFirstOccurrenceOf("-", false, false);
+    Range parsed;
+
+    if (lowText.isNotEmpty() && ! parseValue(lowText, parsed.low))
+        return false;
+
+    if (highText.isNotEmpty() && ! parseValue(highText, parsed.high))
+        return false;
+
+    if (lowText.isEmpty() && highText.isEmpty())
+        return false;
+
+    range = parsed;
+    return true;
+}
+
+/**
+ * @brief Adds a track's postings.
+ * @param id The track's ID.
+ * @param document The track's values.
+ */
+void TrackSearchIndex::addPostings(int id, const Document& document)
+{
+    for (const auto& word : juce::StringArray::fromTokens(document.text, " ", ""))
+    {
+        if (word.isEmpty())
+            continue;
+
+        forEachKey(word, [&](juce::uint64 key) {
+            auto& posting = postings[key];
+
+            if (! posting.ids.empty())
+            {
+                if (posting.ids.back() == id)
+                    return;
+
+                if (posting.ids.back() > id)
+                    posting.sorted = false;
+            }
+
+            posting.ids.push_back(id);
+        });
+    }
+
+    if (document.key.isNotEmpty())
+    {
+        auto& posting = keyPostings[document.key];
+
+        if (posting.ids.empty() || posting.ids.back() != id)
+        {
+            if (! posting.ids.empty() && posting.ids.back() > id)
+                posting.sorted = false;
+
+            posting.ids.push_back(id);
+        }
+    }
+
+    auto addToRange = [id](RangeIndex& index, double value) {
+        if (! index.entries.empty() && index.entries.back() > std::make_pair(value, id))
+            index.sorted = false;
+
+        index.entries.emplace_back(value, id);
+    };
+
+    if (document.bpm > 0.0f)
+        addToRange(bpmIndex, document.bpm);
+
+    addToRange(durationIndex, document.durationSeconds);
+}
+
+/**
+ * @brief Sorts a posting list if needed and returns its IDs.
+ * @param key The posting key.
+ * @return The sorted IDs, or nullptr if nothing has the key.
+ */
+const std::vector<int>* TrackSearchIndex::getPosting(juce::uint64 key)
+{
+    auto found = postings.find(key);
+
+    if (found == postings.end())
+        return nullptr;
+
+    sortPosting(found->second);
+    return &found->second.ids;
+}
+
+/**
+ * @brief Sorts a key's posting list if needed and returns its IDs.
+ * @param key A normalised key.
+ * @return The sorted IDs, or nullptr if no track has the key.
+ */
+const std::vector<int>* TrackSearchIndex::getKeyPosting(const juce::String& key)
+{
+    auto found = keyPostings.find(key);
+
+    if (found == keyPostings.end())
+        return nullptr;
+
+    sortPosting(found->second);
+    return &found->second.ids;
+}
+
+/**
+ * @brief Sorts a posting list and removes duplicate IDs, if needed.
+ * @param posting The posting list.
+ */
+void TrackSearchIndex::sortPosting(Posting& posting)
+{
+    if (posting.sorted)
+        return;
+
+    std::sort(posting.ids.begin(), posting.ids.end());
+    posting.ids.erase(std::unique(posting.ids.begin(), posting.ids.end()), posting.ids.end());
+    posting.sorted = true;
+}
+
+/**
+ * @brief Gets the IDs with values in a range.
+ * @param index The range index.
+ * @param range The range.
+ * @return The IDs, in ascending order; may include stale IDs.
+ */
+std::vector<int> TrackSearchIndex::getRange(RangeIndex& index, const Range& range)
+{
+    if (! index.sorted)
+    {
+        std::sort(index.entries.begin(), index.entries.end());
+        index.sorted = true;
+    }
+
+    const auto first = std::lower_bound(index.entries.begin(), index.entries.end(),
+                                        std::make_pair(range.low, std::numeric_limits<int>::min()));
+    const auto last = std::upper_bound(first, index.entries.end(),
+                                       std::make_pair(range.high, std::numeric_limits<int>::max()));
+
+    std::vector<int> ids;
+    ids.reserve((size_t) std::distance(first, last));
+
+    for (auto it = first; it != last; ++it)
+        ids.push_back(it->second);
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+/**
+ * @brief Rebuilds every posting and range from the live documents.
+ */
+void TrackSearchIndex::rebuild()
+{
+    postings.clear();
+    keyPostings.clear();
+    bpmIndex = {};
+    durationIndex = {};
+
+    for (size_t id = 0; id < documents.size(); ++id)
+    {
+        documents[id].changed = false;
+
+        if (documents[id].live)
+            addPostings((int) id, documents[id]);
+    }
+
+    numStale = 0;
+}
+
+/**
+ * @brief Measures indexing and per-keystroke query times on a synthetic library and prints the results.
+ *
+ * Each query is timed as typed, one keystroke at a time, and the slowest
+ * keystroke is reported against the one millisecond target.
+ *
+ * @param numTracks Number of tracks to index.
+ */
+void TrackSearchIndex::runBenchmark(int numTracks)
+{
+    const juce::StringArray vocabulary { "deep", "house", "night", "love", "dance", "summer", "dream", "fire", "heart", "city",
+                                         "techno", "soul", "light", "bass", "groove", "sunset", "midnight", "feel", "rhythm", "echo" };
+    const juce::StringArray keys { "1a", "2a", "3a", "4a", "5a", "6a", "7a", "8a", "9a", "10a", "11a", "12a",
+                                   "1b", "2b", "3b", "4b", "5b", "6b", "7b", "8b", "9b", "10b", "11b", "12b" };
+    juce::Random random (42);
+
+    // An ID removed and added back with new values must match only the new ones.
+    {
+        TrackSearchIndex revived;
+        TrackMetadata before, after;
+        before.title = "dub";
+        before.key = "8a";
+        after.title = "fog";
+        after.key = "3b";
+
+        revived.update(7, before);
+        revived.remove(7);
+        revived.update(7, after);
+
+        const bool passed = revived.search("dub").empty() && revived.search("key:8a").empty()
+                         && revived.search("fog") == std::vector<int> { 7 } && revived.search("key:3b") == std::vector<int> { 7 };
+        std::cout << "Search check: revived ID " << (passed ? "matches only its new values" : "FAILED, matched stale postings") << std::endl;
+    }
+
+    TrackSearchIndex index;
+
+    const double buildStartMs = juce::Time::getMillisecondCounterHiRes();
+
+    for (int id = 0; id < numTracks; ++id)
+    {
+        TrackMetadata metadata;
+        metadata.ready = true;
+        metadata.title = vocabulary[random.nextInt(vocabulary.size())] + " " + vocabulary[random.nextInt(vocabulary.size())]
+                       + " " + juce::String(random.nextInt(10000));
+        metadata.artist = "Artist " + juce::String(random.nextInt(5000));
+        metadata.album = vocabulary[random.nextInt(vocabulary.size())] + " " + juce::String(random.nextInt(20000));
+        metadata.key = keys[random.nextInt(keys.size())];
+        metadata.bpm = 80.0f + random.nextFloat() * 80.0f;
+        metadata.durationSeconds = 120.0 + random.nextDouble() * 360.0;
+        index.update(id, metadata);
+    }
+
+    std::cout << "Search benchmark: " << numTracks << " tracks indexed in "
+              << juce::String(juce::Time::getMillisecondCounterHiRes() - buildStartMs, 0) << " ms" << std::endl;
+
+    const juce::StringArray queries { "deep house", "artist 42", "key:8a", "bpm:120-130", "time:3:00-4:00",
+                                      "night key:5b bpm:124", "sunset groove 77", "" };
+
+    for (const auto& query : queries)
+    {
+        double slowestMs = 0.0;
+        size_t numResults = 0;
+
+        // Every prefix, as each keystroke would run it; the best of a few runs of each.
+        for (int length = query.isEmpty() ? 0 : 1; length <= query.length(); ++length)
+        {
+            const auto typed = query.substring(0, length);
+            double bestMs = 0.0;
+
+            for (int run = 0; run < 5; ++run)
+            {
+                const double startMs = juce::Time::getMillisecondCounterHiRes();
+                numResults = index.search(typed).size();
+                const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+                bestMs = run == 0 ? elapsedMs : juce::jmin(bestMs, elapsedMs);
+            }
+
+            slowestMs = juce::jmax(slowestMs, bestMs);
+        }
+
+        std::cout << "  \"" << query << "\": " << numResults << " results, slowest keystroke "
+                  << juce::String(slowestMs, 3) << " ms" << (slowestMs > queryTargetMs ? " (over target)" : "") << std::endl;
+    }
+}
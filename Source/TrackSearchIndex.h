@@ -0,0 +1,188 @@
+/**
+ * =================================================================
+ * @file TrackSearchIndex.h
+ * @brief Declaration of the TrackSearchIndex class.
+ *
+ * This file declares the in-memory index behind the playlist's
+ * type-to-filter search box.
+ *
+ * Created: 18 Oct 2026 10:41:19pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackMetadataService.h"
+
+/**
+ * @class TrackSearchIndex
+ * @brief Trigram and range index over track titles, artists, albums, keys, tempos and lengths.
+ *
+ * Text is lowercased and split into words. Every three-character run is
+ * indexed, as are the first one and two characters of each word, so any
+ * query word maps to a few posting lists to intersect. Keys have a posting
+ * list of their own, and tempo and length are kept in sorted (value, ID)
+ * arrays for range queries.
+ *
+ * Everything is append-only: changing a track adds new postings and leaves
+ * the old ones behind. A posting list is exact for a word of up to three
+ * characters and for a key, so only longer words, and tracks changed since
+ * the last rebuild, are checked against the track's text. The index is
+ * rebuilt once stale entries outnumber live ones. Posting lists are sorted
+ * lazily, the first time a query needs them.
+ *
+ * Queries are words separated by spaces; a track must match all of them.
+ * Besides plain words:
+ * - "bpm:128" or "bpm:120-130" filters by tempo,
+ * - "time:3:30-5:00" (or seconds, "time:210-300") filters by length,
+ * - "key:8a" matches the key exactly.
+ *
+ * Call only from the message thread.
+ */
+class TrackSearchIndex
+{
+public:
+    /**
+     * @brief Adds a track or replaces its values.
+     * @param id The track's ID; IDs should be small and dense.
+     * @param metadata The values to index.
+     */
+    void update(int id, const TrackMetadata& metadata);
+
+    /**
+     * @brief Removes a track.
+     * @param id The track's ID.
+     */
+    void remove(int id);
+
+    /**
+     * @brief Checks whether a track is in the index.
+     * @param id The track's ID.
+     * @return True if the track has been added and not removed.
+     */
+    bool contains(int id) const;
+
+    /**
+     * @brief Finds the tracks matching a query.
+     * @param query The query; an empty query matches every track.
+     * @return The matching IDs, in ascending order.
+     */
+    std::vector<int> search(const juce::String& query);
+
+    /**
+     * @brief Measures indexing and per-keystroke query times on a synthetic library and prints the results.
+     * @param numTracks Number of tracks to index.
+     */
+    static void runBenchmark(int numTracks);
+
+private:
+    /**
+     * @brief A track's current values.
+     */
+    struct Document {
+        juce::String text;              ///< Normalised words, each preceded by a space.
+        juce::String key;               ///< Normalised key.
+        float bpm = 0.0f;               ///< Tempo, 0 when unknown.
+        double durationSeconds = 0.0;   ///< Length.
+        bool live = false;              ///< False for removed or never-added IDs.
+        bool changed = false;           ///< True if it changed since the last rebuild, so older postings name it.
+    };
+
+    /**
+     * @brief Track IDs containing one trigram or word prefix.
+     */
+    struct Posting {
+        std::vector<int> ids;           ///< IDs, possibly unsorted, duplicated or stale.
+        bool sorted = true;             ///< True when ids is sorted and unique.
+    };
+
+    /**
+     * @brief A sorted array of (value, ID) pairs for range queries.
+     */
+    struct RangeIndex {
+        std::vector<std::pair<double, int>> entries;  ///< Pairs, possibly unsorted or stale.
+        bool sorted = true;                           ///< True when entries is sorted.
+    };
+
+    /**
+     * @brief A closed range of values; an unset bound is open.
+     */
+    struct Range {
+        double low = -1.0e300;          ///< Smallest value allowed.
+        double high = 1.0e300;          ///< Largest value allowed.
+    };
+
+    /**
+     * @brief Lowercases text and replaces punctuation with spaces.
+     * @param text The text.
+     * @return The normalised text.
+     */
+    static juce::String normalise(const juce::String& text);
+
+    /**
+     * @brief Gets the posting keys a query word needs.
+     * @param word A normalised word.
+     * @return Trigram keys, or a single prefix key for words under three characters.
+     */
+    static std::vector<juce::uint64> getKeysFor(const juce::String& word);
+
+    /**
+     * @brief Parses "128", "120-130" or, with times, "3:30-5:00".
+     * @param text The range text.
+     * @param isTime True to read m:ss values.
+     * @param range Receives the range.
+     * @return True if the text was a valid range.
+     */
+    static bool parseRange(const juce::String& text, bool isTime, Range& range);
+
+    /**
+     * @brief Adds a track's postings.
+     * @param id The track's ID.
+     * @param document The track's values.
+     */
+    void addPostings(int id, const Document& document);
+
+    /**
+     * @brief Sorts a posting list if needed and returns its IDs.
+     * @param key The posting key.
+     * @return The sorted IDs, or nullptr if nothing has the key.
+     */
+    const std::vector<int>* getPosting(juce::uint64 key);
+
+    /**
+     * @brief Gets the IDs with values in a range.
+     * @param index The range index.
+     * @param range The range.
+     * @return The IDs, in ascending order; may include stale IDs.
+     */
+    static std::vector<int> getRange(RangeIndex& index, const Range& range);
+
+    /**
+     * @brief Rebuilds every posting and range from the live documents.
+     */
+    void rebuild();
+
+    /**
+     * @brief Sorts a key's posting list if needed and returns its IDs.
+     * @param key A normalised key.
+     * @return The sorted IDs, or nullptr if no track has the key.
+     */
+    const std::vector<int>* getKeyPosting(const juce::String& key);
+
+    /**
+     * @brief Sorts a posting list and removes duplicate IDs, if needed.
+     * @param posting The posting list.
+     */
+    static void sortPosting(Posting& posting);
+
+    std::vector<Document> documents;                      ///< Current values by ID.
+    std::unordered_map<juce::uint64, Posting> postings;   ///< IDs by trigram or prefix key.
+    std::unordered_map<juce::String, Posting> keyPostings;///< IDs by normalised key.
+    std::vector<int> liveIds;                             ///< Every live ID, in ascending order, when liveIdsValid.
+    bool liveIdsValid = true;                             ///< False once tracks have been added or removed since liveIds was built.
+    RangeIndex bpmIndex;                                  ///< Tracks by tempo.
+    RangeIndex durationIndex;                             ///< Tracks by length.
+    int numLive = 0;                                      ///< Live documents.
+    int numStale = 0;                                     ///< Updates and removals since the last rebuild.
+};
@@ -0,0 +1,310 @@
+/**
+ * =================================================================
+ * @file TrackSuggestionIndex.cpp
+ * @brief Implementation of the TrackSuggestionIndex class.
+ *
+ * Created: 18 Oct 2026 11:52:06pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "TrackSuggestionIndex.h"
+
+namespace
+{
+    /** Extra cost of a track at half or double the target's tempo. */
+    constexpr float octavePenalty = 0.5f;
+
+    /** Cost of a neighbouring or relative key, against 0 for the same key. */
+    constexpr float neighbourKeyPenalty = 1.0f;
+
+    /**
+     * @brief Gets the Camelot number (1 to 12) of a major key.
+     * @param pitchClass The key's root, 0 for C.
+     * @return The Camelot number.
+     */
+    int camelotNumberOfMajor(int pitchClass)
+    {
+        // Each step round the wheel is a fifth; C major is 8B.
+        return (pitchClass * 7 + 7) % 12 + 1;
+    }
+}
+
+/**
+ * @brief Parses a key as Camelot ("8A"), Open Key ("1m") or musical ("Am", "F# minor", "Bb").
+ * @param key The key text.
+ * @return The Camelot key, or -1 if the text is not a key.
+ */
+int TrackSuggestionIndex::toCamelot(const juce::String& key)
+{
+    const auto text = key.trim().removeCharacters(" ");
+
+    if (text.isEmpty())
+        return -1;
+
+    // Camelot and Open Key notation: a number from 1 to 12 and a letter.
+    if (juce::CharacterFunctions::isDigit(text[0]))
+    {
+        const int number = text.getIntValue();
+        const auto suffix = text.trimCharactersAtStart("0123456789").toLowerCase();
+
+        if (number < 1 || number > 12)
+            return -1;
+
+        if (suffix == "a" || suffix == "b")
+            return (number - 1) * 2 + (suffix == "b" ? 1 : 0);
+
+        // Open Key's 1m and 1d are Camelot's 8A and 8B.
+        if (suffix == "m" || suffix == "d")
+            return ((number + 6) % 12) * 2 + (suffix == "d" ? 1 : 0);
+
+        return -1;
+    }
+
+    static const juce::String letters ("CDEFGAB");
+    static const int roots[] = { 0, 2, 4, 5, 7, 9, 11 };
+    const int letter = letters.indexOfChar(juce::CharacterFunctions::toUpperCase(text[0]));
+
+    if (letter < 0)
+        return -1;
+
+    int pitchClass = roots[letter];
+    auto rest = text.substring(1);
+
+    if (rest.startsWith("#") || rest.startsWith(juce::String::charToString(0x266f)))
+    {
+        ++pitchClass;
+        rest = rest.substring(1);
+    }
+    else if (rest.startsWith("b") || rest.startsWith(juce::String::charToString(0x266d)))
+    {
+        --pitchClass;
+        rest = rest.substring(1);
+    }
+
+    pitchClass = (pitchClass + 12) % 12;
+    rest = rest.toLowerCase();
+
+    if (rest.isEmpty() || rest == "maj" || rest == "major")
+        return (camelotNumberOfMajor(pitchClass) - 1) * 2 + 1;
+
+    // A minor key shares its number with its relative major, three semitones up.
+    if (rest == "m" || rest == "min" || rest == "minor")
+        return (camelotNumberOfMajor((pitchClass + 3) % 12) - 1) * 2;
+
+    return -1;
+}
+
+/**
+ * @brief Formats a Camelot key, e.g. "8A".
+ * @param camelot The Camelot key.
+ * @return The key text, or an empty string for -1.
+ */
+juce::String TrackSuggestionIndex::camelotName(int camelot)
+{
+    if (camelot < 0)
+        return {};
+
+    return juce::String(camelot / 2 + 1) + ((camelot % 2) != 0 ? "B" : "A");
+}
+
+/**
+ * @brief Moves a Camelot key by a number of semitones.
+ *
+ * A semitone up is seven steps round the wheel.
+ *
+ * @param camelot The Camelot key, or -1.
+ * @param semitones Semitones to move up; negative to move down.
+ * @return The transposed key, or -1 for -1.
+ */
+int TrackSuggestionIndex::transpose(int camelot, int semitones)
+{
+    if (camelot < 0)
+        return -1;
+
+    const int number = camelot / 2;
+    const int shifted = ((number + semitones * 7) % 12 + 12) % 12;
+    return shifted * 2 + camelot % 2;
+}
+
+/**
+ * @brief Adds a track or replaces its key and tempo.
+ * @param id The track's ID.
+ * @param metadata The track's metadata.
+ */
+void TrackSuggestionIndex::update(int id, const TrackMetadata& metadata)
+{
+    if (id < 0)
+        return;
+
+    const int camelot = toCamelot(metadata.key);
+    const float bpm = metadata.bpm > 0.0f ? metadata.bpm : 0.0f;
+
+    if (id < (int) entries.size() && entries[(size_t) id].cell >= 0
+        && entries[(size_t) id].camelot == camelot && entries[(size_t) id].bpm == bpm)
+        return;
+
+    remove(id);
+
+    if (id >= (int) entries.size())
+        entries.resize((size_t) id + 1);
+
+    const int bucket = bpm > 0.0f ? juce::jmin(numBuckets - 2, (int) (fold(bpm) - minBpm)) : numBuckets - 1;
+    auto& entry = entries[(size_t) id];
+    auto& cell = cells[(size_t) cellFor(camelot, bucket)];
+
+    entry.cell = cellFor(camelot, bucket);
+    entry.slot = (int) cell.size();
+    entry.bpm = bpm;
+    entry.camelot = camelot;
+    cell.push_back(id);
+}
+
+/**
+ * @brief Removes a track.
+ *
+ * The last ID in the cell takes the removed one's slot, so removal is
+ * constant time.
+ *
+ * @param id The track's ID.
+ */
+void TrackSuggestionIndex::remove(int id)
+{
+    if (id < 0 || id >= (int) entries.size() || entries[(size_t) id].cell < 0)
+        return;
+
+    auto& entry = entries[(size_t) id];
+    auto& cell = cells[(size_t) entry.cell];
+    const int moved = cell.back();
+
+    cell[(size_t) entry.slot] = moved;
+    entries[(size_t) moved].slot = entry.slot;
+    cell.pop_back();
+    entry = {};
+}
+
+/**
+ * @brief Ranks the tracks that mix well after a target.
+ *
+ * Each candidate costs its key distance (0 for the same key, 1 for a
+ * neighbour) plus its tempo change as a fraction of the tolerance, plus a
+ * little more for half or double time.
+ *
+ * @param bpm The target tempo, or 0 if unknown.
+ * @param camelot The target Camelot key, or -1 if unknown.
+ * @param tolerance Largest tempo change allowed, as a fraction (0.06 is 6%).
+ * @return Compatible IDs, best match first.
+ */
+std::vector<int> TrackSuggestionIndex::suggest(float bpm, int camelot, float tolerance) const
+{
+    const bool hasTempo = bpm > 0.0f;
+
+    if (! hasTempo && camelot < 0)
+        return {};
+
+    std::vector<int> keys;
+
+    if (camelot >= 0)
+    {
+        const int number = camelot / 2;
+        const int letter = camelot % 2;
+        keys = { camelot, ((number + 1) % 12) * 2 + letter, ((number + 11) % 12) * 2 + letter, number * 2 + (1 - letter) };
+    }
+    else
+    {
+        for (int key = 0; key < numKeys; ++key)
+            keys.push_back(key);
+    }
+
+    std::vector<int> buckets;
+
+    if (hasTempo)
+    {
+        const float low = bpm / (1.0f + tolerance);
+        const float high = bpm * (1.0f + tolerance);
+
+        // The folded tempos form a circle: bucket 0 follows the last one.
+        if (high >= low * 2.0f)
+        {
+            for (int bucket = 0; bucket < numBuckets - 1; ++bucket)
+                buckets.push_back(bucket);
+        }
+        else
+        {
+            const int first = juce::jmin(numBuckets - 2, (int) (fold(low) - minBpm));
+            const int last = juce::jmin(numBuckets - 2, (int) (fold(high) - minBpm));
+
+            for (int bucket = first;; bucket = (bucket + 1) % (numBuckets - 1))
+            {
+                buckets.push_back(bucket);
+
+                if (bucket == last)
+                    break;
+            }
+        }
+    }
+    else
+    {
+        for (int bucket = 0; bucket < numBuckets; ++bucket)
+            buckets.push_back(bucket);
+    }
+
+    const float maxDistance = std::log2(1.0f + tolerance);
+    std::vector<std::pair<float, int>> ranked;
+
+    for (int key : keys)
+    {
+        const float keyCost = key == camelot || camelot < 0 ? 0.0f : neighbourKeyPenalty;
+
+        for (int bucket : buckets)
+        {
+            for (int id : cells[(size_t) cellFor(key, bucket)])
+            {
+                float cost = keyCost;
+
+                if (hasTempo)
+                {
+                    const float octaves = std::log2(entries[(size_t) id].bpm / bpm);
+                    const float nearestOctave = std::round(octaves);
+                    const float distance = std::abs(octaves - nearestOctave);
+
+                    if (distance > maxDistance)
+                        continue;
+
+                    cost += distance / maxDistance;
+
+                    if (nearestOctave != 0.0f)
+                        cost += octavePenalty;
+                }
+
+                ranked.emplace_back(cost, id);
+            }
+        }
+    }
+
+    std::sort(ranked.begin(), ranked.end());
+
+    std::vector<int> ids;
+    ids.reserve(ranked.size());
+
+    for (const auto& [cost, id] : ranked)
+        ids.push_back(id);
+
+    return ids;
+}
+
+/**
+ * @brief Doubles or halves a tempo into [minBpm, 2 * minBpm).
+ * @param bpm A tempo above zero.
+ * @return The folded tempo.
+ */
+float TrackSuggestionIndex::fold(float bpm)
+{
+    while (bpm >= minBpm * 2.0f)
+        bpm *= 0.5f;
+
+    while (bpm < minBpm)
+        bpm *= 2.0f;
+
+    return bpm;
+}
@@ -0,0 +1,121 @@
+/**
+ * =================================================================
+ * @file TrackSuggestionIndex.h
+ * @brief Declaration of the TrackSuggestionIndex class.
+ *
+ * This file declares the key and tempo grid the playlist uses to rank
+ * tracks that mix well after the one playing.
+ *
+ * Created: 18 Oct 2026 11:52:06pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackMetadataService.h"
+
+/**
+ * @class TrackSuggestionIndex
+ * @brief Bucketed grid over Camelot key and tempo for "next track" suggestions.
+ *
+ * Each track sits in one cell: its Camelot key (24 keys plus one for
+ * unknown) by its tempo folded into a single octave, one BPM per bucket.
+ * Folding puts a track at 64 BPM in the same bucket as one at 128, so half
+ * and double time come for free. A query only visits the cells of the keys
+ * that mix with the target (same key, one step round the wheel, or the
+ * relative major or minor) and the few buckets inside the tempo window, so
+ * its cost depends on how many tracks are compatible, not on library size.
+ *
+ * Call only from the message thread.
+ */
+class TrackSuggestionIndex
+{
+public:
+    /** Camelot keys run 0 to 23: (number - 1) * 2, plus 1 for the major ("B") keys. */
+    static constexpr int numKeys = 24;
+
+    /**
+     * @brief Parses a key as Camelot ("8A"), Open Key ("1m") or musical ("Am", "F# minor", "Bb").
+     * @param key The key text.
+     * @return The Camelot key, or -1 if the text is not a key.
+     */
+    static int toCamelot(const juce::String& key);
+
+    /**
+     * @brief Formats a Camelot key, e.g. "8A".
+     * @param camelot The Camelot key.
+     * @return The key text, or an empty string for -1.
+     */
+    static juce::String camelotName(int camelot);
+
+    /**
+     * @brief Moves a Camelot key by a number of semitones.
+     * @param camelot The Camelot key, or -1.
+     * @param semitones Semitones to move up; negative to move down.
+     * @return The transposed key, or -1 for -1.
+     */
+    static int transpose(int camelot, int semitones);
+
+    /**
+     * @brief Adds a track or replaces its key and tempo.
+     * @param id The track's ID; IDs should be small and dense.
+     * @param metadata The track's metadata.
+     */
+    void update(int id, const TrackMetadata& metadata);
+
+    /**
+     * @brief Removes a track.
+     * @param id The track's ID.
+     */
+    void remove(int id);
+
+    /**
+     * @brief Ranks the tracks that mix well after a target.
+     *
+     * With an unknown key every key is allowed; with an unknown tempo every
+     * tempo is. With neither there is nothing to rank by and nothing is
+     * returned.
+     *
+     * @param bpm The target tempo, or 0 if unknown.
+     * @param camelot The target Camelot key, or -1 if unknown.
+     * @param tolerance Largest tempo change allowed, as a fraction (0.06 is 6%).
+     * @return Compatible IDs, best match first.
+     */
+    std::vector<int> suggest(float bpm, int camelot, float tolerance = 0.06f) const;
+
+private:
+    /** Lowest folded tempo; every tempo is doubled or halved into [minBpm, 2 * minBpm). */
+    static constexpr float minBpm = 70.0f;
+
+    /** Tempo buckets per key; the last holds tracks of unknown tempo. */
+    static constexpr int numBuckets = (int) minBpm + 1;
+
+    /**
+     * @brief Where a track sits in the grid.
+     */
+    struct Entry {
+        int cell = -1;          ///< Cell index, -1 if the track is not indexed.
+        int slot = -1;          ///< Position in the cell.
+        float bpm = 0.0f;       ///< Tempo, 0 when unknown.
+        int camelot = -1;       ///< Camelot key, -1 when unknown.
+    };
+
+    /**
+     * @brief Doubles or halves a tempo into [minBpm, 2 * minBpm).
+     * @param bpm A tempo above zero.
+     * @return The folded tempo.
+     */
+    static float fold(float bpm);
+
+    /**
+     * @brief Gets the cell for a key and tempo bucket.
+     * @param camelot The Camelot key, or -1.
+     * @param bucket The tempo bucket.
+     * @return The cell index.
+     */
+    static int cellFor(int camelot, int bucket) { return (camelot + 1) * numBuckets + bucket; }
+
+    std::vector<Entry> entries;                                      ///< Grid position by ID.
+    std::vector<std::vector<int>> cells = std::vector<std::vector<int>>((size_t) ((numKeys + 1) * numBuckets)); ///< IDs in each cell, unordered.
+};
@@ -0,0 +1,72 @@
+/**
+ * =================================================================
+ * @file TripleBuffer.h
+ * @brief Declaration of the TripleBuffer class template.
+ *
+ * This file declares a wait-free triple buffer used to hand the latest value
+ * of something (such as a frame of meter data) from one thread to another.
+ *
+ * Created: 18 Oct 2026 3:20:11pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class TripleBuffer
+ * @brief Wait-free single-writer, single-reader handoff of the latest value.
+ *
+ * The writer always owns one slot and the reader another; the third sits in
+ * the middle. Publishing and reading are a single atomic exchange of slot
+ * indices, so neither side can ever block the other. Values the reader has
+ * not picked up yet are simply overwritten by newer ones.
+ *
+ * @tparam T The value type. Must be copy-assignable.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief Gets the slot the writer should fill next.
+     * @return Reference to the writer's slot.
+     */
+    T& getWriteBuffer()
+    {
+        return slots[(size_t) writeIndex];
+    }
+
+    /**
+     * @brief Publishes the writer's slot, making it the latest value.
+     */
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | dirtyFlag) & indexMask;
+    }
+
+    /**
+     * @brief Copies the latest value if a new one has been published.
+     * @param destination Receives the value.
+     * @return True if a new value was copied.
+     */
+    bool read(T& destination)
+    {
+        if ((middle.load() & dirtyFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex) & indexMask;
+        destination = slots[(size_t) readIndex];
+        return true;
+    }
+
+private:
+    static constexpr int dirtyFlag = 4;  ///< Set on the middle index when it holds unread data.
+    static constexpr int indexMask = 3;  ///< Bits holding the slot index.
+
+    std::array<T, 3> slots {};           ///< The three value slots.
+    int writeIndex = 0;                  ///< Slot owned by the writer.
+    int readIndex = 1;                   ///< Slot owned by the reader.
+    std::atomic<int> middle { 2 };       ///< Slot in the middle, plus the dirty flag.
+};
@@ -0,0 +1,396 @@
+/**
+ * =================================================================
+ * @file WaveformCache.cpp
+ * @brief Implementation of the WaveformCache class.
+ *
+ * Created: 18 Oct 2026 5:05:37pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+
+/**
+ * @class WaveformCache::BuildJob
+ * @brief Thread pool job that decodes one file into its pyramid.
+ */
+class WaveformCache::BuildJob : public juce::ThreadPoolJob
+{
+public:
+    /**
+     * @brief Constructor for BuildJob.
+     * @param ownerCache The cache that owns the job.
+     * @param formatManagerToUse Format manager used to open the file.
+     * @param pyramidToBuild The pyramid to fill; kept alive by the job.
+     */
+    BuildJob(WaveformCache& ownerCache, juce::AudioFormatManager& formatManagerToUse, std::shared_ptr<WaveformPyramid> pyramidToBuild)
+        : juce::ThreadPoolJob("Waveform " + pyramidToBuild->getFile().getFileName()),
+          owner(ownerCache),
+          formatManager(formatManagerToUse),
+          pyramid(std::move(pyramidToBuild))
+    {
+    }
+
+    /**
+     * @brief Builds the pyramid and tells the cache a worker is free.
+     * @return Always jobHasFinished.
+     */
+    JobStatus runJob() override
+    {
+        build();
+
+        {
+            const juce::ScopedLock sl (owner.finishedLock);
+            owner.finishedBuilds.add(pyramid->getFile().getFullPathName());
+        }
+
+        owner.triggerAsyncUpdate();
+        return jobHasFinished;
+    }
+
+private:
+    /**
+     * @brief Loads the pyramid from the store, or decodes the file and saves it.
+     */
+    void build()
+    {
+        const auto storeFile = owner.getStoreFileFor(pyramid->getFile());
+
+        if (storeFile.existsAsFile())
+        {
+            juce::FileInputStream input (storeFile);
+
+            if (input.openedOk() && pyramid->readFrom(input))
+            {
+                // Marks the file as recently used, so trimming the store keeps it.
+                storeFile.setLastModificationTime(juce::Time::getCurrentTime());
+                return;
+            }
+        }
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(pyramid->getFile()));
+
+        if (reader == nullptr)
+        {
+            std::cout << "WaveformCache could not open " << pyramid->getFile().getFullPathName() << std::endl;
+            return;
+        }
+
+        if (pyramid->build(*reader, [this] { return shouldExit(); }))
+        {
+            // Write beside the target and swap it in, so a crash never leaves half a file.
+            juce::TemporaryFile temporary (storeFile);
+            bool written = false;
+
+            {
+                juce::FileOutputStream output (temporary.getFile());
+                written = output.openedOk() && pyramid->writeTo(output);
+            }
+
+            if (written && temporary.overwriteTargetFileWithTemporary())
+                owner.trimStore();
+        }
+    }
+
+    WaveformCache& owner;                       ///< Locates the store file and hears when the job ends.
+    juce::AudioFormatManager& formatManager;    ///< Opens the file.
+    std::shared_ptr<WaveformPyramid> pyramid;   ///< The pyramid being built.
+};
+
+/**
+ * @brief Constructor for WaveformCache.
+ * @param formatManagerToUse Format manager used to open files for decoding.
+ * @param maximumBytes Memory budget for pyramids that are not on screen.
+ */
+WaveformCache::WaveformCache(juce::AudioFormatManager& formatManagerToUse, size_t maximumBytes)
+    : formatManager(formatManagerToUse), maxBytes(maximumBytes),
+      storeDirectory(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                         .getChildFile("New_DJ").getChildFile("WaveformCache"))
+{
+    storeDirectory.createDirectory();
+}
+
+/**
+ * @brief Destructor for WaveformCache.
+ */
+WaveformCache::~WaveformCache()
+{
+    pool.removeAllJobs(true, 5000);
+    cancelPendingUpdate();
+}
+
+/**
+ * @brief Gets the pyramid for a file, starting a build if there is none.
+ * @param file The audio file.
+ * @param priority How urgently the pyramid is wanted.
+ * @return The shared pyramid, or nullptr if the file does not exist.
+ */
+std::shared_ptr<WaveformPyramid> WaveformCache::getPyramid(const juce::File& file, Priority priority)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (! file.existsAsFile())
+        return nullptr;
+
+    const auto path = file.getFullPathName();
+    auto& entry = entries[path];
+    entry.lastUsed = ++requestCounter;
+
+    const bool created = entry.pyramid == nullptr;
+
+    if (created)
+        entry.pyramid = std::make_shared<WaveformPyramid>(file);
+
+    enqueue(path, entry, priority);
+    startBuilds();
+
+    // Held here so the eviction cannot take the pyramid being handed out.
+    auto pyramid = entry.pyramid;
+
+    if (created)
+        evictUnused();
+
+    return pyramid;
+}
+
+/**
+ * @brief Reorders queued builds around the rows a list is showing.
+ * @param visible Files in rows on screen.
+ * @param prefetch Files in rows just off screen.
+ */
+void WaveformCache::prioritise(const juce::Array<juce::File>& visible, const juce::Array<juce::File>& prefetch)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    std::set<juce::String> wanted;
+
+    for (const auto& file : visible)
+        wanted.insert(file.getFullPathName());
+
+    for (const auto& file : prefetch)
+        wanted.insert(file.getFullPathName());
+
+    // Cancel builds for rows that have scrolled away, keeping the decks' builds.
+    for (auto it = queue.begin(); it != queue.end();)
+    {
+        const auto& [priority, order, path] = *it;
+
+        if (priority != Priority::deck && wanted.count(path) == 0)
+        {
+            entries.at(path).queuedAt = 0;
+            it = queue.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    auto request = [this](const juce::File& file, Priority priority) {
+        auto found = entries.find(file.getFullPathName());
+
+        if (found != entries.end())
+            enqueue(found->first, found->second, priority);
+        else
+            getPyramid(file, priority);
+    };
+
+    for (const auto& file : visible)
+        request(file, Priority::visible);
+
+    for (const auto& file : prefetch)
+        request(file, Priority::prefetch);
+
+    startBuilds();
+    evictUnused();
+}
+
+/**
+ * @brief Works out where a file's pyramid is saved.
+ *
+ * Only 64 KB from each end of the file is hashed, which is enough to tell
+ * files apart without reading whole tracks. Called from the build jobs.
+ *
+ * @param audioFile The audio file.
+ * @return The store file for its pyramid.
+ */
+juce::File WaveformCache::getStoreFileFor(const juce::File& audioFile) const
+{
+    const juce::int64 size = audioFile.getSize();
+    const int sampleBytes = (int) juce::jmin((juce::int64) 65536, size);
+    juce::MemoryBlock identity;
+    juce::MemoryOutputStream key (identity, false);
+
+    key << audioFile.getFullPathName() << ':' << size << ':' << audioFile.getLastModificationTime().toMilliseconds() << ':';
+
+    juce::FileInputStream input (audioFile);
+
+    if (input.openedOk())
+    {
+        key.writeFromInputStream(input, sampleBytes);
+        input.setPosition(size - sampleBytes);
+        key.writeFromInputStream(input, sampleBytes);
+    }
+
+    key.flush();
+    return storeDirectory.getChildFile(juce::MD5(identity).toHexString() + ".wfp");
+}
+
+/**
+ * @brief Queues a build, or moves a queued one to a more urgent priority.
+ * @param path Full path of the audio file.
+ * @param entry The file's entry.
+ * @param priority How urgently the pyramid is wanted.
+ */
+void WaveformCache::enqueue(const juce::String& path, Entry& entry, Priority priority)
+{
+    if (entry.building || entry.attempted || entry.pyramid->isFullyBuilt())
+        return;
+
+    if (entry.queuedAt != 0)
+    {
+        if (priority >= entry.priority)
+            return;
+
+        dequeue(path, entry);
+    }
+
+    entry.priority = priority;
+    entry.queuedAt = ++queueCounter;
+    queue.emplace(priority, entry.queuedAt, path);
+}
+
+/**
+ * @brief Takes a queued build off the queue.
+ * @param path Full path of the audio file.
+ * @param entry The file's entry.
+ */
+void WaveformCache::dequeue(const juce::String& path, Entry& entry)
+{
+    queue.erase({ entry.priority, entry.queuedAt, path });
+    entry.queuedAt = 0;
+}
+
+/**
+ * @brief Starts queued builds, most urgent first, while workers are free.
+ */
+void WaveformCache::startBuilds()
+{
+    while (numBuilding < numWorkers && ! queue.empty())
+    {
+        const auto path = std::get<2>(*queue.begin());
+        auto& entry = entries[path];
+        dequeue(path, entry);
+
+        entry.building = true;
+        ++numBuilding;
+        pool.addJob(new BuildJob(*this, formatManager, entry.pyramid), true);
+    }
+}
+
+/**
+ * @brief Records finished builds and starts the next ones.
+ */
+void WaveformCache::handleAsyncUpdate()
+{
+    juce::StringArray finished;
+
+    {
+        const juce::ScopedLock sl (finishedLock);
+        finished.swapWith(finishedBuilds);
+    }
+
+    for (const auto& path : finished)
+    {
+        auto found = entries.find(path);
+
+        if (found != entries.end())
+        {
+            found->second.building = false;
+            found->second.attempted = true;
+        }
+
+        --numBuilding;
+    }
+
+    startBuilds();
+    evictUnused();
+}
+
+/**
+ * @brief Deletes the least recently used saved pyramids until the store fits maxStoreBytes.
+ *
+ * Called on a worker thread after each pyramid is saved; the workers take
+ * turns, so two never trim at once.
+ */
+void WaveformCache::trimStore()
+{
+    const juce::ScopedLock sl (storeLock);
+
+    auto files = storeDirectory.findChildFiles(juce::File::findFiles, false, "*.wfp");
+    juce::int64 totalBytes = 0;
+
+    for (const auto& file : files)
+        totalBytes += file.getSize();
+
+    if (totalBytes <= maxStoreBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b) {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (const auto& file : files)
+    {
+        if (totalBytes <= maxStoreBytes)
+            break;
+
+        const auto size = file.getSize();
+
+        if (file.deleteFile())
+            totalBytes -= size;
+    }
+}
+
+/**
+ * @brief Drops unused pyramids that will never finish, then unused finished ones until the cache fits its budget.
+ *
+ * A pyramid only the cache holds is not on screen. One that is neither
+ * built, building nor queued had its build cancelled or failed, so it is
+ * dropped straight away; asking for the file again starts afresh. Pyramids
+ * still building are kept, since their job holds a reference anyway.
+ */
+void WaveformCache::evictUnused()
+{
+    size_t totalBytes = 0;
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        const auto& entry = it->second;
+
+        if (entry.pyramid.use_count() == 1 && ! entry.building && entry.queuedAt == 0 && ! entry.pyramid->isFullyBuilt())
+        {
+            it = entries.erase(it);
+            continue;
+        }
+
+        totalBytes += entry.pyramid->getMemoryUsage();
+        ++it;
+    }
+
+    while (totalBytes > maxBytes)
+    {
+        auto oldest = entries.end();
+
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.pyramid.use_count() == 1 && it->second.pyramid->isFullyBuilt()
+                && (oldest == entries.end() || it->second.lastUsed < oldest->second.lastUsed))
+                oldest = it;
+
+        if (oldest == entries.end())
+            return;
+
+        totalBytes -= oldest->second.pyramid->getMemoryUsage();
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * =================================================================
+ * @file WaveformCache.h
+ * @brief Declaration of the WaveformCache class.
+ *
+ * This file declares the shared store of waveform pyramids. Every waveform
+ * view asks the cache for its track's pyramid, so a track is decoded once no
+ * matter how many views show it.
+ *
+ * Created: 18 Oct 2026 5:05:37pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+
+/**
+ * @class WaveformCache
+ * @brief Builds and shares one WaveformPyramid per audio file.
+ *
+ * Pyramids are built on a small background thread pool and saved to an
+ * on-disk store, so a track that has been seen before is loaded from the
+ * store instead of being decoded again. Builds wait in a priority queue and
+ * only as many run at once as there are workers: decks first, then rows on
+ * screen, then rows about to scroll into view. Queued builds for rows that
+ * have scrolled away are cancelled; a build that has already started is
+ * left to finish, since its result is saved to the store either way.
+ *
+ * Pyramids no view is using are evicted, oldest first, once the cache grows
+ * past its memory budget; ones whose build was cancelled or failed are
+ * evicted as soon as no view is using them. All public methods must be called from the
+ * message thread.
+ */
+class WaveformCache : private juce::AsyncUpdater
+{
+public:
+    /** How urgently a pyramid is wanted; queued builds run in this order. */
+    enum class Priority
+    {
+        deck,       ///< Loaded on a deck; never cancelled.
+        visible,    ///< Shown in a row on screen.
+        prefetch    ///< In a row just off screen.
+    };
+
+    /**
+     * @brief Constructor for WaveformCache.
+     * @param formatManager Format manager used to open files for decoding.
+     * @param maxBytes Memory budget for pyramids that are not on screen.
+     */
+    WaveformCache(juce::AudioFormatManager& formatManager, size_t maxBytes = 256 * 1024 * 1024);
+
+    /**
+     * @brief Destructor for WaveformCache.
+     *
+     * Stops any builds that are still running.
+     */
+    ~WaveformCache() override;
+
+    /**
+     * @brief Gets the pyramid for a file, starting a build if there is none.
+     *
+     * The returned pyramid may still be building; listen to it for progress.
+     * A queued build is moved up if the new priority is more urgent.
+     *
+     * @param file The audio file.
+     * @param priority How urgently the pyramid is wanted.
+     * @return The shared pyramid, or nullptr if the file does not exist.
+     */
+    std::shared_ptr<WaveformPyramid> getPyramid(const juce::File& file, Priority priority = Priority::deck);
+
+    /**
+     * @brief Reorders queued builds around the rows a list is showing.
+     *
+     * Visible files are queued first, prefetch files after them, and any
+     * other queued build that is not for a deck is cancelled.
+     *
+     * @param visible Files in rows on screen.
+     * @param prefetch Files in rows just off screen.
+     */
+    void prioritise(const juce::Array<juce::File>& visible, const juce::Array<juce::File>& prefetch);
+
+private:
+    class BuildJob;
+
+    /**
+     * @brief Works out where a file's pyramid is saved.
+     *
+     * The name is a hash of the path, size, modification time and a hash of
+     * the start and end of the file's contents, so any edit to the file
+     * (or a different file at the same path) misses the store.
+     *
+     * @param audioFile The audio file.
+     * @return The store file for its pyramid.
+     */
+    juce::File getStoreFileFor(const juce::File& audioFile) const;
+
+    /**
+     * @brief A cached pyramid and when it was last requested.
+     */
+    struct Entry {
+        std::shared_ptr<WaveformPyramid> pyramid;  ///< The pyramid.
+        juce::uint32 lastUsed = 0;                  ///< Request counter value at the last request.
+        Priority priority = Priority::prefetch;     ///< Priority it is queued at.
+        juce::uint32 queuedAt = 0;                  ///< Queue order while queued, 0 otherwise.
+        bool building = false;                      ///< True while a job is running for it.
+        bool attempted = false;                     ///< True once a job has run, even if it failed.
+    };
+
+    /** Orders the queue by priority, then by when each build was queued. */
+    using QueueKey = std::tuple<Priority, juce::uint32, juce::String>;
+
+    /**
+     * @brief Queues a build, or moves a queued one to a more urgent priority.
+     *
+     * Does nothing for pyramids that are built, building or failed to build.
+     *
+     * @param path Full path of the audio file.
+     * @param entry The file's entry.
+     * @param priority How urgently the pyramid is wanted.
+     */
+    void enqueue(const juce::String& path, Entry& entry, Priority priority);
+
+    /**
+     * @brief Takes a queued build off the queue.
+     * @param path Full path of the audio file.
+     * @param entry The file's entry.
+     */
+    void dequeue(const juce::String& path, Entry& entry);
+
+    /**
+     * @brief Starts queued builds, most urgent first, while workers are free.
+     */
+    void startBuilds();
+
+    /**
+     * @brief Records finished builds and starts the next ones.
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * @brief Drops unused pyramids that will never finish, then unused finished ones until the cache fits its budget.
+     */
+    void evictUnused();
+
+    /**
+     * @brief Deletes the least recently used saved pyramids until the store fits maxStoreBytes.
+     */
+    void trimStore();
+
+    juce::AudioFormatManager& formatManager;   ///< Opens files for the build jobs.
+    size_t maxBytes;                           ///< Memory budget.
+    juce::File storeDirectory;                 ///< Where pyramids are saved between runs.
+    juce::CriticalSection storeLock;           ///< Lets one worker at a time trim the store.
+    static constexpr juce::int64 maxStoreBytes = 512 * 1024 * 1024; ///< Disk budget for saved pyramids.
+    juce::uint32 requestCounter = 0;           ///< Incremented on each request, for LRU order.
+    std::map<juce::String, Entry> entries;     ///< Pyramids by full path.
+
+    static constexpr int numWorkers = 2;       ///< Builds that may run at once.
+    std::set<QueueKey> queue;                  ///< Builds waiting for a worker.
+    juce::uint32 queueCounter = 0;             ///< Incremented on each enqueue, for FIFO order within a priority.
+    int numBuilding = 0;                       ///< Jobs started and not yet reported finished.
+
+    juce::CriticalSection finishedLock;        ///< Guards finishedBuilds.
+    juce::StringArray finishedBuilds;          ///< Paths of builds waiting to be reported finished.
+
+    juce::ThreadPool pool { numWorkers };      ///< Runs the build jobs.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformCache)
+};
@@ -0,0 +1,639 @@
+/**
+ * =================================================================
+ * @file WaveformPyramid.cpp
+ * @brief Implementation of the WaveformPyramid class.
+ *
+ * Created: 18 Oct 2026 5:05:37pm
+ * Author: Jacques Thurling
+ */
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+
+namespace
+{
+    /**
+     * @brief The low-pass and high-pass Linkwitz-Riley filters of the band split, run side by side.
+     *
+     * Each Linkwitz-Riley filter is two Butterworth biquads in series. Lane 0
+     * of a SIMD register carries the low pass and lane 1 the high pass, so
+     * both filters cost two vector biquads per sample instead of four scalar
+     * ones. Both lanes start from the same input, so no lanes need shuffling.
+     */
+    class CrossoverPair
+    {
+    public:
+        using Lanes = juce::dsp::SIMDRegister<float>;
+
+        /**
+         * @brief Designs both filters.
+         * @param sampleRate Sample rate of the signal.
+         * @param lowFrequency Cut-off of the low pass, in Hz.
+         * @param highFrequency Cut-off of the high pass, in Hz.
+         */
+        CrossoverPair(double sampleRate, double lowFrequency, double highFrequency)
+        {
+            using Coefficients = juce::dsp::IIR::Coefficients<float>;
+            const auto lowPass = Coefficients::makeLowPass(sampleRate, lowFrequency);
+            const auto highPass = Coefficients::makeHighPass(sampleRate, highFrequency);
+
+            for (auto& stage : stages)
+            {
+                // Coefficients are normalised to { b0, b1, b2, a1, a2 }.
+                for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+                {
+                    const float* c = (lane == 1 ? highPass : lowPass)->getRawCoefficients();
+                    stage.b0.set(lane, c[0]);
+                    stage.b1.set(lane, c[1]);
+                    stage.b2.set(lane, c[2]);
+                    stage.a1.set(lane, c[3]);
+                    stage.a2.set(lane, c[4]);
+                }
+            }
+        }
+
+        /**
+         * @brief Filters a block, carrying the filter state on to the next.
+         * @param input The signal.
+         * @param low Receives the low-passed signal.
+         * @param high Receives the high-passed signal.
+         * @param numSamples Length of the block.
+         */
+        void process(const float* input, float* low, float* high, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto lanes = Lanes::expand(input[i]);
+
+                for (auto& stage : stages)
+                    lanes = stage.process(lanes);
+
+                low[i] = lanes.get(0);
+                high[i] = lanes.get(1);
+            }
+        }
+
+    private:
+        /**
+         * @brief One biquad per lane, in transposed direct form II.
+         */
+        struct Stage
+        {
+            Lanes process(Lanes in) noexcept
+            {
+                const auto out = b0 * in + s1;
+                s1 = b1 * in - a1 * out + s2;
+                s2 = b2 * in - a2 * out;
+                return out;
+            }
+
+            Lanes b0 = Lanes::expand(0.0f), b1 = Lanes::expand(0.0f), b2 = Lanes::expand(0.0f);
+            Lanes a1 = Lanes::expand(0.0f), a2 = Lanes::expand(0.0f);
+            Lanes s1 = Lanes::expand(0.0f), s2 = Lanes::expand(0.0f);
+        };
+
+        std::array<Stage, 2> stages;
+    };
+}
+
+/**
+ * @brief Constructs an empty pyramid for a file.
+ * @param fileToDescribe The audio file the pyramid describes.
+ */
+WaveformPyramid::WaveformPyramid(const juce::File& fileToDescribe)
+    : file(fileToDescribe)
+{
+    for (auto& ready : binsReady)
+        ready.store(0);
+}
+
+/**
+ * @brief Destructor for WaveformPyramid.
+ */
+WaveformPyramid::~WaveformPyramid()
+{
+}
+
+/**
+ * @brief Decodes the file once and fills every level.
+ *
+ * Level 0 is filled one chunk at a time and the higher levels are folded up
+ * behind it. The mono mix of each chunk is also split into three bands with
+ * fourth-order Linkwitz-Riley low and high passes, run side by side in SIMD
+ * lanes; the mid band is what is left once both are subtracted, so the bands
+ * always sum to the signal.
+ *
+ * @param reader Reader for the file.
+ * @param shouldStop Polled between chunks; return true to abandon the build.
+ * @return True if the build completed.
+ */
+bool WaveformPyramid::build(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop)
+{
+    if (numLevels.load() > 0 || reader.lengthInSamples <= 0 || reader.sampleRate <= 0.0)
+        return false;
+
+    allocateLevels(reader.sampleRate, reader.lengthInSamples);
+
+    const int binsPerChunk = 1024;
+    const int samplesPerChunk = binsPerChunk * baseSamplesPerBin;
+    const int numChannels = juce::jlimit(1, 2, (int) reader.numChannels);
+    juce::AudioBuffer<float> buffer(numChannels, samplesPerChunk);
+    juce::AudioBuffer<float> bands(3, samplesPerChunk);
+
+    CrossoverPair crossover(sampleRate, lowCrossover, highCrossover);
+    const juce::ScopedNoDenormals noDenormals;
+
+    auto bandRms = [&bands](int band, int start, int count) {
+        return (juce::uint8) juce::jlimit(0, 255, juce::roundToInt(bands.getRMSLevel(band, start, count) * 255.0f));
+    };
+
+    auto& finest = levels.front();
+    auto lastNotification = juce::Time::getMillisecondCounter();
+
+    for (juce::int64 chunkStart = 0; chunkStart < lengthInSamples; chunkStart += samplesPerChunk)
+    {
+        if (shouldStop())
+            return false;
+
+        const int numSamples = (int) juce::jmin((juce::int64) samplesPerChunk, lengthInSamples - chunkStart);
+        reader.read(&buffer, 0, numSamples, chunkStart, true, numChannels > 1);
+
+        float* lowBand = bands.getWritePointer(0);
+        float* midBand = bands.getWritePointer(1);
+        float* highBand = bands.getWritePointer(2);
+
+        juce::FloatVectorOperations::copy(midBand, buffer.getReadPointer(0), numSamples);
+
+        if (numChannels > 1)
+        {
+            juce::FloatVectorOperations::add(midBand, buffer.getReadPointer(1), numSamples);
+            juce::FloatVectorOperations::multiply(midBand, 0.5f, numSamples);
+        }
+
+        crossover.process(midBand, lowBand, highBand, numSamples);
+        juce::FloatVectorOperations::subtract(midBand, lowBand, numSamples);
+        juce::FloatVectorOperations::subtract(midBand, highBand, numSamples);
+
+        const int firstBin = (int) (chunkStart / baseSamplesPerBin);
+        const int chunkBins = (numSamples + baseSamplesPerBin - 1) / baseSamplesPerBin;
+
+        for (int b = 0; b < chunkBins; ++b)
+        {
+            const int start = b * baseSamplesPerBin;
+            const int count = juce::jmin(baseSamplesPerBin, numSamples - start);
+            float low = 0.0f, high = 0.0f, sumOfSquares = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, start), count);
+                low = juce::jmin(low, range.getStart());
+                high = juce::jmax(high, range.getEnd());
+
+                const float rms = buffer.getRMSLevel(channel, start, count);
+                sumOfSquares += rms * rms;
+            }
+
+            auto& bin = finest[(size_t) (firstBin + b)];
+            bin.min = (juce::int8) juce::jlimit(-127, 127, juce::roundToInt(low * 127.0f));
+            bin.max = (juce::int8) juce::jlimit(-127, 127, juce::roundToInt(high * 127.0f));
+            bin.rms = (juce::uint8) juce::jlimit(0, 255, juce::roundToInt(std::sqrt(sumOfSquares / (float) numChannels) * 255.0f));
+            bin.low = bandRms(0, start, count);
+            bin.mid = bandRms(1, start, count);
+            bin.high = bandRms(2, start, count);
+        }
+
+        binsReady[0].store(firstBin + chunkBins);
+        propagateLevels(chunkStart + numSamples >= lengthInSamples);
+
+        // Throttle progress messages; each one repaints every view of the track.
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if (now - lastNotification > 250)
+        {
+            lastNotification = now;
+            sendChangeMessage();
+        }
+    }
+
+    fullyBuilt.store(true);
+    sendChangeMessage();
+    return true;
+}
+
+/**
+ * @brief Fills the pyramid from data saved by writeTo().
+ * @param input Stream positioned at the saved data.
+ * @return True if the data was valid and the pyramid is now complete.
+ */
+bool WaveformPyramid::readFrom(juce::InputStream& input)
+{
+    if (numLevels.load() > 0 || input.readInt() != storageMagic)
+        return false;
+
+    const double rate = input.readDouble();
+    const juce::int64 length = input.readInt64();
+    const juce::int64 numBins = (length + baseSamplesPerBin - 1) / baseSamplesPerBin;
+    const size_t numBytes = (size_t) numBins * sizeof(Bin);
+
+    if (rate <= 0.0 || length <= 0 || numBytes > (size_t) std::numeric_limits<int>::max()
+        || input.getNumBytesRemaining() < (juce::int64) numBytes)
+        return false;
+
+    // Read into a scratch vector first so a truncated file leaves the pyramid untouched.
+    std::vector<Bin> finest ((size_t) numBins);
+
+    if (input.read(finest.data(), (int) numBytes) != (int) numBytes)
+        return false;
+
+    allocateLevels(rate, length, std::move(finest));
+    binsReady[0].store((int) numBins);
+    propagateLevels(true);
+    fullyBuilt.store(true);
+    sendChangeMessage();
+    return true;
+}
+
+/**
+ * @brief Saves a fully built pyramid.
+ * @param output Stream to write to.
+ * @return True if the pyramid was complete and written.
+ */
+bool WaveformPyramid::writeTo(juce::OutputStream& output) const
+{
+    if (! isFullyBuilt())
+        return false;
+
+    const auto& finest = levels.front();
+
+    return output.writeInt(storageMagic)
+        && output.writeDouble(sampleRate)
+        && output.writeInt64(lengthInSamples)
+        && output.write(finest.data(), finest.size() * sizeof(Bin));
+}
+
+/**
+ * @brief Sizes every level for a track and publishes the level count.
+ *
+ * Everything is allocated, and a ready-made level 0 moved in, before the
+ * count is published, so readers never see a vector being resized.
+ *
+ * @param rate Sample rate of the file.
+ * @param length Length of the file in samples.
+ * @param finest Ready-made level 0, e.g. read from the store, or empty to allocate it.
+ */
+void WaveformPyramid::allocateLevels(double rate, juce::int64 length, std::vector<Bin> finest)
+{
+    sampleRate = rate;
+    lengthInSamples = length;
+
+    int numBins = (int) ((lengthInSamples + baseSamplesPerBin - 1) / baseSamplesPerBin);
+
+    if (finest.size() == (size_t) numBins)
+        levels.push_back(std::move(finest));
+    else
+        levels.emplace_back((size_t) numBins);
+
+    while (numBins > 1 && (int) levels.size() < maxLevels)
+    {
+        numBins = (numBins + 1) / 2;
+        levels.emplace_back((size_t) numBins);
+    }
+
+    numLevels.store((int) levels.size());
+}
+
+/**
+ * @brief Fills the higher levels from the ready part of the level below.
+ *
+ * Each bin combines two bins of the level below: the outer min and max, and
+ * the RMS of the two RMS values for the level and each band.
+ *
+ * @param finished True once level 0 is complete, so odd trailing bins are included.
+ */
+void WaveformPyramid::propagateLevels(bool finished)
+{
+    auto combineRms = [](juce::uint8 a, juce::uint8 b) {
+        return (juce::uint8) juce::roundToInt(std::sqrt(((float) a * a + (float) b * b) * 0.5f));
+    };
+
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        const auto& below = levels[level - 1];
+        auto& current = levels[level];
+        const int belowReady = binsReady[level - 1].load();
+        const int target = finished ? (int) current.size() : belowReady / 2;
+
+        for (int i = binsReady[level].load(); i < target; ++i)
+        {
+            const auto& first = below[(size_t) i * 2];
+            const bool hasSecond = (size_t) i * 2 + 1 < below.size();
+            const auto& second = hasSecond ? below[(size_t) i * 2 + 1] : first;
+
+            auto& bin = current[(size_t) i];
+            bin.min = juce::jmin(first.min, second.min);
+            bin.max = juce::jmax(first.max, second.max);
+            bin.rms = combineRms(first.rms, second.rms);
+            bin.low = combineRms(first.low, second.low);
+            bin.mid = combineRms(first.mid, second.mid);
+            bin.high = combineRms(first.high, second.high);
+        }
+
+        binsReady[level].store(juce::jmax(binsReady[level].load(), target));
+    }
+}
+
+/**
+ * @brief Gets the file the pyramid describes.
+ * @return The audio file.
+ */
+const juce::File& WaveformPyramid::getFile() const
+{
+    return file;
+}
+
+/**
+ * @brief Checks whether every level has been filled.
+ * @return True once the build has finished.
+ */
+bool WaveformPyramid::isFullyBuilt() const
+{
+    return fullyBuilt.load();
+}
+
+/**
+ * @brief Gets the length of the track.
+ * @return The length in seconds, or 0 if the build has not started.
+ */
+double WaveformPyramid::getLengthInSeconds() const
+{
+    if (numLevels.load() == 0)
+        return 0.0;
+
+    return (double) lengthInSamples / sampleRate;
+}
+
+/**
+ * @brief Summarises a time range into a fixed number of points.
+ * @param startTime Start of the range in seconds.
+ * @param endTime End of the range in seconds.
+ * @param numPoints Number of points to produce (usually the width in pixels).
+ * @param peaks Receives the points; resized to numPoints.
+ * @return True if any data was available.
+ */
+bool WaveformPyramid::getPeaks(double startTime, double endTime, int numPoints, std::vector<Peak>& peaks) const
+{
+    peaks.assign((size_t) juce::jmax(0, numPoints), Peak());
+
+    const int levelCount = numLevels.load();
+
+    if (levelCount == 0 || numPoints <= 0 || endTime <= startTime)
+        return false;
+
+    const double samplesPerPoint = (endTime - startTime) * sampleRate / numPoints;
+
+    // The coarsest level with at least one bin per point, falling back to a
+    // finer one if it has not been built yet.
+    int level = 0;
+
+    while (level + 1 < levelCount && (double) (baseSamplesPerBin << (level + 1)) <= samplesPerPoint)
+        ++level;
+
+    while (level > 0 && binsReady[(size_t) level].load() == 0)
+        --level;
+
+    const auto& bins = levels[(size_t) level];
+    const int ready = binsReady[(size_t) level].load();
+    const double samplesPerBin = (double) (baseSamplesPerBin << level);
+    bool anyData = false;
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        const double firstSample = startTime * sampleRate + point * samplesPerPoint;
+        const int firstBin = juce::jmax(0, (int) std::floor(firstSample / samplesPerBin));
+        const int endBin = juce::jmin(ready, juce::jmax(firstBin + 1, (int) std::ceil((firstSample + samplesPerPoint) / samplesPerBin)));
+
+        if (firstBin >= endBin)
+            continue;
+
+        int low = 127, high = -127;
+        float sumOfSquares = 0.0f, lowSquares = 0.0f, midSquares = 0.0f, highSquares = 0.0f;
+
+        for (int i = firstBin; i < endBin; ++i)
+        {
+            const auto& bin = bins[(size_t) i];
+            low = juce::jmin(low, (int) bin.min);
+            high = juce::jmax(high, (int) bin.max);
+            sumOfSquares += (float) bin.rms * bin.rms;
+            lowSquares += (float) bin.low * bin.low;
+            midSquares += (float) bin.mid * bin.mid;
+            highSquares += (float) bin.high * bin.high;
+        }
+
+        const float binCount = (float) (endBin - firstBin);
+
+        auto& peak = peaks[(size_t) point];
+        peak.min = low / 127.0f;
+        peak.max = high / 127.0f;
+        peak.rms = std::sqrt(sumOfSquares / binCount) / 255.0f;
+        peak.low = std::sqrt(lowSquares / binCount) / 255.0f;
+        peak.mid = std::sqrt(midSquares / binCount) / 255.0f;
+        peak.high = std::sqrt(highSquares / binCount) / 255.0f;
+        anyData = true;
+    }
+
+    return anyData;
+}
+
+/**
+ * @brief Draws a time range of the waveform with the current fill.
+ * @param g The graphics context used for drawing.
+ * @param area The area to draw into.
+ * @param startTime Start of the range in seconds.
+ * @param endTime End of the range in seconds.
+ */
+void WaveformPyramid::drawWaveform(juce::Graphics& g, juce::Rectangle<int> area, double startTime, double endTime) const
+{
+    std::vector<Peak> peaks;
+
+    if (! getPeaks(startTime, endTime, area.getWidth(), peaks))
+        return;
+
+    const float centre = (float) area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+
+    {
+        juce::Graphics::ScopedSaveState state(g);
+        g.setOpacity(0.5f);
+
+        for (int x = 0; x < area.getWidth(); ++x)
+        {
+            const auto& peak = peaks[(size_t) x];
+            const float top = centre - peak.max * halfHeight;
+            g.fillRect((float) (area.getX() + x), top, 1.0f, juce::jmax(1.0f, (peak.max - peak.min) * halfHeight));
+        }
+    }
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        const float extent = peaks[(size_t) x].rms * halfHeight;
+
+        if (extent > 0.0f)
+            g.fillRect((float) (area.getX() + x), centre - extent, 1.0f, extent * 2.0f);
+    }
+}
+
+/**
+ * @brief Draws a time range of the waveform coloured by frequency content.
+ * @param g The graphics context used for drawing.
+ * @param area The area to draw into.
+ * @param startTime Start of the range in seconds.
+ * @param endTime End of the range in seconds.
+ * @param brightness Scales every column's colour (0.0 - 1.0).
+ */
+void WaveformPyramid::drawBandWaveform(juce::Graphics& g, juce::Rectangle<int> area, double startTime, double endTime, float brightness) const
+{
+    std::vector<Peak> peaks;
+
+    if (! getPeaks(startTime, endTime, area.getWidth(), peaks))
+        return;
+
+    const float centre = (float) area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        const auto& peak = peaks[(size_t) x];
+        const float strongest = juce::jmax(peak.low, peak.mid, peak.high);
+
+        if (strongest <= 0.0f)
+            continue;
+
+        const float scale = brightness / strongest;
+        g.setColour(juce::Colour::fromFloatRGBA(peak.low * scale, peak.mid * scale, peak.high * scale, 1.0f));
+        g.fillRect((float) (area.getX() + x), centre - peak.max * halfHeight, 1.0f, juce::jmax(1.0f, (peak.max - peak.min) * halfHeight));
+    }
+}
+
+/**
+ * @brief Gets the memory taken by the pyramid's levels.
+ * @return The size in bytes.
+ */
+size_t WaveformPyramid::getMemoryUsage() const
+{
+    if (numLevels.load() == 0)
+        return 0;
+
+    size_t bytes = 0;
+
+    for (const auto& level : levels)
+        bytes += level.size() * sizeof(Bin);
+
+    return bytes;
+}
+
+/**
+ * @brief Measures how many times faster than real time the band split and a full build run, and prints the results.
+ * @param file Audio file to analyse; a synthetic five minute track is written there if it does not exist.
+ */
+void WaveformPyramid::runBenchmark(const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    if (! file.existsAsFile())
+    {
+        std::cout << "Writing a synthetic track to " << file.getFullPathName() << std::endl;
+
+        const double rate = 44100.0;
+        const int blockSize = 65536;
+        juce::AudioBuffer<float> block(2, blockSize);
+        juce::Random random(42);
+        double phase = 0.0;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(new juce::FileOutputStream(file), rate, 2, 16, {}, 0));
+
+        if (writer == nullptr)
+        {
+            std::cerr << "Failed to create " << file.getFullPathName() << std::endl;
+            return;
+        }
+
+        // A kick-like low tone under broadband noise, so every band has energy.
+        for (juce::int64 written = 0; written < (juce::int64) (rate * 300.0); written += blockSize)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                phase += juce::MathConstants<double>::twoPi * 60.0 / rate;
+                const float sample = 0.5f * (float) std::sin(phase) + 0.2f * (random.nextFloat() * 2.0f - 1.0f);
+                block.setSample(0, i, sample);
+                block.setSample(1, i, sample);
+            }
+
+            writer->writeFromAudioSampleBuffer(block, 0, blockSize);
+        }
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+    {
+        std::cerr << "Cannot read " << file.getFullPathName() << std::endl;
+        return;
+    }
+
+    const double seconds = (double) reader->lengthInSamples / reader->sampleRate;
+    std::cout << "Waveform benchmark: " << file.getFullPathName() << " (" << juce::String(seconds, 1) << " s)" << std::endl;
+
+    auto time = [&](const juce::String& name, const std::function<void()>& run) {
+        double bestSeconds = 0.0;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            run();
+            const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            bestSeconds = i == 0 ? elapsed : juce::jmin(bestSeconds, elapsed);
+        }
+
+        std::cout << name << ": " << juce::String(seconds / juce::jmax(bestSeconds, 1.0e-9), 0) << "x real time" << std::endl;
+    };
+
+    // The band split on its own, over the mono mix of the whole track.
+    const int length = (int) juce::jmin(reader->lengthInSamples, (juce::int64) std::numeric_limits<int>::max() / 2);
+    juce::AudioBuffer<float> mono(1, length);
+    juce::AudioBuffer<float> bands(2, length);
+    reader->read(&mono, 0, length, 0, true, false);
+    const juce::ScopedNoDenormals noDenormals;
+
+    time("  band split, scalar IIR filters", [&] {
+        std::array<juce::dsp::IIR::Filter<float>, 2> lowPass, highPass;
+
+        for (auto& stage : lowPass)
+            stage.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(reader->sampleRate, lowCrossover);
+
+        for (auto& stage : highPass)
+            stage.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(reader->sampleRate, highCrossover);
+
+        const float* input = mono.getReadPointer(0);
+        float* low = bands.getWritePointer(0);
+        float* high = bands.getWritePointer(1);
+
+        for (int i = 0; i < length; ++i)
+        {
+            low[i] = lowPass[1].processSample(lowPass[0].processSample(input[i]));
+            high[i] = highPass[1].processSample(highPass[0].processSample(input[i]));
+        }
+    });
+
+    time("  band split, SIMD lanes", [&] {
+        CrossoverPair crossover(reader->sampleRate, lowCrossover, highCrossover);
+        crossover.process(mono.getReadPointer(0), bands.getWritePointer(0), bands.getWritePointer(1), length);
+    });
+
+    // Complete builds, including decoding, on this thread.
+    time("  full build", [&] {
+        WaveformPyramid pyramid(file);
+        pyramid.build(*reader, [] { return false; });
+    });
+}
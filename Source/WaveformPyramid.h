@@ -0,0 +1,211 @@
+/**
+ * =================================================================
+ * @file WaveformPyramid.h
+ * @brief Declaration of the WaveformPyramid class.
+ *
+ * This file declares the multi-resolution waveform summary of a track that
+ * every waveform view draws from. Each level halves the resolution of the
+ * one below it, so any zoom can be drawn from a level with about one bin per
+ * pixel.
+ *
+ * Created: 18 Oct 2026 5:05:37pm
+ * Author: Jacques Thurling
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class WaveformPyramid
+ * @brief Mip-mapped min/max/RMS and band energy summary of one audio file.
+ *
+ * The pyramid is filled by build() on a background thread with a single
+ * decode of the file. Levels become readable progressively while the build
+ * runs, and a change message is sent as new data arrives so views can
+ * repaint.
+ */
+class WaveformPyramid : public juce::ChangeBroadcaster
+{
+public:
+    /**
+     * @brief One bin of a level, quantised to keep large libraries small.
+     */
+    struct Bin {
+        juce::int8 min = 0;   ///< Lowest sample, scaled to -127..127.
+        juce::int8 max = 0;   ///< Highest sample, scaled to -127..127.
+        juce::uint8 rms = 0;  ///< RMS level, scaled to 0..255.
+        juce::uint8 low = 0;  ///< RMS below the low crossover, scaled to 0..255.
+        juce::uint8 mid = 0;  ///< RMS between the crossovers, scaled to 0..255.
+        juce::uint8 high = 0; ///< RMS above the high crossover, scaled to 0..255.
+    };
+
+    /**
+     * @brief A bin converted back to linear sample values.
+     */
+    struct Peak {
+        float min = 0.0f;  ///< Lowest sample (-1.0 - 1.0).
+        float max = 0.0f;  ///< Highest sample (-1.0 - 1.0).
+        float rms = 0.0f;  ///< RMS level (0.0 - 1.0).
+        float low = 0.0f;  ///< Low band RMS level (0.0 - 1.0).
+        float mid = 0.0f;  ///< Mid band RMS level (0.0 - 1.0).
+        float high = 0.0f; ///< High band RMS level (0.0 - 1.0).
+    };
+
+    /** Number of source samples summarised by each bin of level 0. */
+    static constexpr int baseSamplesPerBin = 64;
+
+    /** Upper bound on the number of levels. */
+    static constexpr int maxLevels = 20;
+
+    /** Crossover between the low and mid bands, in Hz. */
+    static constexpr double lowCrossover = 200.0;
+
+    /** Crossover between the mid and high bands, in Hz. */
+    static constexpr double highCrossover = 2500.0;
+
+    /**
+     * @brief Constructs an empty pyramid for a file.
+     * @param file The audio file the pyramid describes.
+     */
+    explicit WaveformPyramid(const juce::File& file);
+
+    /**
+     * @brief Destructor for WaveformPyramid.
+     */
+    ~WaveformPyramid() override;
+
+    /**
+     * @brief Decodes the file once and fills every level.
+     *
+     * Called on a background thread. Readers may use the pyramid while this
+     * runs.
+     *
+     * @param reader Reader for the file.
+     * @param shouldStop Polled between chunks; return true to abandon the build.
+     * @return True if the build completed.
+     */
+    bool build(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop);
+
+    /**
+     * @brief Fills the pyramid from data saved by writeTo().
+     *
+     * Only level 0 is stored; the higher levels are folded up from it, which
+     * takes a fraction of the time of decoding the file.
+     *
+     * @param input Stream positioned at the saved data.
+     * @return True if the data was valid and the pyramid is now complete.
+     */
+    bool readFrom(juce::InputStream& input);
+
+    /**
+     * @brief Saves a fully built pyramid.
+     * @param output Stream to write to.
+     * @return True if the pyramid was complete and written.
+     */
+    bool writeTo(juce::OutputStream& output) const;
+
+    /**
+     * @brief Gets the file the pyramid describes.
+     * @return The audio file.
+     */
+    const juce::File& getFile() const;
+
+    /**
+     * @brief Checks whether every level has been filled.
+     * @return True once the build has finished.
+     */
+    bool isFullyBuilt() const;
+
+    /**
+     * @brief Gets the length of the track.
+     * @return The length in seconds, or 0 if the build has not started.
+     */
+    double getLengthInSeconds() const;
+
+    /**
+     * @brief Summarises a time range into a fixed number of points.
+     *
+     * Picks the coarsest level that still has at least one bin per point.
+     * Points whose data is not built yet are left at zero.
+     *
+     * @param startTime Start of the range in seconds.
+     * @param endTime End of the range in seconds.
+     * @param numPoints Number of points to produce (usually the width in pixels).
+     * @param peaks Receives the points; resized to numPoints.
+     * @return True if any data was available.
+     */
+    bool getPeaks(double startTime, double endTime, int numPoints, std::vector<Peak>& peaks) const;
+
+    /**
+     * @brief Draws a time range of the waveform with the current fill.
+     *
+     * The min/max outline is drawn at reduced opacity with the RMS body on
+     * top at full opacity, one column per pixel.
+     *
+     * @param g The graphics context used for drawing.
+     * @param area The area to draw into.
+     * @param startTime Start of the range in seconds.
+     * @param endTime End of the range in seconds.
+     */
+    void drawWaveform(juce::Graphics& g, juce::Rectangle<int> area, double startTime, double endTime) const;
+
+    /**
+     * @brief Draws a time range of the waveform coloured by frequency content.
+     *
+     * Each column is tinted red, green and blue by its low, mid and high band
+     * energies, normalised so the strongest band is at full brightness.
+     *
+     * @param g The graphics context used for drawing.
+     * @param area The area to draw into.
+     * @param startTime Start of the range in seconds.
+     * @param endTime End of the range in seconds.
+     * @param brightness Scales every column's colour (0.0 - 1.0).
+     */
+    void drawBandWaveform(juce::Graphics& g, juce::Rectangle<int> area, double startTime, double endTime, float brightness = 1.0f) const;
+
+    /**
+     * @brief Gets the memory taken by the pyramid's levels.
+     * @return The size in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * @brief Measures how many times faster than real time the band split and a full build run, and prints the results.
+     *
+     * Compares the band split against plain scalar IIR filters on the same
+     * signal, then times complete builds of the file on one thread.
+     *
+     * @param file Audio file to analyse; a synthetic five minute track is written there if it does not exist.
+     */
+    static void runBenchmark(const juce::File& file);
+
+private:
+    /** Tag at the start of saved data; changes whenever the layout does. */
+    static constexpr int storageMagic = 0x32504657; // "WFP2"
+
+    /**
+     * @brief Sizes every level for a track and publishes the level count.
+     * @param rate Sample rate of the file.
+     * @param length Length of the file in samples.
+     * @param finest Ready-made level 0, e.g. read from the store, or empty to allocate it.
+     */
+    void allocateLevels(double rate, juce::int64 length, std::vector<Bin> finest = {});
+
+    /**
+     * @brief Fills the higher levels from the ready part of the level below.
+     * @param finished True once level 0 is complete, so odd trailing bins are included.
+     */
+    void propagateLevels(bool finished);
+
+    juce::File file;                         ///< The audio file described.
+    double sampleRate = 0.0;                 ///< Sample rate of the file.
+    juce::int64 lengthInSamples = 0;         ///< Length of the file in samples.
+
+    std::vector<std::vector<Bin>> levels;    ///< Level 0 is the finest.
+    std::atomic<int> numLevels { 0 };        ///< Number of levels allocated, 0 until the build starts.
+    std::array<std::atomic<int>, maxLevels> binsReady; ///< Number of filled bins in each level.
+    std::atomic<bool> fullyBuilt { false };  ///< Set when every level is complete.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformPyramid)
+};